@@ -47,6 +47,13 @@ settings =
     windStrength = 5.0,
     windFrequency = 10000.0,
     windEnabled = true,
+    frustumCulling = true,
+    parallelRecording = true,
+    -- Animation level of detail
+    animationLod = true,
+    animationFullRateDistance = 30.0,
+    animationFreezeDistance = 250.0,
+    animationReducedInterval = 4,
     -- Water
     numWaterCells = 512,
     waterLevel = 0.5,
@@ -0,0 +1,49 @@
+#version 450
+
+#extension GL_GOOGLE_include_directive : enable
+
+#include "vertex.glsl"
+#include "shared_variables.glsl"
+#include "baked_animation.glsl"
+
+// Instancing input
+layout (location = 7) in mat4 InInstanceWorld;
+layout (location = 11) in float InInstanceAnimationPhase;
+
+layout (location = 0) out vec4 OutColor;
+layout (location = 1) out vec3 OutPosW;
+layout (location = 2) out vec3 OutNormalW;
+layout (location = 3) out vec2 OutTex;
+layout (location = 4) out vec3 OutNormalV;
+layout (location = 5) out vec2 OutTextureTiling;
+layout (location = 6) out vec3 OutTangentL;
+layout (location = 7) out mat3 OutTBN;
+
+out gl_PerVertex
+{
+   vec4 gl_Position;
+};
+
+void main()
+{
+   // sharedVariables.time is in milliseconds
+   mat4 skinMat = GetBakedSkinMatrix(InJointIndices, InJointWeights, sharedVariables.time / 1000.0, InInstanceAnimationPhase);
+   mat4 world = InInstanceWorld * skinMat;
+
+   vec3 bitangentL = cross(InNormalL, InTangentL.xyz);
+   vec3 T = normalize(mat3(world) * InTangentL.xyz);
+   vec3 B = normalize(mat3(world) * bitangentL);
+   vec3 N = normalize(mat3(world) * InNormalL);
+   OutTBN = mat3(T, B, N); // = transpose(mat3(T, B, N));
+
+   OutColor = vec4(1.0);
+   OutPosW = (world * vec4(InPosL.xyz, 1.0)).xyz;
+   OutNormalW = transpose(inverse(mat3(world))) * InNormalL;
+   mat3 normalMatrix = transpose(inverse(mat3(sharedVariables.viewMatrix * world)));
+   OutNormalV = normalMatrix * InNormalL;
+   OutTex = InTex;
+   OutTextureTiling = vec2(1.0, 1.0);
+   OutTangentL = InTangentL.xyz;
+
+   gl_Position = sharedVariables.projectionMatrix * sharedVariables.viewMatrix * world * vec4(InPosL.xyz, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+/**
+ * Joint matrices of a skinned animation sampled at a fixed rate, the joints of a frame are stored after each other.
+ *
+ * Matches the buffer layout in source\utopian\core\renderer\BakedAnimation.h.
+ */
+layout (std430, set = 2, binding = 0) readonly buffer BakedJointMatrices
+{
+   uint numJoints;
+   uint numFrames;
+   float sampleRate;
+   float pad;
+   mat4 jointMatrices[];
+} bakedAnimation;
+
+// Returns the skin matrix of the vertex at time in seconds, phase offsets the instance by a fraction of the animation.
+// The two closest frames are blended, the last frame is followed by the first one.
+mat4 GetBakedSkinMatrix(vec4 jointIndices, vec4 jointWeights, float time, float phase)
+{
+   float numFrames = float(bakedAnimation.numFrames);
+   float frame = mod(time * bakedAnimation.sampleRate + phase * numFrames, numFrames);
+   uint frame0 = min(uint(frame), bakedAnimation.numFrames - 1u);
+   uint frame1 = (frame0 + 1u) % bakedAnimation.numFrames;
+   float blend = fract(frame);
+
+   uint offset0 = frame0 * bakedAnimation.numJoints;
+   uint offset1 = frame1 * bakedAnimation.numJoints;
+
+   mat4 skinMat = mat4(0.0);
+   for (int i = 0; i < 4; i++)
+   {
+      uint joint = uint(jointIndices[i]);
+      mat4 jointMat = (1.0 - blend) * bakedAnimation.jointMatrices[offset0 + joint] +
+                      blend * bakedAnimation.jointMatrices[offset1 + joint];
+      skinMat += jointWeights[i] * jointMat;
+   }
+
+   return skinMat;
+}
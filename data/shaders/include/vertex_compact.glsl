@@ -0,0 +1,26 @@
+
+/**
+ * The compact vertex layout used by static instanced meshes.
+ *
+ * Matches attribute layout of CompactVertex in source\utopian\vulkan\Vertex.h.
+ * The attributes are decoded to the same names as in vertex.glsl so the shader
+ * code can be shared with the default layout.
+ */
+layout (location = 0) in vec4 InPosPacked;     // xyz: position, w: tangent handedness
+layout (location = 1) in vec2 InNormalPacked;  // Octahedral encoded
+layout (location = 2) in vec2 InTex;
+layout (location = 3) in vec4 InColorPacked;
+layout (location = 4) in vec2 InTangentPacked; // Octahedral encoded
+
+vec3 DecodeOctahedral(vec2 e)
+{
+   vec3 v = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+   float t = max(-v.z, 0.0);
+   v.xy += vec2(v.x >= 0.0 ? -t : t, v.y >= 0.0 ? -t : t);
+   return normalize(v);
+}
+
+#define InPosL InPosPacked.xyz
+#define InNormalL DecodeOctahedral(InNormalPacked)
+#define InColor InColorPacked.rgb
+#define InTangentL vec4(DecodeOctahedral(InTangentPacked), InPosPacked.w)
@@ -0,0 +1,38 @@
+#version 450
+
+#extension GL_GOOGLE_include_directive : enable
+
+#include "vertex.glsl"
+#include "shared_variables.glsl"
+#include "baked_animation.glsl"
+
+// Instancing input
+layout (location = 7) in mat4 InInstanceWorld;
+layout (location = 11) in float InInstanceAnimationPhase;
+
+layout (std140, set = 0, binding = 0) uniform UBO_cascadeTransforms
+{
+   mat4 viewProjection[4];
+} cascade_transforms;
+
+layout (push_constant) uniform PushConstants {
+   mat4 world; // Used by shadowmap.vert
+   uint cascadeIndex;
+} pushConstants;
+
+layout (location = 0) out vec2 OutTex;
+
+out gl_PerVertex
+{
+   vec4 gl_Position;
+};
+
+void main()
+{
+   // sharedVariables.time is in milliseconds
+   mat4 skinMat = GetBakedSkinMatrix(InJointIndices, InJointWeights, sharedVariables.time / 1000.0, InInstanceAnimationPhase);
+
+   OutTex = InTex;
+
+   gl_Position = cascade_transforms.viewProjection[pushConstants.cascadeIndex] * InInstanceWorld * skinMat * vec4(InPosL.xyz, 1.0);
+}
\ No newline at end of file
@@ -49,3 +49,4 @@ include "source/editor/premake.lua"
 include "source/demos/marching_cubes/premake.lua"
 include "source/demos/pbr/premake.lua"
 include "source/demos/raytracing/premake.lua"
+include "source/benchmarks/premake.lua"
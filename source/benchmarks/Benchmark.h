@@ -0,0 +1,32 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace Benchmark
+{
+   /** Runs func the given number of times and returns the average time in microseconds. */
+   template <typename T>
+   double Measure(uint32_t iterations, T func)
+   {
+      auto start = std::chrono::high_resolution_clock::now();
+
+      for (uint32_t i = 0; i < iterations; i++)
+         func(i);
+
+      auto end = std::chrono::high_resolution_clock::now();
+      return std::chrono::duration<double, std::micro>(end - start).count() / iterations;
+   }
+
+   inline void Report(const std::string& name, double microseconds)
+   {
+      printf("  %-40s %12.3f us\n", name.c_str(), microseconds);
+   }
+
+   void RunBvhBenchmark();
+   void RunHeightmapBenchmark();
+   void RunModelBakingBenchmark();
+   void RunSkinAnimatorBenchmark();
+}
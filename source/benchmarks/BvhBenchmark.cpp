@@ -0,0 +1,133 @@
+#include <cfloat>
+#include <random>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "Benchmark.h"
+#include "utility/math/DynamicBvh.h"
+#include "utility/math/BoundingBox.h"
+#include "utility/math/Frustum.h"
+#include "utility/math/Ray.h"
+
+using namespace Utopian;
+
+namespace Benchmark
+{
+   // Compares the DynamicBvh against the linear loops previously used by
+   // World::RayIntersection and the renderer for a scene of 10k actors.
+   void RunBvhBenchmark()
+   {
+      const uint32_t numActors = 10000;
+      const float worldSize = 2000.0f;
+
+      std::mt19937 rng(1337);
+      std::uniform_real_distribution<float> position(-worldSize / 2.0f, worldSize / 2.0f);
+      std::uniform_real_distribution<float> extent(0.5f, 8.0f);
+      std::uniform_real_distribution<float> offset(-0.25f, 0.25f);
+
+      std::vector<BoundingBox> boxes(numActors);
+      for (auto& box : boxes)
+      {
+         glm::vec3 center = glm::vec3(position(rng), position(rng) * 0.05f, position(rng));
+         glm::vec3 halfExtents = glm::vec3(extent(rng), extent(rng), extent(rng));
+         box.Init(center - halfExtents, halfExtents * 2.0f);
+      }
+
+      printf("DynamicBvh, %u actors\n", numActors);
+
+      DynamicBvh bvh;
+      std::vector<int32_t> proxies(numActors);
+      Report("Build (total)", Measure(1, [&](uint32_t) {
+         for (uint32_t i = 0; i < numActors; i++)
+            proxies[i] = bvh.CreateProxy(boxes[i].GetMin(), boxes[i].GetMax(), &boxes[i]);
+      }));
+
+      printf("  Tree height: %d\n", bvh.GetHeight());
+
+      // 10% of the actors moving a small distance every frame
+      const uint32_t numMoving = numActors / 10;
+      Report("Refit 1k moving actors", Measure(100, [&](uint32_t) {
+         for (uint32_t i = 0; i < numMoving; i++)
+         {
+            glm::vec3 delta = glm::vec3(offset(rng), 0.0f, offset(rng));
+            boxes[i].Init(boxes[i].GetMin() + delta, boxes[i].GetMax() - boxes[i].GetMin());
+            bvh.MoveProxy(proxies[i], boxes[i].GetMin(), boxes[i].GetMax());
+         }
+      }));
+
+      // Picking rays from above, like the editor does on every mouse move
+      const uint32_t numRays = 1000;
+      std::vector<Ray> rays(numRays);
+      for (auto& ray : rays)
+         ray = Ray(glm::vec3(position(rng), 200.0f, position(rng)), glm::normalize(glm::vec3(offset(rng), -1.0f, offset(rng))));
+
+      uint32_t linearHits = 0, bvhHits = 0;
+      Report("Ray query, linear", Measure(numRays, [&](uint32_t i) {
+         float closest = FLT_MAX;
+         for (auto& box : boxes)
+         {
+            float dist;
+            glm::vec3 normal;
+            if (box.RayIntersect(rays[i], dist, normal) && dist >= 0.0f && dist < closest)
+               closest = dist;
+         }
+         linearHits += (closest != FLT_MAX);
+      }));
+
+      Report("Ray query, BVH", Measure(numRays, [&](uint32_t i) {
+         float closest = FLT_MAX;
+         bvh.QueryRay(rays[i], FLT_MAX, [&](void* userData, float maxDistance) {
+            float dist;
+            glm::vec3 normal;
+            if (static_cast<BoundingBox*>(userData)->RayIntersect(rays[i], dist, normal) && dist >= 0.0f && dist < closest)
+               closest = dist;
+            return glm::min(closest, maxDistance);
+         });
+         bvhHits += (closest != FLT_MAX);
+      }));
+
+      printf("  Ray hits: linear %u, BVH %u\n", linearHits, bvhHits);
+
+      // Camera frustums looking in random directions
+      const uint32_t numFrustums = 100;
+      std::vector<Frustum> frustums(numFrustums);
+      for (auto& frustum : frustums)
+      {
+         glm::vec3 eye = glm::vec3(position(rng), 20.0f, position(rng));
+         glm::vec3 target = eye + glm::vec3(offset(rng), -0.05f, offset(rng));
+         glm::mat4 view = glm::lookAt(eye, target, glm::vec3(0.0f, 1.0f, 0.0f));
+         glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 1.0f, 400.0f);
+         frustum.Update(projection * view);
+      }
+
+      uint32_t linearVisible = 0, bvhVisible = 0;
+      Report("Frustum query, linear", Measure(numFrustums, [&](uint32_t i) {
+         for (auto& box : boxes)
+            linearVisible += frustums[i].CheckBox(box.GetMin(), box.GetMax());
+      }));
+
+      Report("Frustum query, BVH", Measure(numFrustums, [&](uint32_t i) {
+         bvh.QueryFrustum(frustums[i], true, [&](void*) { bvhVisible++; });
+      }));
+
+      printf("  Visible: linear %u, BVH %u (fat bounds)\n", linearVisible, bvhVisible);
+
+      // Foliage push spheres around the camera
+      uint32_t linearInside = 0, bvhInside = 0;
+      Report("Sphere query, linear", Measure(numFrustums, [&](uint32_t i) {
+         glm::vec3 center = glm::vec3(rays[i].origin.x, 0.0f, rays[i].origin.z);
+         for (auto& box : boxes)
+         {
+            glm::vec3 delta = glm::clamp(center, box.GetMin(), box.GetMax()) - center;
+            linearInside += glm::dot(delta, delta) <= 200.0f * 200.0f;
+         }
+      }));
+
+      Report("Sphere query, BVH", Measure(numFrustums, [&](uint32_t i) {
+         glm::vec3 center = glm::vec3(rays[i].origin.x, 0.0f, rays[i].origin.z);
+         bvh.QuerySphere(center, 200.0f, [&](void*) { bvhInside++; });
+      }));
+
+      printf("  Inside: linear %u, BVH %u (fat bounds)\n", linearInside, bvhInside);
+   }
+}
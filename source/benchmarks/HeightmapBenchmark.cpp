@@ -0,0 +1,177 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "Benchmark.h"
+#include "utility/math/Heightmap.h"
+#include "utility/math/Ray.h"
+
+using namespace Utopian;
+
+namespace Benchmark
+{
+   // The nearest texel lookup that Terrain::GetHeight() used before the Heightmap class, kept as the baseline.
+   static float GetHeightNearest(const std::vector<float>& samples, uint32_t resolution, float size, float amplitude, float x, float z)
+   {
+      float u = 1.0f - (x + size / 2.0f) / size;
+      float v = 1.0f - (z + size / 2.0f) / size;
+
+      uint32_t col = (uint32_t)floorf(u * resolution);
+      uint32_t row = (uint32_t)floorf(v * resolution);
+
+      if (row < resolution && col < resolution)
+         return samples[row * resolution + col] * amplitude * -1;
+
+      return -1.0f;
+   }
+
+   // The fixed step search that Terrain::GetIntersectPoint() used before the min/max pyramid, kept as the baseline.
+   static glm::vec3 LinearSearch(const Heightmap& heightmap, Ray ray)
+   {
+      float stepSize = 0.25;
+      glm::vec3 nextPoint = ray.origin + ray.direction * stepSize;
+      float heightAtNextPoint = heightmap.GetHeight(nextPoint.x, nextPoint.z);
+      int counter = 0;
+      const int numMaxSteps = 2000;
+      while (heightAtNextPoint < nextPoint.y && counter < numMaxSteps)
+      {
+         counter++;
+         ray.origin = nextPoint;
+         nextPoint = ray.origin + ray.direction * stepSize;
+         heightAtNextPoint = heightmap.GetHeight(nextPoint.x, nextPoint.z);
+      }
+
+      return ray.origin;
+   }
+
+   // Measures height queries against a terrain sized heightmap, like placing the instances
+   // of an InstanceGroup when the terrain has been modified.
+   void RunHeightmapBenchmark()
+   {
+      const uint32_t resolution = 512;
+      const float size = 511.0f;
+      const float amplitude = 50.0f;
+      const uint32_t numPositions = 100000;
+      const uint32_t numIterations = 50;
+
+      std::mt19937 generator(1337);
+      std::uniform_real_distribution<float> sampleDistribution(0.0f, 1.0f);
+      std::uniform_real_distribution<float> positionDistribution(-size / 2.0f, size / 2.0f);
+
+      // Rolling hills with some noise, the samples are negated heights like the GPU heightmap
+      std::vector<float> samples(resolution * resolution);
+      for (uint32_t y = 0; y < resolution; y++)
+      {
+         for (uint32_t x = 0; x < resolution; x++)
+            samples[y * resolution + x] = -0.5f * sinf(x * 0.02f) * cosf(y * 0.03f) - 0.02f * sampleDistribution(generator);
+      }
+
+      std::vector<glm::vec2> positions(numPositions);
+      for (auto& position : positions)
+         position = glm::vec2(positionDistribution(generator), positionDistribution(generator));
+
+      Heightmap heightmap;
+      heightmap.SetSamples(samples.data(), resolution);
+      heightmap.SetSize(size);
+      heightmap.SetAmplitude(amplitude);
+
+      std::vector<float> heights(numPositions);
+
+      printf("Heightmap, %ux%u samples, %u positions\n", resolution, resolution, numPositions);
+
+      double time = Measure(numIterations, [&](uint32_t) {
+         for (uint32_t i = 0; i < numPositions; i++)
+            heights[i] = GetHeightNearest(samples, resolution, size, amplitude, positions[i].x, positions[i].y);
+      });
+
+      Report("Nearest (old GetHeight)", time);
+
+      time = Measure(numIterations, [&](uint32_t) {
+         for (uint32_t i = 0; i < numPositions; i++)
+            heights[i] = heightmap.GetHeight(positions[i].x, positions[i].y);
+      });
+
+      Report("Bilinear GetHeight", time);
+
+      time = Measure(numIterations, [&](uint32_t) {
+         heightmap.GetHeights(positions.data(), heights.data(), numPositions);
+      });
+
+      Report("Bilinear GetHeights (batched)", time);
+
+      // The batched path must match the scalar one
+      float maxError = 0.0f;
+      for (uint32_t i = 0; i < numPositions; i++)
+         maxError = std::max(maxError, fabsf(heights[i] - heightmap.GetHeight(positions[i].x, positions[i].y)));
+
+      printf("  %-40s %12.6f\n", "Max batched error", maxError);
+
+      std::vector<glm::vec3> normals(numPositions);
+      time = Measure(numIterations, [&](uint32_t) {
+         for (uint32_t i = 0; i < numPositions; i++)
+            normals[i] = heightmap.GetNormal(positions[i].x, positions[i].y);
+      });
+
+      Report("GetNormal", time);
+
+      // Picking rays from a camera above the terrain, like the terrain and foliage tools
+      const uint32_t numRays = 1000;
+      std::vector<Ray> rays(numRays);
+      for (auto& ray : rays)
+      {
+         glm::vec3 target = glm::vec3(positionDistribution(generator) * 0.5f, 0.0f, positionDistribution(generator) * 0.5f);
+         glm::vec3 origin = glm::vec3(positionDistribution(generator) * 0.5f, 80.0f, positionDistribution(generator) * 0.5f);
+         ray = Ray(origin, glm::normalize(target - origin));
+      }
+
+      std::vector<glm::vec3> intersections(numRays);
+      time = Measure(10, [&](uint32_t) {
+         for (uint32_t i = 0; i < numRays; i++)
+            intersections[i] = LinearSearch(heightmap, rays[i]);
+      });
+
+      Report("Linear search (per ray)", time / numRays);
+
+      uint32_t numHits = 0;
+      time = Measure(10, [&](uint32_t) {
+         numHits = 0;
+         for (uint32_t i = 0; i < numRays; i++)
+            numHits += heightmap.RayIntersect(rays[i], intersections[i]) ? 1 : 0;
+      });
+
+      Report("RayIntersect (per ray)", time / numRays);
+
+      // The linear search stops up to one step before the surface
+      float maxDistance = 0.0f;
+      for (uint32_t i = 0; i < numRays; i++)
+      {
+         if (heightmap.RayIntersect(rays[i], intersections[i]))
+            maxDistance = std::max(maxDistance, glm::length(intersections[i] - LinearSearch(heightmap, rays[i])));
+      }
+
+      printf("  %-40s %12u\n", "RayIntersect hits", numHits);
+      printf("  %-40s %12.6f\n", "Max distance to linear search", maxDistance);
+
+      // A brush stroke modifies a small area and the whole map is read back
+      std::vector<float> modifiedSamples = samples;
+      time = Measure(numIterations, [&](uint32_t) {
+         for (uint32_t y = 200; y < 230; y++)
+         {
+            for (uint32_t x = 300; x < 330; x++)
+               modifiedSamples[y * resolution + x] += 0.001f;
+         }
+
+         heightmap.SetSamples(modifiedSamples.data(), resolution);
+      });
+
+      Report("SetSamples (30x30 brush refit)", time);
+
+      Heightmap rebuiltHeightmap;
+      time = Measure(numIterations, [&](uint32_t) {
+         rebuiltHeightmap = Heightmap();
+         rebuiltHeightmap.SetSamples(modifiedSamples.data(), resolution);
+      });
+
+      Report("SetSamples (full build)", time);
+   }
+}
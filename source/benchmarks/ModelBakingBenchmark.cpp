@@ -0,0 +1,69 @@
+#include <filesystem>
+#include <set>
+#include <string>
+#include <vector>
+#include "Benchmark.h"
+#include "core/AssetLoader.h"
+#include "core/AssimpLoader.h"
+#include "core/BakedModel.h"
+
+using namespace Utopian;
+
+namespace Benchmark
+{
+   // Compares importing the meadow asset set with Assimp against loading the baked .umesh files.
+   // Must be run from the repository root so that the data/ paths resolve.
+   void RunModelBakingBenchmark()
+   {
+      AssetLoader::Start();
+
+      std::set<std::string> uniqueFilenames;
+      for (uint32_t i = 0; i < gAssetLoader().GetNumAssets(); i++)
+      {
+         std::string filename = gAssetLoader().GetFullModelPath(gAssetLoader().GetAssetByIndex(i));
+         if (std::filesystem::exists(filename))
+            uniqueFilenames.insert(filename);
+      }
+
+      gAssetLoader().Destroy();
+
+      std::vector<std::string> filenames(uniqueFilenames.begin(), uniqueFilenames.end());
+      const uint32_t numModels = (uint32_t)filenames.size();
+
+      if (numModels == 0)
+      {
+         printf("Model baking, meadow assets not found, skipped\n");
+         return;
+      }
+
+      printf("Model baking, %u meadow models\n", numModels);
+
+      AssimpLoader assimpLoader(nullptr);
+      const uint32_t importFlags = AssimpLoader::GetImportFlags();
+
+      std::vector<SharedPtr<ImportedModel>> importedModels(numModels);
+      Report("Assimp import (total)", Measure(1, [&](uint32_t) {
+         for (uint32_t i = 0; i < numModels; i++)
+            importedModels[i] = assimpLoader.ImportModel(filenames[i]);
+      }));
+
+      uint64_t numVertices = 0;
+      for (const auto& importedModel : importedModels)
+      {
+         if (importedModel == nullptr)
+            continue;
+
+         BakedModel::Store(*importedModel, importFlags);
+
+         for (const auto& mesh : importedModel->meshes)
+            numVertices += mesh.primitive.vertices.size();
+      }
+
+      printf("  Vertices: %llu\n", (unsigned long long)numVertices);
+
+      Report("Baked load (total)", Measure(10, [&](uint32_t) {
+         for (uint32_t i = 0; i < numModels; i++)
+            importedModels[i] = BakedModel::Load(filenames[i], importFlags);
+      }));
+   }
+}
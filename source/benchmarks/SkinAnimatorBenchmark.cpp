@@ -0,0 +1,101 @@
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "Benchmark.h"
+#include "core/renderer/Model.h"
+#include "core/renderer/SkinAnimator.h"
+#include "utility/Utility.h"
+
+using namespace Utopian;
+
+namespace Benchmark
+{
+   // Creates the node hierarchy of the glTF scene without any meshes, enough for the animations to target.
+   static void CreateNodes(Model* model, const tinygltf::Model& input, Node* parent, uint32_t nodeIndex)
+   {
+      const tinygltf::Node& inputNode = input.nodes[nodeIndex];
+
+      Node* node = model->CreateNode();
+      node->parent = parent;
+      node->index = nodeIndex;
+
+      for (int child : inputNode.children)
+         CreateNodes(model, input, node, child);
+
+      if (parent)
+         parent->children.push_back(node);
+      else
+         model->AddRootNode(node);
+   }
+
+   // Measures the cost of sampling the animations of the skinned glTF assets and evaluating
+   // their skeletons for a crowd of characters.
+   // Must be run from the repository root so that the data/ paths resolve.
+   void RunSkinAnimatorBenchmark()
+   {
+      const std::vector<std::string> filenames = {
+         "data/models/gltf/CesiumMan.gltf",
+         "data/models/gltf/Fox/glTF/Fox.gltf"
+      };
+
+      const uint32_t numCharacters = 64;
+      const uint32_t numFrames = 1000;
+      const float deltaTime = 1.0f / 60.0f;
+
+      for (const auto& filename : filenames)
+      {
+         if (!std::filesystem::exists(filename))
+         {
+            printf("SkinAnimator, %s not found, skipped\n", filename.c_str());
+            continue;
+         }
+
+         tinygltf::Model input;
+         tinygltf::TinyGLTF gltfContext;
+         std::string error, warning;
+         if (!gltfContext.LoadASCIIFromFile(&input, &error, &warning, filename) || input.animations.empty())
+         {
+            printf("SkinAnimator, %s has no animations, skipped\n", filename.c_str());
+            continue;
+         }
+
+         std::vector<SharedPtr<Model>> models(numCharacters);
+         std::vector<SharedPtr<SkinAnimator>> animators(numCharacters);
+         for (uint32_t i = 0; i < numCharacters; i++)
+         {
+            models[i] = std::make_shared<Model>();
+
+            const tinygltf::Scene& scene = input.scenes[0];
+            for (int node : scene.nodes)
+               CreateNodes(models[i].get(), input, nullptr, node);
+
+            // Without a device the joint matrices are computed but not written to the palette
+            animators[i] = std::make_shared<SkinAnimator>(input, models[i].get(), nullptr);
+
+            // Spread the characters over the animation like a crowd would be
+            animators[i]->UpdateAnimation(i * 0.1f);
+         }
+
+         uint32_t numChannels = 0;
+         for (const auto& animation : input.animations)
+            numChannels += (uint32_t)animation.channels.size();
+
+         printf("SkinAnimator, %s, %u characters, %u animations, %u channels\n", ExtractFilename(filename).c_str(),
+                numCharacters, (uint32_t)input.animations.size(), numChannels);
+
+         double frameTime = Measure(numFrames, [&](uint32_t) {
+            for (auto& animator : animators)
+               animator->UpdateAnimation(deltaTime);
+         });
+
+         Report("UpdateAnimation (per character)", frameTime / numCharacters);
+
+         frameTime = Measure(numFrames, [&](uint32_t) {
+            for (auto& animator : animators)
+               animator->UpdateJoints();
+         });
+
+         Report("UpdateJoints (per character)", frameTime / numCharacters);
+      }
+   }
+}
@@ -0,0 +1,14 @@
+#include <cstdio>
+#include "Benchmark.h"
+
+// Microbenchmarks for engine systems that don't require a Vulkan device.
+// Build the Release configuration to get meaningful numbers.
+int main(int argc, char* argv[])
+{
+   Benchmark::RunBvhBenchmark();
+   Benchmark::RunModelBakingBenchmark();
+   Benchmark::RunSkinAnimatorBenchmark();
+   Benchmark::RunHeightmapBenchmark();
+
+   return 0;
+}
@@ -85,13 +85,13 @@ void MarchingCubes::DestroyCallback()
    mBrushJob.effect = nullptr;
    mIntersectionJob.effect = nullptr;
 
-   mMarchingCubesJob.inputUBO.GetBuffer()->Destroy();
-   mTerrainJob.inputUBO.GetBuffer()->Destroy();
-   mTerrainJob.fragmentInputUBO.GetBuffer()->Destroy();
-   mMarchingCubesJob.counterSSBO.GetBuffer()->Destroy();
-   mBrushJob.inputUBO.GetBuffer()->Destroy();
-   mIntersectionJob.outputSSBO.GetBuffer()->Destroy();
-   mIntersectionJob.inputUBO.GetBuffer()->Destroy();
+   mMarchingCubesJob.inputUBO.Destroy();
+   mTerrainJob.inputUBO.Destroy();
+   mTerrainJob.fragmentInputUBO.Destroy();
+   mMarchingCubesJob.counterSSBO.Destroy();
+   mBrushJob.inputUBO.Destroy();
+   mIntersectionJob.outputSSBO.Destroy();
+   mIntersectionJob.inputUBO.Destroy();
 
    for (auto& block : mBlockList)
       delete block.second;
@@ -4,6 +4,7 @@
 #include <glm/matrix.hpp>
 #include <glm/gtc/constants.hpp>
 #include <imgui/imgui.h>
+#include <algorithm>
 #include <string>
 #include <time.h>
 #include <vulkan/handles/DescriptorSet.h>
@@ -105,10 +106,10 @@ void PhysicallyBasedRendering::DestroyCallback()
    for (auto& sceneNode : mSceneNodes)
       sceneNode.model = nullptr;
 
-   mVertexInputParameters.GetBuffer()->Destroy();
-   mPbrSettings.GetBuffer()->Destroy();
-   mSkybox.inputBlock.GetBuffer()->Destroy();
-   mSkybox.shaderVariables.GetBuffer()->Destroy();
+   mVertexInputParameters.Destroy();
+   mPbrSettings.Destroy();
+   mSkybox.inputBlock.Destroy();
+   mSkybox.shaderVariables.Destroy();
 }
 
 void PhysicallyBasedRendering::InitResources()
@@ -126,6 +127,7 @@ void PhysicallyBasedRendering::InitResources()
    mPbrSettings.Create(device, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
    mPbrSettings.data.debugChannel = 0;
    mPbrSettings.data.useIBL = 1;
+   mCubemapBindingsDirty.resize(mVulkanApp->GetNumFramesInFlight(), false);
 
    mRenderTarget = std::make_shared<Vk::RenderTarget>(device, width, height);
    mRenderTarget->AddWriteOnlyColorAttachment(mOutputImage);
@@ -173,21 +175,27 @@ void PhysicallyBasedRendering::InitResources()
    gScreenQuadUi().AddQuad(0, 0, width, height, mOutputImage.get(), mSampler.get());
 }
 
-void PhysicallyBasedRendering::UpdateCubemapBindings()
+void PhysicallyBasedRendering::UpdateCubemapBindings(uint32_t frameIndex)
 {
-   Vk::DescriptorSet& descriptorSet = mSkybox.effect->GetDescriptorSetFromName("samplerCubeMap");
-   descriptorSet.BindCombinedImage("samplerCubeMap", mIrradianceMap->GetDescriptor());
-   mVulkanApp->GetDevice()->QueueDescriptorUpdate(&descriptorSet);
-
-   Vk::DescriptorSet& descriptorSet1 = mEffect->GetDescriptorSetFromName("irradianceMap");
+   // Only called for the current frame slot, the other slots can still be used by the GPU
+   Vk::DescriptorSet& descriptorSet = mSkybox.effect->GetDescriptorSetFromName("samplerCubeMap", frameIndex);
+   if (mSkyboxCubemap == 0)
+      descriptorSet.BindCombinedImage("samplerCubeMap", mIrradianceMap->GetDescriptor());
+   else if (mSkyboxCubemap == 1)
+      descriptorSet.BindCombinedImage("samplerCubeMap", mSpecularMap->GetDescriptor());
+   else
+      descriptorSet.BindCombinedImage("samplerCubeMap", mSkybox.texture->GetDescriptor());
+   descriptorSet.UpdateDescriptorSets();
+
+   Vk::DescriptorSet& descriptorSet1 = mEffect->GetDescriptorSetFromName("irradianceMap", frameIndex);
    descriptorSet1.BindCombinedImage("irradianceMap", mIrradianceMap->GetDescriptor());
    descriptorSet1.BindCombinedImage("specularMap", mSpecularMap->GetDescriptor());
-   mVulkanApp->GetDevice()->QueueDescriptorUpdate(&descriptorSet1);
+   descriptorSet1.UpdateDescriptorSets();
 
-   Vk::DescriptorSet& descriptorSet2 = mSkinningEffect->GetDescriptorSetFromName("irradianceMap");
+   Vk::DescriptorSet& descriptorSet2 = mSkinningEffect->GetDescriptorSetFromName("irradianceMap", frameIndex);
    descriptorSet2.BindCombinedImage("irradianceMap", mIrradianceMap->GetDescriptor());
    descriptorSet2.BindCombinedImage("specularMap", mSpecularMap->GetDescriptor());
-   mVulkanApp->GetDevice()->QueueDescriptorUpdate(&descriptorSet2);
+   descriptorSet2.UpdateDescriptorSets();
 }
 
 void PhysicallyBasedRendering::UpdateCallback(double deltaTime)
@@ -232,30 +240,14 @@ void PhysicallyBasedRendering::UpdateCallback(double deltaTime)
          mSkybox.texture = Vk::gTextureLoader().LoadCubemapTexture(environment, VK_FORMAT_R16G16B16A16_SFLOAT);
 
          GenerateFilteredCubemaps();
-         UpdateCubemapBindings();
+         std::fill(mCubemapBindingsDirty.begin(), mCubemapBindingsDirty.end(), true);
       }
       else
          UTO_LOG("Error selecting environment map");
    }
 
-   static int selectedCubemap = 0u;
-   if (ImGui::Combo("Skybox style", &selectedCubemap, "Irradiance\0Specular\0Environment\0"))
-   {
-      Vk::DescriptorSet& descriptorSet = mSkybox.effect->GetDescriptorSetFromName("samplerCubeMap");
-
-      if (selectedCubemap == 0) {
-         descriptorSet.BindCombinedImage("samplerCubeMap", mIrradianceMap->GetDescriptor());
-         mVulkanApp->GetDevice()->QueueDescriptorUpdate(&descriptorSet);
-      }
-      else if (selectedCubemap == 1) {
-         descriptorSet.BindCombinedImage("samplerCubeMap", mSpecularMap->GetDescriptor());
-         mVulkanApp->GetDevice()->QueueDescriptorUpdate(&descriptorSet);
-      }
-      else {
-         descriptorSet.BindCombinedImage("samplerCubeMap", mSkybox.texture->GetDescriptor());
-         mVulkanApp->GetDevice()->QueueDescriptorUpdate(&descriptorSet);
-      }
-   }
+   if (ImGui::Combo("Skybox style", &mSkyboxCubemap, "Irradiance\0Specular\0Environment\0"))
+      std::fill(mCubemapBindingsDirty.begin(), mCubemapBindingsDirty.end(), true);
 
    ImGui::Combo("Debug channel", &mPbrSettings.data.debugChannel,
                 "None\0Base color\0Metallic\0Roughness\0Normal\0Tangent\0Ambient Occlusion\0Irradiance\0Ambient\0Specular\0");
@@ -268,6 +260,14 @@ void PhysicallyBasedRendering::UpdateCallback(double deltaTime)
 
    ImGuiRenderer::EndWindow();
 
+   // The current frame slot has been waited on so its descriptor sets can be written directly
+   uint32_t frameIndex = mVulkanApp->GetDevice()->GetFrameIndex();
+   if (mCubemapBindingsDirty[frameIndex])
+   {
+      UpdateCubemapBindings(frameIndex);
+      mCubemapBindingsDirty[frameIndex] = false;
+   }
+
    for (auto& sceneNode : mSceneNodes)
       sceneNode.model->UpdateAnimation((float)deltaTime);
 
@@ -307,26 +307,26 @@ void PhysicallyBasedRendering::DrawCallback()
       commandBuffer->CmdBindPipeline(effect->GetPipeline());
       commandBuffer->CmdBindDescriptorSets(effect);
 
-      // Test new method for drawing
-      std::vector<RenderCommand> renderCommands;
-      sceneNode.model->GetRenderCommands(renderCommands, sceneNode.worldMatrix);
+      sceneNode.model->UpdateRenderCommands();
 
-      for (RenderCommand& command : renderCommands)
+      for (const RenderCommand& command : sceneNode.model->GetRenderCommands())
       {
-         if (command.skinDescriptorSet != VK_NULL_HANDLE)
+         VkDescriptorSet skinDescriptorSet = command.GetSkinDescriptorSet(mVulkanApp->GetDevice()->GetFrameIndex());
+         if (skinDescriptorSet != VK_NULL_HANDLE)
          {
-            commandBuffer->CmdBindDescriptorSet(effect->GetPipelineInterface(), 1, &command.skinDescriptorSet,
+            commandBuffer->CmdBindDescriptorSet(effect->GetPipelineInterface(), 1, &skinDescriptorSet,
                                                 VK_PIPELINE_BIND_POINT_GRAPHICS, 4);
          }
 
+         glm::mat4 world = sceneNode.worldMatrix * command.world;
          commandBuffer->CmdPushConstants(effect->GetPipelineInterface(), VK_SHADER_STAGE_ALL,
-                                         sizeof(glm::mat4), &command.world);
+                                         sizeof(glm::mat4), &world);
 
          for (uint32_t i = 0; i < command.mesh->primitives.size(); i++)
          {
             Primitive* primitive = command.mesh->primitives[i];
 
-            VkDescriptorSet descriptorSet = command.mesh->materials[i]->descriptorSet->GetVkHandle();
+            VkDescriptorSet descriptorSet = command.mesh->materials[i]->GetDescriptorSet(mVulkanApp->GetDevice()->GetFrameIndex());
             commandBuffer->CmdBindDescriptorSet(effect->GetPipelineInterface(), 1, &descriptorSet, VK_PIPELINE_BIND_POINT_GRAPHICS, 1);
 
             gRendererUtility().DrawPrimitive(commandBuffer, primitive);
@@ -392,7 +392,7 @@ void PhysicallyBasedRendering::RenderSkybox(Vk::CommandBuffer* commandBuffer)
    Primitive* primitive = mSkybox.model->GetPrimitive(0);
    commandBuffer->CmdBindVertexBuffer(0, 1, primitive->GetVertxBuffer());
    commandBuffer->CmdBindIndexBuffer(primitive->GetIndexBuffer(), 0, VK_INDEX_TYPE_UINT32);
-   commandBuffer->CmdDrawIndexed(primitive->GetNumIndices(), 1, 0, 0, 0);
+   commandBuffer->CmdDrawIndexed(primitive->GetNumIndices(), 1, primitive->GetFirstIndex(), primitive->GetVertexOffset(), 0);
 }
 
 void PhysicallyBasedRendering::GenerateFilteredCubemaps()
@@ -81,7 +81,7 @@ private:
    void InitResources();
    void InitSkybox();
    void RenderSkybox(Vk::CommandBuffer* commandBuffer);
-   void UpdateCubemapBindings();
+   void UpdateCubemapBindings(uint32_t frameIndex);
    void GenerateFilteredCubemaps();
 
    Vk::VulkanApp* mVulkanApp;
@@ -117,4 +117,8 @@ private:
    SharedPtr<Vk::Texture> mIrradianceMap;
    SharedPtr<Vk::Texture> mSpecularMap;
    SharedPtr<Vk::Texture> mBRDFLut;
+
+   /** Set for every frame slot when the cubemaps change, cleared when the slot's sets have been rebound. */
+   std::vector<bool> mCubemapBindingsDirty;
+   int mSkyboxCubemap = 0;
 };
@@ -55,8 +55,8 @@ void RayTrace::DestroyCallback()
    mOutputImage = nullptr;
    mSampler = nullptr;
 
-   mInputParameters.GetBuffer()->Destroy();
-   mSettingParameters.GetBuffer()->Destroy();
+   mInputParameters.Destroy();
+   mSettingParameters.Destroy();
 }
 
 void RayTrace::InitResources()
@@ -200,10 +200,28 @@ namespace Utopian
    {
       Asset asset = FindAsset(assetId);
 
-      std::string fullModelPath = "data/NatureManufacture/Meadow Environment Dynamic Nature/" + asset.model;
+      SharedPtr<Model> model = gModelLoader().LoadModel(GetFullModelPath(asset));
+      ApplyAssetTextures(asset, model.get());
 
-      SharedPtr<Model> model = gModelLoader().LoadModel(fullModelPath);
+      return model;
+   }
+
+   std::shared_future<SharedPtr<Model>> AssetLoader::LoadAssetAsync(uint32_t assetId, Vk::VertexLayout vertexLayout)
+   {
+      Asset asset = FindAsset(assetId);
+
+      return gModelLoader().LoadModelAsync(GetFullModelPath(asset), [this, asset](SharedPtr<Model> model) {
+         ApplyAssetTextures(asset, model.get());
+      }, vertexLayout);
+   }
 
+   std::string AssetLoader::GetFullModelPath(const Asset& asset) const
+   {
+      return "data/NatureManufacture/Meadow Environment Dynamic Nature/" + asset.model;
+   }
+
+   void AssetLoader::ApplyAssetTextures(const Asset& asset, Model* model)
+   {
       // Some assets are not properly storing texture paths so we need to set them manually
       if (asset.diffuseTexture != "-")
       {
@@ -213,8 +231,8 @@ namespace Utopian
          if (asset.normalMap != "-")
             fullNormalPath = "data/NatureManufacture/Meadow Environment Dynamic Nature/" + asset.normalMap;
 
-         SharedPtr<Vk::Texture> diffuseTexture = Vk::gTextureLoader().LoadTexture(fullDiffusePath);
-         SharedPtr<Vk::Texture> normalMap = Vk::gTextureLoader().LoadTexture(fullNormalPath);
+         SharedPtr<Vk::Texture> diffuseTexture = Vk::gTextureLoader().LoadTextureAsync(fullDiffusePath);
+         SharedPtr<Vk::Texture> normalMap = Vk::gTextureLoader().LoadTextureAsync(fullNormalPath);
 
          if (diffuseTexture != nullptr && normalMap != nullptr)
          {
@@ -224,8 +242,6 @@ namespace Utopian
             material->UpdateTextureDescriptors(gRenderer().GetDevice());
          }
       }
-
-      return model;
    }
 
    Asset AssetLoader::GetAssetByIndex(uint32_t index) const
@@ -1,10 +1,12 @@
 #pragma once
 #include <stdint.h>
+#include <future>
 #include <string>
 #include <vector>
 #include "utility/Module.h"
 #include "utility/Common.h"
 #include "vulkan\VulkanPrerequisites.h"
+#include "vulkan/Vertex.h"
 
 #define DEFAULT_NORMAL_MAP_TEXTURE "data/textures/flat_normalmap.png"
 
@@ -215,9 +217,16 @@ namespace Utopian
 
       void AddAsset(uint32_t id, std::string model, std::string texture = "-", std::string normalMap = "-");
       SharedPtr<Model> LoadAsset(uint32_t assetId);
+
+      /** Loads the asset with ModelLoader::LoadModelAsync(), the textures are applied before the future becomes ready. */
+      std::shared_future<SharedPtr<Model>> LoadAssetAsync(uint32_t assetId, Vk::VertexLayout vertexLayout = Vk::VERTEX_LAYOUT_DEFAULT);
       Asset FindAsset(uint32_t id);
       Asset GetAssetByIndex(uint32_t index) const;
       uint32_t GetNumAssets() const;
+      std::string GetFullModelPath(const Asset& asset) const;
+   private:
+      void ApplyAssetTextures(const Asset& asset, Model* model);
+
    private:
       std::vector<Asset> mAssets;
 
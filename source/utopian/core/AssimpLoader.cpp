@@ -29,175 +29,219 @@ namespace Utopian
    {
    }
 
-   SharedPtr<Model> AssimpLoader::LoadModel(std::string filename)
+   SharedPtr<Model> AssimpLoader::LoadModel(std::string filename, Vk::VertexLayout vertexLayout)
    {
-      SharedPtr<Model> model = std::make_shared<Model>();
-      model->SetFilename(filename);
+      SharedPtr<ImportedModel> importedModel = ImportModel(filename);
 
-      uint32_t flags = aiProcess_FlipUVs | aiProcess_Triangulate | aiProcess_PreTransformVertices | aiProcess_CalcTangentSpace | aiProcess_GenSmoothNormals | aiProcess_JoinIdenticalVertices;
+      if (importedModel == nullptr)
+         return nullptr;
 
-      if (gModelLoader().GetFlipWindingOrder())
-         flags |= aiProcess_FlipWindingOrder;
+      return CreateModel(*importedModel, false, vertexLayout);
+   }
 
+   SharedPtr<ImportedModel> AssimpLoader::ImportModel(std::string filename)
+   {
       // Load scene from the file.
       Assimp::Importer importer;
-      const aiScene* scene = importer.ReadFile(filename, flags);
+      const aiScene* scene = importer.ReadFile(filename, GetImportFlags());
 
-      if (scene != nullptr)
+      if (scene == nullptr)
       {
-         Mesh mesh;
+         // Loading of model failed
+         UTO_LOG("Failed to load model: " + filename);
+         return nullptr;
+      }
 
-         // Loop over all meshes
-         for (unsigned int meshId = 0u; meshId < scene->mNumMeshes; meshId++)
-         {
-            Primitive primitive;
-            aiMesh* assimpMesh = scene->mMeshes[meshId];
+      SharedPtr<ImportedModel> importedModel = std::make_shared<ImportedModel>();
+      importedModel->filename = filename;
+      importedModel->meshes.resize(scene->mNumMeshes);
 
-            // Get the diffuse color
-            aiColor3D color(0.f, 0.f, 0.f);
-            scene->mMaterials[assimpMesh->mMaterialIndex]->Get(AI_MATKEY_COLOR_DIFFUSE, color);
+      // Loop over all meshes
+      for (unsigned int meshId = 0u; meshId < scene->mNumMeshes; meshId++)
+      {
+         ImportedMesh& importedMesh = importedModel->meshes[meshId];
+         Primitive& primitive = importedMesh.primitive;
+         aiMesh* assimpMesh = scene->mMeshes[meshId];
 
-            // Load vertices
-            for (unsigned int vertexId = 0u; vertexId < assimpMesh->mNumVertices; vertexId++)
-            {
-               aiVector3D pos = assimpMesh->mVertices[vertexId];
-               aiVector3D normal = assimpMesh->mNormals[vertexId];
-               aiVector3D uv = aiVector3D(0, 0, 0);
-               aiVector3D tangent = aiVector3D(0, 0, 0);
-
-               if (assimpMesh->HasTextureCoords(0))
-                  uv = assimpMesh->mTextureCoords[0][vertexId];
-
-               if (assimpMesh->HasTangentsAndBitangents())
-                  tangent = assimpMesh->mTangents[vertexId];
-
-               normal = normal.Normalize();
-               Vk::Vertex vertex = {};
-               vertex.pos = glm::vec3(pos.x, pos.y, pos.z);
-               vertex.normal = glm::vec3(normal.x, normal.y, normal.z);
-               vertex.tangent = glm::vec4(tangent.x, tangent.y, tangent.z, 1.0f);
-               vertex.uv = glm::vec2(uv.x, uv.y);
-               vertex.color = glm::vec3(color.r, color.g, color.b);
-               primitive.AddVertex(vertex);
-            }
+         // Get the diffuse color
+         aiColor3D color(0.f, 0.f, 0.f);
+         scene->mMaterials[assimpMesh->mMaterialIndex]->Get(AI_MATKEY_COLOR_DIFFUSE, color);
 
-            // Load indices
-            for (unsigned int faceId = 0u; faceId < assimpMesh->mNumFaces; faceId++)
+         primitive.ReserveVertices(assimpMesh->mNumVertices);
+         primitive.ReserveIndices(assimpMesh->mNumFaces * 3);
+
+         // Load vertices
+         for (unsigned int vertexId = 0u; vertexId < assimpMesh->mNumVertices; vertexId++)
+         {
+            aiVector3D pos = assimpMesh->mVertices[vertexId];
+            aiVector3D normal = assimpMesh->mNormals[vertexId];
+            aiVector3D uv = aiVector3D(0, 0, 0);
+            aiVector3D tangent = aiVector3D(0, 0, 0);
+
+            if (assimpMesh->HasTextureCoords(0))
+               uv = assimpMesh->mTextureCoords[0][vertexId];
+
+            if (assimpMesh->HasTangentsAndBitangents())
+               tangent = assimpMesh->mTangents[vertexId];
+
+            normal = normal.Normalize();
+            Vk::Vertex vertex = {};
+            vertex.pos = glm::vec3(pos.x, pos.y, pos.z);
+            vertex.normal = glm::vec3(normal.x, normal.y, normal.z);
+            vertex.tangent = glm::vec4(tangent.x, tangent.y, tangent.z, 1.0f);
+            vertex.uv = glm::vec2(uv.x, uv.y);
+            vertex.color = glm::vec3(color.r, color.g, color.b);
+            primitive.AddVertex(vertex);
+         }
+
+         // Load indices
+         for (unsigned int faceId = 0u; faceId < assimpMesh->mNumFaces; faceId++)
+         {
+            for (unsigned int indexId = 0u; indexId < assimpMesh->mFaces[faceId].mNumIndices; indexId+=3)
             {
-               for (unsigned int indexId = 0u; indexId < assimpMesh->mFaces[faceId].mNumIndices; indexId+=3)
-               {
-                  primitive.AddTriangle(assimpMesh->mFaces[faceId].mIndices[indexId], assimpMesh->mFaces[faceId].mIndices[indexId+1], assimpMesh->mFaces[faceId].mIndices[indexId+2]);
-               }
+               primitive.AddTriangle(assimpMesh->mFaces[faceId].mIndices[indexId], assimpMesh->mFaces[faceId].mIndices[indexId+1], assimpMesh->mFaces[faceId].mIndices[indexId+2]);
             }
+         }
+
+         primitive.SetDebugName(filename);
 
-            // Get texture path
-            aiMaterial* aiMaterial = scene->mMaterials[assimpMesh->mMaterialIndex];
-            int numTextures = aiMaterial->GetTextureCount(aiTextureType_DIFFUSE);
-            int numNormalMaps = aiMaterial->GetTextureCount(aiTextureType_NORMALS);
-            int numHeightMaps = aiMaterial->GetTextureCount(aiTextureType_HEIGHT);
-            int numSpecularMaps = aiMaterial->GetTextureCount(aiTextureType_SPECULAR);
+         // Get texture path
+         aiMaterial* aiMaterial = scene->mMaterials[assimpMesh->mMaterialIndex];
+         int numTextures = aiMaterial->GetTextureCount(aiTextureType_DIFFUSE);
+         int numNormalMaps = aiMaterial->GetTextureCount(aiTextureType_NORMALS);
+         int numHeightMaps = aiMaterial->GetTextureCount(aiTextureType_HEIGHT);
+         int numSpecularMaps = aiMaterial->GetTextureCount(aiTextureType_SPECULAR);
 
-            std::string diffuseTexturePath = DEFAULT_COLOR_TEXTURE_PATH;
-            std::string normalTexturePath = DEFAULT_NORMAL_MAP_TEXTURE;
-            std::string specularTexturePath = DEFAULT_SPECULAR_MAP_TEXTURE;
+         std::string diffuseTexturePath = DEFAULT_COLOR_TEXTURE_PATH;
+         std::string normalTexturePath = DEFAULT_NORMAL_MAP_TEXTURE;
+         std::string specularTexturePath = DEFAULT_SPECULAR_MAP_TEXTURE;
 
-            /* Diffuse texture */
-            if (numTextures > 0)
+         /* Diffuse texture */
+         if (numTextures > 0)
+         {
+            aiString texPath;
+            aiMaterial->GetTexture(aiTextureType_DIFFUSE, 0, &texPath);
+            FindValidPath(&texPath, filename);
+            diffuseTexturePath = texPath.C_Str();
+
+            // Workaround for Unity assets
+            // Note: The textures are loaded on the main thread so only the existence of the files is checked here
+            if (!FileExists(diffuseTexturePath))
             {
-               aiString texPath;
-               aiMaterial->GetTexture(aiTextureType_DIFFUSE, 0, &texPath);
-               FindValidPath(&texPath, filename);
-               diffuseTexturePath = texPath.C_Str();
-               SharedPtr<Vk::Texture> texture = Vk::gTextureLoader().LoadTexture(diffuseTexturePath);
-
-               // Workaround for Unity assets
-               // Note: Instead of calling LoadTexture() something similar to FindFile(diffuseTexturePath) could be used
-               if (texture == nullptr)
-               {
-                  uint32_t idx = (uint32_t)diffuseTexturePath.rfind("\\");
-                  std::string textureName = diffuseTexturePath.substr(idx+1);
-                  idx = (uint32_t)filename.rfind("/");
-                  diffuseTexturePath = filename.substr(0, idx) + "/Textures/" + textureName;
+               uint32_t idx = (uint32_t)diffuseTexturePath.rfind("\\");
+               std::string textureName = diffuseTexturePath.substr(idx+1);
+               idx = (uint32_t)filename.rfind("/");
+               diffuseTexturePath = filename.substr(0, idx) + "/Textures/" + textureName;
 
-                  texture = Vk::gTextureLoader().LoadTexture(diffuseTexturePath);
+               // Try removing _H from the filename
+               if (!FileExists(diffuseTexturePath))
+               {
+                  idx = (uint32_t)diffuseTexturePath.rfind("_H.tga");
+                  if (idx != std::string::npos)
+                     diffuseTexturePath = diffuseTexturePath.substr(0, idx) + ".tga";
 
-                  // Try removing _H from the filename
-                  if (texture == nullptr)
+                  if (!FileExists(diffuseTexturePath))
                   {
-                     idx = (uint32_t)diffuseTexturePath.rfind("_H.tga");
+                     idx = (uint32_t)diffuseTexturePath.rfind("_H.png");
                      if (idx != std::string::npos)
-                     {
-                        diffuseTexturePath = diffuseTexturePath.substr(0, idx) + ".tga";
-                        texture = Vk::gTextureLoader().LoadTexture(diffuseTexturePath);
-                     }
-
-                     if (texture == nullptr)
-                     {
-                        idx = (uint32_t)diffuseTexturePath.rfind("_H.png");
-                        if (idx != std::string::npos)
-                        {
-                           diffuseTexturePath = diffuseTexturePath.substr(0, idx) + ".png";
-                           texture = Vk::gTextureLoader().LoadTexture(diffuseTexturePath);
-                        }
-                     }
+                        diffuseTexturePath = diffuseTexturePath.substr(0, idx) + ".png";
                   }
                }
-
-               if (texture == nullptr)
-               {
-                  texPath = DEFAULT_COLOR_TEXTURE_PATH;
-               }
             }
 
-            /* Normal texture */
-            if (numNormalMaps > 0)
+            if (!FileExists(diffuseTexturePath))
             {
-               normalTexturePath = GetPath(aiMaterial, aiTextureType_NORMALS, filename);
+               diffuseTexturePath = DEFAULT_COLOR_TEXTURE_PATH;
             }
+         }
 
-            /* Heightmap texture, in some formats this is the same as the normal map */
-            if (numHeightMaps > 0)
-            {
-               assert(numNormalMaps == 0);
-               normalTexturePath = GetPath(aiMaterial, aiTextureType_HEIGHT, filename);
-            }
+         /* Normal texture */
+         if (numNormalMaps > 0)
+         {
+            normalTexturePath = GetPath(aiMaterial, aiTextureType_NORMALS, filename);
+         }
 
-            /* Specular texture */
-            if (numSpecularMaps > 0)
-            {
-               specularTexturePath = GetPath(aiMaterial, aiTextureType_SPECULAR, filename);
-            }
+         /* Heightmap texture, in some formats this is the same as the normal map */
+         if (numHeightMaps > 0)
+         {
+            assert(numNormalMaps == 0);
+            normalTexturePath = GetPath(aiMaterial, aiTextureType_HEIGHT, filename);
+         }
+
+         /* Specular texture */
+         if (numSpecularMaps > 0)
+         {
+            specularTexturePath = GetPath(aiMaterial, aiTextureType_SPECULAR, filename);
+         }
 
-            Material material = gModelLoader().GetDefaultMaterial();
+         importedMesh.diffuseTexturePath = diffuseTexturePath;
+         importedMesh.normalTexturePath = normalTexturePath;
+         importedMesh.specularTexturePath = specularTexturePath;
+      }
 
-            material.colorTexture = Vk::gTextureLoader().LoadTexture(diffuseTexturePath);
-            material.normalTexture = Vk::gTextureLoader().LoadTexture(normalTexturePath);
-            material.specularTexture = Vk::gTextureLoader().LoadTexture(specularTexturePath);
-            material.UpdateTextureDescriptors(mDevice);
+      return importedModel;
+   }
 
-            primitive.SetDebugName(filename);
-            primitive.BuildBuffers(mDevice);
+   SharedPtr<Model> AssimpLoader::CreateModel(const ImportedModel& importedModel, bool asyncTextures, Vk::VertexLayout vertexLayout)
+   {
+      SharedPtr<Model> model = std::make_shared<Model>();
+      model->SetFilename(importedModel.filename);
 
-            Primitive* prim = model->AddPrimitive(primitive);
-            Material* mat = model->AddMaterial(material);
+      auto loadTexture = [asyncTextures](const std::string& path) {
+         if (asyncTextures)
+            return Vk::gTextureLoader().LoadTextureAsync(path);
 
-            mesh.AddPrimitive(prim, mat);
-         }
+         return Vk::gTextureLoader().LoadTexture(path);
+      };
 
-         Node* node = model->CreateNode();
-         node->mesh = mesh;
-         model->AddRootNode(node);
-         model->Init();
-      }
-      else {
-         // Loading of model failed
-         UTO_LOG("Failed to load model: " + filename);
-         model = nullptr;
+      Mesh mesh;
+
+      for (const ImportedMesh& importedMesh : importedModel.meshes)
+      {
+         Material material = gModelLoader().GetDefaultMaterial();
+
+         material.colorTexture = loadTexture(importedMesh.diffuseTexturePath);
+         material.normalTexture = loadTexture(importedMesh.normalTexturePath);
+         material.specularTexture = loadTexture(importedMesh.specularTexturePath);
+         material.UpdateTextureDescriptors(mDevice);
+
+         Primitive* prim = model->AddPrimitive(importedMesh.primitive);
+         prim->SetVertexLayout(vertexLayout);
+         prim->BuildBuffers(mDevice);
+
+         Material* mat = model->AddMaterial(material);
+
+         mesh.AddPrimitive(prim, mat);
       }
 
+      Node* node = model->CreateNode();
+      node->mesh = mesh;
+      model->AddRootNode(node);
+      model->Init();
+
       return model;
    }
 
+   uint32_t AssimpLoader::GetImportFlags()
+   {
+      uint32_t flags = aiProcess_FlipUVs | aiProcess_Triangulate | aiProcess_PreTransformVertices | aiProcess_CalcTangentSpace | aiProcess_GenSmoothNormals | aiProcess_JoinIdenticalVertices;
+
+      if (ModelLoader::GetFlipWindingOrder())
+         flags |= aiProcess_FlipWindingOrder;
+
+      return flags;
+   }
+
+   bool AssimpLoader::FileExists(const std::string& path)
+   {
+      FILE* file = fopen(path.c_str(), "rb");
+      if (file == nullptr)
+         return false;
+
+      fclose(file);
+      return true;
+   }
+
    std::string AssimpLoader::GetPath(aiMaterial* material, aiTextureType textureType, std::string filename)
    {
       std::string path;
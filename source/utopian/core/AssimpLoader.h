@@ -6,6 +6,7 @@
 #include "../external/assimp/assimp/Importer.hpp"
 #include "../external/assimp/assimp/material.h"
 #include "vulkan/Vertex.h"
+#include "core/renderer/Primitive.h"
 #include "utility/Module.h"
 #include "utility/Common.h"
 
@@ -15,6 +16,21 @@ namespace Utopian
 {
    class Model;
 
+   /** Geometry and texture paths of a mesh imported by AssimpLoader::ImportModel(). */
+   struct ImportedMesh
+   {
+      Primitive primitive;
+      std::string diffuseTexturePath;
+      std::string normalTexturePath;
+      std::string specularTexturePath;
+   };
+
+   struct ImportedModel
+   {
+      std::string filename;
+      std::vector<ImportedMesh> meshes;
+   };
+
    /**
     * Loader supporting a lot of different file formats.
     * E.g .fbx, .obj, .dae, .mdl, .md2, .md3 etc.
@@ -28,9 +44,28 @@ namespace Utopian
       AssimpLoader(Vk::Device* device);
       ~AssimpLoader();
 
-      SharedPtr<Model> LoadModel(std::string filename);
+      SharedPtr<Model> LoadModel(std::string filename, Vk::VertexLayout vertexLayout = Vk::VERTEX_LAYOUT_DEFAULT);
+
+      /**
+       * Reads the file and builds the vertex and index data without touching the GPU
+       * so it can be called from worker threads.
+       * @return nullptr if the file could not be loaded.
+       */
+      SharedPtr<ImportedModel> ImportModel(std::string filename);
+
+      /**
+       * Creates the buffers, textures and materials of an imported model, must be called from the main thread.
+       * @param asyncTextures Stream the textures with TextureLoader::LoadTextureAsync().
+       * @param vertexLayout The layout of the vertex buffers, animations are not loaded so all meshes can be compact.
+       */
+      SharedPtr<Model> CreateModel(const ImportedModel& importedModel, bool asyncTextures,
+                                   Vk::VertexLayout vertexLayout = Vk::VERTEX_LAYOUT_DEFAULT);
+
+      /** Returns the Assimp post processing flags used by ImportModel(). */
+      static uint32_t GetImportFlags();
 
    private:
+      bool FileExists(const std::string& path);
       std::string GetPath(aiMaterial* material, aiTextureType textureType, std::string filename);
       int FindValidPath(aiString* texturePath, std::string modelPath);
       bool TryLongerPath(char* szTemp, aiString* p_szString);
@@ -0,0 +1,246 @@
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <vector>
+#include "core/BakedModel.h"
+#include "core/AssimpLoader.h"
+#include "core/Log.h"
+#include "utility/MappedFile.h"
+
+namespace Utopian
+{
+   static const uint32_t BAKED_MODEL_MAGIC = 0x48534d55; // "UMSH"
+
+   // Must be increased whenever the layout of the file changes
+   static const uint32_t BAKED_MODEL_VERSION = 1;
+
+   static const uint64_t BAKED_MODEL_ALIGNMENT = 16;
+
+   enum BakedTexture
+   {
+      BAKED_TEXTURE_DIFFUSE,
+      BAKED_TEXTURE_NORMAL,
+      BAKED_TEXTURE_SPECULAR,
+      NUM_BAKED_TEXTURES
+   };
+
+   struct BakedHeader
+   {
+      uint32_t magic;
+      uint32_t version;
+      uint32_t importFlags;
+      uint32_t vertexSize;
+      uint32_t numMeshes;
+      uint32_t stringTableSize;
+      uint64_t stringTableOffset;
+   };
+
+   struct BakedMesh
+   {
+      uint64_t vertexOffset;
+      uint64_t indexOffset;
+      uint32_t numVertices;
+      uint32_t numIndices;
+      float boundsMin[3];
+      float boundsMax[3];
+      uint32_t texturePathOffsets[NUM_BAKED_TEXTURES];
+      uint32_t texturePathSizes[NUM_BAKED_TEXTURES];
+   };
+
+   static uint64_t Align(uint64_t offset)
+   {
+      return (offset + BAKED_MODEL_ALIGNMENT - 1) & ~(BAKED_MODEL_ALIGNMENT - 1);
+   }
+
+   std::string BakedModel::GetBakedPath(const std::string& filename)
+   {
+      return filename + ".umesh";
+   }
+
+   bool BakedModel::IsUpToDate(const std::string& filename)
+   {
+      std::error_code error;
+      auto bakedTime = std::filesystem::last_write_time(GetBakedPath(filename), error);
+      if (error)
+         return false;
+
+      auto sourceTime = std::filesystem::last_write_time(filename, error);
+      if (error)
+         return false;
+
+      return bakedTime >= sourceTime;
+   }
+
+   SharedPtr<ImportedModel> BakedModel::Load(const std::string& filename, uint32_t importFlags)
+   {
+      MappedFile file(GetBakedPath(filename));
+      if (!file.IsOpen() || file.GetSize() < sizeof(BakedHeader))
+         return nullptr;
+
+      const uint8_t* data = file.GetData();
+      const uint64_t fileSize = file.GetSize();
+
+      BakedHeader header;
+      memcpy(&header, data, sizeof(BakedHeader));
+
+      if (header.magic != BAKED_MODEL_MAGIC || header.version != BAKED_MODEL_VERSION ||
+          header.importFlags != importFlags || header.vertexSize != sizeof(Vk::Vertex))
+         return nullptr;
+
+      if (sizeof(BakedHeader) + (uint64_t)header.numMeshes * sizeof(BakedMesh) > fileSize ||
+          header.stringTableOffset + header.stringTableSize > fileSize)
+      {
+         UTO_LOG("Corrupt baked model: " + GetBakedPath(filename));
+         return nullptr;
+      }
+
+      const char* stringTable = (const char*)(data + header.stringTableOffset);
+
+      SharedPtr<ImportedModel> importedModel = std::make_shared<ImportedModel>();
+      importedModel->filename = filename;
+      importedModel->meshes.resize(header.numMeshes);
+
+      for (uint32_t meshId = 0; meshId < header.numMeshes; meshId++)
+      {
+         BakedMesh bakedMesh;
+         memcpy(&bakedMesh, data + sizeof(BakedHeader) + meshId * sizeof(BakedMesh), sizeof(BakedMesh));
+
+         if (bakedMesh.vertexOffset + (uint64_t)bakedMesh.numVertices * sizeof(Vk::Vertex) > fileSize ||
+             bakedMesh.indexOffset + (uint64_t)bakedMesh.numIndices * sizeof(uint32_t) > fileSize)
+         {
+            UTO_LOG("Corrupt baked model: " + GetBakedPath(filename));
+            return nullptr;
+         }
+
+         std::string texturePaths[NUM_BAKED_TEXTURES];
+         for (uint32_t i = 0; i < NUM_BAKED_TEXTURES; i++)
+         {
+            if ((uint64_t)bakedMesh.texturePathOffsets[i] + bakedMesh.texturePathSizes[i] > header.stringTableSize)
+            {
+               UTO_LOG("Corrupt baked model: " + GetBakedPath(filename));
+               return nullptr;
+            }
+
+            texturePaths[i] = std::string(stringTable + bakedMesh.texturePathOffsets[i], bakedMesh.texturePathSizes[i]);
+         }
+
+         ImportedMesh& importedMesh = importedModel->meshes[meshId];
+         importedMesh.diffuseTexturePath = texturePaths[BAKED_TEXTURE_DIFFUSE];
+         importedMesh.normalTexturePath = texturePaths[BAKED_TEXTURE_NORMAL];
+         importedMesh.specularTexturePath = texturePaths[BAKED_TEXTURE_SPECULAR];
+
+         // The blobs have the same layout as the vectors so they are copied as a whole
+         Primitive& primitive = importedMesh.primitive;
+         const Vk::Vertex* vertices = (const Vk::Vertex*)(data + bakedMesh.vertexOffset);
+         const uint32_t* indices = (const uint32_t*)(data + bakedMesh.indexOffset);
+         primitive.vertices.assign(vertices, vertices + bakedMesh.numVertices);
+         primitive.indices.assign(indices, indices + bakedMesh.numIndices);
+
+         glm::vec3 boundsMin = glm::vec3(bakedMesh.boundsMin[0], bakedMesh.boundsMin[1], bakedMesh.boundsMin[2]);
+         glm::vec3 boundsMax = glm::vec3(bakedMesh.boundsMax[0], bakedMesh.boundsMax[1], bakedMesh.boundsMax[2]);
+         BoundingBox boundingBox;
+         boundingBox.Init(boundsMin, boundsMax - boundsMin);
+         primitive.SetBoundingBox(boundingBox);
+      }
+
+      return importedModel;
+   }
+
+   bool BakedModel::Store(const ImportedModel& importedModel, uint32_t importFlags)
+   {
+      const uint32_t numMeshes = (uint32_t)importedModel.meshes.size();
+
+      BakedHeader header = {};
+      header.magic = BAKED_MODEL_MAGIC;
+      header.version = BAKED_MODEL_VERSION;
+      header.importFlags = importFlags;
+      header.vertexSize = sizeof(Vk::Vertex);
+      header.numMeshes = numMeshes;
+
+      std::vector<BakedMesh> bakedMeshes(numMeshes);
+      std::string stringTable;
+      uint64_t offset = sizeof(BakedHeader) + numMeshes * sizeof(BakedMesh);
+
+      for (uint32_t meshId = 0; meshId < numMeshes; meshId++)
+      {
+         const ImportedMesh& importedMesh = importedModel.meshes[meshId];
+         const Primitive& primitive = importedMesh.primitive;
+         BakedMesh& bakedMesh = bakedMeshes[meshId];
+
+         bakedMesh = {};
+         bakedMesh.numVertices = (uint32_t)primitive.vertices.size();
+         bakedMesh.numIndices = (uint32_t)primitive.indices.size();
+
+         offset = Align(offset);
+         bakedMesh.vertexOffset = offset;
+         offset += (uint64_t)bakedMesh.numVertices * sizeof(Vk::Vertex);
+
+         offset = Align(offset);
+         bakedMesh.indexOffset = offset;
+         offset += (uint64_t)bakedMesh.numIndices * sizeof(uint32_t);
+
+         BoundingBox boundingBox;
+         boundingBox.Init(primitive.vertices);
+         glm::vec3 boundsMin = boundingBox.GetMin();
+         glm::vec3 boundsMax = boundingBox.GetMax();
+         for (uint32_t i = 0; i < 3; i++)
+         {
+            bakedMesh.boundsMin[i] = boundsMin[i];
+            bakedMesh.boundsMax[i] = boundsMax[i];
+         }
+
+         const std::string* texturePaths[NUM_BAKED_TEXTURES] = { &importedMesh.diffuseTexturePath,
+                                                                 &importedMesh.normalTexturePath,
+                                                                 &importedMesh.specularTexturePath };
+         for (uint32_t i = 0; i < NUM_BAKED_TEXTURES; i++)
+         {
+            bakedMesh.texturePathOffsets[i] = (uint32_t)stringTable.size();
+            bakedMesh.texturePathSizes[i] = (uint32_t)texturePaths[i]->size();
+            stringTable += *texturePaths[i];
+         }
+      }
+
+      header.stringTableOffset = offset;
+      header.stringTableSize = (uint32_t)stringTable.size();
+
+      std::vector<uint8_t> data(offset + stringTable.size(), 0);
+      memcpy(data.data(), &header, sizeof(BakedHeader));
+      memcpy(data.data() + sizeof(BakedHeader), bakedMeshes.data(), numMeshes * sizeof(BakedMesh));
+
+      for (uint32_t meshId = 0; meshId < numMeshes; meshId++)
+      {
+         const Primitive& primitive = importedModel.meshes[meshId].primitive;
+         const BakedMesh& bakedMesh = bakedMeshes[meshId];
+         memcpy(data.data() + bakedMesh.vertexOffset, primitive.vertices.data(), bakedMesh.numVertices * sizeof(Vk::Vertex));
+         memcpy(data.data() + bakedMesh.indexOffset, primitive.indices.data(), bakedMesh.numIndices * sizeof(uint32_t));
+      }
+
+      memcpy(data.data() + header.stringTableOffset, stringTable.data(), stringTable.size());
+
+      // Written to a temporary file first so that a model loaded by another thread never sees a partial file
+      std::string bakedPath = GetBakedPath(importedModel.filename);
+      std::string temporaryPath = bakedPath + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+
+      std::ofstream fout(temporaryPath, std::ios::binary);
+      if (!fout.is_open())
+      {
+         UTO_LOG("Failed to write baked model: " + bakedPath);
+         return false;
+      }
+
+      fout.write((const char*)data.data(), data.size());
+      fout.close();
+
+      std::error_code error;
+      std::filesystem::rename(temporaryPath, bakedPath, error);
+      if (error)
+      {
+         std::filesystem::remove(temporaryPath, error);
+         return false;
+      }
+
+      return true;
+   }
+}
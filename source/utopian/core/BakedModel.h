@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+#include "utility/Common.h"
+
+namespace Utopian
+{
+   struct ImportedModel;
+
+   /**
+    * Binary container for models imported with the AssimpLoader, stored next to the source file
+    * with the .umesh extension. The vertex and index data are stored in the same layout as
+    * Primitive::vertices and Primitive::indices so loading is a memory mapping and a copy of each
+    * blob, without the Assimp import and post processing.
+    *
+    * The file contains a header, a table with the counts, bounds and texture paths of each mesh,
+    * the vertex and index blobs aligned to 16 bytes and a string table.
+    */
+   class BakedModel
+   {
+   public:
+      /** Returns the path of the baked file for the source model. */
+      static std::string GetBakedPath(const std::string& filename);
+
+      /** Returns true if the baked file exists and was written after the source model was last modified. */
+      static bool IsUpToDate(const std::string& filename);
+
+      /**
+       * Loads the baked file of the source model.
+       * @param importFlags The Assimp post processing flags, the file is rejected if it was baked with other flags.
+       * @return nullptr if the file is missing, corrupt or from an older version.
+       */
+      static SharedPtr<ImportedModel> Load(const std::string& filename, uint32_t importFlags);
+
+      /**
+       * Writes the baked file of the imported model.
+       * @note Can be called from several threads, the file is written to a temporary file that is then renamed.
+       */
+      static bool Store(const ImportedModel& importedModel, uint32_t importFlags);
+   };
+}
@@ -13,8 +13,11 @@
 #include "core/ActorFactory.h"
 #include "core/Profiler.h"
 #include "core/Log.h"
+#include "core/TaskScheduler.h"
 #include "vulkan/EffectManager.h"
 #include "core/ModelLoader.h"
+#include "core/renderer/JointPalette.h"
+#include "core/renderer/SkinAnimator.h"
 #include "vulkan/TextureLoader.h"
 #include "vulkan/ShaderFactory.h"
 #include "vulkan/Debug.h"
@@ -24,7 +27,7 @@
 
 namespace Utopian
 {
-   Engine::Engine(Window* window, const std::string& appName)
+   Engine::Engine(Window* window, const std::string& appName, uint32_t numFramesInFlight)
       : mAppName(appName)
    {
       srand((unsigned int)time(NULL));
@@ -37,7 +40,7 @@ namespace Utopian
 
       gLog().Start();
 
-      mVulkanApp = std::make_shared<Vk::VulkanApp>(window);
+      mVulkanApp = std::make_shared<Vk::VulkanApp>(window, numFramesInFlight);
       mVulkanApp->Prepare();
 
       mLastFrameTime = gTimer().GetTimestamp();
@@ -48,9 +51,7 @@ namespace Utopian
    Engine::~Engine()
    {
       // Vulkan resources cannot be destroyed when they are in use on the GPU
-      while (!mVulkanApp->PreviousFrameComplete())
-      {
-      }
+      mVulkanApp->WaitForFramesInFlight();
 
       // Call application destroy function
       mDestroyCallback();
@@ -72,6 +73,10 @@ namespace Utopian
          plugin->Destroy();
 
       mImGuiRenderer->GarbageCollect();
+
+      // The skinned models of the world free their palette ranges when the plugins are destroyed
+      gJointPalette().Destroy();
+      gTaskScheduler().Destroy();
    }
 
    void Engine::StartModules()
@@ -79,12 +84,14 @@ namespace Utopian
       UTO_LOG("Starting engine modules");
 
       Vk::Device* device = mVulkanApp->GetDevice();
+      gTaskScheduler().Start();
       Vk::gEffectManager().Start();
       Vk::gTextureLoader().Start(device);
       Vk::gShaderFactory().Start(device);
       Vk::gShaderFactory().AddIncludeDirectory("data/shaders/include");
       Vk::gShaderFactory().AddIncludeDirectory("data/shaders/");
 
+      gJointPalette().Start(device);
       gModelLoader().Start(device);
       gTimer().Start();
       gInput().Start();
@@ -127,6 +134,14 @@ namespace Utopian
       deltaTime /= 1000.0f; // To seconds
       mLastFrameTime = gTimer().GetTimestamp();
 
+      // Blocks until the GPU is done with the frame that used the same frame slot, the
+      // frames in between can still be executing while this one is updated and recorded
+      mVulkanApp->BeginFrame();
+      SkinAnimator::RefreshStaleFrames(mVulkanApp->GetDevice()->GetFrameIndex());
+      mImGuiRenderer->GarbageCollect();
+      gModelLoader().Update();
+      Vk::gTextureLoader().Update();
+
       Update(deltaTime);
       Render();
 
@@ -158,29 +173,24 @@ namespace Utopian
 
    void Engine::Render()
    {
-      if (mVulkanApp->PreviousFrameComplete())
-      {
-         mImGuiRenderer->GarbageCollect();
-
-         if (mPreFrameCallback != nullptr)
-            mPreFrameCallback();
+      if (mPreFrameCallback != nullptr)
+         mPreFrameCallback();
 
-         mVulkanApp->PrepareFrame();
+      mVulkanApp->PrepareFrame();
 
-         for(auto& plugin : mPlugins)
-            plugin->Draw();
+      for(auto& plugin : mPlugins)
+         plugin->Draw();
 
-         mImGuiRenderer->Render();
+      mImGuiRenderer->Render();
 
-         // Call the application Render() function
-         mRenderCallback();
+      // Call the application Render() function
+      mRenderCallback();
 
-         mVulkanApp->Render();
+      mVulkanApp->Render();
 
-         mVulkanApp->SubmitFrame();
+      mVulkanApp->SubmitFrame();
 
-         gTimer().CalculateFrameTime();
-      }
+      gTimer().CalculateFrameTime();
    }
    
    void Engine::HandleMessages(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
@@ -13,7 +13,11 @@ namespace Utopian
    class Engine : public Module<Engine>
    {
    public:
-      Engine(Window* window, const std::string& appName);
+      /**
+       * @param numFramesInFlight How many frames the CPU can record while the GPU executes earlier ones,
+       * clamped to Vk::MAX_FRAMES_IN_FLIGHT.
+       */
+      Engine(Window* window, const std::string& appName, uint32_t numFramesInFlight = Vk::DEFAULT_FRAMES_IN_FLIGHT);
       ~Engine();
 
       /** Executes the main loop and calls Engine::Tick() every frame. */
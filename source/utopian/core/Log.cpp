@@ -31,6 +31,8 @@ namespace Utopian
 
    void Log::AddMessage(std::string message)
    {
+      std::lock_guard<std::mutex> lock(mMutex);
+
       std::cout << message << std::endl;
       
       if (mUserLogCallback != nullptr)
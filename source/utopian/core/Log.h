@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 #include <functional>
+#include <mutex>
 #include <vector>
 #include "utility/Module.h"
 
@@ -35,6 +36,9 @@ namespace Utopian
    private:
       std::function<void(std::string)> mUserLogCallback;
       std::vector<std::string> mStartupEntries;
+
+      // Assets are imported on worker threads that can log errors
+      std::mutex mMutex;
    };
 
    Log& gLog();
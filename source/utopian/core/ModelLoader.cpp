@@ -3,6 +3,7 @@
 #include "core/renderer/Primitive.h"
 #include "core/Log.h"
 #include "core/AssimpLoader.h"
+#include "core/BakedModel.h"
 #include "core/glTFLoader.h"
 #include "core/ModelLoader.h"
 #include "core/renderer/Model.h"
@@ -11,6 +12,7 @@
 #include "vulkan/handles/DescriptorSet.h"
 #include "vulkan/TextureLoader.h"
 #include "utility/Utility.h"
+#include "tinygltf/tiny_gltf.h"
 
 namespace Utopian
 {
@@ -32,14 +34,19 @@ namespace Utopian
       mMeshTexturesDescriptorSetLayout->AddUniformBuffer(20, VK_SHADER_STAGE_ALL, 1); // material properties
       mMeshTexturesDescriptorSetLayout->Create();
 
+      // Every material has one set per frame in flight
+      const uint32_t numFrames = device->GetNumFramesInFlight();
       mMeshTexturesDescriptorPool = std::make_shared<Vk::DescriptorPool>(device);
-      mMeshTexturesDescriptorPool->AddDescriptor(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 512);
-      mMeshTexturesDescriptorPool->AddDescriptor(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 512);
+      mMeshTexturesDescriptorPool->AddDescriptor(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 512 * numFrames);
+      mMeshTexturesDescriptorPool->AddDescriptor(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 512 * numFrames);
       mMeshTexturesDescriptorPool->Create();
    }
 
    ModelLoader::~ModelLoader()
    {
+      // The import tasks reference the pending models
+      for (auto& pendingModel : mPendingModels)
+         gTaskScheduler().Wait(&pendingModel.second->counter);
    }
 
    ModelLoader& gModelLoader()
@@ -57,20 +64,31 @@ namespace Utopian
       return mMeshTexturesDescriptorPool.get();
    }
 
-   SharedPtr<Model> ModelLoader::LoadModel(std::string filename, bool uniqueInstance)
+   SharedPtr<Model> ModelLoader::LoadModel(std::string filename, bool uniqueInstance, Vk::VertexLayout vertexLayout)
    {
+      std::string key = GetModelKey(filename, vertexLayout);
+
       // Check if the model already is loaded
-      if (!uniqueInstance && (mModelMap.find(filename) != mModelMap.end()))
-         return mModelMap[filename];
+      if (!uniqueInstance && (mModelMap.find(key) != mModelMap.end()))
+         return mModelMap[key];
+
+      // Finish an asynchronous request for the same file instead of importing it twice
+      if (!uniqueInstance && (mPendingModels.find(key) != mPendingModels.end()))
+         return FinishPendingModel(key);
 
       SharedPtr<Model> model = nullptr;
 
       std::string extension = GetFileExtension(filename);
 
-      if (extension == ".gltf")
+      if (extension == ".gltf" || extension == ".glb")
          model = mglTFLoader->LoadModel(filename, mDevice);
       else
-         model = mAssimpLoader->LoadModel(filename);
+      {
+         SharedPtr<ImportedModel> importedModel = ImportAssimpModel(filename);
+
+         if (importedModel != nullptr)
+            model = mAssimpLoader->CreateModel(*importedModel, false, vertexLayout);
+      }
 
       if (model == nullptr)
       {
@@ -80,11 +98,153 @@ namespace Utopian
          model = mPlaceholderModel;
       }
       else if(!uniqueInstance)
-         mModelMap[filename] = model;
+         mModelMap[key] = model;
 
       return model;
    }
 
+   ModelFuture ModelLoader::LoadModelAsync(std::string filename, const ModelLoadedCallback& onLoaded, Vk::VertexLayout vertexLayout)
+   {
+      std::string key = GetModelKey(filename, vertexLayout);
+
+      // Already loaded so the future is ready immediately
+      if (mModelMap.find(key) != mModelMap.end())
+      {
+         SharedPtr<Model> model = mModelMap[key];
+
+         if (onLoaded)
+            onLoaded(model);
+
+         std::promise<SharedPtr<Model>> promise;
+         promise.set_value(model);
+         return promise.get_future().share();
+      }
+
+      // Share the import that is already in flight
+      auto iter = mPendingModels.find(key);
+      if (iter != mPendingModels.end())
+      {
+         if (onLoaded)
+            iter->second->callbacks.push_back(onLoaded);
+
+         return iter->second->future;
+      }
+
+      SharedPtr<PendingModel> pendingModel = std::make_shared<PendingModel>();
+      pendingModel->filename = filename;
+      pendingModel->vertexLayout = vertexLayout;
+      pendingModel->future = pendingModel->promise.get_future().share();
+
+      if (onLoaded)
+         pendingModel->callbacks.push_back(onLoaded);
+
+      mPendingModels[key] = pendingModel;
+
+      // The pending model is kept alive by mPendingModels until the task has finished
+      PendingModel* pending = pendingModel.get();
+      gTaskScheduler().Submit([this, pending]() {
+         ImportPendingModel(pending);
+      }, &pendingModel->counter, nullptr, TASK_PRIORITY_BACKGROUND);
+
+      return pendingModel->future;
+   }
+
+   void ModelLoader::ImportPendingModel(PendingModel* pendingModel)
+   {
+      std::string extension = GetFileExtension(pendingModel->filename);
+
+      if (extension == ".gltf" || extension == ".glb")
+      {
+         SharedPtr<tinygltf::Model> glTFModel = std::make_shared<tinygltf::Model>();
+         if (mglTFLoader->ImportModel(pendingModel->filename, *glTFModel))
+            pendingModel->glTFModel = glTFModel;
+      }
+      else
+         pendingModel->assimpModel = ImportAssimpModel(pendingModel->filename);
+   }
+
+   SharedPtr<ImportedModel> ModelLoader::ImportAssimpModel(const std::string& filename)
+   {
+      uint32_t importFlags = AssimpLoader::GetImportFlags();
+
+      if (BakedModel::IsUpToDate(filename))
+      {
+         SharedPtr<ImportedModel> importedModel = BakedModel::Load(filename, importFlags);
+
+         if (importedModel != nullptr)
+            return importedModel;
+      }
+
+      SharedPtr<ImportedModel> importedModel = mAssimpLoader->ImportModel(filename);
+
+      // The next launch can skip the import
+      if (importedModel != nullptr)
+         BakedModel::Store(*importedModel, importFlags);
+
+      return importedModel;
+   }
+
+   SharedPtr<Model> ModelLoader::FinishPendingModel(const std::string& key)
+   {
+      SharedPtr<PendingModel> pendingModel = mPendingModels[key];
+      mPendingModels.erase(key);
+
+      // Only blocks when called from LoadModel() before the import has finished
+      gTaskScheduler().Wait(&pendingModel->counter);
+
+      SharedPtr<Model> model = nullptr;
+
+      if (pendingModel->glTFModel != nullptr)
+         model = mglTFLoader->CreateModel(*pendingModel->glTFModel, pendingModel->filename, mDevice);
+      else if (pendingModel->assimpModel != nullptr)
+         model = mAssimpLoader->CreateModel(*pendingModel->assimpModel, true, pendingModel->vertexLayout);
+
+      if (model == nullptr)
+      {
+         if (mPlaceholderModel == nullptr)
+            mPlaceholderModel = LoadModel(PLACEHOLDER_MODEL_PATH);
+
+         model = mPlaceholderModel;
+      }
+      else
+         mModelMap[key] = model;
+
+      for (auto& callback : pendingModel->callbacks)
+         callback(model);
+
+      pendingModel->promise.set_value(model);
+
+      return model;
+   }
+
+   void ModelLoader::Update()
+   {
+      std::vector<std::string> importedModels;
+
+      for (auto& pendingModel : mPendingModels)
+      {
+         if (pendingModel.second->counter.IsDone())
+            importedModels.push_back(pendingModel.first);
+      }
+
+      // All models that finished importing since the last frame have their GPU resources created together
+      for (const std::string& key : importedModels)
+         FinishPendingModel(key);
+   }
+
+   std::string ModelLoader::GetModelKey(const std::string& filename, Vk::VertexLayout vertexLayout) const
+   {
+      if (vertexLayout == Vk::VERTEX_LAYOUT_COMPACT)
+         return filename + "#compact";
+
+      return filename;
+   }
+
+   uint32_t ModelLoader::GetNumPendingModels() const
+   {
+      return (uint32_t)mPendingModels.size();
+   }
+
    SharedPtr<Model> ModelLoader::LoadGrid(float cellSize, int numCells)
    {
       Primitive primitive;
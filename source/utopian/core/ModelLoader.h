@@ -2,9 +2,12 @@
 
 #include <string>
 #include <map>
+#include <functional>
+#include <future>
 #include "vulkan/VulkanPrerequisites.h"
 #include "core/renderer/Model.h"
 #include "vulkan/Vertex.h"
+#include "core/TaskScheduler.h"
 #include "utility/Module.h"
 #include "utility/Common.h"
 
@@ -15,11 +18,20 @@
 #define DEFAULT_OCCLUSION_TEXTURE "data/textures/white_texture.png"
 #define PLACEHOLDER_MODEL_PATH "data/models/teapot.obj"
 
+namespace tinygltf
+{
+   class Model;
+}
+
 namespace Utopian
 {
    class Model;
    class AssimpLoader;
    class glTFLoader;
+   struct ImportedModel;
+
+   typedef std::shared_future<SharedPtr<Model>> ModelFuture;
+   typedef std::function<void(SharedPtr<Model>)> ModelLoadedCallback;
 
    /**
     * Used for loading models from the filesystem.
@@ -31,7 +43,28 @@ namespace Utopian
       ModelLoader(Vk::Device* device);
       ~ModelLoader();
 
-      SharedPtr<Model> LoadModel(std::string filename, bool uniqueInstance = false);
+      /**
+       * @param vertexLayout VERTEX_LAYOUT_COMPACT is only applied to models loaded with the AssimpLoader,
+       *        the .gltf and .glb models can be skinned and always use the default layout. Models are cached
+       *        per layout so the same file can be loaded with both.
+       */
+      SharedPtr<Model> LoadModel(std::string filename, bool uniqueInstance = false,
+                                 Vk::VertexLayout vertexLayout = Vk::VERTEX_LAYOUT_DEFAULT);
+
+      /**
+       * Imports the file on a worker thread, the returned future becomes ready when Update()
+       * has created the GPU resources. Requests for a file that is loaded or already in flight
+       * share the same model, if the import fails the placeholder model is returned.
+       * @param onLoaded Called on the main thread when the model is created, before the future is ready.
+       * @note Must be called from the main thread.
+       */
+      ModelFuture LoadModelAsync(std::string filename, const ModelLoadedCallback& onLoaded = nullptr,
+                                 Vk::VertexLayout vertexLayout = Vk::VERTEX_LAYOUT_DEFAULT);
+
+      /** Creates the models that have finished importing, called once per frame by the Engine. */
+      void Update();
+
+      uint32_t GetNumPendingModels() const;
       SharedPtr<Model> LoadGrid(float cellSize, int numCells);
       SharedPtr<Model> LoadBox();
       SharedPtr<Model> LoadQuad();
@@ -45,8 +78,32 @@ namespace Utopian
 
       static void SetFlipWindingOrder(bool flipWindingOrder);
       static bool GetFlipWindingOrder();
+   private:
+      /** A model that is being imported by LoadModelAsync(). */
+      struct PendingModel
+      {
+         std::string filename;
+         Vk::VertexLayout vertexLayout;
+         SharedPtr<ImportedModel> assimpModel;
+         SharedPtr<tinygltf::Model> glTFModel;
+         std::vector<ModelLoadedCallback> callbacks;
+         std::promise<SharedPtr<Model>> promise;
+         ModelFuture future;
+         TaskCounter counter;
+      };
+
+      void ImportPendingModel(PendingModel* pendingModel);
+
+      /** Loads the baked file of the model if it is up to date, otherwise imports it with Assimp and bakes it. */
+      SharedPtr<ImportedModel> ImportAssimpModel(const std::string& filename);
+      SharedPtr<Model> FinishPendingModel(const std::string& key);
+
+      /** The key of the model in mModelMap and mPendingModels. */
+      std::string GetModelKey(const std::string& filename, Vk::VertexLayout vertexLayout) const;
+
    private:
       std::map<std::string, SharedPtr<Model>> mModelMap;
+      std::map<std::string, SharedPtr<PendingModel>> mPendingModels;
       SharedPtr<Model> mPlaceholderModel = nullptr;
       Vk::Device* mDevice;
 
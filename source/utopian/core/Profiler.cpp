@@ -7,6 +7,9 @@
 #include "utility/math/Helpers.h"
 #include "core/Input.h"
 #include "vulkan/handles/Device.h"
+#include "vulkan/handles/CommandBuffer.h"
+#include "vulkan/GeometryPool.h"
+#include "vulkan/TextureLoader.h"
 
 namespace Utopian
 {
@@ -22,6 +25,7 @@ namespace Utopian
       mFrametimePlot.Configure(20, 30.0f);
       mFpsPlot.Configure(20, 30.0f);
       mMemoryUsagePlot.Configure(20, 300.0f);
+      mBindsPlot.Configure(20, 30.0f);
       mVulkanApp = vulkanApp;
       mDropFrame = true;
    }
@@ -61,10 +65,46 @@ namespace Utopian
          /* FPS */
          mFpsPlot.AddData((float)gTimer().GetAverageFps());
 
+         /* State binds recorded during the previous frame */
+         Vk::BindStatistics bindStatistics = Vk::CommandBuffer::GetFrameStatistics();
+         uint32_t numBinds = bindStatistics.pipelineBinds + bindStatistics.descriptorSetBinds +
+                             bindStatistics.vertexBufferBinds + bindStatistics.indexBufferBinds;
+         mBindsPlot.AddData((float)numBinds);
+
          ImGui::Begin("Profiling data");
          mFrametimePlot.Render("GPU frame time", 0.0f, 2.0f);
          mFpsPlot.Render("FPS", 0.0f, 100.0f);
          mMemoryUsagePlot.Render("GPU memory usage (MB)", 900.0f, 1100.0f);
+         mBindsPlot.Render("Binds per frame", 0.0f, 5000.0f);
+         ImGui::Text("Draws: %u", bindStatistics.draws);
+         ImGui::Text("Pipeline binds: %u", bindStatistics.pipelineBinds);
+         ImGui::Text("Descriptor set binds: %u", bindStatistics.descriptorSetBinds);
+         ImGui::Text("Vertex buffer binds: %u", bindStatistics.vertexBufferBinds);
+         ImGui::Text("Index buffer binds: %u", bindStatistics.indexBufferBinds);
+         ImGui::Text("Skipped redundant binds: %u", bindStatistics.skippedBinds);
+
+         /* Geometry pool occupancy */
+         for (const auto& heap : mVulkanApp->GetDevice()->GetGeometryPool()->GetStatistics())
+         {
+            const char* type = (heap.usage == VK_BUFFER_USAGE_INDEX_BUFFER_BIT) ? "Index" : "Vertex";
+            ImGui::Text("%s pool (%u B): %.1f / %.1f MB in %u pages, %u allocations, %u free ranges, %.0f%% fragmented",
+                        type, heap.elementSize, heap.usedSize / 1000000.0f, heap.capacity / 1000000.0f, heap.numPages,
+                        heap.numAllocations, heap.numFreeRanges, heap.fragmentation * 100.0f);
+         }
+
+         /* Texture residency */
+         Vk::TextureLoader::ResidencyStatistics residency = Vk::gTextureLoader().GetResidencyStatistics();
+         ImGui::Text("Device local memory: %.1f / %.1f MB budget", residency.memoryUsage / 1000000.0f,
+                     residency.memoryBudget / 1000000.0f);
+         ImGui::Text("Streamed textures: %u, %.1f MB resident", residency.numStreamable, residency.residentSize / 1000000.0f);
+         ImGui::Text("Full: %u, reduced mips: %u, evicted: %u, streaming: %u", residency.numResident,
+                     residency.numReduced, residency.numEvicted, residency.numStreaming);
+
+         /* Animation level of detail */
+         const Renderer::AnimationStatistics& animation = gRenderer().GetAnimationStatistics();
+         ImGui::Text("Animated models: %u full rate, %u reduced rate, %u frozen, %u skeletons updated",
+                     animation.numFullRate, animation.numReducedRate, animation.numFrozen, animation.numUpdated);
+
          ImGui::End();
 
          mProfilerWindow.Render();
@@ -86,6 +126,8 @@ namespace Utopian
       if (mDropFrame)
           taskTime = 0.0f;
 
+      std::lock_guard<std::mutex> lock(mProfilerTaskMutex);
+
       bool found = false;
       for (auto& task : mProfilerTasks)
       {
@@ -1,5 +1,6 @@
 #pragma once
 #include <vector>
+#include <mutex>
 #include "utility/Module.h"
 #include "LegitProfiler/ImGuiProfilerRenderer.h"
 #include "vulkan/VulkanPrerequisites.h"
@@ -37,10 +38,12 @@ namespace Utopian
    private:
       LegitProfiler::ProfilersWindow mProfilerWindow;
       std::vector<LegitProfiler::ProfilerTask> mProfilerTasks;
+      std::mutex mProfilerTaskMutex; // Jobs can add tasks from worker threads
       bool mEnabled;
       MiniPlot mFrametimePlot;
       MiniPlot mMemoryUsagePlot;
       MiniPlot mFpsPlot;
+      MiniPlot mBindsPlot;
       std::vector<float> mFrameTimes;
       Vk::VulkanApp* mVulkanApp;
       bool mDropFrame;
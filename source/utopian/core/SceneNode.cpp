@@ -16,21 +16,25 @@ namespace Utopian
    void SceneNode::SetTransform(const Transform& transform)
    {
       mTransform = transform;
+      OnTransformChanged();
    }
 
    void SceneNode::SetPosition(const glm::vec3& position)
    {
       mTransform.SetPosition(position);
+      OnTransformChanged();
    }
 
    void SceneNode::SetRotation(const glm::vec3& rotation)
    {
       mTransform.SetRotation(rotation);
+      OnTransformChanged();
    }
 
    void SceneNode::SetScale(const glm::vec3& scale)
    {
       mTransform.SetScale(scale);
+      OnTransformChanged();
    }
 
    void SceneNode::SetId(uint32_t id)
@@ -41,16 +45,19 @@ namespace Utopian
    void SceneNode::AddTranslation(const glm::vec3& translation)
    {
       mTransform.AddTranslation(translation);
+      OnTransformChanged();
    }
 
    void SceneNode::AddRotation(const glm::vec3& rotation)
    {
       mTransform.AddRotation(rotation);
+      OnTransformChanged();
    }
 
    void SceneNode::AddScale(const glm::vec3& scale)
    {
       mTransform.AddScale(scale);
+      OnTransformChanged();
    }
 
    void SceneNode::SetDrawBoundingBox(bool draw)
@@ -78,6 +85,10 @@ namespace Utopian
       return mTransform.GetWorldMatrix();
    }
 
+   void SceneNode::OnTransformChanged()
+   {
+   }
+
    bool SceneNode::IsBoundingBoxVisible() const
    {
       return mDrawBoundingBox;
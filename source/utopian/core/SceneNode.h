@@ -11,7 +11,7 @@ namespace Utopian
    {
    public:
       SceneNode();
-      ~SceneNode();
+      virtual ~SceneNode();
       
       // Setters
       void SetTransform(const Transform& transform);
@@ -34,6 +34,11 @@ namespace Utopian
       uint32_t GetId() const;
 
       bool IsBoundingBoxVisible() const;
+
+   protected:
+      /** Called whenever the transform has been modified. */
+      virtual void OnTransformChanged();
+
    private:
       uint32_t mId;
       Transform mTransform;
@@ -0,0 +1,227 @@
+#include <algorithm>
+#include <cassert>
+#include "core/TaskScheduler.h"
+
+namespace Utopian
+{
+   // Index of the queue owned by the current thread, the threads that are not
+   // workers share the queue at index 0
+   static thread_local uint32_t sQueueIndex = 0;
+
+   TaskScheduler& gTaskScheduler()
+   {
+      return TaskScheduler::Instance();
+   }
+
+   TaskCounter::TaskCounter()
+      : mValue(0u)
+   {
+   }
+
+   bool TaskCounter::IsDone() const
+   {
+      return mValue == 0u;
+   }
+
+   TaskScheduler::TaskScheduler(uint32_t numWorkers)
+   {
+      if (numWorkers == 0)
+         numWorkers = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+      mNumQueuedTasks = 0u;
+      mStopping = false;
+
+      for (uint32_t i = 0; i < numWorkers + 1; i++)
+         mQueues.push_back(std::make_unique<WorkQueue>());
+
+      mBackgroundQueue = std::make_unique<WorkQueue>();
+
+      for (uint32_t i = 0; i < numWorkers; i++)
+         mWorkers.push_back(std::thread(&TaskScheduler::WorkerMain, this, i + 1));
+   }
+
+   TaskScheduler::~TaskScheduler()
+   {
+      {
+         std::lock_guard<std::mutex> lock(mWakeMutex);
+         mStopping = true;
+      }
+
+      mWakeCondition.notify_all();
+
+      std::for_each(mWorkers.begin(), mWorkers.end(), [](std::thread& t) { t.join(); });
+   }
+
+   void TaskScheduler::Submit(const TaskFunction& task, TaskCounter* counter, TaskCounter* dependency, TaskPriority priority)
+   {
+      if (counter != nullptr)
+         counter->mValue++;
+
+      if (dependency != nullptr)
+      {
+         // The counter lock makes sure that the dependency cannot finish between the check and the insertion
+         std::lock_guard<std::mutex> lock(dependency->mMutex);
+         if (!dependency->IsDone())
+         {
+            dependency->mDependentTasks.push_back({ task, counter, priority });
+            return;
+         }
+      }
+
+      Push({ task, counter, priority });
+   }
+
+   void TaskScheduler::Wait(TaskCounter* counter)
+   {
+      // Background tasks can take milliseconds, running one here would delay the caller far past its own tasks
+      while (!counter->IsDone())
+      {
+         if (!TryExecuteTask(false))
+            std::this_thread::yield();
+      }
+
+      // The finishing thread can still hold the lock, the counter may be destroyed when this returns
+      std::lock_guard<std::mutex> lock(counter->mMutex);
+   }
+
+   void TaskScheduler::ParallelFor(uint32_t count, uint32_t minBatchSize, const std::function<void(uint32_t)>& func)
+   {
+      if (count == 0)
+         return;
+
+      // A few batches per thread leaves room for stealing when the indices are uneven
+      uint32_t numBatches = std::min(GetNumThreads() * 4, std::max(1u, count / std::max(minBatchSize, 1u)));
+      uint32_t batchSize = (count + numBatches - 1) / numBatches;
+
+      TaskCounter counter;
+      for (uint32_t first = 0; first < count; first += batchSize)
+      {
+         uint32_t last = std::min(first + batchSize, count);
+         Submit([first, last, &func]()
+         {
+            for (uint32_t index = first; index < last; index++)
+               func(index);
+         }, &counter);
+      }
+
+      Wait(&counter);
+   }
+
+   uint32_t TaskScheduler::GetNumThreads() const
+   {
+      return (uint32_t)mWorkers.size() + 1;
+   }
+
+   void TaskScheduler::WorkerMain(uint32_t queueIndex)
+   {
+      sQueueIndex = queueIndex;
+
+      while (true)
+      {
+         if (TryExecuteTask(true))
+            continue;
+
+         std::unique_lock<std::mutex> lock(mWakeMutex);
+         mWakeCondition.wait(lock, [this]() { return mStopping || mNumQueuedTasks > 0u; });
+
+         if (mStopping)
+            break;
+      }
+   }
+
+   void TaskScheduler::Push(const Task& task)
+   {
+      // Counted before it is visible to the other threads so the count never wraps below zero
+      {
+         std::lock_guard<std::mutex> lock(mWakeMutex);
+         mNumQueuedTasks++;
+      }
+
+      WorkQueue* queue = (task.priority == TASK_PRIORITY_BACKGROUND) ? mBackgroundQueue.get() : mQueues[sQueueIndex].get();
+      {
+         std::lock_guard<std::mutex> lock(queue->mutex);
+         queue->tasks.push_back(task);
+      }
+
+      mWakeCondition.notify_one();
+   }
+
+   bool TaskScheduler::TryExecuteTask(bool allowBackground)
+   {
+      Task task;
+      if (!TryPop(sQueueIndex, task) && !TrySteal(sQueueIndex, task) && !(allowBackground && TryPopBackground(task)))
+         return false;
+
+      mNumQueuedTasks--;
+      task.function();
+      FinishTask(task);
+
+      return true;
+   }
+
+   bool TaskScheduler::TryPop(uint32_t queueIndex, Task& task)
+   {
+      WorkQueue* queue = mQueues[queueIndex].get();
+      std::lock_guard<std::mutex> lock(queue->mutex);
+
+      if (queue->tasks.empty())
+         return false;
+
+      // The most recently pushed task is likely to still have its data in the cache
+      task = std::move(queue->tasks.back());
+      queue->tasks.pop_back();
+
+      return true;
+   }
+
+   bool TaskScheduler::TrySteal(uint32_t queueIndex, Task& task)
+   {
+      const uint32_t numQueues = (uint32_t)mQueues.size();
+      for (uint32_t i = 1; i < numQueues; i++)
+      {
+         WorkQueue* queue = mQueues[(queueIndex + i) % numQueues].get();
+         std::lock_guard<std::mutex> lock(queue->mutex);
+
+         if (!queue->tasks.empty())
+         {
+            task = std::move(queue->tasks.front());
+            queue->tasks.pop_front();
+            return true;
+         }
+      }
+
+      return false;
+   }
+
+   bool TaskScheduler::TryPopBackground(Task& task)
+   {
+      std::lock_guard<std::mutex> lock(mBackgroundQueue->mutex);
+
+      if (mBackgroundQueue->tasks.empty())
+         return false;
+
+      // Oldest first so that loads finish in the order they were requested
+      task = std::move(mBackgroundQueue->tasks.front());
+      mBackgroundQueue->tasks.pop_front();
+
+      return true;
+   }
+
+   void TaskScheduler::FinishTask(const Task& task)
+   {
+      TaskCounter* counter = task.counter;
+      if (counter == nullptr)
+         return;
+
+      std::vector<TaskCounter::DependentTask> dependentTasks;
+      {
+         std::lock_guard<std::mutex> lock(counter->mMutex);
+         if (--counter->mValue == 0u)
+            dependentTasks.swap(counter->mDependentTasks);
+      }
+
+      // The counter must not be touched after the lock is released since a waiting thread can return and destroy it
+      for (auto& dependentTask : dependentTasks)
+         Push({ dependentTask.function, dependentTask.counter, dependentTask.priority });
+   }
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "utility/Module.h"
+#include "utility/Common.h"
+
+namespace Utopian
+{
+   typedef std::function<void()> TaskFunction;
+
+   enum TaskPriority
+   {
+      /** Work that someone is waiting for, executed by every thread including those in TaskScheduler::Wait(). */
+      TASK_PRIORITY_NORMAL,
+
+      /**
+       * Long running work like file loading and decoding, only executed by the worker threads when
+       * they have no normal tasks. Never executed by a waiting thread so the main thread does not stall on it.
+       */
+      TASK_PRIORITY_BACKGROUND
+   };
+
+   /**
+    * Counts the tasks that have been submitted with it and not yet finished.
+    * Used to wait for a group of tasks and as a dependency for tasks that
+    * should not start until the group has finished.
+    */
+   class TaskCounter
+   {
+   public:
+      TaskCounter();
+
+      /** Returns true when all tasks submitted with the counter have finished. */
+      bool IsDone() const;
+
+   private:
+      friend class TaskScheduler;
+
+      std::atomic<uint32_t> mValue;
+
+      struct DependentTask
+      {
+         TaskFunction function;
+         TaskCounter* counter;
+         TaskPriority priority;
+      };
+
+      // Tasks waiting for the counter to reach zero
+      std::vector<DependentTask> mDependentTasks;
+      std::mutex mMutex;
+   };
+
+   /**
+    * Work-stealing task scheduler.
+    * Every worker thread owns a deque which it pushes and pops tasks from the back of, idle
+    * workers steal from the front of the other deques. Threads that are not workers, like the
+    * main thread, share one extra deque and take part in the execution while they wait.
+    * Background tasks are kept in a separate queue that only the workers take from.
+    */
+   class TaskScheduler : public Module<TaskScheduler>
+   {
+   public:
+      /** @param numWorkers Number of worker threads, 0 uses one less than the hardware threads. */
+      TaskScheduler(uint32_t numWorkers = 0);
+      ~TaskScheduler();
+
+      /**
+       * Queues a task.
+       * @param counter Incremented now and decremented when the task has finished, can be nullptr.
+       * @param dependency The task is not started until this counter is done, can be nullptr.
+       */
+      void Submit(const TaskFunction& task, TaskCounter* counter = nullptr, TaskCounter* dependency = nullptr,
+                  TaskPriority priority = TASK_PRIORITY_NORMAL);
+
+      /** Blocks until the counter is done, the calling thread executes queued normal priority tasks meanwhile. */
+      void Wait(TaskCounter* counter);
+
+      /**
+       * Calls func(index) for every index in [0, count) and returns when all calls are done.
+       * The range is split into tasks of at least minBatchSize indices.
+       */
+      void ParallelFor(uint32_t count, uint32_t minBatchSize, const std::function<void(uint32_t)>& func);
+
+      /** Returns the number of threads executing tasks including the calling thread. */
+      uint32_t GetNumThreads() const;
+
+   private:
+      struct Task
+      {
+         TaskFunction function;
+         TaskCounter* counter;
+         TaskPriority priority;
+      };
+
+      struct WorkQueue
+      {
+         std::deque<Task> tasks;
+         std::mutex mutex;
+      };
+
+      void WorkerMain(uint32_t queueIndex);
+      void Push(const Task& task);
+      bool TryExecuteTask(bool allowBackground);
+      bool TryPop(uint32_t queueIndex, Task& task);
+      bool TrySteal(uint32_t queueIndex, Task& task);
+      bool TryPopBackground(Task& task);
+      void FinishTask(const Task& task);
+
+   private:
+      std::vector<std::thread> mWorkers;
+      std::vector<UniquePtr<WorkQueue>> mQueues;
+      UniquePtr<WorkQueue> mBackgroundQueue;
+
+      // Wakes sleeping workers when tasks are queued
+      std::atomic<uint32_t> mNumQueuedTasks;
+      std::condition_variable mWakeCondition;
+      std::mutex mWakeMutex;
+      bool mStopping;
+   };
+
+   TaskScheduler& gTaskScheduler();
+}
@@ -23,6 +23,7 @@ namespace Utopian
    Terrain::Terrain(Vk::Device* device)
    {
       mDevice = device;
+      mHeightmap.SetAmplitude(mAmplitudeScaling);
 
       GeneratePatches(1.0f, 512);
       GenerateTerrainMaps();
@@ -175,7 +176,7 @@ namespace Utopian
       assert(subResourceLayout.size == MAP_RESOLUTION * MAP_RESOLUTION * sizeof(float));
 
       // Since the image tiling is linear we can use memcpy
-      memcpy(heightmap.data(), data, subResourceLayout.size);
+      mHeightmap.SetSamples((const float*)data, MAP_RESOLUTION);
 
       hostImage->UnmapMemory();
 
@@ -185,7 +186,7 @@ namespace Utopian
 
    void Terrain::UpdatePhysicsHeightmap()
    {
-      gPhysics().SetHeightmap(heightmap.data(), MAP_RESOLUTION, mAmplitudeScaling, terrainSize);
+      gPhysics().SetHeightmap(mHeightmap.GetSamples(), MAP_RESOLUTION, mAmplitudeScaling, terrainSize);
    }
 
    void Terrain::SetupHeightmapEffect()
@@ -282,6 +283,7 @@ namespace Utopian
    void Terrain::GeneratePatches(float cellSize, int numCells)
    {
       terrainSize = cellSize * (numCells - 1);
+      mHeightmap.SetSize(terrainSize);
 
       mQuadPrimitive = new Primitive();
       mQuadPrimitive->SetDebugName("Terrain patches");
@@ -333,59 +335,38 @@ namespace Utopian
 
    float Terrain::GetHeight(float x, float z)
    {
-      // If the creation of the host image failed
-      if (hostImage == nullptr)
-         return 0.0f;
-
-      float height = -1.0f;
-
-      glm::vec2 uv = TransformToUv(x, z);
-
-      uint32_t col = (uint32_t)floorf(uv.x * hostImage->GetWidth());
-      uint32_t row = (uint32_t)floorf(uv.y * hostImage->GetHeight());
-
-      if (row >= 0 && col >= 0 && row < hostImage->GetWidth() && col < hostImage->GetHeight())
-      {
-         height = heightmap[row * hostImage->GetWidth() + col] * mAmplitudeScaling * -1; // Todo: Fix amplitude and -1
-      }
-
-      return height;
+      return mHeightmap.GetHeight(x, z);
    }
 
-   glm::vec3 Terrain::GetIntersectPoint(Ray ray)
+   void Terrain::GetHeights(const glm::vec2* positions, float* heights, uint32_t count)
    {
-      Ray shorterRay = LinearSearch(ray);
+      mHeightmap.GetHeights(positions, heights, count);
+   }
 
-      // This is good enough accuracy for now
-      return shorterRay.origin;
-      //return BinarySearch(shorterRay);
+   const Heightmap& Terrain::GetHeightmap() const
+   {
+      return mHeightmap;
    }
 
-   Ray Terrain::LinearSearch(Ray ray)
+   glm::vec3 Terrain::GetIntersectPoint(Ray ray)
    {
-      float stepSize = 0.25;
-      glm::vec3 nextPoint = ray.origin + ray.direction * stepSize;
-      float heightAtNextPoint = GetHeight(nextPoint.x, nextPoint.z);
-      int counter = 0;
-      const int numMaxSteps = 2000;
-      while (heightAtNextPoint < nextPoint.y && counter < numMaxSteps)
-      {
-         counter++;
-         ray.origin = nextPoint;
-         nextPoint = ray.origin + ray.direction * stepSize;
-         heightAtNextPoint = GetHeight(nextPoint.x, nextPoint.z);
-      }
+      glm::vec3 intersectPoint;
+      if (mHeightmap.RayIntersect(ray, intersectPoint))
+         return intersectPoint;
 
-      // Return infinity if the ray dont strike anything
-      if (counter >= numMaxSteps)
-         ray.direction.x = std::numeric_limits<float>::infinity();
+      // Outside of the map GetHeight() reports -1 which the picking has always treated as the ground
+      const float outsideHeight = -1.0f;
+      if (ray.direction.y < 0.0f && ray.origin.y > outsideHeight)
+         return ray.origin + ray.direction * ((outsideHeight - ray.origin.y) / ray.direction.y);
 
-      return ray;
+      // Same distance as the maximum number of steps of the previous linear search
+      const float maxDistance = 500.0f;
+      return ray.origin + ray.direction * maxDistance;
    }
 
    glm::vec3 Terrain::GetNormal(float x, float z)
    {
-      return glm::vec3(0, 1, 0);
+      return mHeightmap.GetNormal(x, z);
    }
 
    SharedPtr<Vk::Image>& Terrain::GetHeightmapImage()
@@ -436,6 +417,7 @@ namespace Utopian
    void Terrain::SetAmplitudeScaling(float amplitudeScaling)
    {
       mAmplitudeScaling = amplitudeScaling;
+      mHeightmap.SetAmplitude(amplitudeScaling);
    }
 
    TerrainMaterial Terrain::GetMaterial(std::string material)
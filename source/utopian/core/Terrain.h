@@ -1,11 +1,11 @@
 #pragma once
 #include <glm/glm.hpp>
-#include <array>
 #include "vulkan/VulkanPrerequisites.h"
 #include "vulkan/ShaderBuffer.h"
 #include "vulkan/Texture.h"
 #include "utility/Common.h"
 #include "utility/math/Ray.h"
+#include "utility/math/Heightmap.h"
 #include "imgui\imgui.h"
 
 namespace Utopian
@@ -68,6 +68,10 @@ namespace Utopian
       float GetHeight(float x, float z);
       glm::vec3 GetNormal(float x, float z);
 
+      /** Batched GetHeight(), positions are (x, z) pairs. */
+      void GetHeights(const glm::vec2* positions, float* heights, uint32_t count);
+      const Heightmap& GetHeightmap() const;
+
       uint32_t GetMapResolution();
       float GetTerrainSize();
 
@@ -88,7 +92,6 @@ namespace Utopian
       void SetupNormalmapEffect();
       void SetupBlendmapEffect();
       void RenderHeightmap();
-      Ray LinearSearch(Ray ray);
 
    private:
       Vk::Device* mDevice;
@@ -112,7 +115,7 @@ namespace Utopian
 
       // Heightmap on CPU
       SharedPtr<Vk::Image> hostImage;
-      std::array<float, MAP_RESOLUTION * MAP_RESOLUTION> heightmap;
+      Heightmap mHeightmap;
       float terrainSize;
 
       std::map<std::string, TerrainMaterial> mMaterials;
@@ -72,6 +72,17 @@ namespace Utopian
       RebuildWorldMatrix();
    }
 
+   bool Transform::operator==(const Transform& other) const
+   {
+      return mWorld == other.mWorld && mPosition == other.mPosition &&
+             mScale == other.mScale && mOrientation == other.mOrientation;
+   }
+
+   bool Transform::operator!=(const Transform& other) const
+   {
+      return !(*this == other);
+   }
+
    const glm::vec3& Transform::GetPosition() const
    {
       return mPosition;
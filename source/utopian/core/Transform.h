@@ -28,6 +28,9 @@ namespace Utopian
       glm::mat4 GetWorldInverseTransposeMatrix() const;
 
       void RebuildWorldMatrix();
+
+      bool operator==(const Transform& other) const;
+      bool operator!=(const Transform& other) const;
    //private:
 
       glm::mat4 mWorld;
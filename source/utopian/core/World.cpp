@@ -9,6 +9,9 @@
 #include "core/ScriptExports.h"
 #include "core/LuaManager.h"
 #include "core/physics/Physics.h"
+#include "core/renderer/Renderer.h"
+#include "core/renderer/Renderable.h"
+#include "utility/math/DynamicBvh.h"
 #include <glm/gtc/matrix_transform.hpp>
 
 namespace Utopian
@@ -37,8 +40,15 @@ namespace Utopian
    {
       IntersectionInfo intersectInfo = gPhysics().RayIntersection(ray);
 
-      for (auto& actor : mActors)
-      {
+      // Only the actors whose renderable bounds are hit by the ray are tested
+      const DynamicBvh& bvh = gRenderer().GetRenderableBvh();
+      bvh.QueryRay(ray, intersectInfo.distance, [&](void* userData, float maxDistance) {
+         SceneNode* node = static_cast<Renderable*>(userData);
+         auto iter = mBoundNodes.find(node);
+         if (iter == mBoundNodes.end())
+            return maxDistance;
+
+         Actor* actor = iter->second.actor;
          if (sceneLayer == DefaultSceneLayer || actor->GetSceneLayer() == sceneLayer)
          {
             if (actor->HasComponent<CRenderable>() && !actor->HasComponent<CRigidBody>())
@@ -51,14 +61,16 @@ namespace Utopian
                {
                   if (dist < intersectInfo.distance)
                   {
-                     intersectInfo.actor = actor.get();
+                     intersectInfo.actor = actor;
                      intersectInfo.distance = dist;
                      intersectInfo.normal = normal;
                   }
                }
             }
          }
-      }
+
+         return intersectInfo.distance;
+      });
 
       return intersectInfo;
    }
@@ -102,10 +114,13 @@ namespace Utopian
 
    void World::SynchronizeNodeTransforms()
    {
-      // Synchronize transform between nodes and entities
+      // Synchronize transform between nodes and entities, only the changed ones
+      // are updated since that invalidates their bounds in the renderable BVH
       for (auto& entry : mBoundNodes)
       {
-         entry.second.node->SetTransform(entry.second.actor->GetTransform());
+         const Transform& transform = entry.second.actor->GetTransform();
+         if (entry.second.node->GetTransform() != transform)
+            entry.second.node->SetTransform(transform);
       }
    }
 
@@ -223,7 +238,7 @@ namespace Utopian
       transform->AddRotation(glm::vec3(180.0f, 0, 0));
 
       auto renderable = actor->AddComponent<CRenderable>();
-      renderable->LoadModel("data/NatureManufacture/Meadow Environment Dynamic Nature/Tree Stump/Models/Tree_Stump_01.FBX");
+      renderable->LoadModelAsync("data/NatureManufacture/Meadow Environment Dynamic Nature/Tree Stump/Models/Tree_Stump_01.FBX");
 
       // Grass assets
       for (uint32_t assetId = 0; assetId < GrassAsset::NUM_GRASS_ASSETS; assetId++)
@@ -235,7 +250,7 @@ namespace Utopian
          transform->AddRotation(glm::vec3(180.0f, 0, 0));
 
          renderable = actor->AddComponent<CRenderable>();
-         renderable->SetModel(gAssetLoader().LoadAsset(assetId));
+         renderable->SetModelAsync(gAssetLoader().LoadAssetAsync(assetId));
       }
 
       // Tree assets
@@ -249,7 +264,7 @@ namespace Utopian
          transform->SetScale(glm::vec3(0.2f));
 
          renderable = actor->AddComponent<CRenderable>();
-         renderable->SetModel(gAssetLoader().LoadAsset(assetId));
+         renderable->SetModelAsync(gAssetLoader().LoadAssetAsync(assetId));
       }
 
       // Rock assets
@@ -263,7 +278,7 @@ namespace Utopian
          transform->SetScale(glm::vec3(0.10f));
 
          renderable = actor->AddComponent<CRenderable>();
-         renderable->SetModel(gAssetLoader().LoadAsset(assetId));
+         renderable->SetModelAsync(gAssetLoader().LoadAssetAsync(assetId));
       }
 
       // Bush assets
@@ -276,7 +291,7 @@ namespace Utopian
          transform->AddRotation(glm::vec3(180.0f, 0.0f, 0));
 
          renderable = actor->AddComponent<CRenderable>();
-         renderable->SetModel(gAssetLoader().LoadAsset(assetId));
+         renderable->SetModelAsync(gAssetLoader().LoadAssetAsync(assetId));
       }
 
       // Cliff assets
@@ -290,7 +305,7 @@ namespace Utopian
          transform->SetScale(glm::vec3(0.05f));
 
          renderable = actor->AddComponent<CRenderable>();
-         renderable->SetModel(gAssetLoader().LoadAsset(assetId));
+         renderable->SetModelAsync(gAssetLoader().LoadAssetAsync(assetId));
       }
    }
 }
\ No newline at end of file
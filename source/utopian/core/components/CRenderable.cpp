@@ -5,7 +5,6 @@
 #include "core/renderer/Model.h"
 #include "core/World.h"
 #include "core/ModelLoader.h"
-#include "utility/Timer.h"
 #include "im3d/im3d.h"
 
 namespace Utopian
@@ -23,9 +22,7 @@ namespace Utopian
 
    void CRenderable::Update(double deltaTime)
    {
-      mInternal->UpdateAnimation(gTimer().GetFrameTime());
-
-      if (HasRenderFlags(RENDER_FLAG_BOUNDING_BOX))
+      if (HasRenderFlags(RENDER_FLAG_BOUNDING_BOX) && GetModel() != nullptr)
       {
          glm::vec3 position = mInternal->GetTransform().GetPosition();
          BoundingBox aabb = GetBoundingBox();
@@ -79,6 +76,12 @@ namespace Utopian
       mInternal->LoadModel(path);
    }
 
+   void CRenderable::LoadModelAsync(std::string path)
+   {
+      mPath = path;
+      mInternal->LoadModelAsync(path);
+   }
+
    void CRenderable::SetModel(SharedPtr<Model> model)
    {
       // Note: Todo: How should ActorFactory that loads from Lua handle this?
@@ -86,6 +89,12 @@ namespace Utopian
       mInternal->SetModel(model);
    }
 
+   void CRenderable::SetModelAsync(const std::shared_future<SharedPtr<Model>>& model)
+   {
+      mPath = "Unknown";
+      mInternal->SetModelAsync(model);
+   }
+
    Model* CRenderable::GetModel()
    {
       return mInternal->GetModel();
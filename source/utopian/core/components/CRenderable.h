@@ -23,7 +23,9 @@ namespace Utopian
       LuaPlus::LuaObject GetLuaObject() override;
 
       void LoadModel(std::string path);
+      void LoadModelAsync(std::string path);
       void SetModel(SharedPtr<Model> model);
+      void SetModelAsync(const std::shared_future<SharedPtr<Model>>& model);
       Model* GetModel();
 
       /**
@@ -9,9 +9,66 @@
 #include "vulkan/TextureLoader.h"
 #include "vulkan/handles/DescriptorSetLayout.h"
 #include "vulkan/handles/DescriptorSet.h"
+#include "utility/MappedFile.h"
+#include "utility/Utility.h"
 
 namespace Utopian
 {
+   /**
+    * Reads the elements of an accessor directly from the buffer data without copying them,
+    * also handles accessors in interleaved buffer views.
+    */
+   template <typename T>
+   class AccessorView
+   {
+   public:
+      AccessorView() = default;
+
+      AccessorView(const tinygltf::Model& input, int accessorIndex)
+      {
+         const tinygltf::Accessor& accessor = input.accessors[accessorIndex];
+         const tinygltf::BufferView& bufferView = input.bufferViews[accessor.bufferView];
+         const tinygltf::Buffer& buffer = input.buffers[bufferView.buffer];
+
+         mData = buffer.data.data() + bufferView.byteOffset + accessor.byteOffset;
+         mStride = (size_t)accessor.ByteStride(bufferView);
+         mCount = accessor.count;
+      }
+
+      /** Returns a pointer to the first component of the element. */
+      const T* operator[](size_t index) const
+      {
+         return reinterpret_cast<const T*>(mData + index * mStride);
+      }
+
+      bool IsValid() const
+      {
+         return mData != nullptr;
+      }
+
+      /** Returns true if the elements are tightly packed so they can be copied as a block. */
+      bool IsPacked(size_t elementSize) const
+      {
+         return mStride == elementSize;
+      }
+
+      size_t GetCount() const
+      {
+         return mCount;
+      }
+
+   private:
+      const unsigned char* mData = nullptr;
+      size_t mStride = 0;
+      size_t mCount = 0;
+   };
+
+   static int FindAttribute(const tinygltf::Primitive& glTFPrimitive, const std::string& name)
+   {
+      auto iter = glTFPrimitive.attributes.find(name);
+      return iter != glTFPrimitive.attributes.end() ? iter->second : -1;
+   }
+
    class Model;
    
    glTFLoader::glTFLoader(Vk::Device* device)
@@ -31,47 +88,69 @@ namespace Utopian
       mMeshSkinningDescriptorSetLayout->Create();
 
       mMeshSkinningDescriptorPool = std::make_shared<Vk::DescriptorPool>(mDevice);
-      mMeshSkinningDescriptorPool->AddDescriptor(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 100);
+      // Every skin has one descriptor set per frame slot of the joint palette
+      mMeshSkinningDescriptorPool->AddDescriptor(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 100 * mDevice->GetNumFramesInFlight());
       mMeshSkinningDescriptorPool->Create();
    }
 
    SharedPtr<Model> glTFLoader::LoadModel(std::string filename, Vk::Device* device)
    {
       tinygltf::Model glTFInput;
-      tinygltf::TinyGLTF gltfContext;
-      std::string error, warning;
 
-      bool fileLoaded = gltfContext.LoadASCIIFromFile(&glTFInput, &error, &warning, filename);
+      if (!ImportModel(filename, glTFInput))
+         return nullptr;
 
-      SharedPtr<Model> model = nullptr;
-      if (fileLoaded)
-      {
-         model = std::make_shared<Model>();
-         model->SetFilename(filename);
+      return CreateModel(glTFInput, filename, device);
+   }
 
-         LoadMaterials(glTFInput, model.get());
+   bool glTFLoader::ImportModel(std::string filename, tinygltf::Model& input)
+   {
+      tinygltf::TinyGLTF gltfContext;
+      std::string error, warning;
+      bool fileLoaded = false;
 
-         const tinygltf::Scene& scene = glTFInput.scenes[0];
-         for (size_t i = 0; i < scene.nodes.size(); i++)
+      if (GetFileExtension(filename) == ".glb")
+      {
+         // The chunks are parsed straight from the mapped file instead of being read into a temporary buffer first
+         MappedFile file(filename);
+         if (file.IsOpen())
          {
-            const tinygltf::Node node = glTFInput.nodes[scene.nodes[i]];
-            LoadNode(model.get(), node, glTFInput, nullptr, scene.nodes[i], device);
+            fileLoaded = gltfContext.LoadBinaryFromMemory(&input, &error, &warning, file.GetData(), (unsigned int)file.GetSize(),
+                                                          ExtractFileDirectory(filename));
          }
+      }
+      else
+         fileLoaded = gltfContext.LoadASCIIFromFile(&input, &error, &warning, filename);
 
-         if (glTFInput.skins.size() > 0)
-         {
-            SharedPtr<SkinAnimator> skinAnimator = std::make_shared<SkinAnimator>(glTFInput, model.get(), device);
-            skinAnimator->CreateSkinningDescriptorSet(device, mMeshSkinningDescriptorSetLayout.get(), mMeshSkinningDescriptorPool.get());
-            model->AddSkinAnimator(skinAnimator);
-         }
+      if (!fileLoaded)
+         UTO_LOG("Failed to load glTF model " + filename);
+
+      return fileLoaded;
+   }
 
-         model->Init();
+   SharedPtr<Model> glTFLoader::CreateModel(tinygltf::Model& input, std::string filename, Vk::Device* device)
+   {
+      SharedPtr<Model> model = std::make_shared<Model>();
+      model->SetFilename(filename);
+
+      LoadMaterials(input, model.get());
+
+      const tinygltf::Scene& scene = input.scenes[0];
+      for (size_t i = 0; i < scene.nodes.size(); i++)
+      {
+         const tinygltf::Node& node = input.nodes[scene.nodes[i]];
+         LoadNode(model.get(), node, input, nullptr, scene.nodes[i], device);
       }
-      else
+
+      if (input.skins.size() > 0)
       {
-         UTO_LOG("Failed to load glTF model " + filename);
+         SharedPtr<SkinAnimator> skinAnimator = std::make_shared<SkinAnimator>(input, model.get(), device);
+         skinAnimator->CreateSkinningDescriptorSet(device, mMeshSkinningDescriptorSetLayout.get(), mMeshSkinningDescriptorPool.get());
+         model->AddSkinAnimator(skinAnimator);
       }
 
+      model->Init();
+
       return model;
    }
 
@@ -98,34 +177,36 @@ namespace Utopian
 
       for (size_t i = 0; i < input.materials.size(); i++)
       {
-         tinygltf::Material glTFMaterial = input.materials[i];
+         const tinygltf::Material& glTFMaterial = input.materials[i];
+         const tinygltf::ParameterMap& values = glTFMaterial.values;
+         const tinygltf::ParameterMap& additionalValues = glTFMaterial.additionalValues;
 
          Material material = GetDefaultMaterial();
          material.name = glTFMaterial.name;
 
-         if (glTFMaterial.values.find("baseColorFactor") != glTFMaterial.values.end()) {
-            material.properties->data.baseColorFactor = glm::make_vec4(glTFMaterial.values["baseColorFactor"].ColorFactor().data());
+         if (values.find("baseColorFactor") != values.end()) {
+            material.properties->data.baseColorFactor = glm::make_vec4(values.at("baseColorFactor").ColorFactor().data());
          }
-         if (glTFMaterial.values.find("roughnessFactor") != glTFMaterial.values.end()) {
-            material.properties->data.roughnessFactor = static_cast<float>(glTFMaterial.values["roughnessFactor"].Factor());
+         if (values.find("roughnessFactor") != values.end()) {
+            material.properties->data.roughnessFactor = static_cast<float>(values.at("roughnessFactor").Factor());
          }
-         if (glTFMaterial.values.find("metallicFactor") != glTFMaterial.values.end()) {
-            material.properties->data.metallicFactor = static_cast<float>(glTFMaterial.values["metallicFactor"].Factor());
+         if (values.find("metallicFactor") != values.end()) {
+            material.properties->data.metallicFactor = static_cast<float>(values.at("metallicFactor").Factor());
          }
-         if (glTFMaterial.values.find("baseColorTexture") != glTFMaterial.values.end()) {
-            uint32_t baseColorTextureIndex = glTFMaterial.values["baseColorTexture"].TextureIndex();
+         if (values.find("baseColorTexture") != values.end()) {
+            uint32_t baseColorTextureIndex = values.at("baseColorTexture").TextureIndex();
             material.colorTexture = images[imageRefs[baseColorTextureIndex]];
          }
-         if (glTFMaterial.values.find("metallicRoughnessTexture") != glTFMaterial.values.end()) {
-            uint32_t metallicRoughnessTextureIndex = glTFMaterial.values["metallicRoughnessTexture"].TextureIndex();
+         if (values.find("metallicRoughnessTexture") != values.end()) {
+            uint32_t metallicRoughnessTextureIndex = values.at("metallicRoughnessTexture").TextureIndex();
             material.metallicRoughnessTexture = images[imageRefs[metallicRoughnessTextureIndex]];
          }
-         if (glTFMaterial.additionalValues.find("normalTexture") != glTFMaterial.additionalValues.end()) {
-            uint32_t normalTextureIndex = glTFMaterial.additionalValues["normalTexture"].TextureIndex();
+         if (additionalValues.find("normalTexture") != additionalValues.end()) {
+            uint32_t normalTextureIndex = additionalValues.at("normalTexture").TextureIndex();
             material.normalTexture = images[imageRefs[normalTextureIndex]];
          }
-         if (glTFMaterial.additionalValues.find("occlusionTexture") != glTFMaterial.additionalValues.end()) {
-            uint32_t occlusionTextureIndex = glTFMaterial.additionalValues["occlusionTexture"].TextureIndex();
+         if (additionalValues.find("occlusionTexture") != additionalValues.end()) {
+            uint32_t occlusionTextureIndex = additionalValues.at("occlusionTexture").TextureIndex();
             material.occlusionTexture = images[imageRefs[occlusionTextureIndex]];
          }
 
@@ -185,7 +266,7 @@ namespace Utopian
       if (inputNode.mesh > -1)
       {
          // Iterate through all primitives of this node's mesh
-         const tinygltf::Mesh mesh = input.meshes[inputNode.mesh];
+         const tinygltf::Mesh& mesh = input.meshes[inputNode.mesh];
          for (size_t i = 0; i < mesh.primitives.size(); i++)
          {
             const tinygltf::Primitive& glTFPrimitive = mesh.primitives[i];
@@ -223,65 +304,63 @@ namespace Utopian
 
    void glTFLoader::AppendVertexData(const tinygltf::Model& input, const tinygltf::Primitive& glTFPrimitive, Primitive* primitive, bool hasIndices)
    {
-      const float* positionBuffer = nullptr;
-      const float* normalsBuffer = nullptr;
-      const float* texCoordsBuffer = nullptr;
-      const float* tangentsBuffer = nullptr;
-      const uint16_t* jointIndicesBuffer = nullptr;
-      const float* jointWeightsBuffer = nullptr;
+      AccessorView<float> positions, normals, texCoords, tangents, jointWeights;
+      AccessorView<uint8_t> jointIndicesU8;
+      AccessorView<uint16_t> jointIndicesU16;
       size_t vertexCount = 0;
 
-      if (glTFPrimitive.attributes.find("POSITION") != glTFPrimitive.attributes.end())
-      {
-         const tinygltf::Accessor& accessor = input.accessors[glTFPrimitive.attributes.find("POSITION")->second];
-         const tinygltf::BufferView& view = input.bufferViews[accessor.bufferView];
-         positionBuffer = reinterpret_cast<const float*>(&(input.buffers[view.buffer].data[accessor.byteOffset + view.byteOffset]));
-         vertexCount = accessor.count;
-      }
-      if (glTFPrimitive.attributes.find("NORMAL") != glTFPrimitive.attributes.end())
-      {
-         const tinygltf::Accessor& accessor = input.accessors[glTFPrimitive.attributes.find("NORMAL")->second];
-         const tinygltf::BufferView& view = input.bufferViews[accessor.bufferView];
-         normalsBuffer = reinterpret_cast<const float*>(&(input.buffers[view.buffer].data[accessor.byteOffset + view.byteOffset]));
-      }
-      if (glTFPrimitive.attributes.find("TEXCOORD_0") != glTFPrimitive.attributes.end())
+      int accessorIndex = FindAttribute(glTFPrimitive, "POSITION");
+      if (accessorIndex != -1)
       {
-         const tinygltf::Accessor& accessor = input.accessors[glTFPrimitive.attributes.find("TEXCOORD_0")->second];
-         const tinygltf::BufferView& view = input.bufferViews[accessor.bufferView];
-         texCoordsBuffer = reinterpret_cast<const float*>(&(input.buffers[view.buffer].data[accessor.byteOffset + view.byteOffset]));
+         positions = AccessorView<float>(input, accessorIndex);
+         vertexCount = positions.GetCount();
       }
-      if (glTFPrimitive.attributes.find("TANGENT") != glTFPrimitive.attributes.end())
+      if ((accessorIndex = FindAttribute(glTFPrimitive, "NORMAL")) != -1)
+         normals = AccessorView<float>(input, accessorIndex);
+      if ((accessorIndex = FindAttribute(glTFPrimitive, "TEXCOORD_0")) != -1)
+         texCoords = AccessorView<float>(input, accessorIndex);
+      if ((accessorIndex = FindAttribute(glTFPrimitive, "TANGENT")) != -1)
+         tangents = AccessorView<float>(input, accessorIndex);
+      if ((accessorIndex = FindAttribute(glTFPrimitive, "WEIGHTS_0")) != -1)
+         jointWeights = AccessorView<float>(input, accessorIndex);
+      if ((accessorIndex = FindAttribute(glTFPrimitive, "JOINTS_0")) != -1)
       {
-         const tinygltf::Accessor& accessor = input.accessors[glTFPrimitive.attributes.find("TANGENT")->second];
-         const tinygltf::BufferView& view = input.bufferViews[accessor.bufferView];
-         tangentsBuffer = reinterpret_cast<const float*>(&(input.buffers[view.buffer].data[accessor.byteOffset + view.byteOffset]));
-      }
-      if (glTFPrimitive.attributes.find("JOINTS_0") != glTFPrimitive.attributes.end())
-      {
-         const tinygltf::Accessor& accessor = input.accessors[glTFPrimitive.attributes.find("JOINTS_0")->second];
-         const tinygltf::BufferView& view = input.bufferViews[accessor.bufferView];
-         jointIndicesBuffer = reinterpret_cast<const uint16_t*>(&(input.buffers[view.buffer].data[accessor.byteOffset + view.byteOffset]));
-      }
-      if (glTFPrimitive.attributes.find("WEIGHTS_0") != glTFPrimitive.attributes.end())
-      {
-         const tinygltf::Accessor& accessor = input.accessors[glTFPrimitive.attributes.find("WEIGHTS_0")->second];
-         const tinygltf::BufferView& view = input.bufferViews[accessor.bufferView];
-         jointWeightsBuffer = reinterpret_cast<const float*>(&(input.buffers[view.buffer].data[accessor.byteOffset + view.byteOffset]));
+         // Joint indices are either unsigned bytes or shorts
+         if (input.accessors[accessorIndex].componentType == TINYGLTF_PARAMETER_TYPE_UNSIGNED_BYTE)
+            jointIndicesU8 = AccessorView<uint8_t>(input, accessorIndex);
+         else
+            jointIndicesU16 = AccessorView<uint16_t>(input, accessorIndex);
       }
 
-      bool hasSkin = (jointIndicesBuffer && jointWeightsBuffer);
+      bool hasSkin = ((jointIndicesU8.IsValid() || jointIndicesU16.IsValid()) && jointWeights.IsValid());
+
+      // The vertices are written in place, the accessors are read directly from the buffer data
+      const size_t firstVertex = primitive->vertices.size();
+      primitive->vertices.resize(firstVertex + vertexCount);
 
       for (size_t v = 0; v < vertexCount; v++)
       {
-         Vk::Vertex vert = {};
-         vert.pos = glm::make_vec3(&positionBuffer[v * 3]);
-         vert.normal = glm::normalize(glm::vec3(normalsBuffer ? glm::make_vec3(&normalsBuffer[v * 3]) : glm::vec3(0.0f)));
-         vert.uv = texCoordsBuffer ? glm::make_vec2(&texCoordsBuffer[v * 2]) : glm::vec3(0.0f);
-         vert.tangent = tangentsBuffer ? glm::make_vec4(&tangentsBuffer[v * 4]) : glm::vec4(0.0f);
+         Vk::Vertex& vert = primitive->vertices[firstVertex + v];
+         vert.pos = glm::make_vec3(positions[v]);
+         vert.normal = normals.IsValid() ? glm::normalize(glm::make_vec3(normals[v])) : glm::vec3(0.0f);
+         vert.uv = texCoords.IsValid() ? glm::make_vec2(texCoords[v]) : glm::vec2(0.0f);
+         vert.tangent = tangents.IsValid() ? glm::make_vec4(tangents[v]) : glm::vec4(0.0f);
          vert.color = glm::vec3(1.0f);
-         vert.jointIndices = hasSkin ? glm::vec4(glm::make_vec4(&jointIndicesBuffer[v * 4])) : glm::vec4(0.0f);
-         vert.jointWeights = hasSkin ? glm::make_vec4(&jointWeightsBuffer[v * 4]) : glm::vec4(0.0f);
-         primitive->AddVertex(vert);
+
+         if (hasSkin)
+         {
+            if (jointIndicesU8.IsValid())
+               vert.jointIndices = glm::vec4(glm::make_vec4(jointIndicesU8[v]));
+            else
+               vert.jointIndices = glm::vec4(glm::make_vec4(jointIndicesU16[v]));
+
+            vert.jointWeights = glm::make_vec4(jointWeights[v]);
+         }
+         else
+         {
+            vert.jointIndices = glm::vec4(0.0f);
+            vert.jointWeights = glm::vec4(0.0f);
+         }
       }
 
       // Flip winding order
@@ -296,7 +375,7 @@ namespace Utopian
          }
       }
 
-      if (normalsBuffer == nullptr)
+      if (!normals.IsValid())
       {
          UTO_LOG("Missing normals for model, calculating flat normals");
          for (size_t v = 0; v < primitive->GetNumVertices(); v += 3)
@@ -314,40 +393,40 @@ namespace Utopian
 
    void glTFLoader::AppendIndexData(const tinygltf::Model& input, const tinygltf::Primitive& glTFPrimitive, Primitive* primitive)
    {
-      const tinygltf::Accessor& accessor = input.accessors[glTFPrimitive.indices];
-      const tinygltf::BufferView& bufferView = input.bufferViews[accessor.bufferView];
-      const tinygltf::Buffer& buffer = input.buffers[bufferView.buffer];
-
-      uint32_t indexCount = static_cast<uint32_t>(accessor.count);
+      std::vector<unsigned int>& indices = primitive->indices;
+      const size_t firstIndex = indices.size();
+      const int componentType = input.accessors[glTFPrimitive.indices].componentType;
 
       // glTF supports different component types of indices
-      switch (accessor.componentType) {
+      switch (componentType) {
       case TINYGLTF_PARAMETER_TYPE_UNSIGNED_INT: {
-         uint32_t* buf = new uint32_t[accessor.count];
-         memcpy(buf, &buffer.data[accessor.byteOffset + bufferView.byteOffset], accessor.count * sizeof(uint32_t));
-         for (size_t index = 0; index < accessor.count; index += 3) {
-            primitive->AddTriangle(buf[index], buf[index+1], buf[index+2]);
+         AccessorView<uint32_t> view(input, glTFPrimitive.indices);
+         if (view.IsPacked(sizeof(uint32_t)))
+            indices.insert(indices.end(), view[0], view[0] + view.GetCount());
+         else
+         {
+            indices.resize(firstIndex + view.GetCount());
+            for (size_t index = 0; index < view.GetCount(); index++)
+               indices[firstIndex + index] = *view[index];
          }
          break;
       }
       case TINYGLTF_PARAMETER_TYPE_UNSIGNED_SHORT: {
-         uint16_t* buf = new uint16_t[accessor.count];
-         memcpy(buf, &buffer.data[accessor.byteOffset + bufferView.byteOffset], accessor.count * sizeof(uint16_t));
-         for (size_t index = 0; index < accessor.count; index += 3) {
-            primitive->AddTriangle(buf[index], buf[index+1], buf[index+2]);
-         }
+         AccessorView<uint16_t> view(input, glTFPrimitive.indices);
+         indices.resize(firstIndex + view.GetCount());
+         for (size_t index = 0; index < view.GetCount(); index++)
+            indices[firstIndex + index] = *view[index];
          break;
       }
       case TINYGLTF_PARAMETER_TYPE_UNSIGNED_BYTE: {
-         uint8_t* buf = new uint8_t[accessor.count];
-         memcpy(buf, &buffer.data[accessor.byteOffset + bufferView.byteOffset], accessor.count * sizeof(uint8_t));
-         for (size_t index = 0; index < accessor.count; index += 3) {
-            primitive->AddTriangle(buf[index], buf[index+1], buf[index+2]);
-         }
+         AccessorView<uint8_t> view(input, glTFPrimitive.indices);
+         indices.resize(firstIndex + view.GetCount());
+         for (size_t index = 0; index < view.GetCount(); index++)
+            indices[firstIndex + index] = *view[index];
          break;
       }
       default:
-         UTO_LOG("Index component type " + std::to_string(accessor.componentType) + " not supported!");
+         UTO_LOG("Index component type " + std::to_string(componentType) + " not supported!");
          assert(0);
       }
 
@@ -368,10 +447,10 @@ namespace Utopian
    {
       Material material;
 
-      material.descriptorSet = std::make_shared<Vk::DescriptorSet>(mDevice, gModelLoader().GetMeshTextureDescriptorSetLayout(),
-                                                                   gModelLoader().GetMeshTextureDescriptorPool());
+      material.CreateDescriptorSets(mDevice, gModelLoader().GetMeshTextureDescriptorSetLayout(),
+                                    gModelLoader().GetMeshTextureDescriptorPool());
 
-      material.properties->Create(mDevice, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
+      material.properties->Create(mDevice, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, Vk::UPDATE_FREQUENCY_RARELY);
       material.properties->UpdateMemory();
 
       material.colorTexture = Vk::gTextureLoader().LoadTexture(DEFAULT_COLOR_TEXTURE_PATH);
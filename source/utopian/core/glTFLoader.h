@@ -8,7 +8,7 @@
 namespace Utopian
 {
    /**
-    * The loader used for loading .gltf models.
+    * The loader used for loading .gltf and .glb models.
     * Supports PBR materials and skinning.
     */
    class glTFLoader
@@ -19,6 +19,15 @@ namespace Utopian
 
       SharedPtr<Model> LoadModel(std::string filename, Vk::Device* device);
 
+      /**
+       * Parses the file and decodes the images, does not touch the GPU so it can be
+       * called from worker threads.
+       */
+      bool ImportModel(std::string filename, tinygltf::Model& input);
+
+      /** Creates the model from the parsed file, must be called from the main thread. */
+      SharedPtr<Model> CreateModel(tinygltf::Model& input, std::string filename, Vk::Device* device);
+
       Material GetDefaultMaterial();
 
       // Todo: this is due to the coordinate system being inversed in the engine,
@@ -0,0 +1,107 @@
+#include <cassert>
+#include <cstring>
+#include "core/renderer/BakedAnimation.h"
+#include "core/renderer/Model.h"
+#include "core/renderer/SkinAnimator.h"
+#include "core/Log.h"
+#include "vulkan/UploadManager.h"
+#include "vulkan/handles/Device.h"
+#include "vulkan/handles/Buffer.h"
+#include "vulkan/handles/DescriptorSetLayout.h"
+#include "vulkan/handles/DescriptorSet.h"
+
+namespace Utopian
+{
+   BakedAnimation::BakedAnimation(Vk::Device* device, const std::vector<glm::mat4>& jointMatrices, uint32_t numJoints, uint32_t numFrames, float sampleRate)
+   {
+      assert(jointMatrices.size() == (size_t)numJoints * numFrames);
+
+      mDevice = device;
+      mNumJoints = numJoints;
+      mNumFrames = numFrames;
+      mSampleRate = sampleRate;
+
+      Header header;
+      header.numJoints = numJoints;
+      header.numFrames = numFrames;
+      header.sampleRate = sampleRate;
+      header.pad = 0.0f;
+
+      std::vector<uint8_t> data(sizeof(Header) + jointMatrices.size() * sizeof(glm::mat4));
+      memcpy(data.data(), &header, sizeof(Header));
+      memcpy(data.data() + sizeof(Header), jointMatrices.data(), jointMatrices.size() * sizeof(glm::mat4));
+
+      // Never written again so it lives in device local memory
+      Vk::BUFFER_CREATE_INFO createInfo;
+      createInfo.usageFlags = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+      createInfo.memoryPropertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+      createInfo.data = nullptr;
+      createInfo.size = data.size();
+      createInfo.name = "Baked animation buffer";
+      mBuffer = std::make_shared<Vk::Buffer>(createInfo, device);
+
+      device->GetUploadManager()->UploadBuffer(mBuffer, data.data(), data.size());
+
+      mDescriptorSetLayout = std::make_shared<Vk::DescriptorSetLayout>(device);
+      mDescriptorSetLayout->AddStorageBuffer(0, VK_SHADER_STAGE_ALL, 1); // BakedJointMatrices
+      mDescriptorSetLayout->Create();
+
+      mDescriptorPool = std::make_shared<Vk::DescriptorPool>(device);
+      mDescriptorPool->AddDescriptor(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1);
+      mDescriptorPool->Create();
+
+      mDescriptor.buffer = mBuffer->GetVkHandle();
+      mDescriptor.offset = 0;
+      mDescriptor.range = VK_WHOLE_SIZE;
+
+      mDescriptorSet = std::make_shared<Vk::DescriptorSet>(device, mDescriptorSetLayout.get(), mDescriptorPool.get());
+      mDescriptorSet->BindStorageBuffer(0, &mDescriptor);
+      mDescriptorSet->UpdateDescriptorSets();
+   }
+
+   BakedAnimation::~BakedAnimation()
+   {
+      mDevice->QueueDestroy(mBuffer);
+   }
+
+   SharedPtr<BakedAnimation> BakedAnimation::Create(Vk::Device* device, Model* model)
+   {
+      SkinAnimator* animator = model->GetAnimator();
+      if (animator == nullptr || animator->GetNumAnimations() == 0)
+         return nullptr;
+
+      if (animator->GetNumSkins() != 1)
+      {
+         UTO_LOG("Only models with a single skin can be instanced with a baked animation");
+         return nullptr;
+      }
+
+      uint32_t numFrames = 0;
+      std::vector<glm::mat4> jointMatrices = animator->BakeJointMatrices(animator->GetActiveAnimation(), 0,
+                                                                         BAKED_ANIMATION_SAMPLE_RATE, numFrames);
+      if (jointMatrices.empty())
+         return nullptr;
+
+      return std::make_shared<BakedAnimation>(device, jointMatrices, animator->GetNumJoints(0), numFrames, BAKED_ANIMATION_SAMPLE_RATE);
+   }
+
+   VkDescriptorSet BakedAnimation::GetDescriptorSet() const
+   {
+      return mDescriptorSet->GetVkHandle();
+   }
+
+   uint32_t BakedAnimation::GetNumJoints() const
+   {
+      return mNumJoints;
+   }
+
+   uint32_t BakedAnimation::GetNumFrames() const
+   {
+      return mNumFrames;
+   }
+
+   float BakedAnimation::GetDuration() const
+   {
+      return mNumFrames / mSampleRate;
+   }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "vulkan/VulkanPrerequisites.h"
+#include "utility/Common.h"
+
+// Keyframes per second that the animations of instanced models are baked at
+#define BAKED_ANIMATION_SAMPLE_RATE 30.0f
+
+namespace Utopian
+{
+   class Model;
+
+   /**
+    * The joint matrices of a skinned animation sampled at a fixed rate into a device local storage buffer,
+    * so that all instances of an InstanceGroup can be skinned in one draw without a SkinAnimator each.
+    * The buffer starts with the number of joints, the number of frames and the sample rate followed by the
+    * joint matrices of every frame, see data/shaders/include/baked_animation.glsl.
+    */
+   class BakedAnimation
+   {
+   public:
+      BakedAnimation(Vk::Device* device, const std::vector<glm::mat4>& jointMatrices, uint32_t numJoints, uint32_t numFrames, float sampleRate);
+      ~BakedAnimation();
+
+      /**
+       * Bakes the active animation of the model.
+       * Returns nullptr if the model has no animations or more than one skin, since all primitives of an
+       * instanced draw read the same joint matrices.
+       */
+      static SharedPtr<BakedAnimation> Create(Vk::Device* device, Model* model);
+
+      VkDescriptorSet GetDescriptorSet() const;
+      uint32_t GetNumJoints() const;
+      uint32_t GetNumFrames() const;
+
+      /** Returns the length of the baked animation in seconds. */
+      float GetDuration() const;
+
+   private:
+      /** Matches the header of the BakedJointMatrices block in baked_animation.glsl. */
+      struct Header
+      {
+         uint32_t numJoints;
+         uint32_t numFrames;
+         float sampleRate;
+         float pad;
+      };
+
+      Vk::Device* mDevice;
+      SharedPtr<Vk::Buffer> mBuffer;
+      SharedPtr<Vk::DescriptorSetLayout> mDescriptorSetLayout;
+      SharedPtr<Vk::DescriptorPool> mDescriptorPool;
+      SharedPtr<Vk::DescriptorSet> mDescriptorSet;
+      VkDescriptorBufferInfo mDescriptor;
+      uint32_t mNumJoints;
+      uint32_t mNumFrames;
+      float mSampleRate;
+   };
+}
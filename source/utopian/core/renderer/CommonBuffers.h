@@ -9,25 +9,21 @@ namespace Utopian
 {
    class LightUniformBuffer : public Utopian::Vk::ShaderBuffer
    {
-   public:
-      virtual void UpdateMemory()
+   protected:
+      virtual void WriteMemory(uint8_t* mapped)
       {
-         // Map and update the light data
-         uint8_t* mapped;
+         // Update number of lights
          uint32_t dataOffset = 0;
          uint32_t dataSize = sizeof(constants);
-         mBuffer->MapMemory((void**)&mapped);
          memcpy(mapped, &constants.numLights, dataSize);
-         mBuffer->UnmapMemory();
 
-         // Map and update number of lights
+         // Update the light data
          dataOffset += dataSize;
          dataSize = (uint32_t)lights.size() * sizeof(Utopian::LightData);
-         mBuffer->MapMemory((void**)&mapped);
          memcpy(&mapped[dataOffset], lights.data(), dataSize);
-         mBuffer->UnmapMemory();
       }
 
+   public:
       virtual int GetSize()
       {
          return (NUM_MAX_LIGHTS) * sizeof(Utopian::LightData) + sizeof(constants);
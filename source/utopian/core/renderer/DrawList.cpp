@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <cstring>
+#include "core/renderer/DrawList.h"
+#include "core/renderer/Model.h"
+#include "core/renderer/Primitive.h"
+#include "vulkan/handles/DescriptorSet.h"
+
+namespace Utopian
+{
+   // Number of bits of each part of the sort key, from most to least significant
+   static const uint32_t EFFECT_BITS = 8;
+   static const uint32_t MATERIAL_BITS = 20;
+   static const uint32_t VERTEX_BUFFER_BITS = 16;
+   static const uint32_t DEPTH_BITS = 20;
+
+   static uint64_t HashPointer(const void* pointer, uint32_t bits)
+   {
+      // Fibonacci hashing spreads the aligned pointers over the available bits
+      uint64_t value = (uint64_t)(uintptr_t)pointer * 0x9E3779B97F4A7C15ull;
+      return value >> (64 - bits);
+   }
+
+   DrawList::DrawList()
+   {
+   }
+
+   DrawList::~DrawList()
+   {
+   }
+
+   uint64_t DrawList::MakeSortKey(uint32_t effectIndex, const void* material, const void* vertexBuffer, float depth)
+   {
+      // The bit pattern of a positive float increases with its value
+      uint32_t depthBits;
+      depth = std::max(depth, 0.0f);
+      memcpy(&depthBits, &depth, sizeof(depthBits));
+      depthBits >>= (31 - DEPTH_BITS);
+
+      uint64_t key = (uint64_t)(effectIndex & ((1u << EFFECT_BITS) - 1));
+      key = (key << MATERIAL_BITS) | HashPointer(material, MATERIAL_BITS);
+      key = (key << VERTEX_BUFFER_BITS) | HashPointer(vertexBuffer, VERTEX_BUFFER_BITS);
+      key = (key << DEPTH_BITS) | depthBits;
+
+      return key;
+   }
+
+   void DrawList::Clear()
+   {
+      mItems.clear();
+   }
+
+   void DrawList::AddRenderCommand(Vk::Effect* effect, uint32_t effectIndex, Renderable* renderable, const RenderCommand* command, float depth)
+   {
+      for (uint32_t i = 0; i < command->mesh->primitives.size(); i++)
+      {
+         Primitive* primitive = command->mesh->primitives[i];
+         Material* material = command->mesh->materials[i];
+
+         DrawItem item;
+         // The descriptor sets of all frame slots bind the same resources, the first one identifies the material
+         item.sortKey = MakeSortKey(effectIndex, material->GetDescriptorSet(0), primitive->GetVertxBuffer(), depth);
+         item.effect = effect;
+         item.renderable = renderable;
+         item.command = command;
+         item.primitiveIndex = i;
+         mItems.push_back(item);
+      }
+   }
+
+   void DrawList::Sort()
+   {
+      std::sort(mItems.begin(), mItems.end(), [](const DrawItem& a, const DrawItem& b) {
+         return a.sortKey < b.sortKey;
+      });
+   }
+
+   const std::vector<DrawItem>& DrawList::GetItems() const
+   {
+      return mItems;
+   }
+
+   uint32_t DrawList::GetNumItems() const
+   {
+      return (uint32_t)mItems.size();
+   }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "vulkan/VulkanPrerequisites.h"
+
+namespace Utopian
+{
+   class Renderable;
+   struct RenderCommand;
+
+   /** A single primitive to draw, see DrawList. */
+   struct DrawItem
+   {
+      uint64_t sortKey;
+      Vk::Effect* effect;
+      Renderable* renderable;
+      const RenderCommand* command;
+      uint32_t primitiveIndex;
+   };
+
+   /**
+    * List of primitives sorted by state so that consecutive draws share as
+    * much as possible of the pipeline, material descriptor set and vertex buffer.
+    * Jobs build it once per frame and replay it, the redundant binds between
+    * neighbouring items are then skipped by CommandBuffer.
+    */
+   class DrawList
+   {
+   public:
+      DrawList();
+      ~DrawList();
+
+      /**
+       * Packs the state into a key where the effect has the highest priority followed
+       * by the material, the vertex buffer and the distance to the camera.
+       * The material and vertex buffer are hashed so only equality is meaningful.
+       */
+      static uint64_t MakeSortKey(uint32_t effectIndex, const void* material, const void* vertexBuffer, float depth);
+
+      /** Removes all items but keeps the memory. */
+      void Clear();
+
+      /** Adds one item per primitive in the render command. */
+      void AddRenderCommand(Vk::Effect* effect, uint32_t effectIndex, Renderable* renderable, const RenderCommand* command, float depth);
+
+      void Sort();
+
+      const std::vector<DrawItem>& GetItems() const;
+      uint32_t GetNumItems() const;
+
+   private:
+      std::vector<DrawItem> mItems;
+   };
+}
@@ -17,18 +17,20 @@ namespace Utopian
       mViewportSize = viewportSize;
       mVulkanApp = vulkanApp;
 
-      mVertexBuffer = std::make_shared<Vk::Buffer>(vulkanApp->GetDevice(), "Im3d vertex buffer");
-      mVertexCount = 0;
+      mFrameVertexBuffers.resize(vulkanApp->GetNumFramesInFlight());
+      for (auto& frame : mFrameVertexBuffers)
+         frame.vertexBuffer = std::make_shared<Vk::Buffer>(vulkanApp->GetDevice(), "Im3d vertex buffer");
    }
 
    Im3dRenderer::~Im3dRenderer()
    {
-      mVertexBuffer->UnmapMemory();
+      for (auto& frame : mFrameVertexBuffers)
+         frame.vertexBuffer->UnmapMemory();
    }
 
    SharedPtr<Vk::Buffer> Im3dRenderer::GetVertexBuffer()
    {
-      return mVertexBuffer;
+      return mFrameVertexBuffers[mVulkanApp->GetFrameIndex()].vertexBuffer;
    }
 
    void Im3dRenderer::NewFrame()
@@ -69,21 +71,22 @@ namespace Utopian
       Im3d::AppData& appData = Im3d::GetAppData();
 
       uint32_t totalNumVertices = GetTotalNumVertices();
+      FrameVertexBuffer& frame = mFrameVertexBuffers[mVulkanApp->GetFrameIndex()];
 
-      if ((mVertexBuffer->GetVkHandle() == VK_NULL_HANDLE) || (mVertexCount < totalNumVertices))
+      if ((frame.vertexBuffer->GetVkHandle() == VK_NULL_HANDLE) || (frame.vertexCount < totalNumVertices))
       {
          VkDeviceSize vertexBufferSize = totalNumVertices * sizeof(Im3d::VertexData);
 
-         mVertexBuffer->UnmapMemory();
-         mVulkanApp->GetDevice()->QueueDestroy(mVertexBuffer);
-         mVertexBuffer = std::make_shared<Vk::Buffer>(mVulkanApp->GetDevice(), "Im3d vertex buffer");
+         frame.vertexBuffer->UnmapMemory();
+         mVulkanApp->GetDevice()->QueueDestroy(frame.vertexBuffer);
+         frame.vertexBuffer = std::make_shared<Vk::Buffer>(mVulkanApp->GetDevice(), "Im3d vertex buffer");
 
-         mVertexBuffer->Create(mVulkanApp->GetDevice(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, vertexBufferSize);
-         mVertexCount = totalNumVertices;
-         mVertexBuffer->MapMemory((void**)&mMappedVertices);
+         frame.vertexBuffer->Create(mVulkanApp->GetDevice(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, vertexBufferSize);
+         frame.vertexCount = totalNumVertices;
+         frame.vertexBuffer->MapMemory((void**)&frame.mappedVertices);
       }
 
-      Im3d::VertexData* vertexDst = mMappedVertices;
+      Im3d::VertexData* vertexDst = frame.mappedVertices;
 
       for (uint32_t i = 0; i < Im3d::GetDrawListCount(); i++)
       {
@@ -1,4 +1,5 @@
 #pragma once
+#include <vector>
 #include "vulkan/VulkanPrerequisites.h"
 #include "im3d/im3d.h"
 #include "vulkan/ShaderBuffer.h"
@@ -19,14 +20,21 @@ namespace Utopian
       /** Uploads the Im3d generated vertex buffer to the GPU. Actual rendering is done in Im3dJob. */
       void UploadVertexData();
 
+      /** Returns the vertex buffer of the current frame. */
       SharedPtr<Vk::Buffer> GetVertexBuffer();
    private:
       uint32_t GetTotalNumVertices();
    private:
+      /** Rewritten every frame so each frame in flight has its own. */
+      struct FrameVertexBuffer
+      {
+         SharedPtr<Vk::Buffer> vertexBuffer; // Contains all vertices created by Im3d, when rendering offsets are used in this buffer.
+         Im3d::VertexData* mappedVertices = nullptr;
+         uint32_t vertexCount = 0;
+      };
+
       Vk::VulkanApp* mVulkanApp;
-      Im3d::VertexData* mMappedVertices;
       glm::vec2 mViewportSize;
-      SharedPtr<Vk::Buffer> mVertexBuffer; // Contains all vertices created by Im3d, when rendering offsets are used in this buffer.
-      uint32_t mVertexCount;
+      std::vector<FrameVertexBuffer> mFrameVertexBuffers;
    };
 }
@@ -37,8 +37,12 @@ namespace Utopian
    ImGuiRenderer::ImGuiRenderer(Vk::VulkanApp* vulkanApp, uint32_t width, uint32_t height)
       : mVulkanApp(vulkanApp)
    {
-      mVertexBuffer = std::make_shared<Vk::Buffer>(vulkanApp->GetDevice(), "ImGui vertex buffer");
-      mIndexBuffer = std::make_shared<Vk::Buffer>(vulkanApp->GetDevice(), "ImGui index buffer");
+      mFrames.resize(vulkanApp->GetNumFramesInFlight());
+      for (auto& frame : mFrames)
+      {
+         frame.vertexBuffer = std::make_shared<Vk::Buffer>(vulkanApp->GetDevice(), "ImGui vertex buffer");
+         frame.indexBuffer = std::make_shared<Vk::Buffer>(vulkanApp->GetDevice(), "ImGui index buffer");
+      }
 
       ImGui::CreateContext();
 
@@ -116,31 +120,42 @@ namespace Utopian
 
       io.Fonts->TexID = (ImTextureID)AddImage(mTexture->GetImage());
 
-      mCommandBuffer = std::make_shared<Vk::CommandBuffer>(mVulkanApp->GetDevice(), VK_COMMAND_BUFFER_LEVEL_SECONDARY);
-      mCommandBuffer->SetActive(false); // Enable the command buffer when something is recorded to it (not the first frame)
+      for (uint32_t frameIndex = 0; frameIndex < mFrames.size(); frameIndex++)
+      {
+         SharedPtr<Vk::CommandBuffer>& commandBuffer = mFrames[frameIndex].commandBuffer;
+         commandBuffer = std::make_shared<Vk::CommandBuffer>(mVulkanApp->GetDevice(), VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+         commandBuffer->SetActive(false); // Enable the command buffer when something is recorded to it (not the first frame)
+
+         mVulkanApp->AddSecondaryCommandBuffer(commandBuffer.get(), frameIndex);
+      }
+   }
 
-      mVulkanApp->AddSecondaryCommandBuffer(mCommandBuffer.get());
+   ImGuiRenderer::FrameResources& ImGuiRenderer::GetCurrentFrame()
+   {
+      return mFrames[mVulkanApp->GetFrameIndex()];
    }
 
    void ImGuiRenderer::UpdateCommandBuffers()
    {
       ImGuiIO& io = ImGui::GetIO();
+      FrameResources& frame = GetCurrentFrame();
+      Vk::CommandBuffer* commandBuffer = frame.commandBuffer.get();
 
-      mCommandBuffer->Begin(mVulkanApp->GetRenderPass(), mVulkanApp->GetCurrentFrameBuffer());
+      commandBuffer->Begin(mVulkanApp->GetRenderPass(), mVulkanApp->GetCurrentFrameBuffer());
 
-      mCommandBuffer->CmdSetViewPort(ImGui::GetIO().DisplaySize.x, ImGui::GetIO().DisplaySize.y);
-      mCommandBuffer->CmdSetScissor((uint32_t)ImGui::GetIO().DisplaySize.x, (uint32_t)ImGui::GetIO().DisplaySize.y);
+      commandBuffer->CmdSetViewPort(ImGui::GetIO().DisplaySize.x, ImGui::GetIO().DisplaySize.y);
+      commandBuffer->CmdSetScissor((uint32_t)ImGui::GetIO().DisplaySize.x, (uint32_t)ImGui::GetIO().DisplaySize.y);
 
-      mCommandBuffer->CmdBindPipeline(mImguiEffect->GetPipeline());
+      commandBuffer->CmdBindPipeline(mImguiEffect->GetPipeline());
 
-      mCommandBuffer->CmdBindVertexBuffer(0, 1, mVertexBuffer.get());
-      mCommandBuffer->CmdBindIndexBuffer(mIndexBuffer->GetVkHandle(), 0, VK_INDEX_TYPE_UINT16);
+      commandBuffer->CmdBindVertexBuffer(0, 1, frame.vertexBuffer.get());
+      commandBuffer->CmdBindIndexBuffer(frame.indexBuffer->GetVkHandle(), 0, VK_INDEX_TYPE_UINT16);
 
       // UI scale and translate via push constants
       PushConstantBlock pushConstBlock;
       pushConstBlock.scale = glm::vec2(2.0f / io.DisplaySize.x, 2.0f / io.DisplaySize.y);
       pushConstBlock.translate = glm::vec2(-1.0f);
-      mCommandBuffer->CmdPushConstants(mImguiEffect->GetPipelineInterface(), VK_SHADER_STAGE_ALL, sizeof(pushConstBlock), &pushConstBlock);
+      commandBuffer->CmdPushConstants(mImguiEffect->GetPipelineInterface(), VK_SHADER_STAGE_ALL, sizeof(pushConstBlock), &pushConstBlock);
 
       // Render commands
       ImDrawData* imDrawData = ImGui::GetDrawData();
@@ -155,25 +170,23 @@ namespace Utopian
                scissorRect.offset.y = std::max((int32_t)(pcmd->ClipRect.y), 0);
                scissorRect.extent.width = (uint32_t)(pcmd->ClipRect.z - pcmd->ClipRect.x);
                scissorRect.extent.height = (uint32_t)(pcmd->ClipRect.w - pcmd->ClipRect.y);
-               mCommandBuffer->CmdSetScissor(scissorRect);
+               commandBuffer->CmdSetScissor(scissorRect);
 
                VkDescriptorSet desc_set[1] = { (VkDescriptorSet)pcmd->TextureId };
-               vkCmdBindDescriptorSets(mCommandBuffer->GetVkHandle(), VK_PIPELINE_BIND_POINT_GRAPHICS, mImguiEffect->GetPipelineInterface()->GetPipelineLayout(), 0, 1, desc_set, 0, NULL);
+               commandBuffer->CmdBindDescriptorSet(mImguiEffect->GetPipelineInterface(), 1, desc_set, VK_PIPELINE_BIND_POINT_GRAPHICS);
 
-               mCommandBuffer->CmdDrawIndexed(pcmd->ElemCount, 1, indexOffset, vertexOffset, 0);
+               commandBuffer->CmdDrawIndexed(pcmd->ElemCount, 1, indexOffset, vertexOffset, 0);
                indexOffset += pcmd->ElemCount;
          }
          vertexOffset += cmd_list->VtxBuffer.Size;
       }
 
-      mCommandBuffer->End();
+      commandBuffer->End();
 
       // A hack to disable the command buffer until something have been recorded to it
-      static bool firstCall = true;
-      if (firstCall)
+      if (!commandBuffer->IsActive() && mImguiVisible)
       {
-         mCommandBuffer->SetActive(true);
-         firstCall = false;
+         commandBuffer->SetActive(true);
       }
    }
 
@@ -192,32 +205,34 @@ namespace Utopian
       if (vertexBufferSize == 0u || indexBufferSize == 0u)
          return;
 
+      FrameResources& frame = GetCurrentFrame();
+
       // Update buffers only if vertex or index count has been changed compared to current buffer size
 
       // Vertex buffer
-      if ((mVertexBuffer->GetVkHandle() == VK_NULL_HANDLE) || (mVertexCount != imDrawData->TotalVtxCount)) {
-         mVertexBuffer->UnmapMemory();
-         mVertexBuffer->Destroy();
-         mVertexBuffer->Create(mVulkanApp->GetDevice(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, vertexBufferSize);
-         mVertexCount = imDrawData->TotalVtxCount;
-         mVertexBuffer->MapMemory((void**)&mMappedVertices);
+      if ((frame.vertexBuffer->GetVkHandle() == VK_NULL_HANDLE) || (frame.vertexCount != imDrawData->TotalVtxCount)) {
+         frame.vertexBuffer->UnmapMemory();
+         frame.vertexBuffer->Destroy();
+         frame.vertexBuffer->Create(mVulkanApp->GetDevice(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, vertexBufferSize);
+         frame.vertexCount = imDrawData->TotalVtxCount;
+         frame.vertexBuffer->MapMemory((void**)&frame.mappedVertices);
          updateCmdBuffers = true;
       }
 
       // Index buffer
       VkDeviceSize indexSize = imDrawData->TotalIdxCount * sizeof(ImDrawIdx);
-      if ((mIndexBuffer->GetVkHandle() == VK_NULL_HANDLE) || (mIndexCount < imDrawData->TotalIdxCount)) {
-         mIndexBuffer->UnmapMemory();
-         mIndexBuffer->Destroy();
-         mIndexBuffer->Create(mVulkanApp->GetDevice(), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, indexBufferSize);
-         mIndexCount = imDrawData->TotalIdxCount;
-         mIndexBuffer->MapMemory((void**)&mMappedIndices);
+      if ((frame.indexBuffer->GetVkHandle() == VK_NULL_HANDLE) || (frame.indexCount < imDrawData->TotalIdxCount)) {
+         frame.indexBuffer->UnmapMemory();
+         frame.indexBuffer->Destroy();
+         frame.indexBuffer->Create(mVulkanApp->GetDevice(), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, indexBufferSize);
+         frame.indexCount = imDrawData->TotalIdxCount;
+         frame.indexBuffer->MapMemory((void**)&frame.mappedIndices);
          updateCmdBuffers = true;
       }
 
       // Upload data
-      ImDrawVert* vtxDst = (ImDrawVert*)mMappedVertices;
-      ImDrawIdx* idxDst = (ImDrawIdx*)mMappedIndices;
+      ImDrawVert* vtxDst = (ImDrawVert*)frame.mappedVertices;
+      ImDrawIdx* idxDst = (ImDrawIdx*)frame.mappedIndices;
 
       for (int n = 0; n < imDrawData->CmdListsCount; n++) {
          const ImDrawList* cmd_list = imDrawData->CmdLists[n];
@@ -268,7 +283,7 @@ namespace Utopian
    void ImGuiRenderer::FreeTexture(ImTextureID textureId)
    {
       VkDescriptorSet descriptorSet = (VkDescriptorSet)textureId;
-      mTextureDescriptorsToFree.push_back(descriptorSet);
+      GetCurrentFrame().textureDescriptorsToFree.push_back(descriptorSet);
    }
 
    void ImGuiRenderer::NewFrame()
@@ -382,7 +397,7 @@ namespace Utopian
 
    Utopian::Vk::CommandBuffer* ImGuiRenderer::GetCommandBuffer() const
    {
-      return mCommandBuffer.get();
+      return mFrames[mVulkanApp->GetFrameIndex()].commandBuffer.get();
    }
 
    void ImGuiRenderer::TextV(const char* format, ...)
@@ -412,13 +427,17 @@ namespace Utopian
    void ImGuiRenderer::ToggleVisible()
    {
       mImguiVisible = !mImguiVisible;
-      mCommandBuffer->SetActive(mImguiVisible);
+
+      for (auto& frame : mFrames)
+         frame.commandBuffer->SetActive(mImguiVisible);
    }
 
    void ImGuiRenderer::SetVisible(bool visible)
    {
       mImguiVisible = visible;
-      mCommandBuffer->SetActive(mImguiVisible);
+
+      for (auto& frame : mFrames)
+         frame.commandBuffer->SetActive(mImguiVisible);
    }
 
    bool ImGuiRenderer::IsMouseInsideUi()
@@ -449,10 +468,11 @@ namespace Utopian
    void ImGuiRenderer::GarbageCollect()
    {
       // Clear garbage collected textures
-      if (mTextureDescriptorsToFree.size() > 0)
+      std::vector<VkDescriptorSet>& textureDescriptorsToFree = GetCurrentFrame().textureDescriptorsToFree;
+      if (textureDescriptorsToFree.size() > 0)
       {
-         vkFreeDescriptorSets(mVulkanApp->GetDevice()->GetVkDevice(), mTextureDescriptorPool->GetVkHandle(), (uint32_t)mTextureDescriptorsToFree.size(), mTextureDescriptorsToFree.data());
-         mTextureDescriptorsToFree.clear();
+         vkFreeDescriptorSets(mVulkanApp->GetDevice()->GetVkDevice(), mTextureDescriptorPool->GetVkHandle(), (uint32_t)textureDescriptorsToFree.size(), textureDescriptorsToFree.data());
+         textureDescriptorsToFree.clear();
       }
    }
 
@@ -58,7 +58,7 @@ namespace Utopian
       static UiMode GetMode();
       static void SetMode(UiMode mode);
 
-      // Frees UI textures.
+      // Frees UI textures that were released during the last use of the current frame slot.
       // Needs to be called when the textures are not in an active command buffer
       void GarbageCollect();
 
@@ -75,25 +75,31 @@ namespace Utopian
          glm::vec2 translate;
       } pushConstBlock;
 
+      /** The buffers are rewritten every frame so each frame in flight has its own. */
+      struct FrameResources
+      {
+         SharedPtr<Vk::CommandBuffer> commandBuffer;
+         SharedPtr<Vk::Buffer> vertexBuffer;
+         SharedPtr<Vk::Buffer> indexBuffer;
+         ImDrawVert* mappedVertices = nullptr;
+         ImDrawIdx* mappedIndices = nullptr;
+         int32_t vertexCount = 0;
+         int32_t indexCount = 0;
+         std::vector<VkDescriptorSet> textureDescriptorsToFree;
+      };
+
+      FrameResources& GetCurrentFrame();
+
       Vk::VulkanApp* mVulkanApp;
-      SharedPtr<Vk::CommandBuffer> mCommandBuffer;
-      SharedPtr<Vk::Buffer> mVertexBuffer;
-      SharedPtr<Vk::Buffer> mIndexBuffer;
+      std::vector<FrameResources> mFrames;
       SharedPtr<Vk::Effect> mImguiEffect;
       SharedPtr<Vk::DescriptorPool> mTextureDescriptorPool;
       SharedPtr<Vk::VertexDescription> mVertexDescription;
       SharedPtr<Vk::Sampler> mSampler;
       SharedPtr<Vk::Texture> mTexture;
 
-      ImDrawVert* mMappedVertices;
-      ImDrawIdx* mMappedIndices;
-
-      int32_t mVertexCount = 0;
-      int32_t mIndexCount = 0;
-
       float mScale = 1.0f;
       Timestamp mLastFrameTime;
-      std::vector<VkDescriptorSet> mTextureDescriptorsToFree;
       static bool mImguiVisible;
       static UiMode mUiMode;
    };
@@ -1,9 +1,13 @@
 #include <string>
 #include <fstream>
+#include <algorithm>
+#include <numeric>
 #include "core/renderer/InstancingManager.h"
 #include "core/renderer/SceneInfo.h"
 #include "core/renderer/Renderer.h"
 #include "core/AssetLoader.h"
+#include "core/renderer/Model.h"
+#include "core/renderer/BakedAnimation.h"
 #include "vulkan/handles/Device.h"
 #include "utility/math/Helpers.h"
 
@@ -134,10 +138,13 @@ namespace Utopian
       mInstanceBuffer = nullptr;
       mAnimated = animated;
       mCastShadows = castShadows;
+      mBoundsMin = glm::vec3(0.0f);
+      mBoundsMax = glm::vec3(0.0f);
+      mNumVisibleInstances.fill(0u);
 
-      mModel = gAssetLoader().LoadAsset(assetId);
-
-      assert(mModel);
+      mModel = nullptr;
+      // The instanced models are static so they can use the compact vertex layout
+      mPendingModel = gAssetLoader().LoadAssetAsync(assetId, Vk::VERTEX_LAYOUT_COMPACT);
    }
 
    InstanceGroup::~InstanceGroup()
@@ -156,6 +163,10 @@ namespace Utopian
       InstanceDataGPU instanceData;
       instanceData.world = world;
 
+      // Instances of skinned models should not move in sync, the phase only depends on the position
+      // so that it is the same after the instances are saved and loaded again
+      instanceData.animationPhase = glm::fract(glm::sin(glm::dot(position, glm::vec3(12.9898f, 78.233f, 37.719f))) * 43758.5453f);
+
       mInstances.push_back(instanceData);
       mInstanceData.push_back(InstanceData(position, rotation, scale));
    }
@@ -164,8 +175,16 @@ namespace Utopian
    {
       mInstances.clear();
       mInstanceData.clear();
+      mCells.clear();
+      mNumVisibleInstances.fill(0u);
 
       gRenderer().GetDevice()->QueueDestroy(mInstanceBuffer);
+
+      for (auto& frameBuffers : mVisibleInstanceBuffers)
+      {
+         for (auto& visibleBuffer : frameBuffers)
+            gRenderer().GetDevice()->QueueDestroy(visibleBuffer);
+      }
    }
 
    void InstanceGroup::RemoveInstancesWithinRadius(glm::vec3 position, float radius)
@@ -201,6 +220,12 @@ namespace Utopian
 
    void InstanceGroup::BuildBuffer(Vk::Device* device)
    {
+      // The cells need the model bounds, the buffers are built by UpdatePendingModel() instead
+      if (mModel == nullptr)
+         return;
+
+      BuildCells();
+
       // Todo: use device local buffer for better performance
       // Note: Recreating the buffer every time since if the size has increased just
       // mapping and updating the memory is not enough.
@@ -215,15 +240,149 @@ namespace Utopian
          createInfo.size = mInstances.size() * sizeof(InstanceDataGPU);
          createInfo.name = "ScreenQuad vertex buffer";
          mInstanceBuffer = std::make_shared<Vk::Buffer>(createInfo, device);
+
+         // One buffer per view and frame in flight that the visible instances are compacted into every frame
+         mVisibleInstanceBuffers.resize(device->GetNumFramesInFlight());
+         for (auto& frameBuffers : mVisibleInstanceBuffers)
+         {
+            for (uint32_t viewIndex = 0; viewIndex < INSTANCE_VIEW_COUNT; viewIndex++)
+            {
+               gRenderer().GetDevice()->QueueDestroy(frameBuffers[viewIndex]);
+
+               createInfo.data = nullptr;
+               createInfo.name = "Visible instances buffer";
+               frameBuffers[viewIndex] = std::make_shared<Vk::Buffer>(createInfo, device);
+               mNumVisibleInstances[viewIndex] = 0u;
+            }
+         }
       }
    }
 
-   void InstanceGroup::UpdateAltitudes(const SharedPtr<Terrain>& terrain)
+   void InstanceGroup::UpdatePendingModel()
+   {
+      if (mPendingModel.valid() && mPendingModel.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+      {
+         mModel = mPendingModel.get();
+         mPendingModel = std::shared_future<SharedPtr<Model>>();
+
+         // The instances of skinned models share the baked joint matrices instead of a SkinAnimator each
+         if (mModel != nullptr && mModel->IsAnimated())
+            mBakedAnimation = BakedAnimation::Create(gRenderer().GetDevice(), mModel.get());
+
+         BuildBuffer(gRenderer().GetDevice());
+      }
+   }
+
+   void InstanceGroup::BuildCells()
    {
+      mCells.clear();
+      mBoundsMin = glm::vec3(0.0f);
+      mBoundsMax = glm::vec3(0.0f);
+
+      if (mInstances.empty())
+         return;
+
+      auto cellCoord = [](const glm::mat4& world) {
+         glm::vec3 position = Math::GetTranslation(world);
+         return glm::ivec2(glm::floor(glm::vec2(position.x, position.z) / INSTANCE_CELL_SIZE));
+      };
+
+      // Sort the instances by grid cell so that each cell becomes a contiguous range
+      std::vector<uint32_t> order(mInstances.size());
+      std::iota(order.begin(), order.end(), 0u);
+      std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+         glm::ivec2 cellA = cellCoord(mInstances[a].world);
+         glm::ivec2 cellB = cellCoord(mInstances[b].world);
+         return cellA.x < cellB.x || (cellA.x == cellB.x && cellA.y < cellB.y);
+      });
+
+      std::vector<InstanceDataGPU> sortedInstances;
+      std::vector<InstanceData> sortedInstanceData;
+      sortedInstances.reserve(mInstances.size());
+      sortedInstanceData.reserve(mInstanceData.size());
+      for (uint32_t index : order)
+      {
+         sortedInstances.push_back(mInstances[index]);
+         sortedInstanceData.push_back(mInstanceData[index]);
+      }
+
+      mInstances = std::move(sortedInstances);
+      mInstanceData = std::move(sortedInstanceData);
+
+      // The model bounding box is in physical space and the instance matrices in render space
+      const BoundingBox& modelBox = mModel->GetBoundingBox();
+      glm::vec3 localMin = -modelBox.GetMax();
+      glm::vec3 localMax = -modelBox.GetMin();
+
+      mBoundsMin = glm::vec3(FLT_MAX);
+      mBoundsMax = glm::vec3(-FLT_MAX);
+
+      glm::ivec2 currentCoord = cellCoord(mInstances[0].world);
+      InstanceCell cell = { glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX), 0u, 0u };
+
       for (uint32_t i = 0; i < mInstances.size(); i++)
+      {
+         glm::ivec2 coord = cellCoord(mInstances[i].world);
+         if (coord != currentCoord)
+         {
+            mCells.push_back(cell);
+            cell = { glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX), i, 0u };
+            currentCoord = coord;
+         }
+
+         glm::vec3 min, max;
+         Math::TransformAabb(mInstances[i].world, localMin, localMax, min, max);
+         cell.min = glm::min(cell.min, min);
+         cell.max = glm::max(cell.max, max);
+         cell.numInstances++;
+
+         mBoundsMin = glm::min(mBoundsMin, min);
+         mBoundsMax = glm::max(mBoundsMax, max);
+      }
+
+      mCells.push_back(cell);
+   }
+
+   uint32_t InstanceGroup::CullInstances(uint32_t viewIndex, const Frustum& frustum, bool checkDepth)
+   {
+      Vk::Buffer* visibleBuffer = GetVisibleBuffer(viewIndex);
+      if (visibleBuffer == nullptr)
+         return 0u;
+
+      InstanceDataGPU* mapped;
+      visibleBuffer->MapMemory((void**)&mapped);
+
+      uint32_t numVisible = 0u;
+      for (const InstanceCell& cell : mCells)
+      {
+         if (frustum.CheckBox(cell.min, cell.max, checkDepth))
+         {
+            memcpy(mapped + numVisible, &mInstances[cell.firstInstance], cell.numInstances * sizeof(InstanceDataGPU));
+            numVisible += cell.numInstances;
+         }
+      }
+
+      visibleBuffer->UnmapMemory();
+
+      mNumVisibleInstances[viewIndex] = numVisible;
+
+      return numVisible;
+   }
+
+   void InstanceGroup::UpdateAltitudes(const SharedPtr<Terrain>& terrain)
+   {
+      const uint32_t numInstances = (uint32_t)mInstances.size();
+      std::vector<glm::vec2> positions(numInstances);
+      std::vector<float> heights(numInstances);
+      for (uint32_t i = 0; i < numInstances; i++)
+         positions[i] = glm::vec2(-mInstanceData[i].position.x, -mInstanceData[i].position.z);
+
+      terrain->GetHeights(positions.data(), heights.data(), numInstances);
+
+      for (uint32_t i = 0; i < numInstances; i++)
       {
          glm::vec3 translation = mInstanceData[i].position;
-         translation.y = -terrain->GetHeight(-translation.x, -translation.z);
+         translation.y = -heights[i];
          mInstances[i].world = Math::SetTranslation(mInstances[i].world, translation);
          mInstanceData[i].position = translation;
       }
@@ -259,6 +418,11 @@ namespace Utopian
       return mModel.get();
    }
 
+   BakedAnimation* InstanceGroup::GetBakedAnimation()
+   {
+      return mBakedAnimation.get();
+   }
+
    bool InstanceGroup::IsAnimated()
    {
       return mAnimated;
@@ -268,4 +432,32 @@ namespace Utopian
    {
       return mCastShadows;
    }
+
+   const glm::vec3& InstanceGroup::GetBoundsMin() const
+   {
+      return mBoundsMin;
+   }
+
+   const glm::vec3& InstanceGroup::GetBoundsMax() const
+   {
+      return mBoundsMax;
+   }
+
+   Vk::Buffer* InstanceGroup::GetVisibleBuffer(uint32_t viewIndex)
+   {
+      if (mVisibleInstanceBuffers.empty())
+         return nullptr;
+
+      return mVisibleInstanceBuffers[gRenderer().GetDevice()->GetFrameIndex()][viewIndex].get();
+   }
+
+   uint32_t InstanceGroup::GetNumVisibleInstances(uint32_t viewIndex) const
+   {
+      return mNumVisibleInstances[viewIndex];
+   }
+
+   uint32_t InstanceGroup::GetNumCells() const
+   {
+      return (uint32_t)mCells.size();
+   }
 }
@@ -0,0 +1,131 @@
+#include <algorithm>
+#include <cassert>
+#include <string>
+#include "core/renderer/JointPalette.h"
+#include "core/Log.h"
+#include "vulkan/handles/Device.h"
+#include "vulkan/handles/Buffer.h"
+
+namespace Utopian
+{
+   JointPalette& gJointPalette()
+   {
+      return JointPalette::Instance();
+   }
+
+   JointPalette::JointPalette(Vk::Device* device)
+   {
+      mUsedSize = 0;
+      mNumAllocatedJoints = 0u;
+      mAlignment = std::max(device->GetProperties().limits.minStorageBufferOffsetAlignment, (VkDeviceSize)sizeof(glm::mat4));
+
+      Vk::BUFFER_CREATE_INFO createInfo;
+      createInfo.usageFlags = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+      createInfo.memoryPropertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+      createInfo.data = nullptr;
+      createInfo.size = JOINT_PALETTE_CAPACITY * sizeof(glm::mat4);
+
+      for (uint32_t i = 0; i < device->GetNumFramesInFlight(); i++)
+      {
+         createInfo.name = "Joint palette frame " + std::to_string(i);
+         SharedPtr<Vk::Buffer> buffer = std::make_shared<Vk::Buffer>(createInfo, device);
+
+         uint8_t* mapped;
+         buffer->MapMemory((void**)&mapped);
+
+         mFrameBuffers.push_back(buffer);
+         mMappedMemory.push_back(mapped);
+      }
+   }
+
+   JointPalette::~JointPalette()
+   {
+      for (auto& buffer : mFrameBuffers)
+         buffer->UnmapMemory();
+   }
+
+   JointPalette::Allocation JointPalette::Allocate(uint32_t numJoints)
+   {
+      Allocation allocation;
+
+      if (numJoints == 0)
+         return allocation;
+
+      VkDeviceSize size = numJoints * sizeof(glm::mat4);
+      VkDeviceSize alignedSize = (size + mAlignment - 1) & ~(mAlignment - 1);
+      uint32_t alignedJoints = (uint32_t)(alignedSize / sizeof(glm::mat4));
+
+      std::lock_guard<std::mutex> lock(mMutex);
+
+      std::vector<Allocation>& freeAllocations = mFreeAllocations[alignedJoints];
+      if (!freeAllocations.empty())
+      {
+         allocation = freeAllocations.back();
+         freeAllocations.pop_back();
+      }
+      else
+      {
+         if (mUsedSize + alignedSize > JOINT_PALETTE_CAPACITY * sizeof(glm::mat4))
+         {
+            UTO_LOG("Joint palette is full, increase JOINT_PALETTE_CAPACITY");
+            return allocation;
+         }
+
+         allocation.offset = mUsedSize;
+         mUsedSize += alignedSize;
+      }
+
+      allocation.numJoints = alignedJoints;
+      mNumAllocatedJoints += alignedJoints;
+
+      return allocation;
+   }
+
+   void JointPalette::Free(Allocation& allocation)
+   {
+      if (!allocation.IsValid())
+         return;
+
+      std::lock_guard<std::mutex> lock(mMutex);
+
+      // Frames in flight only read the ranges of their own slot, which the next owner does not
+      // write until the slot is recorded again, see SkinAnimator::RefreshStaleFrames()
+      mFreeAllocations[allocation.numJoints].push_back(allocation);
+      mNumAllocatedJoints -= allocation.numJoints;
+
+      allocation = Allocation();
+   }
+
+   glm::mat4* JointPalette::GetMappedMemory(const Allocation& allocation, uint32_t frameIndex) const
+   {
+      assert(allocation.IsValid() && frameIndex < mMappedMemory.size());
+
+      std::lock_guard<std::mutex> lock(mMutex);
+
+      return (glm::mat4*)(mMappedMemory[frameIndex] + allocation.offset);
+   }
+
+   VkDescriptorBufferInfo JointPalette::GetDescriptor(const Allocation& allocation, uint32_t frameIndex) const
+   {
+      assert(allocation.IsValid() && frameIndex < mFrameBuffers.size());
+
+      VkDescriptorBufferInfo descriptor;
+      descriptor.buffer = mFrameBuffers[frameIndex]->GetVkHandle();
+      descriptor.offset = allocation.offset;
+      descriptor.range = allocation.numJoints * sizeof(glm::mat4);
+
+      return descriptor;
+   }
+
+   uint32_t JointPalette::GetNumFrames() const
+   {
+      return (uint32_t)mFrameBuffers.size();
+   }
+
+   uint32_t JointPalette::GetNumAllocatedJoints() const
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+
+      return mNumAllocatedJoints;
+   }
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <vector>
+#include <glm/glm.hpp>
+#include "vulkan/VulkanPrerequisites.h"
+#include "utility/Module.h"
+#include "utility/Common.h"
+
+// Maximum number of joint matrices of all skins together
+#define JOINT_PALETTE_CAPACITY (64 * 1024)
+
+namespace Utopian
+{
+   /**
+    * Joint matrices of all skins in one persistently mapped storage buffer per frame in flight.
+    * Every skin allocates a range that has the same offset in all of the buffers, the palette of
+    * the frame slot that the CPU is recording is written directly to the mapped memory.
+    * This replaces one host visible buffer per skin that was written while the GPU could read it.
+    */
+   class JointPalette : public Module<JointPalette>
+   {
+   public:
+      struct Allocation
+      {
+         bool IsValid() const { return numJoints != 0; }
+
+         VkDeviceSize offset = 0;
+         uint32_t numJoints = 0;
+      };
+
+      JointPalette(Vk::Device* device);
+      ~JointPalette();
+
+      /** Returns an invalid allocation if the palette is full. */
+      Allocation Allocate(uint32_t numJoints);
+      void Free(Allocation& allocation);
+
+      /**
+       * Returns the persistently mapped joint matrices of the allocation in the frame slot.
+       * @note Locks the palette, the result is meant to be cached by the owner of the allocation.
+       */
+      glm::mat4* GetMappedMemory(const Allocation& allocation, uint32_t frameIndex) const;
+
+      VkDescriptorBufferInfo GetDescriptor(const Allocation& allocation, uint32_t frameIndex) const;
+
+      uint32_t GetNumFrames() const;
+
+      /** Returns the number of joint matrices in use, including the alignment padding. */
+      uint32_t GetNumAllocatedJoints() const;
+
+   private:
+      std::vector<SharedPtr<Vk::Buffer>> mFrameBuffers;
+      std::vector<uint8_t*> mMappedMemory;
+
+      // Freed ranges are reused by skins with the same aligned number of joints
+      std::map<uint32_t, std::vector<Allocation>> mFreeAllocations;
+      VkDeviceSize mUsedSize;
+      VkDeviceSize mAlignment;
+      uint32_t mNumAllocatedJoints;
+
+      // Skinned models can be loaded by the asset loading threads
+      mutable std::mutex mMutex;
+   };
+
+   JointPalette& gJointPalette();
+}
@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <atomic>
 #include <glm/gtc/type_ptr.hpp>
 #include <vulkan/vulkan_core.h>
 #include "core/Log.h"
@@ -36,21 +37,67 @@ namespace Utopian
       properties->data.occlusionFactor = 1.0f;
    }
 
+   void Material::CreateDescriptorSets(Vk::Device* device, Vk::DescriptorSetLayout* setLayout, Vk::DescriptorPool* pool)
+   {
+      descriptorSets.resize(device->GetNumFramesInFlight());
+
+      for (auto& descriptorSet : descriptorSets)
+         descriptorSet = std::make_shared<Vk::DescriptorSet>(device, setLayout, pool);
+   }
+
    void Material::UpdateTextureDescriptors(Vk::Device* device)
    {
-      descriptorSet->BindCombinedImage(0, colorTexture->GetDescriptor());
-      descriptorSet->BindCombinedImage(1, normalTexture->GetDescriptor());
-      descriptorSet->BindCombinedImage(2, specularTexture->GetDescriptor());
-      descriptorSet->BindCombinedImage(3, metallicRoughnessTexture->GetDescriptor());
-      descriptorSet->BindCombinedImage(4, occlusionTexture->GetDescriptor());
-      descriptorSet->BindUniformBuffer(20, properties->GetDescriptor());
+      for (uint32_t frameIndex = 0; frameIndex < descriptorSets.size(); frameIndex++)
+      {
+         const SharedPtr<Vk::DescriptorSet>& descriptorSet = descriptorSets[frameIndex];
+         descriptorSet->BindCombinedImage(0, colorTexture->GetDescriptor());
+         descriptorSet->BindCombinedImage(1, normalTexture->GetDescriptor());
+         descriptorSet->BindCombinedImage(2, specularTexture->GetDescriptor());
+         descriptorSet->BindCombinedImage(3, metallicRoughnessTexture->GetDescriptor());
+         descriptorSet->BindCombinedImage(4, occlusionTexture->GetDescriptor());
+         descriptorSet->BindUniformBuffer(20, properties->GetDescriptor());
+
+         // Asynchronously loaded textures update the set again when their image is ready
+         colorTexture->AddDependentDescriptorSet(descriptorSet, frameIndex);
+         normalTexture->AddDependentDescriptorSet(descriptorSet, frameIndex);
+         specularTexture->AddDependentDescriptorSet(descriptorSet, frameIndex);
+         metallicRoughnessTexture->AddDependentDescriptorSet(descriptorSet, frameIndex);
+         occlusionTexture->AddDependentDescriptorSet(descriptorSet, frameIndex);
+
+         device->QueueDescriptorUpdate(descriptorSet, frameIndex);
+      }
+   }
+
+   VkDescriptorSet Material::GetDescriptorSet(uint32_t frameIndex) const
+   {
+      return descriptorSets[frameIndex]->GetVkHandle();
+   }
 
-      device->QueueDescriptorUpdate(descriptorSet.get());
+   VkDescriptorSet RenderCommand::GetSkinDescriptorSet(uint32_t frameIndex) const
+   {
+      if (skinAnimator == nullptr)
+         return VK_NULL_HANDLE;
+
+      return skinAnimator->GetJointMatricesDescriptorSet(skin, frameIndex);
    }
 
-   Model::Model()
+   void Material::MarkTexturesUsed(uint64_t frameNumber)
    {
+      Vk::Texture* textures[] = { colorTexture.get(), normalTexture.get(), specularTexture.get(),
+                                  metallicRoughnessTexture.get(), occlusionTexture.get() };
+
+      for (Vk::Texture* texture : textures)
+      {
+         if (texture != nullptr)
+            texture->SetLastUsedFrame(frameNumber);
+      }
+   }
 
+   Model::Model()
+   {
+      // Models are created by the loader tasks
+      static std::atomic<uint32_t> nextAnimationPhase(0u);
+      mAnimationPhase = nextAnimationPhase++;
    }
 
    Model::~Model()
@@ -59,26 +106,42 @@ namespace Utopian
 
    void Model::Init()
    {
+      bool hasBounds = false;
       for (auto& node : mRootNodes)
       {
-         mBoundingBox = CalculateBoundingBox(node, glm::mat4());
+         CalculateBoundingBox(node, glm::mat4(), mBoundingBox, hasBounds);
       }
    }
 
-   BoundingBox Model::CalculateBoundingBox(Node* node, glm::mat4 world)
+   void Model::CalculateBoundingBox(Node* node, glm::mat4 world, BoundingBox& boundingBox, bool& hasBounds)
    {
       glm::mat4 nodeMatrix = world * node->GetLocalMatrix();
-      BoundingBox bb;
 
-      if (node->mesh.primitives.size() > 0)
-         return node->mesh.primitives[0]->GetBoundingBox();
+      // Primitive bounding boxes are stored in the physical space which is the negated
+      // render space, so the translation of the node matrix needs to be negated as well
+      glm::mat4 physicalMatrix = nodeMatrix;
+      physicalMatrix[3] = glm::vec4(-glm::vec3(nodeMatrix[3]), nodeMatrix[3].w);
 
-      for (auto& child : node->children)
+      for (auto& primitive : node->mesh.primitives)
       {
-         bb = CalculateBoundingBox(child, nodeMatrix);
+         BoundingBox primitiveBox = primitive->GetBoundingBox();
+         primitiveBox.Update(physicalMatrix);
+
+         if (!hasBounds)
+         {
+            boundingBox.Init(primitiveBox.GetMin(), primitiveBox.GetMax() - primitiveBox.GetMin());
+            hasBounds = true;
+         }
+         else
+         {
+            boundingBox.Merge(primitiveBox);
+         }
       }
 
-      return bb;
+      for (auto& child : node->children)
+      {
+         CalculateBoundingBox(child, nodeMatrix, boundingBox, hasBounds);
+      }
    }
 
    Primitive* Model::AddPrimitive(const Primitive& primitive)
@@ -108,6 +171,7 @@ namespace Utopian
    void Model::AddRootNode(Node* node)
    {
       mRootNodes.push_back(node);
+      mRenderCommandsDirty = true;
    }
 
    void Model::AddSkinAnimator(SharedPtr<SkinAnimator> skinAnimator)
@@ -115,23 +179,33 @@ namespace Utopian
       mSkinAnimator = skinAnimator;
 
       // Calculate initial pose
-      for (auto node : mRootNodes)
-         mSkinAnimator->UpdateJoints(node);
+      mSkinAnimator->UpdateJoints();
+
+      mRenderCommandsDirty = true;
    }
 
    void Model::UpdateAnimation(float deltaTime)
    {
-      // Note: Todo: Updating the animation is very slow and needs to be
-      // improved, see #135.
-      if (IsAnimated())
-      {
-         mSkinAnimator->UpdateAnimation(deltaTime);
+      deltaTime += mSkippedAnimationTime;
+      mSkippedAnimationTime = 0.0f;
 
-         for (auto node : mRootNodes)
-            mSkinAnimator->UpdateJoints(node);
+      if (IsAnimated() && mSkinAnimator->UpdateAnimation(deltaTime))
+      {
+         mSkinAnimator->UpdateJoints();
+         mRenderCommandsDirty = true;
       }
    }
 
+   void Model::SkipAnimationUpdate(float deltaTime)
+   {
+      mSkippedAnimationTime += deltaTime;
+   }
+
+   const std::vector<Node*>& Model::GetRootNodes() const
+   {
+      return mRootNodes;
+   }
+
    Primitive* Model::GetPrimitive(uint32_t index)
    {
       assert(index < mPrimitives.size());
@@ -154,34 +228,50 @@ namespace Utopian
          return nullptr;
    }
 
-   void Model::GetRenderCommands(std::vector<RenderCommand>& renderCommands, glm::mat4 worldMatrix)
+   void Model::UpdateRenderCommands()
    {
+      if (!mRenderCommandsDirty)
+         return;
+
+      // Keeps the capacity so rebuilding an animated model doesn't allocate
+      mRenderCommands.clear();
       for (auto& node : mRootNodes) {
-         AppendRenderCommands(renderCommands, node, worldMatrix);
+         AppendRenderCommands(node, glm::mat4());
       }
+
+      mRenderCommandsDirty = false;
+      mRenderCommandsVersion++;
    }
 
-   void Model::AppendRenderCommands(std::vector<RenderCommand>& renderCommands, Node* node, glm::mat4 worldMatrix)
+   const std::vector<RenderCommand>& Model::GetRenderCommands() const
    {
-      glm::mat4 nodeMatrix = worldMatrix * node->GetLocalMatrix();
+      assert(!mRenderCommandsDirty);
 
-      RenderCommand command;
-      command.world = nodeMatrix;
-      command.skinDescriptorSet = VK_NULL_HANDLE;
+      return mRenderCommands;
+   }
+
+   uint32_t Model::GetRenderCommandsVersion() const
+   {
+      return mRenderCommandsVersion;
+   }
+
+   void Model::AppendRenderCommands(Node* node, const glm::mat4& parentMatrix)
+   {
+      glm::mat4 nodeMatrix = parentMatrix * node->GetLocalMatrix();
 
       if (node->mesh.primitives.size() > 0)
       {
-         if (IsAnimated())
-         {
-            command.skinDescriptorSet = mSkinAnimator->GetJointMatricesDescriptorSet(node->skin);
-         }
+         RenderCommand command;
+         command.world = nodeMatrix;
+         command.skinAnimator = IsAnimated() ? mSkinAnimator.get() : nullptr;
+         command.skin = node->skin;
 
          command.mesh = &node->mesh;
-         renderCommands.push_back(command);
+         mRenderCommands.push_back(command);
       }
 
       for (auto& child : node->children) {
-         AppendRenderCommands(renderCommands, child, nodeMatrix);
+         AppendRenderCommands(child, nodeMatrix);
       }
    }
 
@@ -226,12 +316,23 @@ namespace Utopian
       mFilename = filename;
    }
 
+   uint32_t Model::GetAnimationPhase() const
+   {
+      return mAnimationPhase;
+   }
+
    bool Model::IsAnimated() const
    {
       return (mSkinAnimator != nullptr);
    }
 
-   BoundingBox Model::GetBoundingBox()
+   void Model::MarkTexturesUsed(uint64_t frameNumber)
+   {
+      for (auto& material : mMaterials)
+         material->MarkTexturesUsed(frameNumber);
+   }
+
+   const BoundingBox& Model::GetBoundingBox() const
    {
       return mBoundingBox;
    }
@@ -28,15 +28,29 @@ namespace Utopian
    {
       Material();
 
+      /** Allocates one descriptor set per frame in flight. */
+      void CreateDescriptorSets(Vk::Device* device, Vk::DescriptorSetLayout* setLayout, Vk::DescriptorPool* pool);
+
+      /**
+       * Binds the textures and properties to the descriptor sets.
+       * Each copy is written when its frame slot is recorded next, so the sets of frames that the GPU
+       * is still executing are never modified.
+       */
       void UpdateTextureDescriptors(Vk::Device* device);
 
+      /** Returns the copy of the descriptor set for the frame slot, see Vk::Device::GetFrameIndex(). */
+      VkDescriptorSet GetDescriptorSet(uint32_t frameIndex) const;
+
+      /** Keeps the textures from being evicted by TextureLoader, see Vk::Texture::SetLastUsedFrame(). */
+      void MarkTexturesUsed(uint64_t frameNumber);
+
       SharedPtr<MaterialProperties> properties = nullptr;
       SharedPtr<Vk::Texture> colorTexture;
       SharedPtr<Vk::Texture> normalTexture;
       SharedPtr<Vk::Texture> specularTexture;
       SharedPtr<Vk::Texture> metallicRoughnessTexture;
       SharedPtr<Vk::Texture> occlusionTexture;
-      SharedPtr<Vk::DescriptorSet> descriptorSet;
+      std::vector<SharedPtr<Vk::DescriptorSet>> descriptorSets;
       std::string name = "Material_unknown";
    };
 
@@ -59,8 +73,12 @@ namespace Utopian
 
    struct RenderCommand
    {
+      /** Returns the joint matrices of the frame slot, VK_NULL_HANDLE if the mesh is not skinned. */
+      VkDescriptorSet GetSkinDescriptorSet(uint32_t frameIndex) const;
+
       Mesh* mesh;
-      VkDescriptorSet skinDescriptorSet;
+      SkinAnimator* skinAnimator;
+      int32_t skin;
       glm::mat4 world;
    };
 
@@ -105,27 +123,58 @@ namespace Utopian
 
       Primitive* GetPrimitive(uint32_t index);
       Material* GetMaterial(uint32_t index);
+      const std::vector<Node*>& GetRootNodes() const;
       SkinAnimator* GetAnimator();
 
-      void GetRenderCommands(std::vector<RenderCommand>& renderCommands, glm::mat4 worldMatrix);
-      void AppendRenderCommands(std::vector<RenderCommand>& renderCommands, Node* node, glm::mat4 worldMatrix);
+      /**
+       * Flattens the node hierarchy into the cached render command array if it is dirty.
+       * Must be called from the main thread before any job reads the commands.
+       */
+      void UpdateRenderCommands();
+
+      /** Returns the cached render commands in model space, see UpdateRenderCommands(). */
+      const std::vector<RenderCommand>& GetRenderCommands() const;
+
+      /** Incremented every time the cached render commands are rebuilt. */
+      uint32_t GetRenderCommandsVersion() const;
 
+      /**
+       * Samples the active animation and writes the joint matrices, models can be updated in parallel.
+       * The time of the updates skipped by SkipAnimationUpdate() is added to deltaTime.
+       */
       void UpdateAnimation(float deltaTime);
+
+      /**
+       * Defers the animation time to the next UpdateAnimation(), used to update distant models at a lower rate.
+       * The frame slots keep the last pose, see SkinAnimator::RefreshStaleFrames().
+       */
+      void SkipAnimationUpdate(float deltaTime);
       bool IsAnimated() const;
 
+      /**
+       * Fixed per model and assigned round robin when the model is created, used to spread the reduced
+       * rate animation updates of a crowd over the update interval.
+       */
+      uint32_t GetAnimationPhase() const;
+
+      /** Marks the textures of all materials as used by the frame. */
+      void MarkTexturesUsed(uint64_t frameNumber);
+
       void SetFilename(std::string filename);
 
       // Used by SkinAnimator to the node to animate
       Node* NodeFromIndex(uint32_t index);
       Node* FindNode(Node* parent, uint32_t index);
 
-      BoundingBox GetBoundingBox();
+      const BoundingBox& GetBoundingBox() const;
       uint32_t GetNumPrimitives() const;
       uint32_t GetNumMaterials() const;
 
    private:
-      // Todo: currently only returns the first primitive bounding box
-      BoundingBox CalculateBoundingBox(Node* node, glm::mat4 world);
+      /** Merges the bounding boxes of all primitives in the node hierarchy. */
+      void CalculateBoundingBox(Node* node, glm::mat4 world, BoundingBox& boundingBox, bool& hasBounds);
+
+      void AppendRenderCommands(Node* node, const glm::mat4& parentMatrix);
 
    private:
       std::vector<SharedPtr<Primitive>> mPrimitives;
@@ -135,5 +184,10 @@ namespace Utopian
       SharedPtr<SkinAnimator> mSkinAnimator = nullptr;
       std::string mFilename;
       BoundingBox mBoundingBox;
+      std::vector<RenderCommand> mRenderCommands;
+      uint32_t mRenderCommandsVersion = 0;
+      bool mRenderCommandsDirty = true;
+      float mSkippedAnimationTime = 0.0f;
+      uint32_t mAnimationPhase;
    };
 }
@@ -0,0 +1,108 @@
+#include <algorithm>
+#include "core/renderer/ParallelRecorder.h"
+#include "core/TaskScheduler.h"
+#include "vulkan/FrameCommandPool.h"
+#include "vulkan/handles/Device.h"
+#include "vulkan/handles/CommandBuffer.h"
+
+namespace Utopian
+{
+   ParallelRecorder::ParallelRecorder(Vk::Device* device, uint32_t numThreads)
+   {
+      assert(numThreads > 0);
+
+      mDevice = device;
+      mNumThreads = numThreads;
+
+      mCommandPools.resize(device->GetNumFramesInFlight());
+      mFreeCommandPools.resize(device->GetNumFramesInFlight());
+   }
+
+   ParallelRecorder::~ParallelRecorder()
+   {
+   }
+
+   void ParallelRecorder::ResetCommandPools()
+   {
+      std::lock_guard<std::mutex> lock(mCommandPoolMutex);
+
+      const uint32_t frameIndex = mDevice->GetFrameIndex();
+      assert(mFreeCommandPools[frameIndex].size() == mCommandPools[frameIndex].size());
+
+      for (auto& commandPool : mCommandPools[frameIndex])
+         commandPool->Reset();
+   }
+
+   void ParallelRecorder::ParallelFor(uint32_t count, const std::function<void(uint32_t)>& func)
+   {
+      gTaskScheduler().ParallelFor(count, 1, [&](uint32_t index)
+      {
+         // The pool is restored afterwards since a thread waiting for nested recording can execute this in between
+         Vk::FrameCommandPool* commandPool = AcquireCommandPool();
+         Vk::FrameCommandPool* previousCommandPool = Vk::FrameCommandPool::GetCurrent();
+         Vk::FrameCommandPool::SetCurrent(commandPool);
+
+         func(index);
+
+         Vk::FrameCommandPool::SetCurrent(previousCommandPool);
+         ReleaseCommandPool(commandPool);
+      });
+   }
+
+   void ParallelRecorder::RecordSecondary(Vk::CommandBuffer* primaryCommandBuffer, Vk::RenderPass* renderPass, VkFramebuffer frameBuffer,
+                                          uint32_t width, uint32_t height, uint32_t numItems, const RecordFunction& recordFunction)
+   {
+      uint32_t numChunks = std::min(mNumThreads, std::max(1u, numItems / MIN_ITEMS_PER_SECONDARY));
+      uint32_t itemsPerChunk = (numItems + numChunks - 1) / numChunks;
+      std::vector<VkCommandBuffer> secondaryCommandBuffers(numChunks);
+
+      ParallelFor(numChunks, [&](uint32_t chunk)
+      {
+         Vk::CommandBuffer* commandBuffer = Vk::FrameCommandPool::GetCurrent()->Acquire(VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+         commandBuffer->Begin(renderPass, frameBuffer);
+         commandBuffer->CmdSetViewPort((float)width, (float)height);
+         commandBuffer->CmdSetScissor(width, height);
+
+         uint32_t first = std::min(chunk * itemsPerChunk, numItems);
+         uint32_t last = std::min(first + itemsPerChunk, numItems);
+         recordFunction(commandBuffer, first, last);
+
+         commandBuffer->End();
+         secondaryCommandBuffers[chunk] = commandBuffer->GetVkHandle();
+      });
+
+      // Executing in chunk order keeps the draw order of the list
+      primaryCommandBuffer->CmdExecuteCommands(numChunks, secondaryCommandBuffers.data());
+   }
+
+   uint32_t ParallelRecorder::GetNumThreads() const
+   {
+      return mNumThreads;
+   }
+
+   Vk::FrameCommandPool* ParallelRecorder::AcquireCommandPool()
+   {
+      std::lock_guard<std::mutex> lock(mCommandPoolMutex);
+
+      const uint32_t frameIndex = mDevice->GetFrameIndex();
+      std::vector<Vk::FrameCommandPool*>& freeCommandPools = mFreeCommandPools[frameIndex];
+
+      // Nested recording can need more pools than there are threads so they are created on demand
+      if (freeCommandPools.empty())
+      {
+         mCommandPools[frameIndex].push_back(std::make_shared<Vk::FrameCommandPool>(mDevice));
+         return mCommandPools[frameIndex].back().get();
+      }
+
+      Vk::FrameCommandPool* commandPool = freeCommandPools.back();
+      freeCommandPools.pop_back();
+
+      return commandPool;
+   }
+
+   void ParallelRecorder::ReleaseCommandPool(Vk::FrameCommandPool* commandPool)
+   {
+      std::lock_guard<std::mutex> lock(mCommandPoolMutex);
+      mFreeCommandPools[mDevice->GetFrameIndex()].push_back(commandPool);
+   }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <functional>
+#include "vulkan/VulkanPrerequisites.h"
+#include "utility/Common.h"
+
+namespace Utopian
+{
+   /**
+    * Records command buffers from multiple threads.
+    * Every recording thread has a Vk::FrameCommandPool of its own since a Vulkan
+    * command pool cannot be used from more than one thread at a time.
+    * The pools are kept per frame in flight and only the ones of the current frame are used.
+    */
+   class ParallelRecorder
+   {
+   public:
+      /** Records the draw list items [first, last) into a secondary command buffer. */
+      typedef std::function<void(Vk::CommandBuffer* commandBuffer, uint32_t first, uint32_t last)> RecordFunction;
+
+      ParallelRecorder(Vk::Device* device, uint32_t numThreads);
+      ~ParallelRecorder();
+
+      /** Recycles the command buffers of the current frame, the GPU must be done executing the frame that last used them. */
+      void ResetCommandPools();
+
+      /**
+       * Calls func(index) for every index in [0, count) as tasks in the TaskScheduler.
+       * The calling thread takes part and blocks until all calls have returned.
+       * Every call has a FrameCommandPool current so render targets record into thread owned command buffers.
+       */
+      void ParallelFor(uint32_t count, const std::function<void(uint32_t)>& func);
+
+      /**
+       * Splits a draw list of numItems into chunks that are recorded into secondary command buffers
+       * in parallel and then executed in order from primaryCommandBuffer. The render pass must have
+       * been begun with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS.
+       */
+      void RecordSecondary(Vk::CommandBuffer* primaryCommandBuffer, Vk::RenderPass* renderPass, VkFramebuffer frameBuffer,
+                           uint32_t width, uint32_t height, uint32_t numItems, const RecordFunction& recordFunction);
+
+      uint32_t GetNumThreads() const;
+
+   private:
+      Vk::FrameCommandPool* AcquireCommandPool();
+      void ReleaseCommandPool(Vk::FrameCommandPool* commandPool);
+
+   private:
+      Vk::Device* mDevice;
+      std::vector<std::vector<SharedPtr<Vk::FrameCommandPool>>> mCommandPools;
+      std::vector<std::vector<Vk::FrameCommandPool*>> mFreeCommandPools;
+      std::mutex mCommandPoolMutex;
+      uint32_t mNumThreads;
+
+      // Splitting smaller draw lists than this costs more than it saves
+      const uint32_t MIN_ITEMS_PER_SECONDARY = 64;
+   };
+}
@@ -7,7 +7,8 @@
 #include "vulkan/TextureLoader.h"
 #include "vulkan/Texture.h"
 #include "vulkan/handles/DescriptorSet.h"
-#include "vulkan/handles/CommandBuffer.h"
+#include "vulkan/UploadManager.h"
+#include "vulkan/GeometryPool.h"
 
 namespace Utopian
 {
@@ -62,54 +63,42 @@ namespace Utopian
 
    void Primitive::BuildBuffers(Vk::Device* device)
    {
-      uint32_t vertexBufferSize = GetNumVertices() * sizeof(Vk::Vertex);
+      uint32_t vertexSize = sizeof(Vk::Vertex);
+      const void* vertexData = vertices.data();
+
+      // Only needed until the upload has copied them to the staging memory
+      std::vector<Vk::CompactVertex> compactVertices;
+      if (mVertexLayout == Vk::VERTEX_LAYOUT_COMPACT)
+      {
+         compactVertices.assign(vertices.begin(), vertices.end());
+         vertexSize = sizeof(Vk::CompactVertex);
+         vertexData = compactVertices.data();
+      }
+
+      uint32_t vertexBufferSize = GetNumVertices() * vertexSize;
       uint32_t indexBufferSize = GetNumIndices() * sizeof(uint32_t);
 
-      Vk::BUFFER_CREATE_INFO stagingVertexCI;
-      stagingVertexCI.usageFlags = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-      stagingVertexCI.memoryPropertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
-      stagingVertexCI.data = vertices.data();
-      stagingVertexCI.size = vertexBufferSize;
-      stagingVertexCI.name = "Staging Vertex buffer: " + mDebugName;
-      Vk::Buffer vertexStaging = Vk::Buffer(stagingVertexCI, device);
-
-      Vk::BUFFER_CREATE_INFO vertexCI;
-      vertexCI.usageFlags = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
-      vertexCI.memoryPropertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
-      vertexCI.data = nullptr;
-      vertexCI.size = vertexBufferSize;
-      vertexCI.name = "Vertex buffer: " + mDebugName;
-      mVertexBuffer = std::make_shared<Vk::Buffer>(vertexCI, device);
-
-      // Copy from host visible to device local memory
-      Vk::CommandBuffer cmdBuffer = Vk::CommandBuffer(device, VK_COMMAND_BUFFER_LEVEL_PRIMARY, true);
-      vertexStaging.Copy(&cmdBuffer, mVertexBuffer.get());
-      cmdBuffer.Flush();
-
-      if (GetNumIndices() > 0)
+      // The copies are batched with other uploads and submitted before the next queue submission
+      Vk::UploadManager* uploadManager = device->GetUploadManager();
+      Vk::GeometryPool* geometryPool = device->GetGeometryPool();
+
+      mVertexAllocation = geometryPool->AllocateVertices(GetNumVertices(), vertexSize);
+      mIndexAllocation = geometryPool->AllocateIndices(GetNumIndices());
+
+      if (mVertexAllocation != nullptr)
       {
-         Vk::BUFFER_CREATE_INFO stagingIndexCI;
-         stagingIndexCI.usageFlags = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-         stagingIndexCI.memoryPropertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
-         stagingIndexCI.data = indices.data();
-         stagingIndexCI.size = indexBufferSize;
-         stagingIndexCI.name = "Staging Index buffer: " + mDebugName;
-         Vk::Buffer indexStaging = Vk::Buffer(stagingIndexCI, device);
-
-         Vk::BUFFER_CREATE_INFO indexCI;
-         indexCI.usageFlags = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
-         indexCI.memoryPropertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
-         indexCI.data = nullptr;
-         indexCI.size = indexBufferSize;
-         indexCI.name = "Index buffer: " + mDebugName;
-         mIndexBuffer = std::make_shared<Vk::Buffer>(indexCI, device);
-
-         cmdBuffer.Begin();
-         indexStaging.Copy(&cmdBuffer, mIndexBuffer.get());
-         cmdBuffer.Flush();
+         uploadManager->UploadBuffer(mVertexAllocation->GetBuffer(), vertexData, vertexBufferSize,
+                                     mVertexAllocation->GetByteOffset());
       }
 
-      mBoundingBox.Init(vertices);
+      if (mIndexAllocation != nullptr)
+      {
+         uploadManager->UploadBuffer(mIndexAllocation->GetBuffer(), indices.data(), indexBufferSize,
+                                     mIndexAllocation->GetByteOffset());
+      }
+
+      if (!mHasBoundingBox)
+         mBoundingBox.Init(vertices);
    }
 
    uint32_t Primitive::GetNumVertices() const
@@ -122,14 +111,34 @@ namespace Utopian
       return indices.size();
    }
 
+   void Primitive::SetVertexLayout(Vk::VertexLayout vertexLayout)
+   {
+      mVertexLayout = vertexLayout;
+   }
+
+   Vk::VertexLayout Primitive::GetVertexLayout() const
+   {
+      return mVertexLayout;
+   }
+
    Vk::Buffer* Primitive::GetVertxBuffer()
    {
-      return mVertexBuffer.get();
+      return mVertexAllocation != nullptr ? mVertexAllocation->GetBuffer().get() : nullptr;
    }
 
    Vk::Buffer* Primitive::GetIndexBuffer()
    {
-      return mIndexBuffer.get();
+      return mIndexAllocation != nullptr ? mIndexAllocation->GetBuffer().get() : nullptr;
+   }
+
+   uint32_t Primitive::GetFirstIndex() const
+   {
+      return mIndexAllocation != nullptr ? mIndexAllocation->GetOffset() : 0u;
+   }
+
+   int32_t Primitive::GetVertexOffset() const
+   {
+      return mVertexAllocation != nullptr ? (int32_t)mVertexAllocation->GetOffset() : 0;
    }
 
    BoundingBox Primitive::GetBoundingBox()
@@ -137,6 +146,12 @@ namespace Utopian
       return mBoundingBox;
    }
 
+   void Primitive::SetBoundingBox(const BoundingBox& boundingBox)
+   {
+      mBoundingBox = boundingBox;
+      mHasBoundingBox = true;
+   }
+
    void Primitive::SetDebugName(std::string debugName)
    {
       mDebugName = debugName;
@@ -29,10 +29,23 @@ namespace Utopian
       uint32_t GetNumIndices() const;
       uint32_t GetNumVertices() const;
 
+      /**
+       * Sets the layout the vertices are stored with in the vertex buffer, must be called before BuildBuffers().
+       * The vertices member always uses the default layout.
+       */
+      void SetVertexLayout(Vk::VertexLayout vertexLayout);
+      Vk::VertexLayout GetVertexLayout() const;
+
+      /** The buffers are shared with other primitives, draw with GetFirstIndex() and GetVertexOffset(). */
       Vk::Buffer* GetVertxBuffer();
       Vk::Buffer* GetIndexBuffer();
+      uint32_t GetFirstIndex() const;
+      int32_t GetVertexOffset() const;
       BoundingBox GetBoundingBox();
 
+      /** Used when the bounds are already known, BuildBuffers() then skips calculating them from the vertices. */
+      void SetBoundingBox(const BoundingBox& boundingBox);
+
       void SetDebugName(std::string debugName);
       std::string GetDebugName() const;
 
@@ -40,9 +53,12 @@ namespace Utopian
       std::vector<unsigned int> indices;
 
    private:
-      SharedPtr<Vk::Buffer> mVertexBuffer;
-      SharedPtr<Vk::Buffer> mIndexBuffer;
+      // Copies of the primitive share the ranges in the geometry pool
+      SharedPtr<Vk::GeometryAllocation> mVertexAllocation;
+      SharedPtr<Vk::GeometryAllocation> mIndexAllocation;
       BoundingBox mBoundingBox;
+      bool mHasBoundingBox = false;
+      Vk::VertexLayout mVertexLayout = Vk::VERTEX_LAYOUT_DEFAULT;
       std::string mDebugName = "unnamed";
    };
 }
@@ -32,6 +32,8 @@ namespace Utopian
          ImGui::Checkbox("Cascade color debug", &renderSettings.cascadeColorDebug);
          ImGui::Checkbox("Terrain wireframe", &renderSettings.terrainWireframe);
          ImGui::Checkbox("Wind enabled", &renderSettings.windEnabled);
+         ImGui::Checkbox("Frustum culling", &renderSettings.frustumCulling);
+         ImGui::Checkbox("Parallel recording", &renderSettings.parallelRecording);
       }
 
       if (ImGui::CollapsingHeader("Depth of Field settings"))
@@ -41,6 +43,14 @@ namespace Utopian
          ImGui::SliderFloat("DOF range", &renderSettings.dofRange, 0.0f, 50.0f);
       }
 
+      if (ImGui::CollapsingHeader("Animation settings"))
+      {
+         ImGui::Checkbox("Animation LOD", &renderSettings.animationLod);
+         ImGui::SliderFloat("Full rate distance", &renderSettings.animationFullRateDistance, 0.0f, 500.0f);
+         ImGui::SliderFloat("Freeze distance", &renderSettings.animationFreezeDistance, 0.0f, 1000.0f);
+         ImGui::SliderInt("Reduced rate interval", &renderSettings.animationReducedInterval, 1, 16);
+      }
+
       if (ImGui::CollapsingHeader("Fog settings"))
       {
          ImGui::ColorEdit4("Fog color", &renderSettings.fogColor.x);
@@ -166,6 +176,12 @@ namespace Utopian
       renderSettings.windStrength = (float)luaSettings["windStrength"].ToNumber();
       renderSettings.windFrequency = (float)luaSettings["windFrequency"].ToNumber();
       renderSettings.windEnabled = (float)luaSettings["windEnabled"].ToNumber();
+      renderSettings.frustumCulling = luaSettings["frustumCulling"].GetBoolean();
+      renderSettings.parallelRecording = luaSettings["parallelRecording"].GetBoolean();
+      renderSettings.animationLod = luaSettings["animationLod"].GetBoolean();
+      renderSettings.animationFullRateDistance = (float)luaSettings["animationFullRateDistance"].ToNumber();
+      renderSettings.animationFreezeDistance = (float)luaSettings["animationFreezeDistance"].ToNumber();
+      renderSettings.animationReducedInterval = (int)luaSettings["animationReducedInterval"].ToInteger();
       renderSettings.numWaterCells = (int)luaSettings["numWaterCells"].ToInteger();
       renderSettings.waterLevel = (float)luaSettings["waterLevel"].ToNumber();
       renderSettings.waterColor = glm::vec3(luaSettings["waterColor_x"].ToNumber(),
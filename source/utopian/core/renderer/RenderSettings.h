@@ -59,6 +59,14 @@ namespace Utopian
       float windStrength = 5.0f;
       float windFrequency = 10000.0f;
       bool windEnabled = true;
+      bool frustumCulling = true;
+      bool parallelRecording = true;
+
+      // Animation level of detail
+      bool animationLod = true;
+      float animationFullRateDistance = 30.0f;
+      float animationFreezeDistance = 250.0f;
+      int animationReducedInterval = 4;
 
       // Water
       int numWaterCells = 512;
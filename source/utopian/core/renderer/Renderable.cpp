@@ -10,6 +10,10 @@ namespace Utopian
 {
    Renderable::Renderable()
    {
+      mBoundsDirty = false;
+      mBvhProxy = -1;
+      mModelRenderCommandsVersion = 0;
+      mRenderCommandsDirty = true;
       SetRenderFlags(RENDER_FLAG_DEFERRED | RENDER_FLAG_CAST_SHADOW);
       SetTileFactor(glm::vec2(1.0f, 1.0f));
       SetColor(glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
@@ -41,11 +45,6 @@ namespace Utopian
       Renderer::Instance().AddRenderable(this);
    }
 
-   void Renderable::UpdateAnimation(float deltaTime)
-   {
-      mModel->UpdateAnimation(deltaTime / 1000.0f);
-   }
-
    Model* Renderable::GetModel()
    {
       return mModel.get();
@@ -53,12 +52,34 @@ namespace Utopian
 
    void Renderable::LoadModel(std::string path)
    {
-      mModel = gModelLoader().LoadModel(path);
+      SetModel(gModelLoader().LoadModel(path));
+   }
+
+   void Renderable::LoadModelAsync(std::string path)
+   {
+      SetModelAsync(gModelLoader().LoadModelAsync(path));
    }
 
    void Renderable::SetModel(SharedPtr<Model> model)
    {
       mModel = model;
+      mPendingModel = std::shared_future<SharedPtr<Model>>();
+      mRenderCommandsDirty = true;
+      gRenderer().InvalidateBounds(this);
+   }
+
+   void Renderable::SetModelAsync(const std::shared_future<SharedPtr<Model>>& model)
+   {
+      // The culler skips renderables without a model
+      SetModel(nullptr);
+      mPendingModel = model;
+      UpdatePendingModel();
+   }
+
+   void Renderable::UpdatePendingModel()
+   {
+      if (mPendingModel.valid() && mPendingModel.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+         SetModel(mPendingModel.get());
    }
 
    void Renderable::SetDiffuseTexture(uint32_t materialIdx, SharedPtr<Vk::Texture> texture)
@@ -119,6 +140,14 @@ namespace Utopian
 
    const BoundingBox Renderable::GetBoundingBox() const
    {
+      // Empty box at the position while the model is loading
+      if (mModel == nullptr)
+      {
+         BoundingBox boundingBox;
+         boundingBox.Init(GetPosition(), glm::vec3(0.0f));
+         return boundingBox;
+      }
+
       BoundingBox boundingBox = mModel->GetBoundingBox();
       boundingBox.Update(GetWorldMatrix());
 
@@ -154,4 +183,59 @@ namespace Utopian
    {
       return (mRenderFlags & renderFlags) == renderFlags;
    }
+
+   void Renderable::SetBvhProxy(int32_t proxy)
+   {
+      mBvhProxy = proxy;
+   }
+
+   int32_t Renderable::GetBvhProxy() const
+   {
+      return mBvhProxy;
+   }
+
+   void Renderable::SetBoundsDirty(bool dirty)
+   {
+      mBoundsDirty = dirty;
+   }
+
+   bool Renderable::IsBoundsDirty() const
+   {
+      return mBoundsDirty;
+   }
+
+   void Renderable::UpdateRenderCommands()
+   {
+      if (mModel == nullptr)
+         return;
+
+      mModel->UpdateRenderCommands();
+
+      if (!mRenderCommandsDirty && mModelRenderCommandsVersion == mModel->GetRenderCommandsVersion())
+         return;
+
+      const glm::mat4 worldMatrix = GetWorldMatrix();
+      const std::vector<RenderCommand>& modelCommands = mModel->GetRenderCommands();
+
+      mRenderCommands.resize(modelCommands.size());
+      for (size_t i = 0; i < modelCommands.size(); i++)
+      {
+         mRenderCommands[i] = modelCommands[i];
+         mRenderCommands[i].world = worldMatrix * modelCommands[i].world;
+      }
+
+      mModelRenderCommandsVersion = mModel->GetRenderCommandsVersion();
+      mRenderCommandsDirty = false;
+   }
+
+   const std::vector<RenderCommand>& Renderable::GetRenderCommands() const
+   {
+      return mRenderCommands;
+   }
+
+   void Renderable::OnTransformChanged()
+   {
+      mRenderCommandsDirty = true;
+      gRenderer().InvalidateBounds(this);
+   }
 }
\ No newline at end of file
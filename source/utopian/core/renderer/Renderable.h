@@ -1,4 +1,6 @@
 #pragma once
+#include <future>
+#include <vector>
 #include <glm/glm.hpp>
 #include "core/SceneNode.h"
 #include "core/components/Component.h"
@@ -9,6 +11,7 @@ namespace Utopian
 {
    class Actor;
    class Model;
+   struct RenderCommand;
 
    enum RenderFlags
    {
@@ -32,10 +35,13 @@ namespace Utopian
 
       static SharedPtr<Renderable> Create();
 
-      void UpdateAnimation(float deltaTime);
       void LoadModel(std::string path);
 
+      /** Loads the model on a worker thread, nothing is drawn until it is ready. */
+      void LoadModelAsync(std::string path);
+
       void SetModel(SharedPtr<Model> model);
+      void SetModelAsync(const std::shared_future<SharedPtr<Model>>& model);
       void SetDiffuseTexture(uint32_t materialIdx, SharedPtr<Vk::Texture> texture);
       void SetNormalTexture(uint32_t materialIdx, SharedPtr<Vk::Texture> texture);
       void SetSpecularTexture(uint32_t materialIdx, SharedPtr<Vk::Texture> texture);
@@ -57,12 +63,39 @@ namespace Utopian
 
       const bool HasRenderFlags(uint32_t renderFlags) const;
 
+      /** Proxy in the renderable BVH maintained by VisibilityCuller. */
+      void SetBvhProxy(int32_t proxy);
+      int32_t GetBvhProxy() const;
+      void SetBoundsDirty(bool dirty);
+      bool IsBoundsDirty() const;
+
+      /**
+       * Rebuilds the cached world space render commands if the transform or the model pose changed.
+       * Called by the Renderer on the main thread once per frame before the jobs are recorded.
+       */
+      void UpdateRenderCommands();
+
+      /** Swaps in the model set by SetModelAsync() when it has finished loading, called once per frame by the Renderer. */
+      void UpdatePendingModel();
+
+      /** Returns the render commands cached by UpdateRenderCommands(). */
+      const std::vector<RenderCommand>& GetRenderCommands() const;
+
+   protected:
+      void OnTransformChanged() override;
+
    private:
       SharedPtr<Model> mModel;
+      std::shared_future<SharedPtr<Model>> mPendingModel;
       glm::vec4 mColor;
       glm::vec2 mTextureTileFactor;
       uint32_t mRenderFlags;
       bool mVisible;
       bool mPushFoliage;
+      bool mBoundsDirty;
+      int32_t mBvhProxy;
+      std::vector<RenderCommand> mRenderCommands;
+      uint32_t mModelRenderCommandsVersion;
+      bool mRenderCommandsDirty;
    };
 }
@@ -1,7 +1,9 @@
+#include <algorithm>
 #include <core/renderer/RendererUtility.h>
 #include <glm/gtc/matrix_transform.hpp>
 #include "core/renderer/Renderer.h"
 #include "core/renderer/Renderable.h"
+#include "core/renderer/Model.h"
 #include "vulkan/VulkanApp.h"
 #include "vulkan/Vertex.h"
 #include "vulkan/handles/CommandBuffer.h"
@@ -19,6 +21,7 @@
 #include "core/renderer/Im3dRenderer.h"
 #include "core/Terrain.h"
 #include "core/AssetLoader.h"
+#include "core/TaskScheduler.h"
 #include "core/renderer/jobs/GBufferJob.h"
 #include "core/renderer/jobs/SSAOJob.h"
 #include "core/renderer/jobs/BlurJob.h"
@@ -29,6 +32,7 @@
 #include "core/renderer/jobs/SunShaftJob.h"
 #include "core/renderer/jobs/DebugJob.h"
 #include "core/renderer/InstancingManager.h"
+#include "core/renderer/VisibilityCuller.h"
 #include "core/ScriptExports.h"
 #include "core/renderer/ScreenQuadRenderer.h"
 #include "core/Log.h"
@@ -54,6 +58,7 @@ namespace Utopian
       UTO_LOG("Initializing Renderer");
 
       mNextNodeId = 0;
+      mAnimationFrame = 0;
       mMainCamera = nullptr;
       mVulkanApp = vulkanApp;
       mDevice = vulkanApp->GetDevice();
@@ -63,6 +68,7 @@ namespace Utopian
 
       mIm3dRenderer = std::make_shared<Im3dRenderer>(mVulkanApp, glm::vec2(mVulkanApp->GetWindowWidth(), mVulkanApp->GetWindowHeight()));
       mInstancingManager = std::make_shared<InstancingManager>(this);
+      mVisibilityCuller = std::make_shared<VisibilityCuller>(this);
    }
 
    Renderer::~Renderer()
@@ -95,6 +101,8 @@ namespace Utopian
 
    void Renderer::Update(double deltaTime)
    {
+      UpdatePendingModels();
+      UpdateAnimations(deltaTime);
       UpdateCascades();
       UpdateSun();
 
@@ -122,6 +130,9 @@ namespace Utopian
       ImGuiRenderer::TextV("Camera pos = (%.2f, %.2f, %.2f)", pos.x, pos.y, pos.z);
       ImGuiRenderer::TextV("Camera dir = (%.2f, %.2f, %.2f)", dir.x, dir.y, dir.z);
       ImGuiRenderer::TextV("Models: %u, Lights: %u", mSceneInfo.renderables.size(), mSceneInfo.lights.size());
+      ImGuiRenderer::TextV("Visible models: %u, Visible instance groups: %u", mVisibilityCuller->GetNumVisibleRenderables(),
+                           mVisibilityCuller->GetNumVisibleInstanceGroups());
+      ImGuiRenderer::TextV("Visible instances: %u", mVisibilityCuller->GetNumVisibleInstances());
 
       ImGuiRenderer::EndWindow();
 
@@ -276,6 +287,125 @@ namespace Utopian
          mSceneInfo.directionalLight->SetDirection(glm::vec3(1, 1, -1) * mSceneInfo.sunInfo.direction);
    }
 
+   void Renderer::UpdateRenderCommands()
+   {
+      for (auto& renderable : mSceneInfo.renderables)
+         renderable->UpdateRenderCommands();
+
+      for (auto& instanceGroup : mSceneInfo.instanceGroups)
+      {
+         if (instanceGroup->GetModel() != nullptr)
+            instanceGroup->GetModel()->UpdateRenderCommands();
+      }
+   }
+
+   void Renderer::UpdateAnimations(double deltaTime)
+   {
+      // The culling result of the previous frame, models that only cast shadows into view count as visible
+      mVisibleRenderables.assign(mSceneInfo.mainView.renderables.begin(), mSceneInfo.mainView.renderables.end());
+      for (uint32_t i = 0; i < SHADOW_MAP_CASCADE_COUNT; i++)
+      {
+         const std::vector<Renderable*>& casters = mSceneInfo.cascadeViews[i].renderables;
+         mVisibleRenderables.insert(mVisibleRenderables.end(), casters.begin(), casters.end());
+      }
+
+      std::sort(mVisibleRenderables.begin(), mVisibleRenderables.end());
+      mVisibleRenderables.erase(std::unique(mVisibleRenderables.begin(), mVisibleRenderables.end()), mVisibleRenderables.end());
+
+      const glm::vec3 eyePos = mMainCamera->GetPosition();
+
+      mAnimatedModels.clear();
+      for (auto& renderable : mSceneInfo.renderables)
+      {
+         Model* model = renderable->GetModel();
+         if (model == nullptr || !model->IsAnimated())
+            continue;
+
+         AnimatedModel animatedModel;
+         animatedModel.model = model;
+         animatedModel.distance = glm::distance(renderable->GetPosition(), eyePos);
+         animatedModel.visible = std::binary_search(mVisibleRenderables.begin(), mVisibleRenderables.end(), renderable);
+         animatedModel.lod = ANIMATION_LOD_FULL_RATE;
+         mAnimatedModels.push_back(animatedModel);
+      }
+
+      // A model shared by several renderables is animated at the rate of its closest visible renderable
+      std::sort(mAnimatedModels.begin(), mAnimatedModels.end(), [](const AnimatedModel& a, const AnimatedModel& b) {
+         if (a.model != b.model)
+            return a.model < b.model;
+         if (a.visible != b.visible)
+            return a.visible;
+         return a.distance < b.distance;
+      });
+
+      mAnimatedModels.erase(std::unique(mAnimatedModels.begin(), mAnimatedModels.end(), [](const AnimatedModel& a, const AnimatedModel& b) {
+         return a.model == b.model;
+      }), mAnimatedModels.end());
+
+      const RenderingSettings& settings = mRenderingSettings;
+      const uint32_t reducedInterval = (uint32_t)std::max(settings.animationReducedInterval, 1);
+
+      mAnimationStatistics = AnimationStatistics();
+      mAnimationFrame++;
+
+      for (uint32_t i = 0; i < mAnimatedModels.size(); i++)
+      {
+         AnimatedModel& animatedModel = mAnimatedModels[i];
+
+         if (settings.animationLod)
+         {
+            if (!animatedModel.visible || animatedModel.distance > settings.animationFreezeDistance)
+               animatedModel.lod = ANIMATION_LOD_FROZEN;
+            else if (animatedModel.distance > settings.animationFullRateDistance)
+               animatedModel.lod = ANIMATION_LOD_REDUCED_RATE;
+         }
+
+         switch (animatedModel.lod)
+         {
+         case ANIMATION_LOD_FULL_RATE:
+            mAnimationStatistics.numFullRate++;
+            mAnimationStatistics.numUpdated++;
+            break;
+         case ANIMATION_LOD_REDUCED_RATE:
+            mAnimationStatistics.numReducedRate++;
+            // Spread the updates of a crowd over the interval instead of updating all of it in the same frame
+            if ((mAnimationFrame + animatedModel.model->GetAnimationPhase()) % reducedInterval == 0)
+               mAnimationStatistics.numUpdated++;
+            break;
+         case ANIMATION_LOD_FROZEN:
+            mAnimationStatistics.numFrozen++;
+            break;
+         }
+      }
+
+      // Every model writes its own skeleton and range of the joint palette. Skipped and frozen models keep
+      // their pose, SkinAnimator::RefreshStaleFrames() has already copied it to the current frame slot.
+      gTaskScheduler().ParallelFor((uint32_t)mAnimatedModels.size(), 1, [&](uint32_t index)
+      {
+         const AnimatedModel& animatedModel = mAnimatedModels[index];
+
+         if (animatedModel.lod == ANIMATION_LOD_FULL_RATE)
+            animatedModel.model->UpdateAnimation((float)deltaTime);
+         else if (animatedModel.lod == ANIMATION_LOD_REDUCED_RATE)
+         {
+            // The skipped time is applied at the next update so that the animation keeps its speed
+            if ((mAnimationFrame + animatedModel.model->GetAnimationPhase()) % reducedInterval == 0)
+               animatedModel.model->UpdateAnimation((float)deltaTime);
+            else
+               animatedModel.model->SkipAnimationUpdate((float)deltaTime);
+         }
+      });
+   }
+
+   void Renderer::UpdatePendingModels()
+   {
+      for (auto& renderable : mSceneInfo.renderables)
+         renderable->UpdatePendingModel();
+
+      for (auto& instanceGroup : mSceneInfo.instanceGroups)
+         instanceGroup->UpdatePendingModel();
+   }
+
    void Renderer::Render()
    {
       // Note: This had to be done here due to the different periodicity of Update() and Render().
@@ -295,6 +425,9 @@ namespace Utopian
          mSceneInfo.sharedVariables.data.viewportSize = glm::vec2(mVulkanApp->GetWindowWidth(), mVulkanApp->GetWindowHeight());
          mSceneInfo.sharedVariables.UpdateMemory();
 
+         mVisibilityCuller->Cull(mMainCamera.get(), mRenderingSettings);
+         UpdateRenderCommands();
+
          mJobGraph->Render(mSceneInfo, mRenderingSettings);
       }
 
@@ -315,6 +448,7 @@ namespace Utopian
    {
       renderable->SetId(mNextNodeId++);
       mSceneInfo.renderables.push_back(renderable);
+      mVisibilityCuller->AddRenderable(renderable);
    }
 
    void Renderer::AddLight(Light* light)
@@ -338,6 +472,8 @@ namespace Utopian
 
    void Renderer::RemoveRenderable(Renderable* renderable)
    {
+      mVisibilityCuller->RemoveRenderable(renderable);
+
       for (auto iter = mSceneInfo.renderables.begin(); iter != mSceneInfo.renderables.end(); iter++)
       {
          // Note: No need to free memory here since that will happen when the SharedPtr is removed from the CRenderable
@@ -349,6 +485,16 @@ namespace Utopian
       }
    }
 
+   void Renderer::InvalidateBounds(Renderable* renderable)
+   {
+      mVisibilityCuller->InvalidateBounds(renderable);
+   }
+
+   const DynamicBvh& Renderer::GetRenderableBvh()
+   {
+      return mVisibilityCuller->GetBvh();
+   }
+
    void Renderer::RemoveLight(Light* light)
    {
       for (auto iter = mSceneInfo.lights.begin(); iter != mSceneInfo.lights.end(); iter++)
@@ -446,6 +592,11 @@ namespace Utopian
       return mSceneInfo.sharedVariables;
    }
 
+   const Renderer::AnimationStatistics& Renderer::GetAnimationStatistics() const
+   {
+      return mAnimationStatistics;
+   }
+
    Camera* Renderer::GetMainCamera() const
    {
       return mMainCamera.get();
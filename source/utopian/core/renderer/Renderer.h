@@ -16,6 +16,8 @@ namespace Utopian
    class ImGuiRenderer;
    class Im3dRenderer;
    class InstancingManager;
+   class VisibilityCuller;
+   class DynamicBvh;
 
    /**
     * The scene renderer that manages and renders all the nodes in the scene.
@@ -24,6 +26,15 @@ namespace Utopian
    class Renderer : public Module<Renderer>
    {
    public:
+      /** Level of detail chosen for the animated models during the last update, see RenderingSettings::animationLod. */
+      struct AnimationStatistics
+      {
+         uint32_t numFullRate = 0;
+         uint32_t numReducedRate = 0;
+         uint32_t numFrozen = 0;
+         uint32_t numUpdated = 0;
+      };
+
       Renderer(Vk::VulkanApp* vulkanApp);
       ~Renderer();
 
@@ -57,6 +68,12 @@ namespace Utopian
       /** Removes a Renderable from the scene. */
       void RemoveRenderable(Renderable* renderable);
 
+      /** Called when the bounds of a Renderable have changed, e.g. when it has moved. */
+      void InvalidateBounds(Renderable* renderable);
+
+      /** Returns the BVH containing the physical space bounds of all renderables. */
+      const DynamicBvh& GetRenderableBvh();
+
       /** Removes a Light from the scene. */
       void RemoveLight(Light* light);
 
@@ -86,6 +103,8 @@ namespace Utopian
 
       const SharedShaderVariables& GetSharedShaderVariables() const;
 
+      const AnimationStatistics& GetAnimationStatistics() const;
+
       /** Instancing experimentation. */
       void AddInstancedAsset(uint32_t assetId, glm::vec3 position, glm::vec3 rotation, glm::vec3 scale, bool animated = false, bool castShadow = false);
       void RemoveInstancesWithinRadius(uint32_t assetId, glm::vec3 position, float radius);
@@ -104,6 +123,21 @@ namespace Utopian
       uint32_t GetWindowHeight() const;
 
    private:
+      enum AnimationLod
+      {
+         ANIMATION_LOD_FULL_RATE,
+         ANIMATION_LOD_REDUCED_RATE,
+         ANIMATION_LOD_FROZEN
+      };
+
+      struct AnimatedModel
+      {
+         Model* model;
+         float distance;
+         bool visible;
+         AnimationLod lod;
+      };
+
       /** Adds widgets to the ImGui use interface for rendering settings. */
       void UpdateUi();
 
@@ -113,9 +147,23 @@ namespace Utopian
       /** Updates the sun position. */
       void UpdateSun();
 
+      /** Rebuilds the cached render commands that are dirty, before the jobs read them in parallel. */
+      void UpdateRenderCommands();
+
+      /** Swaps in the models of renderables and instance groups that have finished loading. */
+      void UpdatePendingModels();
+
+      /**
+       * Updates the animated models of all renderables in parallel, a model shared by several renderables is updated once.
+       * Models that were visible in the previous frame are updated every frame when close to the camera and every Nth
+       * frame further away, models that were culled or are beyond the freeze distance keep their pose.
+       */
+      void UpdateAnimations(double deltaTime);
+
    private:
       SharedPtr<JobGraph> mJobGraph;
       SharedPtr<InstancingManager> mInstancingManager;
+      SharedPtr<VisibilityCuller> mVisibilityCuller;
       RenderingSettings mRenderingSettings;
       SceneInfo mSceneInfo;
       Vk::VulkanApp* mVulkanApp;
@@ -123,6 +171,10 @@ namespace Utopian
       SharedPtr<Camera> mMainCamera;
       ImGuiRenderer* mImGuiRenderer;
       uint32_t mNextNodeId;
+      std::vector<AnimatedModel> mAnimatedModels;
+      std::vector<Renderable*> mVisibleRenderables;
+      AnimationStatistics mAnimationStatistics;
+      uint32_t mAnimationFrame;
 
       // Where does this belong?
    public:
@@ -47,10 +47,10 @@ namespace Utopian
       if (primitive->GetNumIndices() > 0)
       {
          commandBuffer->CmdBindIndexBuffer(primitive->GetIndexBuffer(), 0, VK_INDEX_TYPE_UINT32);
-         commandBuffer->CmdDrawIndexed(primitive->GetNumIndices(), 1, 0, 0, 0);
+         commandBuffer->CmdDrawIndexed(primitive->GetNumIndices(), 1, primitive->GetFirstIndex(), primitive->GetVertexOffset(), 0);
       }
       else
-         commandBuffer->CmdDraw(primitive->GetNumVertices(), 1, 0, 0);
+         commandBuffer->CmdDraw(primitive->GetNumVertices(), 1, primitive->GetVertexOffset(), 0);
    }
 
    void RendererUtility::SetAdditiveBlending(VkPipelineColorBlendAttachmentState& blendAttachmentState)
@@ -285,7 +285,7 @@ namespace Utopian
             Primitive* primitive = mCubemapModel->GetPrimitive(0);
             commandBuffer->CmdBindVertexBuffer(0, 1, primitive->GetVertxBuffer());
             commandBuffer->CmdBindIndexBuffer(primitive->GetIndexBuffer(), 0, VK_INDEX_TYPE_UINT32);
-            commandBuffer->CmdDrawIndexed(primitive->GetNumIndices(), 1, 0, 0, 0);
+            commandBuffer->CmdDrawIndexed(primitive->GetNumIndices(), 1, primitive->GetFirstIndex(), primitive->GetVertexOffset(), 0);
 
             commandBuffer->CmdEndRenderPass();
 
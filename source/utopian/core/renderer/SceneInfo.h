@@ -1,20 +1,33 @@
 #pragma once
 #include <glm/glm.hpp>
 #include <array>
+#include <future>
 #include "vulkan/VulkanApp.h"
 #include "core/renderer/Renderable.h"
 #include "core/renderer/Light.h"
 #include "core/Terrain.h"
+#include "utility/math/Frustum.h"
 
 #define SHADOW_MAP_CASCADE_COUNT 4
 
+// The main camera view followed by one view per shadow cascade
+#define INSTANCE_VIEW_COUNT (SHADOW_MAP_CASCADE_COUNT + 1)
+#define INSTANCE_MAIN_VIEW 0u
+
+// Size of the grid cells that instances are bucketed into for culling
+#define INSTANCE_CELL_SIZE 32.0f
+
 namespace Utopian
 {
    class Terrain;
+   class BakedAnimation;
 
    struct InstanceDataGPU
    {
       glm::mat4 world;
+
+      // Offset into the baked animation of skinned models as a fraction of its duration
+      float animationPhase;
    };
 
    struct InstanceData
@@ -27,6 +40,15 @@ namespace Utopian
       glm::vec3 scale;
    };
 
+   /** A grid cell of instances, the instances are stored contiguously in InstanceGroup::mInstances. */
+   struct InstanceCell
+   {
+      glm::vec3 min;
+      glm::vec3 max;
+      uint32_t firstInstance;
+      uint32_t numInstances;
+   };
+
    class InstanceGroup
    {
    public:
@@ -42,21 +64,58 @@ namespace Utopian
       void SetCastShadows(bool castShadows);
       void SaveToFile(std::ofstream& fout);
 
+      /**
+       * The asset is loaded asynchronously and the group is not drawn until it is ready.
+       * Swaps in the model and builds the buffers when it has finished, called once per frame by the Renderer.
+       */
+      void UpdatePendingModel();
+
       uint32_t GetAssetId();
       uint32_t GetNumInstances();
       Vk::Buffer* GetBuffer();
       Model* GetModel();
+
+      /** Returns the baked animation that the instances of a skinned model are drawn with, nullptr if not skinned. */
+      BakedAnimation* GetBakedAnimation();
       bool IsAnimated();
       bool IsCastingShadows();
 
+      /** Returns the bounding box enclosing all instances, in render space. */
+      const glm::vec3& GetBoundsMin() const;
+      const glm::vec3& GetBoundsMax() const;
+
+      /**
+       * Culls the grid cells against the frustum and copies the instances of the visible
+       * cells into the instance buffer of the view.
+       * @return The number of visible instances.
+       */
+      uint32_t CullInstances(uint32_t viewIndex, const Frustum& frustum, bool checkDepth = true);
+
+      /** Returns the compacted instance buffer of the current frame filled by CullInstances(). */
+      Vk::Buffer* GetVisibleBuffer(uint32_t viewIndex);
+      uint32_t GetNumVisibleInstances(uint32_t viewIndex) const;
+      uint32_t GetNumCells() const;
+
+   private:
+      /** Sorts the instances into grid cells and calculates the cell bounding boxes. */
+      void BuildCells();
+
    private:
       SharedPtr<Vk::Buffer> mInstanceBuffer;
+      // Rewritten every frame so each frame in flight has its own set of buffers
+      std::vector<std::array<SharedPtr<Vk::Buffer>, INSTANCE_VIEW_COUNT>> mVisibleInstanceBuffers;
+      std::array<uint32_t, INSTANCE_VIEW_COUNT> mNumVisibleInstances;
+      std::vector<InstanceCell> mCells;
       SharedPtr<Model> mModel;
+      std::shared_future<SharedPtr<Model>> mPendingModel;
+      SharedPtr<BakedAnimation> mBakedAnimation;
       std::vector<InstanceDataGPU> mInstances; // Uploaded to GPU
       std::vector<InstanceData> mInstanceData;
       uint32_t mAssetId;
       bool mAnimated;
       bool mCastShadows;
+      glm::vec3 mBoundsMin;
+      glm::vec3 mBoundsMax;
    };
 
    class Cascade
@@ -79,6 +138,27 @@ namespace Utopian
       UNIFORM_PARAM(float, time)
    UNIFORM_BLOCK_END()
 
+   /** An instance group with the instances that passed culling against a view. */
+   struct VisibleInstanceGroup
+   {
+      InstanceGroup* instanceGroup;
+      Vk::Buffer* instanceBuffer;
+      uint32_t numInstances;
+   };
+
+   /** The renderables and instance groups that passed culling against a single view. */
+   struct VisibilityList
+   {
+      std::vector<Renderable*> renderables;
+      std::vector<VisibleInstanceGroup> instanceGroups;
+
+      void Clear()
+      {
+         renderables.clear();
+         instanceGroups.clear();
+      }
+   };
+
    struct SceneInfo
    {
       std::vector<Renderable*> renderables;
@@ -89,6 +169,11 @@ namespace Utopian
       std::array<Cascade, SHADOW_MAP_CASCADE_COUNT> cascades;
       SharedPtr<Vk::Buffer> im3dVertices;
 
+      // Filled by VisibilityCuller before the job graph is executed
+      VisibilityList mainView;
+      std::array<VisibilityList, SHADOW_MAP_CASCADE_COUNT> cascadeViews;
+      std::vector<Renderable*> foliagePushers;
+
       // The light that will cast shadows
       // Currently assumes that there only is one directional light in the scene
       Light* directionalLight;
@@ -33,8 +33,12 @@ namespace Utopian
 
       mEffect = Vk::gEffectManager().AddEffect<Vk::Effect>(vulkanApp->GetDevice(), vulkanApp->GetRenderPass(), effectDesc);
 
-      mCommandBuffer = std::make_shared<Vk::CommandBuffer>(vulkanApp->GetDevice(), VK_COMMAND_BUFFER_LEVEL_SECONDARY);
-      mVulkanApp->AddSecondaryCommandBuffer(mCommandBuffer.get());
+      // Re-recorded every frame so each frame in flight needs its own command buffer
+      for (uint32_t frameIndex = 0; frameIndex < vulkanApp->GetNumFramesInFlight(); frameIndex++)
+      {
+         mCommandBuffers.push_back(std::make_shared<Vk::CommandBuffer>(vulkanApp->GetDevice(), VK_COMMAND_BUFFER_LEVEL_SECONDARY));
+         mVulkanApp->AddSecondaryCommandBuffer(mCommandBuffers.back().get(), frameIndex);
+      }
 
       mDescriptorPool = std::make_shared<Vk::DescriptorPool>(vulkanApp->GetDevice());
       mDescriptorPool->AddDescriptor(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 20);
@@ -73,11 +77,13 @@ namespace Utopian
 
    void ScreenQuadRenderer::Render(Vk::VulkanApp* vulkanApp)
    {
-      mCommandBuffer->Begin(vulkanApp->GetRenderPass(), vulkanApp->GetCurrentFrameBuffer());
-      mCommandBuffer->CmdSetViewPort((float)vulkanApp->GetWindowWidth(), (float)vulkanApp->GetWindowHeight());
-      mCommandBuffer->CmdSetScissor(vulkanApp->GetWindowWidth(), vulkanApp->GetWindowHeight());
+      Vk::CommandBuffer* commandBuffer = mCommandBuffers[vulkanApp->GetFrameIndex()].get();
+
+      commandBuffer->Begin(vulkanApp->GetRenderPass(), vulkanApp->GetCurrentFrameBuffer());
+      commandBuffer->CmdSetViewPort((float)vulkanApp->GetWindowWidth(), (float)vulkanApp->GetWindowHeight());
+      commandBuffer->CmdSetScissor(vulkanApp->GetWindowWidth(), vulkanApp->GetWindowHeight());
 
-      mCommandBuffer->CmdBindPipeline(mEffect->GetPipeline());
+      commandBuffer->CmdBindPipeline(mEffect->GetPipeline());
 
       for (uint32_t layer = NUM_MAX_LAYERS; layer > 0u; layer--)
       {
@@ -97,17 +103,17 @@ namespace Utopian
             pushConstantBlock.world = glm::translate(pushConstantBlock.world, glm::vec3(offsetX * 2.0f - 1.0f, offsetY * 2.0f - 1.0, 0));
             pushConstantBlock.world = glm::scale(pushConstantBlock.world, glm::vec3(horizontalRatio, verticalRatio, 0));
 
-            mCommandBuffer->CmdPushConstants(mEffect->GetPipelineInterface(), VK_SHADER_STAGE_ALL, sizeof(PushConstantBlock), &pushConstantBlock);
+            commandBuffer->CmdPushConstants(mEffect->GetPipelineInterface(), VK_SHADER_STAGE_ALL, sizeof(PushConstantBlock), &pushConstantBlock);
             VkDescriptorSet descriptorSets[1] = { mQuadList[i]->descriptorSet->GetVkHandle() };
-            mCommandBuffer->CmdBindDescriptorSet(mEffect->GetPipelineInterface(), 1, descriptorSets, VK_PIPELINE_BIND_POINT_GRAPHICS, 0);
+            commandBuffer->CmdBindDescriptorSet(mEffect->GetPipelineInterface(), 1, descriptorSets, VK_PIPELINE_BIND_POINT_GRAPHICS, 0);
 
-            mCommandBuffer->CmdBindVertexBuffer(0, 1, mScreenQuad.vertexBuffer);
-            mCommandBuffer->CmdBindIndexBuffer(mScreenQuad.indexBuffer->GetVkHandle(), 0, VK_INDEX_TYPE_UINT32);
-            mCommandBuffer->CmdDrawIndexed(6, 1, 0, 0, 0);
+            commandBuffer->CmdBindVertexBuffer(0, 1, mScreenQuad.vertexBuffer);
+            commandBuffer->CmdBindIndexBuffer(mScreenQuad.indexBuffer->GetVkHandle(), 0, VK_INDEX_TYPE_UINT32);
+            commandBuffer->CmdDrawIndexed(6, 1, 0, 0, 0);
          }
       }
 
-      mCommandBuffer->End();
+      commandBuffer->End();
    }
 
    SharedPtr<ScreenQuad> ScreenQuadRenderer::AddQuad(uint32_t left, uint32_t top, uint32_t width, uint32_t height, Utopian::Vk::Image* image, Utopian::Vk::Sampler* sampler, uint32_t layer)
@@ -61,7 +61,7 @@ namespace Utopian
 
       SharedPtr<Utopian::Vk::Effect> mEffect;
       SharedPtr<Utopian::Vk::DescriptorPool> mDescriptorPool;
-      SharedPtr<Utopian::Vk::CommandBuffer> mCommandBuffer;
+      std::vector<SharedPtr<Utopian::Vk::CommandBuffer>> mCommandBuffers;
       Utopian::Vk::VulkanApp* mVulkanApp;
 
       struct {
@@ -1,8 +1,12 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
 #include "SkinAnimator.h"
 #include "Model.h"
 #include "core/Log.h"
 #include "core/glTFLoader.h"
-#include "vulkan/handles/Buffer.h"
+#include "vulkan/handles/Device.h"
 
 // Todo: remove
 #include "vulkan/handles/DescriptorSetLayout.h"
@@ -10,24 +14,64 @@
 
 namespace Utopian
 {
+   std::set<SkinAnimator*> SkinAnimator::sStaleAnimators;
+   std::mutex SkinAnimator::sStaleAnimatorsMutex;
+
    SkinAnimator::SkinAnimator(tinygltf::Model& input, Model* model, Vk::Device* device)
    {
-      LoadSkins(input, model, device);
+      mDevice = device;
+
+      FlattenHierarchy(model);
+      LoadSkins(input, model);
       LoadAnimations(input, model);
    }
 
    SkinAnimator::~SkinAnimator()
    {
+      {
+         std::lock_guard<std::mutex> lock(sStaleAnimatorsMutex);
+         sStaleAnimators.erase(this);
+      }
+
+      for (auto& skin : mSkins)
+      {
+         if (skin.palette.IsValid())
+            gJointPalette().Free(skin.palette);
+      }
+   }
+
+   void SkinAnimator::FlattenHierarchy(Model* model)
+   {
+      for (Node* node : model->GetRootNodes())
+         FlattenNode(node, -1);
+
+      mGlobalMatrices.resize(mNodes.size());
+   }
+
+   void SkinAnimator::FlattenNode(Node* node, int32_t parentIndex)
+   {
+      uint32_t nodeIndex = (uint32_t)mNodes.size();
+      mNodes.push_back(node);
+      mParentIndices.push_back(parentIndex);
+
+      if (node->skin > -1)
+         mSkinnedNodes.push_back(nodeIndex);
 
+      for (Node* child : node->children)
+         FlattenNode(child, (int32_t)nodeIndex);
    }
 
-   void SkinAnimator::LoadSkins(tinygltf::Model& input, Model* model, Vk::Device* device)
+   void SkinAnimator::LoadSkins(tinygltf::Model& input, Model* model)
    {
+      std::unordered_map<Node*, uint32_t> flatIndices;
+      for (uint32_t i = 0; i < mNodes.size(); i++)
+         flatIndices[mNodes[i]] = i;
+
       mSkins.resize(input.skins.size());
 
       for (size_t i = 0; i < input.skins.size(); i++)
       {
-         tinygltf::Skin glTFSkin = input.skins[i];
+         const tinygltf::Skin& glTFSkin = input.skins[i];
 
          mSkins[i].name = glTFSkin.name;
          mSkins[i].skeletonRoot = model->NodeFromIndex(glTFSkin.skeleton);
@@ -39,6 +83,7 @@ namespace Utopian
             if (node)
             {
                mSkins[i].joints.push_back(node);
+               mSkins[i].jointNodes.push_back(flatIndices[node]);
             }
          }
 
@@ -51,15 +96,11 @@ namespace Utopian
             mSkins[i].inverseBindMatrices.resize(accessor.count);
             memcpy(mSkins[i].inverseBindMatrices.data(), &buffer.data[accessor.byteOffset + bufferView.byteOffset],
                    accessor.count * sizeof(glm::mat4));
-
-            Vk::BUFFER_CREATE_INFO createInfo;
-            createInfo.usageFlags = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
-            createInfo.memoryPropertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-            createInfo.data = mSkins[i].inverseBindMatrices.data();
-            createInfo.size = sizeof(glm::mat4) * mSkins[i].inverseBindMatrices.size();
-            createInfo.name = "SSBO jointMatrices " + mSkins[i].name;
-            mSkins[i].ssbo = std::make_shared<Vk::Buffer>(createInfo, device);
          }
+
+         // Joints without an inverse bind matrix use the identity
+         if (mSkins[i].inverseBindMatrices.size() < mSkins[i].joints.size())
+            mSkins[i].inverseBindMatrices.resize(mSkins[i].joints.size(), glm::mat4(1.0f));
       }
    }
 
@@ -69,7 +110,7 @@ namespace Utopian
 
       for (size_t i = 0; i < input.animations.size(); i++)
       {
-         tinygltf::Animation glTFAnimation = input.animations[i];
+         const tinygltf::Animation& glTFAnimation = input.animations[i];
 
          if (glTFAnimation.name != "")
             mAnimations[i].name = glTFAnimation.name;
@@ -77,12 +118,19 @@ namespace Utopian
             mAnimations[i].name = "animation_" + std::to_string(i);
 
          // Samplers
-         mAnimations[i].samplers.resize(glTFAnimation.samplers.size());
+         Animation& animation = mAnimations[i];
+         animation.samplers.resize(glTFAnimation.samplers.size());
          for (size_t j = 0; j < glTFAnimation.samplers.size(); j++)
          {
-            tinygltf::AnimationSampler glTFSampler = glTFAnimation.samplers[j];
-            AnimationSampler& dstSampler = mAnimations[i].samplers[j];
-            dstSampler.interpolation = glTFSampler.interpolation;
+            const tinygltf::AnimationSampler& glTFSampler = glTFAnimation.samplers[j];
+            AnimationSampler& dstSampler = animation.samplers[j];
+
+            if (glTFSampler.interpolation == "STEP")
+               dstSampler.interpolation = ANIMATION_INTERPOLATION_STEP;
+            else if (glTFSampler.interpolation == "CUBICSPLINE")
+               dstSampler.interpolation = ANIMATION_INTERPOLATION_CUBICSPLINE;
+            else
+               dstSampler.interpolation = ANIMATION_INTERPOLATION_LINEAR;
 
             // Read sampler keyframe input time values
             {
@@ -91,21 +139,14 @@ namespace Utopian
                const tinygltf::Buffer& buffer = input.buffers[bufferView.buffer];
                const void* dataPtr = &buffer.data[accessor.byteOffset + bufferView.byteOffset];
                const float* buf = static_cast<const float *>(dataPtr);
-               for (size_t index = 0; index < accessor.count; index++)
-               {
-                  dstSampler.inputs.push_back(buf[index]);
-               }
+               dstSampler.firstKey = (uint32_t)animation.keyTimes.size();
+               dstSampler.numKeys = (uint32_t)accessor.count;
+               animation.keyTimes.insert(animation.keyTimes.end(), buf, buf + accessor.count);
                // Adjust animation's start and end times
-               for (auto input : mAnimations[i].samplers[j].inputs)
+               for (size_t index = 0; index < accessor.count; index++)
                {
-                  if (input < mAnimations[i].start)
-                  {
-                     mAnimations[i].start = input;
-                  }
-                  if (input > mAnimations[i].end)
-                  {
-                     mAnimations[i].end = input;
-                  }
+                  animation.start = std::min(animation.start, buf[index]);
+                  animation.end = std::max(animation.end, buf[index]);
                }
             }
 
@@ -115,22 +156,21 @@ namespace Utopian
                const tinygltf::BufferView& bufferView = input.bufferViews[accessor.bufferView];
                const tinygltf::Buffer& buffer = input.buffers[bufferView.buffer];
                const void* dataPtr = &buffer.data[accessor.byteOffset + bufferView.byteOffset];
+               dstSampler.firstValue = (uint32_t)animation.keyValues.size();
+               animation.keyValues.reserve(animation.keyValues.size() + accessor.count);
                switch (accessor.type)
                {
                   case TINYGLTF_TYPE_VEC3: {
                      const glm::vec3 *buf = static_cast<const glm::vec3 *>(dataPtr);
                      for (size_t index = 0; index < accessor.count; index++)
                      {
-                        dstSampler.outputsVec4.push_back(glm::vec4(buf[index], 0.0f));
+                        animation.keyValues.push_back(glm::vec4(buf[index], 0.0f));
                      }
                      break;
                   }
                   case TINYGLTF_TYPE_VEC4: {
                      const glm::vec4 *buf = static_cast<const glm::vec4 *>(dataPtr);
-                     for (size_t index = 0; index < accessor.count; index++)
-                     {
-                        dstSampler.outputsVec4.push_back(buf[index]);
-                     }
+                     animation.keyValues.insert(animation.keyValues.end(), buf, buf + accessor.count);
                      break;
                   }
                   default: {
@@ -138,130 +178,237 @@ namespace Utopian
                      break;
                   }
                }
+
+               // Samplers without a value per keyframe are not evaluated
+               uint32_t valuesPerKey = (dstSampler.interpolation == ANIMATION_INTERPOLATION_CUBICSPLINE) ? 3u : 1u;
+               if (animation.keyValues.size() - dstSampler.firstValue < (size_t)dstSampler.numKeys * valuesPerKey)
+               {
+                  UTO_LOG("Animation sampler has too few output values");
+                  dstSampler.numKeys = 0;
+               }
             }
          }
 
-         // Channels
-         mAnimations[i].channels.resize(glTFAnimation.channels.size());
+         // Channels, the paths are resolved once here instead of on every update
+         animation.channels.reserve(glTFAnimation.channels.size());
          for (size_t j = 0; j < glTFAnimation.channels.size(); j++)
          {
-            tinygltf::AnimationChannel glTFChannel = glTFAnimation.channels[j];
-            AnimationChannel& dstChannel = mAnimations[i].channels[j];
-            dstChannel.path = glTFChannel.target_path;
+            const tinygltf::AnimationChannel& glTFChannel = glTFAnimation.channels[j];
+
+            AnimationChannel dstChannel;
             dstChannel.samplerIndex = glTFChannel.sampler;
             dstChannel.node = model->NodeFromIndex(glTFChannel.target_node);
+
+            if (glTFChannel.target_path == "translation")
+               dstChannel.path = ANIMATION_PATH_TRANSLATION;
+            else if (glTFChannel.target_path == "rotation")
+               dstChannel.path = ANIMATION_PATH_ROTATION;
+            else if (glTFChannel.target_path == "scale")
+               dstChannel.path = ANIMATION_PATH_SCALE;
+            else
+            {
+               UTO_LOG("Unsupported animation channel path: " + glTFChannel.target_path);
+               continue;
+            }
+
+            if (dstChannel.node == nullptr || animation.samplers[dstChannel.samplerIndex].numKeys == 0)
+               continue;
+
+            animation.channels.push_back(dstChannel);
          }
       }
    }
 
-   void SkinAnimator::UpdateAnimation(float deltaTime)
+   bool SkinAnimator::UpdateAnimation(float deltaTime)
    {
       if (mAnimations.size() == 0)
-         return;
+         return false;
 
       if (mActiveAnimation > static_cast<uint32_t>(mAnimations.size()) - 1)
       {
          UTO_LOG("No animation with index " + std::to_string(mActiveAnimation));
-         return;
+         return false;
       }
 
       if (GetPaused())
-         return;
+         return false;
 
       Animation &animation = mAnimations[mActiveAnimation];
       animation.currentTime += deltaTime;
       if (animation.currentTime > animation.end)
       {
-         animation.currentTime -= animation.end;
+         // Throttled models can advance by more than the duration of a short animation
+         animation.currentTime = animation.end > 0.0f ? std::fmod(animation.currentTime, animation.end) : 0.0f;
       }
 
-      for (auto &channel : animation.channels)
+      for (auto& channel : animation.channels)
+         SampleChannel(animation, channel, animation.currentTime);
+
+      return true;
+   }
+
+   void SkinAnimator::SampleChannel(const Animation& animation, AnimationChannel& channel, float time)
+   {
+      const AnimationSampler& sampler = animation.samplers[channel.samplerIndex];
+      const float* times = &animation.keyTimes[sampler.firstKey];
+      const glm::vec4* values = &animation.keyValues[sampler.firstValue];
+      const uint32_t lastKey = sampler.numKeys - 1;
+      const bool cubicSpline = (sampler.interpolation == ANIMATION_INTERPOLATION_CUBICSPLINE);
+
+      // The time only moves backwards when the animation wraps around, otherwise
+      // the cursor is at or just before the keyframe to use
+      uint32_t key = channel.keyCursor;
+      if (time < times[key])
+         key = 0;
+
+      while (key < lastKey && time >= times[key + 1])
+         key++;
+
+      channel.keyCursor = key;
+
+      glm::vec4 value;
+      if (key == lastKey || time <= times[key])
+      {
+         // Outside of the keyframes the first or last value is held
+         value = cubicSpline ? values[key * 3 + 1] : values[key];
+      }
+      else
       {
-         AnimationSampler &sampler = animation.samplers[channel.samplerIndex];
-         for (size_t i = 0; i < sampler.inputs.size() - 1; i++)
+         float duration = times[key + 1] - times[key];
+         float a = (time - times[key]) / duration;
+
+         switch (sampler.interpolation)
          {
-            if (sampler.interpolation != "LINEAR")
+            case ANIMATION_INTERPOLATION_STEP:
             {
-               UTO_LOG("This sample only supports linear interpolations");
-               continue;
+               value = values[key];
+               break;
             }
-
-            // Get the input keyframe values for the current time stamp
-            if ((animation.currentTime >= sampler.inputs[i]) && (animation.currentTime <= sampler.inputs[i + 1]))
+            case ANIMATION_INTERPOLATION_LINEAR:
             {
-               float a = (animation.currentTime - sampler.inputs[i]) / (sampler.inputs[i + 1] - sampler.inputs[i]);
-               if (channel.path == "translation")
-               {
-                  channel.node->translation = glm::mix(sampler.outputsVec4[i], sampler.outputsVec4[i + 1], a);
-               }
-               if (channel.path == "rotation")
-               {
-                  glm::quat q1;
-                  q1.x = sampler.outputsVec4[i].x;
-                  q1.y = sampler.outputsVec4[i].y;
-                  q1.z = sampler.outputsVec4[i].z;
-                  q1.w = sampler.outputsVec4[i].w;
-
-                  glm::quat q2;
-                  q2.x = sampler.outputsVec4[i + 1].x;
-                  q2.y = sampler.outputsVec4[i + 1].y;
-                  q2.z = sampler.outputsVec4[i + 1].z;
-                  q2.w = sampler.outputsVec4[i + 1].w;
-
-                  channel.node->rotation = glm::normalize(glm::slerp(q1, q2, a));
-               }
-               if (channel.path == "scale")
+               if (channel.path == ANIMATION_PATH_ROTATION)
                {
-                  channel.node->scale = glm::mix(sampler.outputsVec4[i], sampler.outputsVec4[i + 1], a);
+                  glm::quat q1(values[key].w, values[key].x, values[key].y, values[key].z);
+                  glm::quat q2(values[key + 1].w, values[key + 1].x, values[key + 1].y, values[key + 1].z);
+                  glm::quat q = glm::slerp(q1, q2, a);
+                  value = glm::vec4(q.x, q.y, q.z, q.w);
                }
+               else
+                  value = glm::mix(values[key], values[key + 1], a);
+               break;
+            }
+            case ANIMATION_INTERPOLATION_CUBICSPLINE:
+            {
+               // Hermite spline, the tangents are scaled by the duration of the keyframe
+               const glm::vec4* previous = &values[key * 3];
+               const glm::vec4* next = &values[(key + 1) * 3];
+               float a2 = a * a;
+               float a3 = a2 * a;
+               value = (2.0f * a3 - 3.0f * a2 + 1.0f) * previous[1] +
+                       (a3 - 2.0f * a2 + a) * duration * previous[2] +
+                       (-2.0f * a3 + 3.0f * a2) * next[1] +
+                       (a3 - a2) * duration * next[0];
+               break;
             }
          }
       }
+
+      switch (channel.path)
+      {
+         case ANIMATION_PATH_TRANSLATION:
+            channel.node->translation = glm::vec3(value);
+            break;
+         case ANIMATION_PATH_ROTATION:
+            channel.node->rotation = glm::normalize(glm::quat(value.w, value.x, value.y, value.z));
+            break;
+         case ANIMATION_PATH_SCALE:
+            channel.node->scale = glm::vec3(value);
+            break;
+      }
    }
 
-   void SkinAnimator::UpdateJoints(Node* node)
+   void SkinAnimator::UpdateGlobalMatrices()
    {
-      if (node->skin > -1)
+      // Parents come before their children so their global matrices are already up to date
+      for (size_t i = 0; i < mNodes.size(); i++)
       {
-         // Update the joint matrices
-         glm::mat4 inverseTransform = glm::inverse(GetNodeMatrix(node));
-         Skin skin = mSkins[node->skin];
-         size_t numJoints = (uint32_t) skin.joints.size();
-         std::vector<glm::mat4> jointMatrices(numJoints);
-         for (size_t i = 0; i < numJoints; i++)
-         {
-            jointMatrices[i] = GetNodeMatrix(skin.joints[i]) * skin.inverseBindMatrices[i];
-            jointMatrices[i] = inverseTransform * jointMatrices[i];
-         }
+         glm::mat4 localMatrix = mNodes[i]->GetLocalMatrix();
+         mGlobalMatrices[i] = (mParentIndices[i] < 0) ? localMatrix : mGlobalMatrices[mParentIndices[i]] * localMatrix;
+      }
+   }
+
+   void SkinAnimator::UpdateJoints()
+   {
+      UpdateGlobalMatrices();
+
+      const uint32_t frameIndex = (mDevice != nullptr) ? mDevice->GetFrameIndex() : 0u;
+      uint32_t numFrames = 0u;
 
-         skin.ssbo->UpdateMemory(jointMatrices.data(), jointMatrices.size() * sizeof(glm::mat4));
+      for (uint32_t nodeIndex : mSkinnedNodes)
+      {
+         Skin& skin = mSkins[mNodes[nodeIndex]->skin];
+
+         if (!skin.palette.IsValid())
+            continue;
+
+         glm::mat4 inverseTransform = glm::inverse(mGlobalMatrices[nodeIndex]);
+         for (size_t i = 0; i < skin.jointNodes.size(); i++)
+            skin.jointMatrices[i] = inverseTransform * mGlobalMatrices[skin.jointNodes[i]] * skin.inverseBindMatrices[i];
+
+         // The frame slot is not read by the GPU while it is recorded
+         memcpy(skin.paletteMemory[frameIndex], skin.jointMatrices.data(), skin.jointMatrices.size() * sizeof(glm::mat4));
+         numFrames = (uint32_t)skin.paletteMemory.size();
       }
 
-      for (auto& child : node->children)
+      if (numFrames > 1)
       {
-         UpdateJoints(child);
+         std::lock_guard<std::mutex> lock(sStaleAnimatorsMutex);
+
+         for (auto& skin : mSkins)
+         {
+            if (skin.palette.IsValid())
+               skin.staleFrames = ((1u << numFrames) - 1u) & ~(1u << frameIndex);
+         }
+
+         sStaleAnimators.insert(this);
       }
    }
 
-   glm::mat4 SkinAnimator::GetNodeMatrix(Node* node)
+   void SkinAnimator::RefreshStaleFrames(uint32_t frameIndex)
    {
-      glm::mat4 nodeMatrix = node->GetLocalMatrix();
-      Node* currentParent = node->parent;
+      std::lock_guard<std::mutex> lock(sStaleAnimatorsMutex);
 
-      while (currentParent)
+      for (auto iter = sStaleAnimators.begin(); iter != sStaleAnimators.end();)
       {
-         nodeMatrix = currentParent->GetLocalMatrix() * nodeMatrix;
-         currentParent = currentParent->parent;
-      }
+         uint32_t staleFrames = 0u;
+
+         for (auto& skin : (*iter)->mSkins)
+         {
+            if (skin.staleFrames & (1u << frameIndex))
+            {
+               memcpy(skin.paletteMemory[frameIndex], skin.jointMatrices.data(), skin.jointMatrices.size() * sizeof(glm::mat4));
+               skin.staleFrames &= ~(1u << frameIndex);
+            }
+
+            staleFrames |= skin.staleFrames;
+         }
 
-      return nodeMatrix;
+         if (staleFrames == 0u)
+            iter = sStaleAnimators.erase(iter);
+         else
+            iter++;
+      }
    }
 
-   VkDescriptorSet SkinAnimator::GetJointMatricesDescriptorSet(int32_t skin)
+   VkDescriptorSet SkinAnimator::GetJointMatricesDescriptorSet(int32_t skin, uint32_t frameIndex) const
    {
       assert(skin < mSkins.size());
 
-      return mSkins[skin].descriptorSet->GetVkHandle();
+      const Skin& animatorSkin = mSkins[skin];
+      if (animatorSkin.descriptorSets.empty())
+         return VK_NULL_HANDLE;
+
+      return animatorSkin.descriptorSets[frameIndex]->GetVkHandle();
    }
 
    uint32_t SkinAnimator::GetNumAnimations() const
@@ -307,16 +454,101 @@ namespace Utopian
 
    void SkinAnimator::CreateSkinningDescriptorSet(Vk::Device* device, Vk::DescriptorSetLayout* setLayout, Vk::DescriptorPool* pool)
    {
+      JointPalette& jointPalette = gJointPalette();
+
       for (auto& skin : mSkins)
       {
-         VkDescriptorBufferInfo descriptor;
-         descriptor.buffer = skin.ssbo->GetVkHandle();
-         descriptor.range = sizeof(glm::mat4) * skin.inverseBindMatrices.size();;
-         descriptor.offset = 0;
-
-         skin.descriptorSet = std::make_shared<Vk::DescriptorSet>(device, setLayout, pool);
-         skin.descriptorSet->BindStorageBuffer(0, &descriptor);
-         skin.descriptorSet->UpdateDescriptorSets();
+         skin.palette = jointPalette.Allocate((uint32_t)skin.jointNodes.size());
+
+         if (!skin.palette.IsValid())
+            continue;
+
+         const uint32_t numFrames = jointPalette.GetNumFrames();
+         skin.paletteMemory.resize(numFrames);
+         skin.descriptors.resize(numFrames);
+         skin.descriptorSets.resize(numFrames);
+         skin.jointMatrices.resize(skin.jointNodes.size());
+
+         for (uint32_t i = 0; i < numFrames; i++)
+         {
+            skin.paletteMemory[i] = jointPalette.GetMappedMemory(skin.palette, i);
+            skin.descriptors[i] = jointPalette.GetDescriptor(skin.palette, i);
+
+            skin.descriptorSets[i] = std::make_shared<Vk::DescriptorSet>(device, setLayout, pool);
+            skin.descriptorSets[i]->BindStorageBuffer(0, &skin.descriptors[i]);
+            skin.descriptorSets[i]->UpdateDescriptorSets();
+         }
+      }
+   }
+
+   std::vector<glm::mat4> SkinAnimator::BakeJointMatrices(uint32_t animationIndex, int32_t skin, float sampleRate, uint32_t& numFrames)
+   {
+      std::vector<glm::mat4> jointMatrices;
+      numFrames = 0;
+
+      if (animationIndex >= mAnimations.size() || skin < 0 || skin >= (int32_t)mSkins.size() || sampleRate <= 0.0f)
+      {
+         UTO_LOG("Cannot bake animation " + std::to_string(animationIndex) + " of skin " + std::to_string(skin));
+         return jointMatrices;
       }
+
+      Animation& animation = mAnimations[animationIndex];
+      const Skin& bakedSkin = mSkins[skin];
+
+      if (animation.end < animation.start)
+         return jointMatrices;
+
+      // Sampling writes to the nodes, the pose is restored when done
+      struct NodePose
+      {
+         glm::vec3 translation;
+         glm::quat rotation;
+         glm::vec3 scale;
+      };
+
+      std::vector<NodePose> poses(mNodes.size());
+      for (size_t i = 0; i < mNodes.size(); i++)
+         poses[i] = { mNodes[i]->translation, mNodes[i]->rotation, mNodes[i]->scale };
+
+      // The last frame is followed by the first one when the animation loops
+      numFrames = std::max((uint32_t)std::ceil((animation.end - animation.start) * sampleRate), 1u);
+      jointMatrices.resize((size_t)numFrames * bakedSkin.jointNodes.size());
+
+      for (uint32_t frame = 0; frame < numFrames; frame++)
+      {
+         const float time = animation.start + frame / sampleRate;
+         for (auto& channel : animation.channels)
+            SampleChannel(animation, channel, time);
+
+         UpdateGlobalMatrices();
+
+         glm::mat4* frameMatrices = &jointMatrices[(size_t)frame * bakedSkin.jointNodes.size()];
+         for (size_t i = 0; i < bakedSkin.jointNodes.size(); i++)
+            frameMatrices[i] = mGlobalMatrices[bakedSkin.jointNodes[i]] * bakedSkin.inverseBindMatrices[i];
+      }
+
+      for (size_t i = 0; i < mNodes.size(); i++)
+      {
+         mNodes[i]->translation = poses[i].translation;
+         mNodes[i]->rotation = poses[i].rotation;
+         mNodes[i]->scale = poses[i].scale;
+      }
+
+      for (auto& channel : animation.channels)
+         channel.keyCursor = 0;
+
+      return jointMatrices;
+   }
+
+   uint32_t SkinAnimator::GetNumSkins() const
+   {
+      return (uint32_t)mSkins.size();
+   }
+
+   uint32_t SkinAnimator::GetNumJoints(int32_t skin) const
+   {
+      assert(skin < mSkins.size());
+
+      return (uint32_t)mSkins[skin].jointNodes.size();
    }
 }
@@ -1,9 +1,12 @@
 #pragma once
 
+#include <mutex>
+#include <set>
 #include <string>
 #include <vector>
 #include <glm/glm.hpp>
 #include "tinygltf/tiny_gltf.h"
+#include "core/renderer/JointPalette.h"
 #include "vulkan/VulkanPrerequisites.h"
 #include "utility/Common.h"
 
@@ -13,6 +16,20 @@ namespace Utopian
    class glTFLoader;
    struct Node;
 
+   enum AnimationPath
+   {
+      ANIMATION_PATH_TRANSLATION,
+      ANIMATION_PATH_ROTATION,
+      ANIMATION_PATH_SCALE
+   };
+
+   enum AnimationInterpolation
+   {
+      ANIMATION_INTERPOLATION_LINEAR,
+      ANIMATION_INTERPOLATION_STEP,
+      ANIMATION_INTERPOLATION_CUBICSPLINE
+   };
+
    class SkinAnimator
    {
    public:
@@ -22,22 +39,41 @@ namespace Utopian
          Node* skeletonRoot = nullptr;
          std::vector<glm::mat4> inverseBindMatrices;
          std::vector<Node*> joints;
-         SharedPtr<Vk::Buffer> ssbo;
-         SharedPtr<Vk::DescriptorSet> descriptorSet;
+
+         /** Indices of the joints in the flattened node hierarchy. */
+         std::vector<uint32_t> jointNodes;
+
+         /** The joint matrices have the same offset in the palette buffer of every frame slot. */
+         JointPalette::Allocation palette;
+         std::vector<glm::mat4*> paletteMemory;
+         std::vector<VkDescriptorBufferInfo> descriptors;
+         std::vector<SharedPtr<Vk::DescriptorSet>> descriptorSets;
+
+         /** The latest pose, copied to the frame slots in staleFrames by RefreshStaleFrames(). */
+         std::vector<glm::mat4> jointMatrices;
+         uint32_t staleFrames = 0u;
       };
 
+      /**
+       * Range of keyframes in the time and value arrays of the animation.
+       * Cubic spline samplers store an in-tangent, the value and an out-tangent per keyframe.
+       */
       struct AnimationSampler
       {
-         std::string interpolation;
-         std::vector<float> inputs;
-         std::vector<glm::vec4> outputsVec4;
+         AnimationInterpolation interpolation;
+         uint32_t firstKey;
+         uint32_t numKeys;
+         uint32_t firstValue;
       };
 
       struct AnimationChannel
       {
-         std::string path;
+         AnimationPath path;
          Node* node;
          uint32_t samplerIndex;
+
+         /** Keyframe that the time was at during the previous update, the search continues from it. */
+         uint32_t keyCursor = 0;
       };
 
       struct Animation
@@ -45,22 +81,45 @@ namespace Utopian
          std::string name;
          std::vector<AnimationSampler> samplers;
          std::vector<AnimationChannel> channels;
+
+         // Keyframes of all samplers stored after each other, see AnimationSampler
+         std::vector<float> keyTimes;
+         std::vector<glm::vec4> keyValues;
+
          float start = std::numeric_limits<float>::max();
          float end = std::numeric_limits<float>::min();
          float currentTime = 0.0f;
       };
 
+      /**
+       * The node hierarchy of the model must have been created. The device is only used by
+       * CreateSkinningDescriptorSet(), without one the pose is evaluated but not written anywhere.
+       */
       SkinAnimator(tinygltf::Model& input, Model* model, Vk::Device* device);
       ~SkinAnimator();
 
-      void LoadSkins(tinygltf::Model& input, Model* model, Vk::Device* device);
+      void LoadSkins(tinygltf::Model& input, Model* model);
       void LoadAnimations(tinygltf::Model& input, Model* model);
 
-      void UpdateAnimation(float deltaTime);
-      void UpdateJoints(Node* node);
-      glm::mat4 GetNodeMatrix(Node* node);
+      /** Returns true if the pose changed, i.e. an animation is active and not paused. */
+      bool UpdateAnimation(float deltaTime);
 
-      VkDescriptorSet GetJointMatricesDescriptorSet(int32_t skin);
+      /**
+       * Computes the global matrices of all nodes in one pass over the flattened hierarchy and writes
+       * the joint matrices of every skin to the palette of the current frame slot. The other slots
+       * are still read by the GPU and get the pose from RefreshStaleFrames().
+       * Animators of different models can be updated in parallel.
+       */
+      void UpdateJoints();
+
+      /**
+       * Copies the latest pose to the frame slot of every animator that has not written it since
+       * the pose changed. Must be called once the GPU is done with the frame slot.
+       */
+      static void RefreshStaleFrames(uint32_t frameIndex);
+
+      /** Returns the descriptor set of the joint matrices in the frame slot, see Vk::Device::GetFrameIndex(). */
+      VkDescriptorSet GetJointMatricesDescriptorSet(int32_t skin, uint32_t frameIndex) const;
       uint32_t GetNumAnimations() const;
       uint32_t GetActiveAnimation() const;
       std::string GetAnimationName(uint32_t index) const;
@@ -69,12 +128,46 @@ namespace Utopian
       void SetAnimation(uint32_t index);
       void SetPaused(bool paused);
 
+      /** Allocates the joint matrices of the skins from the JointPalette, one descriptor set per frame slot. */
       void CreateSkinningDescriptorSet(Vk::Device* device, Vk::DescriptorSetLayout* setLayout, Vk::DescriptorPool* pool);
 
+      /**
+       * Samples the animation at a fixed rate from its first to its last keyframe and returns the model space
+       * joint matrices of the skin, numFrames * numJoints matrices with the joints of a frame after each other.
+       * The pose of the nodes is restored afterwards, the joint palette is not written.
+       */
+      std::vector<glm::mat4> BakeJointMatrices(uint32_t animationIndex, int32_t skin, float sampleRate, uint32_t& numFrames);
+
+      uint32_t GetNumSkins() const;
+      uint32_t GetNumJoints(int32_t skin) const;
+
    private:
+      /** Evaluates the sampler of the channel at time and writes the result to the node. */
+      void SampleChannel(const Animation& animation, AnimationChannel& channel, float time);
+
+      /** Orders the nodes of the model so that every parent comes before its children. */
+      void FlattenHierarchy(Model* model);
+      void FlattenNode(Node* node, int32_t parentIndex);
+
+      /** Computes the global matrices of all nodes, parents come before their children in mNodes. */
+      void UpdateGlobalMatrices();
+
+   private:
+      Vk::Device* mDevice;
       std::vector<Skin> mSkins;
+
+      // Flattened node hierarchy, see FlattenHierarchy()
+      std::vector<Node*> mNodes;
+      std::vector<int32_t> mParentIndices;
+      std::vector<glm::mat4> mGlobalMatrices;
+      std::vector<uint32_t> mSkinnedNodes;
+
       std::vector<Animation> mAnimations;
       uint32_t mActiveAnimation = 0;
       bool mPaused = false;
+
+      // Animators with frame slots that do not contain the latest pose
+      static std::set<SkinAnimator*> sStaleAnimators;
+      static std::mutex sStaleAnimatorsMutex;
    };
 }
\ No newline at end of file
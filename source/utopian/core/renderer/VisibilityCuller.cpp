@@ -0,0 +1,242 @@
+#include <algorithm>
+#include "core/renderer/VisibilityCuller.h"
+#include "core/renderer/Renderer.h"
+#include "core/renderer/Renderable.h"
+#include "core/renderer/Model.h"
+#include "core/renderer/RenderSettings.h"
+#include "core/Camera.h"
+#include "utility/math/Helpers.h"
+#include "vulkan/TextureLoader.h"
+
+namespace Utopian
+{
+   // The physical representation is the negated render space, so are the frustum planes
+   static Frustum ToPhysicalSpace(const Frustum& frustum)
+   {
+      Frustum physicalFrustum = frustum;
+      for (auto& plane : physicalFrustum.planes)
+         plane = glm::vec4(-glm::vec3(plane), plane.w);
+
+      return physicalFrustum;
+   }
+
+   VisibilityCuller::VisibilityCuller(Renderer* renderer)
+   {
+      mSceneInfo = renderer->GetSceneInfo();
+      mNumVisibleInstances = 0u;
+      mDirtyRenderables.reserve(64);
+   }
+
+   VisibilityCuller::~VisibilityCuller()
+   {
+
+   }
+
+   void VisibilityCuller::Cull(const Camera* camera, const RenderingSettings& renderingSettings)
+   {
+      RefitBvh();
+
+      mSceneInfo->mainView.Clear();
+      mSceneInfo->foliagePushers.clear();
+
+      for (uint32_t i = 0; i < SHADOW_MAP_CASCADE_COUNT; i++)
+      {
+         mSceneInfo->cascadeViews[i].Clear();
+         mCascadeFrustums[i].Update(mSceneInfo->cascades[i].viewProjMatrix);
+      }
+
+      const Frustum& cameraFrustum = camera->GetFrustum();
+      const bool culling = renderingSettings.frustumCulling;
+
+      if (culling)
+      {
+         // The BVH is in physical space and the frustums in render space
+         mBvh.QueryFrustum(ToPhysicalSpace(cameraFrustum), true, [&](void* userData) {
+            Renderable* renderable = static_cast<Renderable*>(userData);
+            if (renderable->IsVisible())
+               mSceneInfo->mainView.renderables.push_back(renderable);
+         });
+
+         // Casters outside of the cascade depth range can still cast shadows into it
+         for (uint32_t i = 0; i < SHADOW_MAP_CASCADE_COUNT; i++)
+         {
+            mBvh.QueryFrustum(ToPhysicalSpace(mCascadeFrustums[i]), false, [&](void* userData) {
+               Renderable* renderable = static_cast<Renderable*>(userData);
+               if (renderable->IsVisible() && renderable->HasRenderFlags(RENDER_FLAG_CAST_SHADOW))
+                  mSceneInfo->cascadeViews[i].renderables.push_back(renderable);
+            });
+         }
+      }
+      else
+      {
+         for (auto& renderable : mSceneInfo->renderables)
+         {
+            if (!renderable->IsVisible() || renderable->GetModel() == nullptr)
+               continue;
+
+            mSceneInfo->mainView.renderables.push_back(renderable);
+
+            if (!renderable->HasRenderFlags(RENDER_FLAG_CAST_SHADOW))
+               continue;
+
+            for (uint32_t i = 0; i < SHADOW_MAP_CASCADE_COUNT; i++)
+               mSceneInfo->cascadeViews[i].renderables.push_back(renderable);
+         }
+      }
+
+      mBvh.QuerySphere(camera->GetPosition(), FOLIAGE_PUSH_RADIUS, [&](void* userData) {
+         Renderable* renderable = static_cast<Renderable*>(userData);
+         if (renderable->IsPushingFoliage())
+            mSceneInfo->foliagePushers.push_back(renderable);
+      });
+
+      for (auto& instanceGroup : mSceneInfo->instanceGroups)
+      {
+         if (instanceGroup->GetNumInstances() == 0 || instanceGroup->GetBuffer() == nullptr)
+            continue;
+
+         if (!culling)
+         {
+            VisibleInstanceGroup allInstances = { instanceGroup.get(), instanceGroup->GetBuffer(), instanceGroup->GetNumInstances() };
+            mSceneInfo->mainView.instanceGroups.push_back(allInstances);
+
+            if (instanceGroup->IsCastingShadows())
+            {
+               for (uint32_t i = 0; i < SHADOW_MAP_CASCADE_COUNT; i++)
+                  mSceneInfo->cascadeViews[i].instanceGroups.push_back(allInstances);
+            }
+
+            continue;
+         }
+
+         // The group bounding box rejects whole groups before the grid cells are tested
+         const glm::vec3& min = instanceGroup->GetBoundsMin();
+         const glm::vec3& max = instanceGroup->GetBoundsMax();
+
+         if (cameraFrustum.CheckBox(min, max))
+            AddVisibleInstances(instanceGroup.get(), INSTANCE_MAIN_VIEW, cameraFrustum, true, mSceneInfo->mainView);
+
+         if (!instanceGroup->IsCastingShadows())
+            continue;
+
+         for (uint32_t i = 0; i < SHADOW_MAP_CASCADE_COUNT; i++)
+         {
+            if (mCascadeFrustums[i].CheckBox(min, max, false))
+               AddVisibleInstances(instanceGroup.get(), i + 1, mCascadeFrustums[i], false, mSceneInfo->cascadeViews[i]);
+         }
+      }
+
+      mNumVisibleInstances = 0u;
+      for (const VisibleInstanceGroup& visibleGroup : mSceneInfo->mainView.instanceGroups)
+         mNumVisibleInstances += visibleGroup.numInstances;
+
+      // The texture loader evicts the textures that have not been visible for a while
+      const uint64_t frameNumber = Vk::gTextureLoader().GetFrameNumber();
+      MarkTexturesUsed(mSceneInfo->mainView, frameNumber);
+      for (uint32_t i = 0; i < SHADOW_MAP_CASCADE_COUNT; i++)
+         MarkTexturesUsed(mSceneInfo->cascadeViews[i], frameNumber);
+   }
+
+   void VisibilityCuller::MarkTexturesUsed(const VisibilityList& visibilityList, uint64_t frameNumber)
+   {
+      for (Renderable* renderable : visibilityList.renderables)
+         renderable->GetModel()->MarkTexturesUsed(frameNumber);
+
+      for (const VisibleInstanceGroup& visibleGroup : visibilityList.instanceGroups)
+      {
+         if (Model* model = visibleGroup.instanceGroup->GetModel())
+            model->MarkTexturesUsed(frameNumber);
+      }
+   }
+
+   void VisibilityCuller::AddVisibleInstances(InstanceGroup* instanceGroup, uint32_t viewIndex, const Frustum& frustum,
+                                              bool checkDepth, VisibilityList& visibilityList)
+   {
+      uint32_t numVisible = instanceGroup->CullInstances(viewIndex, frustum, checkDepth);
+
+      if (numVisible > 0)
+      {
+         VisibleInstanceGroup visibleGroup = { instanceGroup, instanceGroup->GetVisibleBuffer(viewIndex), numVisible };
+         visibilityList.instanceGroups.push_back(visibleGroup);
+      }
+   }
+
+   void VisibilityCuller::AddRenderable(Renderable* renderable)
+   {
+      InvalidateBounds(renderable);
+   }
+
+   void VisibilityCuller::RemoveRenderable(Renderable* renderable)
+   {
+      if (renderable->GetBvhProxy() != DynamicBvh::NULL_NODE)
+      {
+         mBvh.DestroyProxy(renderable->GetBvhProxy());
+         renderable->SetBvhProxy(DynamicBvh::NULL_NODE);
+      }
+
+      if (renderable->IsBoundsDirty())
+      {
+         mDirtyRenderables.erase(std::remove(mDirtyRenderables.begin(), mDirtyRenderables.end(), renderable), mDirtyRenderables.end());
+         renderable->SetBoundsDirty(false);
+      }
+   }
+
+   void VisibilityCuller::InvalidateBounds(Renderable* renderable)
+   {
+      if (!renderable->IsBoundsDirty())
+      {
+         renderable->SetBoundsDirty(true);
+         mDirtyRenderables.push_back(renderable);
+      }
+   }
+
+   const DynamicBvh& VisibilityCuller::GetBvh()
+   {
+      RefitBvh();
+
+      return mBvh;
+   }
+
+   void VisibilityCuller::RefitBvh()
+   {
+      for (auto& renderable : mDirtyRenderables)
+      {
+         renderable->SetBoundsDirty(false);
+
+         // Renderables without a model are added once SetModel() invalidates them again
+         if (renderable->GetModel() == nullptr)
+            continue;
+
+         glm::vec3 min, max;
+         GetPhysicalBounds(renderable, min, max);
+
+         if (renderable->GetBvhProxy() == DynamicBvh::NULL_NODE)
+            renderable->SetBvhProxy(mBvh.CreateProxy(min, max, renderable));
+         else
+            mBvh.MoveProxy(renderable->GetBvhProxy(), min, max);
+      }
+
+      mDirtyRenderables.clear();
+   }
+
+   void VisibilityCuller::GetPhysicalBounds(Renderable* renderable, glm::vec3& min, glm::vec3& max) const
+   {
+      const BoundingBox& modelBox = renderable->GetModel()->GetBoundingBox();
+      Math::TransformAabb(renderable->GetWorldMatrix(), modelBox.GetMin(), modelBox.GetMax(), min, max);
+   }
+
+   uint32_t VisibilityCuller::GetNumVisibleRenderables() const
+   {
+      return (uint32_t)mSceneInfo->mainView.renderables.size();
+   }
+
+   uint32_t VisibilityCuller::GetNumVisibleInstanceGroups() const
+   {
+      return (uint32_t)mSceneInfo->mainView.instanceGroups.size();
+   }
+
+   uint32_t VisibilityCuller::GetNumVisibleInstances() const
+   {
+      return mNumVisibleInstances;
+   }
+}
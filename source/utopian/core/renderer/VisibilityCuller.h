@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "core/renderer/SceneInfo.h"
+#include "utility/math/Frustum.h"
+#include "utility/math/DynamicBvh.h"
+
+// Renderables further away from the camera than this don't push the foliage
+#define FOLIAGE_PUSH_RADIUS 200.0f
+
+namespace Utopian
+{
+   class Renderer;
+   class Camera;
+   struct RenderingSettings;
+
+   /**
+    * Culls the scene against the main camera and the shadow cascades once per frame.
+    * The result is written to the visibility lists in SceneInfo that the jobs consume.
+    * The renderables are kept in a BVH that is refitted when their transforms change.
+    */
+   class VisibilityCuller
+   {
+   public:
+      VisibilityCuller(Renderer* renderer);
+      ~VisibilityCuller();
+
+      /** Fills SceneInfo::mainView, SceneInfo::cascadeViews and SceneInfo::foliagePushers. */
+      void Cull(const Camera* camera, const RenderingSettings& renderingSettings);
+
+      void AddRenderable(Renderable* renderable);
+      void RemoveRenderable(Renderable* renderable);
+
+      /** Queues the renderable for refitting in the BVH. */
+      void InvalidateBounds(Renderable* renderable);
+
+      /** Returns the BVH with the physical space bounds of all renderables, refitted if needed. */
+      const DynamicBvh& GetBvh();
+
+      uint32_t GetNumVisibleRenderables() const;
+      uint32_t GetNumVisibleInstanceGroups() const;
+      uint32_t GetNumVisibleInstances() const;
+
+   private:
+      /** Updates the BVH proxies of all renderables that have been invalidated. */
+      void RefitBvh();
+
+      /** Returns the world space bounding box of the renderable in physical space. */
+      void GetPhysicalBounds(Renderable* renderable, glm::vec3& min, glm::vec3& max) const;
+
+      /** Compacts the instances inside the frustum and adds them to the visibility list. */
+      void AddVisibleInstances(InstanceGroup* instanceGroup, uint32_t viewIndex, const Frustum& frustum,
+                               bool checkDepth, VisibilityList& visibilityList);
+
+      /** Keeps the textures of the visible models from being evicted by Vk::TextureLoader. */
+      void MarkTexturesUsed(const VisibilityList& visibilityList, uint64_t frameNumber);
+
+   private:
+      SceneInfo* mSceneInfo;
+      DynamicBvh mBvh;
+      std::vector<Renderable*> mDirtyRenderables;
+      std::array<Frustum, SHADOW_MAP_CASCADE_COUNT> mCascadeFrustums;
+      uint32_t mNumVisibleInstances;
+   };
+}
@@ -13,6 +13,7 @@ namespace Utopian
    class Camera;
    class BaseJob;
    class PerlinTerrain; 
+   class ParallelRecorder;
 
    struct GBuffer
    {
@@ -31,14 +32,18 @@ namespace Utopian
 
    struct JobInput
    {
-      JobInput(const SceneInfo& sceneInfo, const std::vector<BaseJob*>& jobs, const RenderingSettings& renderingSettings) 
-         : sceneInfo(sceneInfo), jobs(jobs) , renderingSettings(renderingSettings) {
+      JobInput(const SceneInfo& sceneInfo, const std::vector<BaseJob*>& jobs, const RenderingSettings& renderingSettings,
+               ParallelRecorder* parallelRecorder = nullptr)
+         : sceneInfo(sceneInfo), jobs(jobs) , renderingSettings(renderingSettings), parallelRecorder(parallelRecorder) {
 
       }
 
       const SceneInfo& sceneInfo;
       const std::vector<BaseJob*>& jobs;
       const RenderingSettings& renderingSettings;
+
+      // Set when jobs are recorded in parallel, large passes can use it to split their draw lists
+      ParallelRecorder* parallelRecorder;
    };
 
    class BaseJob
@@ -67,7 +72,14 @@ namespace Utopian
       virtual void Init(const std::vector<BaseJob*>& jobs, const GBuffer& gbuffer) = 0;
       virtual void PostInit(const std::vector<BaseJob*>& jobs, const GBuffer& gbuffer) {};
 
+      /** Called serially on the main thread before any job is rendered. */
       virtual void PreRender(const JobInput& jobInput) {};
+
+      /**
+       * Records and submits the job's command buffers.
+       * @note Can be called from a worker thread concurrently with other jobs, see RenderingSettings::parallelRecording.
+       * Work that is not thread safe belongs in PreRender().
+       */
       virtual void Render(const JobInput& jobInput) = 0;
       virtual void Update(double deltaTime) {};
 
@@ -54,21 +54,19 @@ namespace Utopian
       Vk::CommandBuffer* commandBuffer = mRenderTarget->GetCommandBuffer();
 
       /* Render all renderables */
-      for (auto& renderable : jobInput.sceneInfo.renderables)
+      for (auto& renderable : jobInput.sceneInfo.mainView.renderables)
       {
          if (!renderable->IsVisible())
             continue;
 
-         Model* model = renderable->GetModel();
-         std::vector<RenderCommand> renderCommands;
-         model->GetRenderCommands(renderCommands, renderable->GetTransform().GetWorldMatrix());
+         const std::vector<RenderCommand>& renderCommands = renderable->GetRenderCommands();
 
          if (renderable->HasRenderFlags(RENDER_FLAG_COLOR))
          {
             commandBuffer->CmdBindPipeline(mColorEffect->GetPipeline());
             commandBuffer->CmdBindDescriptorSets(mColorEffect);
 
-            for (RenderCommand& command : renderCommands)
+            for (const RenderCommand& command : renderCommands)
             {
                Vk::PushConstantBlock pushConsts(command.world, renderable->GetColor());
                commandBuffer->CmdPushConstants(mColorEffect->GetPipelineInterface(), VK_SHADER_STAGE_ALL, sizeof(pushConsts), &pushConsts);
@@ -85,7 +83,7 @@ namespace Utopian
             commandBuffer->CmdBindPipeline(mNormalEffect->GetPipeline());
             commandBuffer->CmdBindDescriptorSets(mNormalEffect);
 
-            for (RenderCommand& command : renderCommands)
+            for (const RenderCommand& command : renderCommands)
             {
                Vk::PushConstantBlock pushConsts(command.world, renderable->GetColor());
                commandBuffer->CmdPushConstants(mNormalEffect->GetPipelineInterface(), VK_SHADER_STAGE_ALL, sizeof(pushConsts), &pushConsts);
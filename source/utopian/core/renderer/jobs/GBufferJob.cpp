@@ -1,6 +1,8 @@
 #include "core/renderer/jobs/GBufferJob.h"
 #include "core/renderer/CommonJobIncludes.h"
 #include "core/renderer/Model.h"
+#include "core/renderer/BakedAnimation.h"
+#include "core/renderer/ParallelRecorder.h"
 #include "core/Camera.h"
 #include "vulkan/Debug.h"
 #include "vulkan/handles/Queue.h"
@@ -60,12 +62,18 @@ namespace Utopian
          mGBufferEffectSkinning = Vk::gEffectManager().AddEffect<Vk::Effect>(mDevice, mRenderTarget->GetRenderPass(), effectDescSkinning);
 
          // Override vertex description for instancing shaders
-         SharedPtr<Vk::VertexDescription> vertexDescription = std::make_shared<Vk::VertexDescription>(Vk::Vertex::GetDescription());
-         vertexDescription->AddBinding(BINDING_1, sizeof(InstanceDataGPU), VK_VERTEX_INPUT_RATE_INSTANCE);
-         vertexDescription->AddAttribute(BINDING_1, Vk::Vec4Attribute());  // Location 0 : InInstanceWorld
-         vertexDescription->AddAttribute(BINDING_1, Vk::Vec4Attribute());  // Location 1 : InInstanceWorld
-         vertexDescription->AddAttribute(BINDING_1, Vk::Vec4Attribute());  // Location 2 : InInstanceWorld
-         vertexDescription->AddAttribute(BINDING_1, Vk::Vec4Attribute());  // Location 3 : InInstanceWorld
+         auto createInstancingDescription = [](const Vk::VertexDescription& meshDescription) {
+            SharedPtr<Vk::VertexDescription> vertexDescription = std::make_shared<Vk::VertexDescription>(meshDescription);
+            vertexDescription->AddBinding(BINDING_1, sizeof(InstanceDataGPU), VK_VERTEX_INPUT_RATE_INSTANCE);
+            vertexDescription->AddAttribute(BINDING_1, Vk::Vec4Attribute());  // Location 0 : InInstanceWorld
+            vertexDescription->AddAttribute(BINDING_1, Vk::Vec4Attribute());  // Location 1 : InInstanceWorld
+            vertexDescription->AddAttribute(BINDING_1, Vk::Vec4Attribute());  // Location 2 : InInstanceWorld
+            vertexDescription->AddAttribute(BINDING_1, Vk::Vec4Attribute());  // Location 3 : InInstanceWorld
+            return vertexDescription;
+         };
+
+         SharedPtr<Vk::VertexDescription> vertexDescription = createInstancingDescription(Vk::Vertex::GetDescription());
+         SharedPtr<Vk::VertexDescription> compactVertexDescription = createInstancingDescription(Vk::CompactVertex::GetDescription());
 
          Vk::EffectCreateInfo effectDescInstancingAnimation;
          effectDescInstancingAnimation.shaderDesc.vertexShaderPath = "data/shaders/gbuffer/gbuffer_instancing_animation.vert";
@@ -80,6 +88,25 @@ namespace Utopian
          effectDescInstancing.pipelineDesc.rasterizationState.cullMode = VK_CULL_MODE_NONE;
          effectDescInstancing.pipelineDesc.OverrideVertexInput(vertexDescription);
          mGBufferEffectInstanced = Vk::gEffectManager().AddEffect<Vk::Effect>(mDevice, mRenderTarget->GetRenderPass(), effectDescInstancing);
+
+         // Variants for primitives with the compact vertex layout
+         effectDescInstancingAnimation.shaderDesc.vertexShaderPath = "data/shaders/gbuffer/gbuffer_instancing_animation_compact.vert";
+         effectDescInstancingAnimation.pipelineDesc.OverrideVertexInput(compactVertexDescription);
+         mInstancedAnimationEffectCompact = Vk::gEffectManager().AddEffect<Vk::Effect>(mDevice, mRenderTarget->GetRenderPass(), effectDescInstancingAnimation);
+
+         effectDescInstancing.shaderDesc.vertexShaderPath = "data/shaders/gbuffer/gbuffer_instancing_compact.vert";
+         effectDescInstancing.pipelineDesc.OverrideVertexInput(compactVertexDescription);
+         mGBufferEffectInstancedCompact = Vk::gEffectManager().AddEffect<Vk::Effect>(mDevice, mRenderTarget->GetRenderPass(), effectDescInstancing);
+
+         // Skinned instances also read the phase into the baked animation
+         SharedPtr<Vk::VertexDescription> skinningVertexDescription = createInstancingDescription(Vk::Vertex::GetDescription());
+         skinningVertexDescription->AddAttribute(BINDING_1, Vk::FloatAttribute()); // Location 4 : InInstanceAnimationPhase
+
+         Vk::EffectCreateInfo effectDescInstancingSkinning;
+         effectDescInstancingSkinning.shaderDesc.vertexShaderPath = "data/shaders/gbuffer/gbuffer_instancing_skinning.vert";
+         effectDescInstancingSkinning.shaderDesc.fragmentShaderPath = "data/shaders/gbuffer/gbuffer.frag";
+         effectDescInstancingSkinning.pipelineDesc.OverrideVertexInput(skinningVertexDescription);
+         mGBufferEffectInstancedSkinning = Vk::gEffectManager().AddEffect<Vk::Effect>(mDevice, mRenderTarget->GetRenderPass(), effectDescInstancingSkinning);
       };
 
       loadShaders();
@@ -105,6 +132,9 @@ namespace Utopian
       mGBufferEffectSkinning->BindUniformBuffer("UBO_sharedVariables", gRenderer().GetSharedShaderVariables());
       mInstancedAnimationEffect->BindUniformBuffer("UBO_sharedVariables", gRenderer().GetSharedShaderVariables());
       mGBufferEffectInstanced->BindUniformBuffer("UBO_sharedVariables", gRenderer().GetSharedShaderVariables());
+      mInstancedAnimationEffectCompact->BindUniformBuffer("UBO_sharedVariables", gRenderer().GetSharedShaderVariables());
+      mGBufferEffectInstancedCompact->BindUniformBuffer("UBO_sharedVariables", gRenderer().GetSharedShaderVariables());
+      mGBufferEffectInstancedSkinning->BindUniformBuffer("UBO_sharedVariables", gRenderer().GetSharedShaderVariables());
       mGBufferEffectWireframe->BindUniformBuffer("UBO_sharedVariables", gRenderer().GetSharedShaderVariables());
 
       mSettingsBlock.Create(mDevice, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
@@ -113,15 +143,21 @@ namespace Utopian
       mGBufferEffectWireframe->BindUniformBuffer("UBO_settings", mSettingsBlock);
       mInstancedAnimationEffect->BindUniformBuffer("UBO_settings", mSettingsBlock);
       mGBufferEffectInstanced->BindUniformBuffer("UBO_settings", mSettingsBlock);
+      mInstancedAnimationEffectCompact->BindUniformBuffer("UBO_settings", mSettingsBlock);
+      mGBufferEffectInstancedCompact->BindUniformBuffer("UBO_settings", mSettingsBlock);
+      mGBufferEffectInstancedSkinning->BindUniformBuffer("UBO_settings", mSettingsBlock);
 
       mFoliageSpheresBlock.Create(mDevice, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
       mInstancedAnimationEffect->BindUniformBuffer("UBO_sphereList", mFoliageSpheresBlock);
+      mInstancedAnimationEffectCompact->BindUniformBuffer("UBO_sphereList", mFoliageSpheresBlock);
 
       mAnimationParametersBlock.Create(mDevice, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
       mInstancedAnimationEffect->BindUniformBuffer("UBO_animationParameters", mAnimationParametersBlock);
+      mInstancedAnimationEffectCompact->BindUniformBuffer("UBO_animationParameters", mAnimationParametersBlock);
 
       mWindmapTexture = Vk::gTextureLoader().LoadTexture("data/textures/windmap.jpg");
       mInstancedAnimationEffect->BindCombinedImage("windmapSampler", *mWindmapTexture);
+      mInstancedAnimationEffectCompact->BindCombinedImage("windmapSampler", *mWindmapTexture);
    }
 
    void GBufferJob::Render(const JobInput& jobInput)
@@ -140,119 +176,191 @@ namespace Utopian
       mAnimationParametersBlock.data.enabled = jobInput.renderingSettings.windEnabled;
       mAnimationParametersBlock.UpdateMemory();
 
-      // Collect renderables that should affect the vegetation
+      // Renderables near the camera that should affect the vegetation, found by VisibilityCuller
       uint32_t nextSphereIndex = 0;
-      for (auto& renderable : jobInput.sceneInfo.renderables)
+      for (auto& renderable : jobInput.sceneInfo.foliagePushers)
       {
-         if (renderable->IsPushingFoliage())
-         {
-            mFoliageSpheresBlock.spheres[nextSphereIndex].position = renderable->GetPosition();
-            mFoliageSpheresBlock.spheres[nextSphereIndex].radius = renderable->GetBoundingBox().GetRadius();
-            mFoliageSpheresBlock.constants.padding = glm::vec3(13.37f);
-            nextSphereIndex++;
-         }
+         if (nextSphereIndex == NUM_MAX_SPHERES)
+            break;
+
+         mFoliageSpheresBlock.spheres[nextSphereIndex].position = renderable->GetPosition();
+         mFoliageSpheresBlock.spheres[nextSphereIndex].radius = renderable->GetBoundingBox().GetRadius();
+         mFoliageSpheresBlock.constants.padding = glm::vec3(13.37f);
+         nextSphereIndex++;
       }
 
       mFoliageSpheresBlock.constants.numSpheres = (float)nextSphereIndex;
       if (mFoliageSpheresBlock.constants.numSpheres > 0)
          mFoliageSpheresBlock.UpdateMemory();
 
-      mRenderTarget->Begin("G-buffer pass", glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
-      Vk::CommandBuffer* commandBuffer = mRenderTarget->GetCommandBuffer();
-
-      /* Render instanced assets */
-      for (uint32_t i = 0; i < jobInput.sceneInfo.instanceGroups.size(); i++)
-      {
-         SharedPtr<InstanceGroup> instanceGroup = jobInput.sceneInfo.instanceGroups[i];
-         Vk::Buffer* instanceBuffer = instanceGroup->GetBuffer();
-         Model* model = instanceGroup->GetModel();
-
-         if (instanceBuffer != nullptr && model != nullptr)
-         {
-            SharedPtr<Vk::Effect> effect = nullptr;
-            if (!instanceGroup->IsAnimated())
-               effect = mGBufferEffectInstanced;
-            else
-               effect = mInstancedAnimationEffect;
+      const VisibilityList& mainView = jobInput.sceneInfo.mainView;
+      const glm::vec3 eyePos = glm::vec3(jobInput.sceneInfo.sharedVariables.data.eyePos);
 
-            commandBuffer->CmdBindPipeline(effect->GetPipeline());
+      // Sort the primitives by state so that the redundant binds can be skipped
+      mDrawList.Clear();
+      for (auto& renderable : mainView.renderables)
+         AddRenderable(renderable, eyePos);
 
-            float modelHeight = model->GetBoundingBox().GetHeight();
+      mDrawList.Sort();
 
-            // Todo: Perhaps they can share the same shader and just have a flag for doing animation
-            if (instanceGroup->IsAnimated())
-            {
-               // Push the world matrix constant
-               InstancePushConstantBlock pushConsts(modelHeight);
-               commandBuffer->CmdPushConstants(effect->GetPipelineInterface(), VK_SHADER_STAGE_ALL, sizeof(pushConsts), &pushConsts);
-            }
+      const std::vector<DrawItem>& drawItems = mDrawList.GetItems();
+      const uint32_t numInstanceGroups = (uint32_t)mainView.instanceGroups.size();
+      const uint32_t numItems = numInstanceGroups + mDrawList.GetNumItems();
 
-            std::vector<RenderCommand> renderCommands;
-            model->GetRenderCommands(renderCommands, glm::mat4());
-            
-            for (RenderCommand& command : renderCommands)
-            {
-               for (uint32_t i = 0; i < command.mesh->primitives.size(); i++)
-               {
-                  Primitive* primitive = command.mesh->primitives[i];
-
-                  VkDescriptorSet materialDescriptorSet = command.mesh->materials[i]->descriptorSet->GetVkHandle();
-                  VkDescriptorSet descriptorSets[2] = { effect->GetDescriptorSet(0).GetVkHandle(), materialDescriptorSet };
-                  commandBuffer->CmdBindDescriptorSet(effect->GetPipelineInterface(), 2, descriptorSets, VK_PIPELINE_BIND_POINT_GRAPHICS);
-                  commandBuffer->CmdBindVertexBuffer(0, 1, primitive->GetVertxBuffer());
-                  commandBuffer->CmdBindVertexBuffer(1, 1, instanceBuffer);
-                  commandBuffer->CmdBindIndexBuffer(primitive->GetIndexBuffer(), 0, VK_INDEX_TYPE_UINT32);
-                  commandBuffer->CmdDrawIndexed(primitive->GetNumIndices(), instanceGroup->GetNumInstances(), 0, 0, 0);
-               }
-            }
+      // The draw list is the instanced assets followed by the sorted primitives
+      auto recordDrawList = [&](Vk::CommandBuffer* commandBuffer, uint32_t first, uint32_t last)
+      {
+         for (uint32_t i = first; i < last; i++)
+         {
+            if (i < numInstanceGroups)
+               RenderInstanceGroup(commandBuffer, mainView.instanceGroups[i]);
+            else
+               RenderDrawItem(commandBuffer, drawItems[i - numInstanceGroups]);
          }
-      }
+      };
 
-      /* Render all renderables */
-      for (auto& renderable : jobInput.sceneInfo.renderables)
+      if (jobInput.parallelRecorder != nullptr)
+      {
+         mRenderTarget->Begin("G-buffer pass", glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+         jobInput.parallelRecorder->RecordSecondary(mRenderTarget->GetCommandBuffer(), mRenderTarget->GetRenderPass(), mRenderTarget->GetFrameBuffer(),
+                                                    mRenderTarget->GetWidth(), mRenderTarget->GetHeight(), numItems, recordDrawList);
+      }
+      else
       {
-         if (!renderable->IsVisible() || !(renderable->HasRenderFlags(RENDER_FLAG_DEFERRED) || renderable->HasRenderFlags(RENDER_FLAG_WIREFRAME)))
-            continue;
+         mRenderTarget->Begin("G-buffer pass", glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
+         Vk::CommandBuffer* commandBuffer = mRenderTarget->GetCommandBuffer();
 
-         Model* model = renderable->GetModel();
+         recordDrawList(commandBuffer, 0, numItems);
 
-         Vk::Effect* effect = mGBufferEffect.get();
-         if (renderable->HasRenderFlags(RENDER_FLAG_WIREFRAME))
-            effect = mGBufferEffectWireframe.get();
-         else if(model->IsAnimated())
-            effect = mGBufferEffectSkinning.get();
+         Vk::DebugLabel::EndRegion(commandBuffer->GetVkHandle());
+      }
 
-         commandBuffer->CmdBindPipeline(effect->GetPipeline());
+      mRenderTarget->End(GetWaitSemahore(), GetCompletedSemahore());
+   }
 
-         std::vector<RenderCommand> renderCommands;
-         model->GetRenderCommands(renderCommands, renderable->GetTransform().GetWorldMatrix());
+   void GBufferJob::RenderInstanceGroup(Vk::CommandBuffer* commandBuffer, const VisibleInstanceGroup& visibleGroup)
+   {
+      InstanceGroup* instanceGroup = visibleGroup.instanceGroup;
+      Vk::Buffer* instanceBuffer = visibleGroup.instanceBuffer;
+      Model* model = instanceGroup->GetModel();
 
-         for (RenderCommand& command : renderCommands)
+      if (instanceBuffer != nullptr && model != nullptr)
+      {
+         BakedAnimation* bakedAnimation = instanceGroup->GetBakedAnimation();
+         Vk::Effect* defaultEffect = nullptr;
+         Vk::Effect* compactEffect = nullptr;
+         if (bakedAnimation != nullptr)
          {
-            if (command.skinDescriptorSet != VK_NULL_HANDLE)
-            {
-               commandBuffer->CmdBindDescriptorSet(effect->GetPipelineInterface(), 1, &command.skinDescriptorSet,
-                                                   VK_PIPELINE_BIND_POINT_GRAPHICS, JOINT_MATRICES_DESCRIPTOR_SET);
-            }
+            // Skinned primitives always have the default vertex layout with the joints
+            defaultEffect = mGBufferEffectInstancedSkinning.get();
+            compactEffect = mGBufferEffectInstancedCompact.get();
+         }
+         else if (!instanceGroup->IsAnimated())
+         {
+            defaultEffect = mGBufferEffectInstanced.get();
+            compactEffect = mGBufferEffectInstancedCompact.get();
+         }
+         else
+         {
+            defaultEffect = mInstancedAnimationEffect.get();
+            compactEffect = mInstancedAnimationEffectCompact.get();
+         }
 
-            GBufferPushConstants pushConsts(command.world, renderable->GetColor(), renderable->GetTextureTiling());
-            commandBuffer->CmdPushConstants(effect->GetPipelineInterface(), VK_SHADER_STAGE_ALL, sizeof(pushConsts), &pushConsts);
+         float modelHeight = model->GetBoundingBox().GetHeight();
+         Vk::Effect* effect = nullptr;
 
+         const std::vector<RenderCommand>& renderCommands = model->GetRenderCommands();
+         
+         for (const RenderCommand& command : renderCommands)
+         {
             for (uint32_t i = 0; i < command.mesh->primitives.size(); i++)
             {
                Primitive* primitive = command.mesh->primitives[i];
 
-               VkDescriptorSet materialDescriptorSet = command.mesh->materials[i]->descriptorSet->GetVkHandle();
+               // The placeholder model and .gltf assets use the default vertex layout
+               Vk::Effect* primitiveEffect = primitive->GetVertexLayout() == Vk::VERTEX_LAYOUT_COMPACT ? compactEffect : defaultEffect;
+               if (primitiveEffect != effect)
+               {
+                  effect = primitiveEffect;
+                  commandBuffer->CmdBindPipeline(effect->GetPipeline());
+
+                  if (effect == mGBufferEffectInstancedSkinning.get())
+                  {
+                     VkDescriptorSet bakedDescriptorSet = bakedAnimation->GetDescriptorSet();
+                     commandBuffer->CmdBindDescriptorSet(effect->GetPipelineInterface(), 1, &bakedDescriptorSet,
+                                                         VK_PIPELINE_BIND_POINT_GRAPHICS, JOINT_MATRICES_DESCRIPTOR_SET);
+                  }
+                  // Todo: Perhaps they can share the same shader and just have a flag for doing animation
+                  else if (instanceGroup->IsAnimated())
+                  {
+                     // Push the world matrix constant
+                     InstancePushConstantBlock pushConsts(modelHeight);
+                     commandBuffer->CmdPushConstants(effect->GetPipelineInterface(), VK_SHADER_STAGE_ALL, sizeof(pushConsts), &pushConsts);
+                  }
+               }
+
+               VkDescriptorSet materialDescriptorSet = command.mesh->materials[i]->GetDescriptorSet(mDevice->GetFrameIndex());
                VkDescriptorSet descriptorSets[2] = { effect->GetDescriptorSet(0).GetVkHandle(), materialDescriptorSet };
                commandBuffer->CmdBindDescriptorSet(effect->GetPipelineInterface(), 2, descriptorSets, VK_PIPELINE_BIND_POINT_GRAPHICS);
-
-               gRendererUtility().DrawPrimitive(commandBuffer, primitive);
+               commandBuffer->CmdBindVertexBuffer(0, 1, primitive->GetVertxBuffer());
+               commandBuffer->CmdBindVertexBuffer(1, 1, instanceBuffer);
+               commandBuffer->CmdBindIndexBuffer(primitive->GetIndexBuffer(), 0, VK_INDEX_TYPE_UINT32);
+               commandBuffer->CmdDrawIndexed(primitive->GetNumIndices(), visibleGroup.numInstances, primitive->GetFirstIndex(), primitive->GetVertexOffset(), 0);
             }
          }
       }
+   }
 
-      Vk::DebugLabel::EndRegion(commandBuffer->GetVkHandle());
+   void GBufferJob::AddRenderable(Renderable* renderable, const glm::vec3& eyePos)
+   {
+      if (!renderable->IsVisible() || !(renderable->HasRenderFlags(RENDER_FLAG_DEFERRED) || renderable->HasRenderFlags(RENDER_FLAG_WIREFRAME)))
+         return;
 
-      mRenderTarget->End(GetWaitSemahore(), GetCompletedSemahore());
+      Model* model = renderable->GetModel();
+
+      Vk::Effect* effect = mGBufferEffect.get();
+      uint32_t effectIndex = 0;
+      if (renderable->HasRenderFlags(RENDER_FLAG_WIREFRAME))
+      {
+         effect = mGBufferEffectWireframe.get();
+         effectIndex = 2;
+      }
+      else if (model->IsAnimated())
+      {
+         effect = mGBufferEffectSkinning.get();
+         effectIndex = 1;
+      }
+
+      const float depth = glm::distance(renderable->GetPosition(), eyePos);
+
+      for (const RenderCommand& command : renderable->GetRenderCommands())
+         mDrawList.AddRenderCommand(effect, effectIndex, renderable, &command, depth);
+   }
+
+   void GBufferJob::RenderDrawItem(Vk::CommandBuffer* commandBuffer, const DrawItem& drawItem)
+   {
+      Vk::Effect* effect = drawItem.effect;
+      const RenderCommand& command = *drawItem.command;
+      Renderable* renderable = drawItem.renderable;
+
+      commandBuffer->CmdBindPipeline(effect->GetPipeline());
+
+      VkDescriptorSet skinDescriptorSet = command.GetSkinDescriptorSet(mDevice->GetFrameIndex());
+      if (skinDescriptorSet != VK_NULL_HANDLE)
+      {
+         commandBuffer->CmdBindDescriptorSet(effect->GetPipelineInterface(), 1, &skinDescriptorSet,
+                                             VK_PIPELINE_BIND_POINT_GRAPHICS, JOINT_MATRICES_DESCRIPTOR_SET);
+      }
+
+      GBufferPushConstants pushConsts(command.world, renderable->GetColor(), renderable->GetTextureTiling());
+      commandBuffer->CmdPushConstants(effect->GetPipelineInterface(), VK_SHADER_STAGE_ALL, sizeof(pushConsts), &pushConsts);
+
+      Primitive* primitive = command.mesh->primitives[drawItem.primitiveIndex];
+
+      VkDescriptorSet materialDescriptorSet = command.mesh->materials[drawItem.primitiveIndex]->GetDescriptorSet(mDevice->GetFrameIndex());
+      VkDescriptorSet descriptorSets[2] = { effect->GetDescriptorSet(0).GetVkHandle(), materialDescriptorSet };
+      commandBuffer->CmdBindDescriptorSet(effect->GetPipelineInterface(), 2, descriptorSets, VK_PIPELINE_BIND_POINT_GRAPHICS);
+
+      gRendererUtility().DrawPrimitive(commandBuffer, primitive);
    }
-}
\ No newline at end of file
+}
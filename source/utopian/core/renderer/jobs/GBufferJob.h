@@ -1,6 +1,7 @@
 #pragma once
 
 #include "core/renderer/jobs/BaseJob.h"
+#include "core/renderer/DrawList.h"
 #include "vulkan/VulkanPrerequisites.h"
 
 namespace Utopian
@@ -14,23 +15,19 @@ namespace Utopian
 
    class SphereUniformBuffer : public Utopian::Vk::ShaderBuffer
    {
-   public:
-      virtual void UpdateMemory()
+   protected:
+      virtual void WriteMemory(uint8_t* mapped)
       {
-         uint8_t* mapped;
          uint32_t dataOffset = 0;
          uint32_t dataSize = sizeof(constants);
-         mBuffer->MapMemory((void**)&mapped);
          memcpy(mapped, &constants.numSpheres, dataSize);
-         mBuffer->UnmapMemory();
 
          dataOffset += dataSize;
          dataSize = (uint32_t)spheres.size() * sizeof(SphereInfo);
-         mBuffer->MapMemory((void**)&mapped);
          memcpy(&mapped[dataOffset], spheres.data(), dataSize);
-         mBuffer->UnmapMemory();
       }
 
+   public:
       virtual int GetSize()
       {
          return (NUM_MAX_SPHERES) * sizeof(Utopian::SphereInfo) + sizeof(constants);
@@ -88,13 +85,24 @@ namespace Utopian
       void PostInit(const std::vector<BaseJob*>& jobs, const GBuffer& gbuffer) override;
       void Render(const JobInput& jobInput) override;
 
+   private:
+      void RenderInstanceGroup(Vk::CommandBuffer* commandBuffer, const VisibleInstanceGroup& visibleGroup);
+
+      /** Adds the primitives of the renderable to mDrawList. */
+      void AddRenderable(Renderable* renderable, const glm::vec3& eyePos);
+      void RenderDrawItem(Vk::CommandBuffer* commandBuffer, const DrawItem& drawItem);
+
    private:
       SharedPtr<Vk::RenderTarget> mRenderTarget;
       SharedPtr<Vk::Effect> mGBufferEffect;
       SharedPtr<Vk::Effect> mGBufferEffectWireframe;
       SharedPtr<Vk::Effect> mInstancedAnimationEffect;
       SharedPtr<Vk::Effect> mGBufferEffectInstanced;
+      SharedPtr<Vk::Effect> mInstancedAnimationEffectCompact;
+      SharedPtr<Vk::Effect> mGBufferEffectInstancedCompact;
       SharedPtr<Vk::Effect> mGBufferEffectSkinning;
+      SharedPtr<Vk::Effect> mGBufferEffectInstancedSkinning;
+      DrawList mDrawList;
 
       SettingsBlock mSettingsBlock;
       SphereUniformBuffer mFoliageSpheresBlock;
@@ -61,16 +61,14 @@ namespace Utopian
          // Todo: Instanced objects
 
          /* Render all renderables */
-         for (auto& renderable : jobInput.sceneInfo.renderables)
+         for (auto& renderable : jobInput.sceneInfo.mainView.renderables)
          {
             if (!renderable->IsVisible() || ((renderable->GetRenderFlags() & RENDER_FLAG_DEFERRED) != RENDER_FLAG_DEFERRED))
                continue;
 
-            Model* model = renderable->GetModel();
-            std::vector<RenderCommand> renderCommands;
-            model->GetRenderCommands(renderCommands, renderable->GetTransform().GetWorldMatrix());
+            const std::vector<RenderCommand>& renderCommands = renderable->GetRenderCommands();
 
-            for (RenderCommand& command : renderCommands)
+            for (const RenderCommand& command : renderCommands)
             {
                Vk::PushConstantBlock pushConsts(command.world, renderable->GetColor());
                commandBuffer->CmdPushConstants(mEffect->GetPipelineInterface(), VK_SHADER_STAGE_ALL, sizeof(pushConsts), &pushConsts);
@@ -79,7 +77,7 @@ namespace Utopian
                {
                   Primitive* primitive = command.mesh->primitives[i];
 
-                  VkDescriptorSet materialDescriptorSet = command.mesh->materials[i]->descriptorSet->GetVkHandle();
+                  VkDescriptorSet materialDescriptorSet = command.mesh->materials[i]->GetDescriptorSet(mDevice->GetFrameIndex());
                   VkDescriptorSet descriptorSets[2] = { mEffect->GetDescriptorSet(0).GetVkHandle(), materialDescriptorSet };
                   commandBuffer->CmdBindDescriptorSet(mEffect->GetPipelineInterface(), 2, descriptorSets, VK_PIPELINE_BIND_POINT_GRAPHICS);
 
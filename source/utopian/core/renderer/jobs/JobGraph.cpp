@@ -26,10 +26,10 @@
 #include "core/renderer/jobs/OutlineJob.h"
 #include "core/renderer/jobs/DepthOfFieldJob.h"
 #include "core/Log.h"
+#include "core/TaskScheduler.h"
 #include "vulkan/VulkanApp.h"
 #include "vulkan/handles/Device.h"
 #include "vulkan/handles/Image.h"
-#include <thread>
 #include <algorithm>
 
 namespace Utopian
@@ -38,6 +38,13 @@ namespace Utopian
    {
       Timestamp start = gTimer().GetTimestamp();
 
+      mDevice = device;
+      mVulkanApp = vulkanApp;
+
+      // Draw lists are split in at most one secondary command buffer per thread of the task scheduler
+      const uint32_t numRecordingThreads = gTaskScheduler().GetNumThreads();
+      mParallelRecorder = std::make_shared<ParallelRecorder>(device, numRecordingThreads);
+
       uint32_t width = vulkanApp->GetWindowWidth();
       uint32_t height = vulkanApp->GetWindowHeight();
 
@@ -124,49 +131,61 @@ namespace Utopian
 
    void JobGraph::AsynchronousResourceLoading()
    {
-      // Splits the resource loading work from all jobs in the graph evenly
-      // across the number of threads configured for asyncrhonous loading.
-      auto work = [&](uint32_t currentThread, uint32_t numThreads)
-      {
-         uint32_t functionsInThreads = (uint32_t)mJobs.size() / numThreads;
-         uint32_t functionsInCurrentThread = functionsInThreads;
-
-         // Last thread needs to contain remaining tasks if not evenly divided.
-         if (currentThread == numThreads - 1)
-            functionsInCurrentThread = (uint32_t)mJobs.size() - ((numThreads - 1) * functionsInThreads);
-
-         for (uint32_t j = 0; j < functionsInCurrentThread; j++)
-         {
-            mJobs[currentThread * functionsInThreads + j]->LoadResources();
-         }
-      };
-
-      // From testing 4 threads shows the best performance.
-      const uint32_t numThreads = 4;
-      std::vector<std::thread> workerThreads;
-
-      for (uint32_t i = 0; i < numThreads; i++)
+      // Every job is its own task so that idle workers can steal the remaining
+      // jobs when some of them take much longer to compile than the others
+      gTaskScheduler().ParallelFor((uint32_t)mJobs.size(), 1, [&](uint32_t jobIndex)
       {
-         workerThreads.push_back(std::thread(work, i, numThreads));
-      }
-
-      // Wait for all shader compilation worker threads to finish
-      std::for_each(workerThreads.begin(), workerThreads.end(), [](std::thread& t) { t.join(); });
+         mJobs[jobIndex]->LoadResources();
+      });
    }
 
    void JobGraph::Render(const SceneInfo& sceneInfo, const RenderingSettings& renderingSettings)
    {
-      JobInput jobInput(sceneInfo, mJobs, renderingSettings);
+      ParallelRecorder* parallelRecorder = renderingSettings.parallelRecording ? mParallelRecorder.get() : nullptr;
+      JobInput jobInput(sceneInfo, mJobs, renderingSettings, parallelRecorder);
+
+      // Every frame in flight acquires its swapchain image with its own semaphore
+      mJobs.front()->SetWaitSemaphore(mVulkanApp->GetImageAvailableSemaphore());
 
       for (auto& job : mJobs)
       {
          job->PreRender(jobInput);
       }
 
-      for (auto& job : mJobs)
+      if (parallelRecorder == nullptr)
       {
-         job->Render(jobInput);
+         for (auto& job : mJobs)
+         {
+            job->Render(jobInput);
+         }
+
+         return;
       }
+
+      // The GPU is done with the frame that last used this frame slot so its command buffers can be reused
+      mParallelRecorder->ResetCommandPools();
+
+      // Each job collects its submits in its own list. They are sent to the queue in job order
+      // which keeps the semaphore chain from AddJob() intact.
+      mJobSubmissions.resize(mJobs.size());
+
+      mParallelRecorder->ParallelFor((uint32_t)mJobs.size(), [&](uint32_t jobIndex)
+      {
+         // The list is restored afterwards since a thread waiting for nested recording can execute this in between
+         std::vector<Vk::Queue::Submission>* previousSubmissions = Vk::Queue::GetDeferredSubmits();
+         mJobSubmissions[jobIndex].clear();
+         Vk::Queue::SetDeferredSubmits(&mJobSubmissions[jobIndex]);
+         mJobs[jobIndex]->Render(jobInput);
+         Vk::Queue::SetDeferredSubmits(previousSubmissions);
+      });
+
+      std::vector<Vk::Queue::Submission> submissions;
+      for (auto& jobSubmissions : mJobSubmissions)
+      {
+         submissions.insert(submissions.end(), jobSubmissions.begin(), jobSubmissions.end());
+      }
+
+      mDevice->GetQueue()->Submit(submissions);
    }
 
    void JobGraph::Update(double deltaTime)
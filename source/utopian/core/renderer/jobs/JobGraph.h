@@ -1,6 +1,8 @@
 #pragma once
 #include "core/renderer/jobs/BaseJob.h"
+#include "core/renderer/ParallelRecorder.h"
 #include "vulkan/VulkanPrerequisites.h"
+#include "vulkan/handles/Queue.h"
 #include "imgui/imgui.h"
 
 namespace Utopian
@@ -59,7 +61,11 @@ namespace Utopian
 
       void AsynchronousResourceLoading();
 
-      /** Renders all jobs added to the graph. */
+      /**
+       * Renders all jobs added to the graph.
+       * With RenderingSettings::parallelRecording the jobs record their command buffers on worker
+       * threads and the submits are sent to the queue in job order once all jobs are recorded.
+       */
       void Render(const SceneInfo& sceneInfo, const RenderingSettings& renderingSettings);
       void Update(double deltaTime);
       void EnableJob(JobIndex jobIndex, bool enabled);
@@ -72,8 +78,12 @@ namespace Utopian
       /** Adds a job to the graph. */
       void AddJob(BaseJob* job);
    private:
+      Vk::Device* mDevice;
+      Vk::VulkanApp* mVulkanApp;
       std::vector<BaseJob*> mJobs;
       GBuffer mGBuffer;
+      SharedPtr<ParallelRecorder> mParallelRecorder;
+      std::vector<std::vector<Vk::Queue::Submission>> mJobSubmissions;
       
       GBufferDebugDescriptorSets mDebugDescriptorSets;
       DebugChannel mDebugChannel = DebugChannel::NONE;
@@ -92,13 +92,12 @@ namespace Utopian
 
       if (IsEnabled())
       {
-         for (auto& renderable : jobInput.sceneInfo.renderables)
+         for (auto& renderable : jobInput.sceneInfo.mainView.renderables)
          {
             if (renderable->IsVisible() && renderable->HasRenderFlags(RENDER_FLAG_DRAW_OUTLINE))
             {
                Model* model = renderable->GetModel();
-               std::vector<RenderCommand> renderCommands;
-               model->GetRenderCommands(renderCommands, renderable->GetTransform().GetWorldMatrix());
+               const std::vector<RenderCommand>& renderCommands = renderable->GetRenderCommands();
 
                Vk::Effect* effect = mMaskPass.effect.get();
                if (model->IsAnimated())
@@ -109,11 +108,12 @@ namespace Utopian
                VkDescriptorSet descriptorSets[1] = { effect->GetDescriptorSet(0).GetVkHandle() };
                commandBuffer->CmdBindDescriptorSet(effect->GetPipelineInterface(), 1, descriptorSets, VK_PIPELINE_BIND_POINT_GRAPHICS, 0);
 
-               for (RenderCommand& command : renderCommands)
+               for (const RenderCommand& command : renderCommands)
                {
-                  if (command.skinDescriptorSet != VK_NULL_HANDLE)
+                  VkDescriptorSet skinDescriptorSet = command.GetSkinDescriptorSet(mDevice->GetFrameIndex());
+                  if (skinDescriptorSet != VK_NULL_HANDLE)
                   {
-                     commandBuffer->CmdBindDescriptorSet(effect->GetPipelineInterface(), 1, &command.skinDescriptorSet,
+                     commandBuffer->CmdBindDescriptorSet(effect->GetPipelineInterface(), 1, &skinDescriptorSet,
                                                          VK_PIPELINE_BIND_POINT_GRAPHICS, 1);
                   }
 
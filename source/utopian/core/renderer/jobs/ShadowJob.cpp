@@ -2,9 +2,12 @@
 #include "core/renderer/jobs/BlurJob.h"
 #include "core/renderer/CommonJobIncludes.h"
 #include "core/renderer/Model.h"
+#include "core/renderer/BakedAnimation.h"
+#include "core/renderer/ParallelRecorder.h"
 #include "core/Profiler.h"
 #include "vulkan/handles/FrameBuffers.h"
 #include "vulkan/handles/QueryPoolTimestamp.h"
+#include "vulkan/FrameCommandPool.h"
 #include "vulkan/Debug.h"
 
 namespace Utopian
@@ -74,12 +77,17 @@ namespace Utopian
          mEffectSkinning = Vk::gEffectManager().AddEffect<Vk::Effect>(mDevice, mRenderPass.get(), effectDescSkinning);
 
          // Custom vertex description due to instancing
-         SharedPtr<Vk::VertexDescription> vertexDescription = std::make_shared<Vk::VertexDescription>(Vk::Vertex::GetDescription());
-         vertexDescription->AddBinding(BINDING_1, sizeof(InstanceDataGPU), VK_VERTEX_INPUT_RATE_INSTANCE);
-         vertexDescription->AddAttribute(BINDING_1, Vk::Vec4Attribute());  // Location 0 : InInstanceWorld
-         vertexDescription->AddAttribute(BINDING_1, Vk::Vec4Attribute());  // Location 1 : InInstanceWorld
-         vertexDescription->AddAttribute(BINDING_1, Vk::Vec4Attribute());  // Location 2 : InInstanceWorld
-         vertexDescription->AddAttribute(BINDING_1, Vk::Vec4Attribute());  // Location 3 : InInstanceWorld
+         auto createInstancingDescription = [](const Vk::VertexDescription& meshDescription) {
+            SharedPtr<Vk::VertexDescription> vertexDescription = std::make_shared<Vk::VertexDescription>(meshDescription);
+            vertexDescription->AddBinding(BINDING_1, sizeof(InstanceDataGPU), VK_VERTEX_INPUT_RATE_INSTANCE);
+            vertexDescription->AddAttribute(BINDING_1, Vk::Vec4Attribute());  // Location 0 : InInstanceWorld
+            vertexDescription->AddAttribute(BINDING_1, Vk::Vec4Attribute());  // Location 1 : InInstanceWorld
+            vertexDescription->AddAttribute(BINDING_1, Vk::Vec4Attribute());  // Location 2 : InInstanceWorld
+            vertexDescription->AddAttribute(BINDING_1, Vk::Vec4Attribute());  // Location 3 : InInstanceWorld
+            return vertexDescription;
+         };
+
+         SharedPtr<Vk::VertexDescription> vertexDescription = createInstancingDescription(Vk::Vertex::GetDescription());
 
          Vk::EffectCreateInfo effectDescInstancing;
          effectDescInstancing.shaderDesc.vertexShaderPath = "data/shaders/shadowmap/shadowmap_instancing.vert";
@@ -87,6 +95,22 @@ namespace Utopian
          effectDescInstancing.pipelineDesc.rasterizationState.cullMode = VK_CULL_MODE_NONE;
          effectDescInstancing.pipelineDesc.OverrideVertexInput(vertexDescription);
          mEffectInstanced = Vk::gEffectManager().AddEffect<Vk::Effect>(mDevice, mRenderPass.get(), effectDescInstancing);
+
+         // Variant for primitives with the compact vertex layout
+         effectDescInstancing.shaderDesc.vertexShaderPath = "data/shaders/shadowmap/shadowmap_instancing_compact.vert";
+         effectDescInstancing.pipelineDesc.OverrideVertexInput(createInstancingDescription(Vk::CompactVertex::GetDescription()));
+         mEffectInstancedCompact = Vk::gEffectManager().AddEffect<Vk::Effect>(mDevice, mRenderPass.get(), effectDescInstancing);
+
+         // Skinned instances also read the phase into the baked animation
+         SharedPtr<Vk::VertexDescription> skinningVertexDescription = createInstancingDescription(Vk::Vertex::GetDescription());
+         skinningVertexDescription->AddAttribute(BINDING_1, Vk::FloatAttribute()); // Location 4 : InInstanceAnimationPhase
+
+         Vk::EffectCreateInfo effectDescInstancingSkinning;
+         effectDescInstancingSkinning.shaderDesc.vertexShaderPath = "data/shaders/shadowmap/shadowmap_instancing_skinning.vert";
+         effectDescInstancingSkinning.shaderDesc.fragmentShaderPath = "data/shaders/shadowmap/shadowmap.frag";
+         effectDescInstancingSkinning.pipelineDesc.rasterizationState.cullMode = VK_CULL_MODE_FRONT_BIT;
+         effectDescInstancingSkinning.pipelineDesc.OverrideVertexInput(skinningVertexDescription);
+         mEffectInstancedSkinning = Vk::gEffectManager().AddEffect<Vk::Effect>(mDevice, mRenderPass.get(), effectDescInstancingSkinning);
       };
 
       loadShaders();
@@ -102,6 +126,9 @@ namespace Utopian
       mEffect->BindUniformBuffer("UBO_cascadeTransforms", mCascadeTransforms);
       mEffectSkinning->BindUniformBuffer("UBO_cascadeTransforms", mCascadeTransforms);
       mEffectInstanced->BindUniformBuffer("UBO_cascadeTransforms", mCascadeTransforms);
+      mEffectInstancedCompact->BindUniformBuffer("UBO_cascadeTransforms", mCascadeTransforms);
+      mEffectInstancedSkinning->BindUniformBuffer("UBO_cascadeTransforms", mCascadeTransforms);
+      mEffectInstancedSkinning->BindUniformBuffer("UBO_sharedVariables", gRenderer().GetSharedShaderVariables());
    }
 
    void ShadowJob::Render(const JobInput& jobInput)
@@ -113,10 +140,28 @@ namespace Utopian
 
       mCascadeTransforms.UpdateMemory();
 
-      mCommandBuffer->Begin();
-      Vk::DebugLabel::BeginRegion(mCommandBuffer->GetVkHandle(), "Cascade pass", glm::vec4(1.0, 1.0, 0.0, 1.0));
-      mQueryPool->Reset(mCommandBuffer.get());
-      mQueryPool->Begin(mCommandBuffer.get());
+      // Sort the primitives of each cascade by state so that the redundant binds can be skipped
+      for (uint32_t i = 0; i < SHADOW_MAP_CASCADE_COUNT; i++)
+      {
+         mDrawLists[i].Clear();
+         for (auto& renderable : jobInput.sceneInfo.cascadeViews[i].renderables)
+            AddRenderable(renderable, mDrawLists[i]);
+
+         mDrawLists[i].Sort();
+      }
+
+      // Record into a command buffer owned by the current thread when jobs are recorded in parallel
+      Vk::CommandBuffer* commandBuffer = mCommandBuffer.get();
+      if (Vk::FrameCommandPool::GetCurrent() != nullptr)
+         commandBuffer = Vk::FrameCommandPool::GetCurrent()->Acquire(VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+
+      commandBuffer->Begin();
+      Vk::DebugLabel::BeginRegion(commandBuffer->GetVkHandle(), "Cascade pass", glm::vec4(1.0, 1.0, 0.0, 1.0));
+      mQueryPool->Reset(commandBuffer);
+      mQueryPool->Begin(commandBuffer);
+
+      const VkSubpassContents subpassContents = (jobInput.parallelRecorder != nullptr) ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+                                                                                       : VK_SUBPASS_CONTENTS_INLINE;
 
       for (uint32_t cascadeIndex = 0; cascadeIndex < SHADOW_MAP_CASCADE_COUNT; cascadeIndex++)
       {
@@ -130,104 +175,144 @@ namespace Utopian
          renderPassBeginInfo.pClearValues = mClearValues.data();
          renderPassBeginInfo.framebuffer = mFrameBuffers[cascadeIndex]->GetFrameBuffer(0);
 
-         mCommandBuffer->CmdBeginRenderPass(&renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
-         mCommandBuffer->CmdSetViewPort((float)SHADOWMAP_DIMENSION, (float)SHADOWMAP_DIMENSION);
-         mCommandBuffer->CmdSetScissor(SHADOWMAP_DIMENSION, SHADOWMAP_DIMENSION);
+         commandBuffer->CmdBeginRenderPass(&renderPassBeginInfo, subpassContents);
 
-         if (IsEnabled())
-         {
-            /* Render instanced assets */
-            mCommandBuffer->CmdBindPipeline(mEffectInstanced->GetPipeline());
+         const VisibilityList& cascadeView = jobInput.sceneInfo.cascadeViews[cascadeIndex];
+         const uint32_t numInstanceGroups = (uint32_t)cascadeView.instanceGroups.size();
+         const std::vector<DrawItem>& drawItems = mDrawLists[cascadeIndex].GetItems();
+         const uint32_t numItems = IsEnabled() ? numInstanceGroups + mDrawLists[cascadeIndex].GetNumItems() : 0u;
 
-            for (uint32_t i = 0; i < jobInput.sceneInfo.instanceGroups.size(); i++)
+         // The draw list is the instanced assets followed by the sorted primitives
+         auto recordDrawList = [&](Vk::CommandBuffer* cascadeCommandBuffer, uint32_t first, uint32_t last)
+         {
+            for (uint32_t i = first; i < last; i++)
             {
-               SharedPtr<InstanceGroup> instanceGroup = jobInput.sceneInfo.instanceGroups[i];
+               if (i < numInstanceGroups)
+                  RenderInstanceGroup(cascadeCommandBuffer, cascadeView.instanceGroups[i], cascadeIndex);
+               else
+                  RenderDrawItem(cascadeCommandBuffer, drawItems[i - numInstanceGroups], cascadeIndex);
+            }
+         };
 
-               // Skip if instance group does not cast shadows
-               if (!instanceGroup->IsCastingShadows())
-                  continue;
+         if (subpassContents == VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS)
+         {
+            jobInput.parallelRecorder->RecordSecondary(commandBuffer, mRenderPass.get(), mFrameBuffers[cascadeIndex]->GetFrameBuffer(0),
+                                                       SHADOWMAP_DIMENSION, SHADOWMAP_DIMENSION, numItems, recordDrawList);
+         }
+         else
+         {
+            commandBuffer->CmdSetViewPort((float)SHADOWMAP_DIMENSION, (float)SHADOWMAP_DIMENSION);
+            commandBuffer->CmdSetScissor(SHADOWMAP_DIMENSION, SHADOWMAP_DIMENSION);
+            recordDrawList(commandBuffer, 0, numItems);
+         }
 
-               Vk::Buffer* instanceBuffer = instanceGroup->GetBuffer();
-               Model* model = instanceGroup->GetModel();
+         commandBuffer->CmdEndRenderPass();
+      }
 
-               if (instanceBuffer != nullptr && model != nullptr)
-               {
-                  std::vector<RenderCommand> renderCommands;
-                  model->GetRenderCommands(renderCommands, glm::mat4());
+      mQueryPool->End(commandBuffer);
+      Vk::DebugLabel::EndRegion(commandBuffer->GetVkHandle());
 
-                  for (RenderCommand& command : renderCommands)
-                  {
-                     for (uint32_t i = 0; i < command.mesh->primitives.size(); i++)
-                     {
-                        Primitive* primitive = command.mesh->primitives[i];
-
-                        CascadePushConst pushConst(glm::mat4(), cascadeIndex);
-                        mCommandBuffer->CmdPushConstants(mEffectInstanced->GetPipelineInterface(), VK_SHADER_STAGE_ALL, sizeof(CascadePushConst), &pushConst);
-
-                        VkDescriptorSet materialDescriptorSet = command.mesh->materials[i]->descriptorSet->GetVkHandle();
-                        VkDescriptorSet descriptorSets[2] = { mEffectInstanced->GetDescriptorSet(0).GetVkHandle(), materialDescriptorSet };
-                        mCommandBuffer->CmdBindDescriptorSet(mEffectInstanced->GetPipelineInterface(), 2, descriptorSets, VK_PIPELINE_BIND_POINT_GRAPHICS);
-                        mCommandBuffer->CmdBindVertexBuffer(0, 1, primitive->GetVertxBuffer());
-                        mCommandBuffer->CmdBindVertexBuffer(1, 1, instanceBuffer);
-                        mCommandBuffer->CmdBindIndexBuffer(primitive->GetIndexBuffer(), 0, VK_INDEX_TYPE_UINT32);
-                        mCommandBuffer->CmdDrawIndexed(primitive->GetNumIndices(), instanceGroup->GetNumInstances(), 0, 0, 0);
-                     }
-                  }
-               }
-            }
+      commandBuffer->Submit(GetWaitSemahore(), GetCompletedSemahore());
 
-            /* Render all renderables */
-            for (auto& renderable : jobInput.sceneInfo.renderables)
-            {
-               if (!renderable->IsVisible() || !renderable->HasRenderFlags(RENDER_FLAG_CAST_SHADOW))
-                  continue;
+      if (gProfiler().IsEnabled())
+         gProfiler().AddProfilerTask("Cascade pass: ", mQueryPool->GetElapsedTime(), glm::vec4(1.0, 1.0, 0.0, 1.0));
+   }
 
-               Model* model = renderable->GetModel();
-               std::vector<RenderCommand> renderCommands;
-               model->GetRenderCommands(renderCommands, renderable->GetTransform().GetWorldMatrix());
+   void ShadowJob::RenderInstanceGroup(Vk::CommandBuffer* commandBuffer, const VisibleInstanceGroup& visibleGroup, uint32_t cascadeIndex)
+   {
+      InstanceGroup* instanceGroup = visibleGroup.instanceGroup;
 
-               Vk::Effect* effect = mEffect.get();
-               if (model->IsAnimated())
-                  effect = mEffectSkinning.get();
+      // Skip if instance group does not cast shadows
+      if (!instanceGroup->IsCastingShadows())
+         return;
 
-               // Note: Todo: all renderables with animation should be sorted
-               // so that we don't have to change the pipeline between each renderable.
-               mCommandBuffer->CmdBindPipeline(effect->GetPipeline());
+      Vk::Buffer* instanceBuffer = visibleGroup.instanceBuffer;
+      Model* model = instanceGroup->GetModel();
 
-               for (RenderCommand& command : renderCommands)
-               {
-                  if (command.skinDescriptorSet != VK_NULL_HANDLE)
-                  {
-                     mCommandBuffer->CmdBindDescriptorSet(effect->GetPipelineInterface(), 1, &command.skinDescriptorSet,
-                                                          VK_PIPELINE_BIND_POINT_GRAPHICS, JOINT_MATRICES_DESCRIPTOR_SET);
-                  }
+      if (instanceBuffer != nullptr && model != nullptr)
+      {
+         BakedAnimation* bakedAnimation = instanceGroup->GetBakedAnimation();
+         Vk::Effect* defaultEffect = (bakedAnimation != nullptr) ? mEffectInstancedSkinning.get() : mEffectInstanced.get();
+         Vk::Effect* effect = nullptr;
 
-                  CascadePushConst pushConst(command.world, cascadeIndex);
-                  mCommandBuffer->CmdPushConstants(effect->GetPipelineInterface(), VK_SHADER_STAGE_ALL, sizeof(CascadePushConst), &pushConst);
+         const std::vector<RenderCommand>& renderCommands = model->GetRenderCommands();
 
-                  for (uint32_t i = 0; i < command.mesh->primitives.size(); i++)
-                  {
-                     Primitive* primitive = command.mesh->primitives[i];
+         for (const RenderCommand& command : renderCommands)
+         {
+            for (uint32_t i = 0; i < command.mesh->primitives.size(); i++)
+            {
+               Primitive* primitive = command.mesh->primitives[i];
 
-                     VkDescriptorSet materialDescriptorSet = command.mesh->materials[i]->descriptorSet->GetVkHandle();
-                     VkDescriptorSet descriptorSets[2] = { effect->GetDescriptorSet(0).GetVkHandle(), materialDescriptorSet };
-                     mCommandBuffer->CmdBindDescriptorSet(effect->GetPipelineInterface(), 2, descriptorSets, VK_PIPELINE_BIND_POINT_GRAPHICS);
+               Vk::Effect* primitiveEffect = primitive->GetVertexLayout() == Vk::VERTEX_LAYOUT_COMPACT ? mEffectInstancedCompact.get() : defaultEffect;
+               if (primitiveEffect != effect)
+               {
+                  effect = primitiveEffect;
+                  commandBuffer->CmdBindPipeline(effect->GetPipeline());
 
-                     gRendererUtility().DrawPrimitive(mCommandBuffer.get(), primitive);
+                  if (effect == mEffectInstancedSkinning.get())
+                  {
+                     VkDescriptorSet bakedDescriptorSet = bakedAnimation->GetDescriptorSet();
+                     commandBuffer->CmdBindDescriptorSet(effect->GetPipelineInterface(), 1, &bakedDescriptorSet,
+                                                         VK_PIPELINE_BIND_POINT_GRAPHICS, JOINT_MATRICES_DESCRIPTOR_SET);
                   }
                }
+
+               CascadePushConst pushConst(glm::mat4(), cascadeIndex);
+               commandBuffer->CmdPushConstants(effect->GetPipelineInterface(), VK_SHADER_STAGE_ALL, sizeof(CascadePushConst), &pushConst);
+
+               VkDescriptorSet materialDescriptorSet = command.mesh->materials[i]->GetDescriptorSet(mDevice->GetFrameIndex());
+               VkDescriptorSet descriptorSets[2] = { effect->GetDescriptorSet(0).GetVkHandle(), materialDescriptorSet };
+               commandBuffer->CmdBindDescriptorSet(effect->GetPipelineInterface(), 2, descriptorSets, VK_PIPELINE_BIND_POINT_GRAPHICS);
+               commandBuffer->CmdBindVertexBuffer(0, 1, primitive->GetVertxBuffer());
+               commandBuffer->CmdBindVertexBuffer(1, 1, instanceBuffer);
+               commandBuffer->CmdBindIndexBuffer(primitive->GetIndexBuffer(), 0, VK_INDEX_TYPE_UINT32);
+               commandBuffer->CmdDrawIndexed(primitive->GetNumIndices(), visibleGroup.numInstances, primitive->GetFirstIndex(), primitive->GetVertexOffset(), 0);
             }
          }
+      }
+   }
+
+   void ShadowJob::AddRenderable(Renderable* renderable, DrawList& drawList)
+   {
+      if (!renderable->IsVisible() || !renderable->HasRenderFlags(RENDER_FLAG_CAST_SHADOW))
+         return;
 
-         mCommandBuffer->CmdEndRenderPass();
+      Vk::Effect* effect = mEffect.get();
+      uint32_t effectIndex = 0;
+      if (renderable->GetModel()->IsAnimated())
+      {
+         effect = mEffectSkinning.get();
+         effectIndex = 1;
       }
 
-      mQueryPool->End(mCommandBuffer.get());
-      Vk::DebugLabel::EndRegion(mCommandBuffer->GetVkHandle());
+      // The draw order doesn't matter for depth only rendering so only the state is sorted on
+      for (const RenderCommand& command : renderable->GetRenderCommands())
+         drawList.AddRenderCommand(effect, effectIndex, renderable, &command, 0.0f);
+   }
 
-      mCommandBuffer->Submit(GetWaitSemahore(), GetCompletedSemahore());
+   void ShadowJob::RenderDrawItem(Vk::CommandBuffer* commandBuffer, const DrawItem& drawItem, uint32_t cascadeIndex)
+   {
+      Vk::Effect* effect = drawItem.effect;
+      const RenderCommand& command = *drawItem.command;
 
-      if (gProfiler().IsEnabled())
-         gProfiler().AddProfilerTask("Cascade pass: ", mQueryPool->GetElapsedTime(), glm::vec4(1.0, 1.0, 0.0, 1.0));
+      commandBuffer->CmdBindPipeline(effect->GetPipeline());
+
+      VkDescriptorSet skinDescriptorSet = command.GetSkinDescriptorSet(mDevice->GetFrameIndex());
+      if (skinDescriptorSet != VK_NULL_HANDLE)
+      {
+         commandBuffer->CmdBindDescriptorSet(effect->GetPipelineInterface(), 1, &skinDescriptorSet,
+                                             VK_PIPELINE_BIND_POINT_GRAPHICS, JOINT_MATRICES_DESCRIPTOR_SET);
+      }
+
+      CascadePushConst pushConst(command.world, cascadeIndex);
+      commandBuffer->CmdPushConstants(effect->GetPipelineInterface(), VK_SHADER_STAGE_ALL, sizeof(CascadePushConst), &pushConst);
+
+      Primitive* primitive = command.mesh->primitives[drawItem.primitiveIndex];
+
+      VkDescriptorSet materialDescriptorSet = command.mesh->materials[drawItem.primitiveIndex]->GetDescriptorSet(mDevice->GetFrameIndex());
+      VkDescriptorSet descriptorSets[2] = { effect->GetDescriptorSet(0).GetVkHandle(), materialDescriptorSet };
+      commandBuffer->CmdBindDescriptorSet(effect->GetPipelineInterface(), 2, descriptorSets, VK_PIPELINE_BIND_POINT_GRAPHICS);
+
+      gRendererUtility().DrawPrimitive(commandBuffer, primitive);
    }
 }
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <array>
 #include "core/renderer/jobs/BaseJob.h"
+#include "core/renderer/DrawList.h"
 
 namespace Utopian
 {
@@ -41,6 +43,13 @@ namespace Utopian
 
       SharedPtr<Vk::Image> depthColorImage;
 
+   private:
+      void RenderInstanceGroup(Vk::CommandBuffer* commandBuffer, const VisibleInstanceGroup& visibleGroup, uint32_t cascadeIndex);
+
+      /** Adds the primitives of the renderable to the draw list of the cascade. */
+      void AddRenderable(Renderable* renderable, DrawList& drawList);
+      void RenderDrawItem(Vk::CommandBuffer* commandBuffer, const DrawItem& drawItem, uint32_t cascadeIndex);
+
    private:
       /* ShadowJob is using one framebuffer per cascade so it needs some special handling and therefor
        * cannot use the RenderTarget API, leading to the job being more low level than other jobs in the graph. */
@@ -53,7 +62,10 @@ namespace Utopian
       SharedPtr<Vk::Effect> mEffect;
       SharedPtr<Vk::Effect> mEffectSkinning;
       SharedPtr<Vk::Effect> mEffectInstanced;
+      SharedPtr<Vk::Effect> mEffectInstancedCompact;
+      SharedPtr<Vk::Effect> mEffectInstancedSkinning;
       CascadeTransforms mCascadeTransforms;
+      std::array<DrawList, SHADOW_MAP_CASCADE_COUNT> mDrawLists;
       const uint32_t SHADOWMAP_DIMENSION = 4096;
    };
 }
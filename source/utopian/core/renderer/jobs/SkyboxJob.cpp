@@ -74,7 +74,7 @@ namespace Utopian
       Primitive* primitive = mCubeModel->GetPrimitive(0);
       commandBuffer->CmdBindVertexBuffer(0, 1, primitive->GetVertxBuffer());
       commandBuffer->CmdBindIndexBuffer(primitive->GetIndexBuffer(), 0, VK_INDEX_TYPE_UINT32);
-      commandBuffer->CmdDrawIndexed(primitive->GetNumIndices(), 1, 0, 0, 0);
+      commandBuffer->CmdDrawIndexed(primitive->GetNumIndices(), 1, primitive->GetFirstIndex(), primitive->GetVertexOffset(), 0);
 
       mRenderTarget->End(GetWaitSemahore(), GetCompletedSemahore());
    }
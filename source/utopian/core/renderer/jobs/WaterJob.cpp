@@ -173,7 +173,7 @@ namespace Utopian
 
          commandBuffer->CmdBindVertexBuffer(0, 1, mWaterMesh->GetVertxBuffer());
          commandBuffer->CmdBindIndexBuffer(mWaterMesh->GetIndexBuffer(), 0, VK_INDEX_TYPE_UINT32);
-         commandBuffer->CmdDrawIndexed(mWaterMesh->GetNumIndices(), 1, 0, 0, 0);
+         commandBuffer->CmdDrawIndexed(mWaterMesh->GetNumIndices(), 1, mWaterMesh->GetFirstIndex(), mWaterMesh->GetVertexOffset(), 0);
       }
 
       renderTarget->End(GetWaitSemahore(), GetCompletedSemahore());
@@ -0,0 +1,90 @@
+#include "utility/MappedFile.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Utopian
+{
+#if defined(_WIN32)
+   MappedFile::MappedFile(const std::string& filename)
+   {
+      HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+      if (file == INVALID_HANDLE_VALUE)
+         return;
+
+      mFileHandle = file;
+
+      LARGE_INTEGER size;
+      if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+         return;
+
+      mMappingHandle = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+      if (mMappingHandle == NULL)
+         return;
+
+      mData = (const uint8_t*)MapViewOfFile(mMappingHandle, FILE_MAP_READ, 0, 0, 0);
+      if (mData != nullptr)
+         mSize = (size_t)size.QuadPart;
+   }
+
+   MappedFile::~MappedFile()
+   {
+      if (mData != nullptr)
+         UnmapViewOfFile(mData);
+
+      if (mMappingHandle != nullptr)
+         CloseHandle(mMappingHandle);
+
+      if (mFileHandle != nullptr)
+         CloseHandle(mFileHandle);
+   }
+#else
+   MappedFile::MappedFile(const std::string& filename)
+   {
+      mFileDescriptor = open(filename.c_str(), O_RDONLY);
+      if (mFileDescriptor == -1)
+         return;
+
+      struct stat fileStat;
+      if (fstat(mFileDescriptor, &fileStat) != 0 || fileStat.st_size == 0)
+         return;
+
+      void* data = mmap(nullptr, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, mFileDescriptor, 0);
+      if (data == MAP_FAILED)
+         return;
+
+      mData = (const uint8_t*)data;
+      mSize = (size_t)fileStat.st_size;
+   }
+
+   MappedFile::~MappedFile()
+   {
+      if (mData != nullptr)
+         munmap((void*)mData, mSize);
+
+      if (mFileDescriptor != -1)
+         close(mFileDescriptor);
+   }
+#endif
+
+   bool MappedFile::IsOpen() const
+   {
+      return mData != nullptr;
+   }
+
+   const uint8_t* MappedFile::GetData() const
+   {
+      return mData;
+   }
+
+   size_t MappedFile::GetSize() const
+   {
+      return mSize;
+   }
+}
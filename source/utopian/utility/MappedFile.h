@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Utopian
+{
+   /**
+    * Read-only memory mapping of a file.
+    * The pages are loaded by the OS on first access so only the parts of the file that are read
+    * are touched, and there is no copy into a user space buffer like with std::ifstream.
+    */
+   class MappedFile
+   {
+   public:
+      MappedFile(const std::string& filename);
+      ~MappedFile();
+
+      MappedFile(const MappedFile&) = delete;
+      MappedFile& operator=(const MappedFile&) = delete;
+
+      /** Returns false if the file does not exist, is empty or could not be mapped. */
+      bool IsOpen() const;
+
+      const uint8_t* GetData() const;
+      size_t GetSize() const;
+
+   private:
+      const uint8_t* mData = nullptr;
+      size_t mSize = 0;
+
+#if defined(_WIN32)
+      void* mFileHandle = nullptr;
+      void* mMappingHandle = nullptr;
+#else
+      int mFileDescriptor = -1;
+#endif
+   };
+}
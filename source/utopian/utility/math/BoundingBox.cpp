@@ -19,17 +19,17 @@ namespace Utopian
 
          if (vertex.pos.x < min.x)
             min.x = vertex.pos.x;
-         else if (vertex.pos.x > max.x)
+         if (vertex.pos.x > max.x)
             max.x = vertex.pos.x;
 
          if (vertex.pos.y < min.y)
             min.y = vertex.pos.y;
-         else if (vertex.pos.y > max.y)
+         if (vertex.pos.y > max.y)
             max.y = vertex.pos.y;
 
          if (vertex.pos.z < min.z)
             min.z = vertex.pos.z;
-         else if (vertex.pos.z > max.z)
+         if (vertex.pos.z > max.z)
             max.z = vertex.pos.z;
       }
 
@@ -80,17 +80,17 @@ namespace Utopian
 
          if (pos.x < min.x)
             min.x = pos.x;
-         else if (pos.x > max.x)
+         if (pos.x > max.x)
             max.x = pos.x;
 
          if (pos.y < min.y)
             min.y = pos.y;
-         else if (pos.y > max.y)
+         if (pos.y > max.y)
             max.y = pos.y;
 
          if (pos.z < min.z)
             min.z = pos.z;
-         else if (pos.z > max.z)
+         if (pos.z > max.z)
             max.z = pos.z;
       }
 
@@ -98,6 +98,14 @@ namespace Utopian
       mMax = max;
    }
 
+   void BoundingBox::Merge(const BoundingBox& other)
+   {
+      glm::vec3 min = glm::min(mMin, other.GetMin());
+      glm::vec3 max = glm::max(mMax, other.GetMax());
+
+      Init(min, max - min);
+   }
+
    bool BoundingBox::RayIntersect(const Ray& ray, float& dist, glm::vec3& normal)
    {
       glm::vec3 min = mMin;
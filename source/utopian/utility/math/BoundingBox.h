@@ -16,6 +16,9 @@ namespace Utopian
       void Init(const std::vector<Vk::Vertex>& vertices);
       void Init(glm::vec3 position, glm::vec3 extents);
       void Update(glm::mat4 worldMatrix);
+
+      /** Grows the box to also enclose other. */
+      void Merge(const BoundingBox& other);
       bool RayIntersect(const Ray& ray, float& dist, glm::vec3& normal);
 
       float GetWidth() const;
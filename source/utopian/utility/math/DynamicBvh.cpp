@@ -0,0 +1,396 @@
+#include "utility/math/DynamicBvh.h"
+
+namespace Utopian
+{
+   DynamicBvh::DynamicBvh(float margin)
+   {
+      mMargin = margin;
+      Clear();
+   }
+
+   DynamicBvh::~DynamicBvh()
+   {
+   }
+
+   void DynamicBvh::Clear()
+   {
+      mNodes.clear();
+      mRoot = NULL_NODE;
+      mFreeList = NULL_NODE;
+      mNumProxies = 0u;
+   }
+
+   int32_t DynamicBvh::CreateProxy(const glm::vec3& min, const glm::vec3& max, void* userData)
+   {
+      int32_t proxyId = AllocateNode();
+
+      Node& node = mNodes[proxyId];
+      node.min = min - glm::vec3(mMargin);
+      node.max = max + glm::vec3(mMargin);
+      node.userData = userData;
+      node.height = 0;
+
+      InsertLeaf(proxyId);
+      mNumProxies++;
+
+      return proxyId;
+   }
+
+   void DynamicBvh::DestroyProxy(int32_t proxyId)
+   {
+      assert(proxyId >= 0 && proxyId < (int32_t)mNodes.size());
+      assert(mNodes[proxyId].IsLeaf());
+
+      RemoveLeaf(proxyId);
+      FreeNode(proxyId);
+      mNumProxies--;
+   }
+
+   bool DynamicBvh::MoveProxy(int32_t proxyId, const glm::vec3& min, const glm::vec3& max)
+   {
+      assert(proxyId >= 0 && proxyId < (int32_t)mNodes.size());
+      assert(mNodes[proxyId].IsLeaf());
+
+      Node& node = mNodes[proxyId];
+
+      // Still inside the fat box, nothing to do
+      if (glm::all(glm::lessThanEqual(node.min, min)) && glm::all(glm::greaterThanEqual(node.max, max)))
+         return false;
+
+      RemoveLeaf(proxyId);
+
+      mNodes[proxyId].min = min - glm::vec3(mMargin);
+      mNodes[proxyId].max = max + glm::vec3(mMargin);
+
+      InsertLeaf(proxyId);
+
+      return true;
+   }
+
+   void* DynamicBvh::GetUserData(int32_t proxyId) const
+   {
+      assert(proxyId >= 0 && proxyId < (int32_t)mNodes.size());
+      return mNodes[proxyId].userData;
+   }
+
+   void DynamicBvh::GetFatBounds(int32_t proxyId, glm::vec3& min, glm::vec3& max) const
+   {
+      assert(proxyId >= 0 && proxyId < (int32_t)mNodes.size());
+      min = mNodes[proxyId].min;
+      max = mNodes[proxyId].max;
+   }
+
+   uint32_t DynamicBvh::GetNumProxies() const
+   {
+      return mNumProxies;
+   }
+
+   int32_t DynamicBvh::GetHeight() const
+   {
+      if (mRoot == NULL_NODE)
+         return 0;
+
+      return mNodes[mRoot].height;
+   }
+
+   int32_t DynamicBvh::AllocateNode()
+   {
+      int32_t nodeId;
+
+      if (mFreeList != NULL_NODE)
+      {
+         nodeId = mFreeList;
+         mFreeList = mNodes[nodeId].parent;
+      }
+      else
+      {
+         nodeId = (int32_t)mNodes.size();
+         mNodes.push_back(Node());
+      }
+
+      Node& node = mNodes[nodeId];
+      node.userData = nullptr;
+      node.parent = NULL_NODE;
+      node.child1 = NULL_NODE;
+      node.child2 = NULL_NODE;
+      node.height = 0;
+
+      return nodeId;
+   }
+
+   void DynamicBvh::FreeNode(int32_t nodeId)
+   {
+      mNodes[nodeId].parent = mFreeList;
+      mNodes[nodeId].height = -1;
+      mFreeList = nodeId;
+   }
+
+   void DynamicBvh::InsertLeaf(int32_t leaf)
+   {
+      if (mRoot == NULL_NODE)
+      {
+         mRoot = leaf;
+         mNodes[mRoot].parent = NULL_NODE;
+         return;
+      }
+
+      // Find the best sibling by descending towards the cheapest surface area increase
+      const glm::vec3 leafMin = mNodes[leaf].min;
+      const glm::vec3 leafMax = mNodes[leaf].max;
+      int32_t index = mRoot;
+
+      while (!mNodes[index].IsLeaf())
+      {
+         const Node& node = mNodes[index];
+         int32_t child1 = node.child1;
+         int32_t child2 = node.child2;
+
+         float area = SurfaceArea(node.min, node.max);
+         float combinedArea = SurfaceArea(glm::min(node.min, leafMin), glm::max(node.max, leafMax));
+
+         // Cost of creating a new parent for this node and the new leaf
+         float cost = 2.0f * combinedArea;
+
+         // Minimum cost of pushing the leaf further down the tree
+         float inheritanceCost = 2.0f * (combinedArea - area);
+
+         auto descendCost = [&](int32_t child) {
+            const Node& childNode = mNodes[child];
+            float newArea = SurfaceArea(glm::min(childNode.min, leafMin), glm::max(childNode.max, leafMax));
+            if (childNode.IsLeaf())
+               return newArea + inheritanceCost;
+            else
+               return (newArea - SurfaceArea(childNode.min, childNode.max)) + inheritanceCost;
+         };
+
+         float cost1 = descendCost(child1);
+         float cost2 = descendCost(child2);
+
+         if (cost < cost1 && cost < cost2)
+            break;
+
+         index = (cost1 < cost2) ? child1 : child2;
+      }
+
+      int32_t sibling = index;
+
+      // Create a new parent for the sibling and the leaf
+      int32_t oldParent = mNodes[sibling].parent;
+      int32_t newParent = AllocateNode();
+      mNodes[newParent].parent = oldParent;
+      mNodes[newParent].min = glm::min(mNodes[sibling].min, leafMin);
+      mNodes[newParent].max = glm::max(mNodes[sibling].max, leafMax);
+      mNodes[newParent].height = mNodes[sibling].height + 1;
+      mNodes[newParent].child1 = sibling;
+      mNodes[newParent].child2 = leaf;
+      mNodes[sibling].parent = newParent;
+      mNodes[leaf].parent = newParent;
+
+      if (oldParent != NULL_NODE)
+      {
+         if (mNodes[oldParent].child1 == sibling)
+            mNodes[oldParent].child1 = newParent;
+         else
+            mNodes[oldParent].child2 = newParent;
+      }
+      else
+      {
+         mRoot = newParent;
+      }
+
+      RefitAncestors(mNodes[leaf].parent);
+   }
+
+   void DynamicBvh::RemoveLeaf(int32_t leaf)
+   {
+      if (leaf == mRoot)
+      {
+         mRoot = NULL_NODE;
+         return;
+      }
+
+      int32_t parent = mNodes[leaf].parent;
+      int32_t grandParent = mNodes[parent].parent;
+      int32_t sibling = (mNodes[parent].child1 == leaf) ? mNodes[parent].child2 : mNodes[parent].child1;
+
+      if (grandParent != NULL_NODE)
+      {
+         // Replace the parent with the sibling
+         if (mNodes[grandParent].child1 == parent)
+            mNodes[grandParent].child1 = sibling;
+         else
+            mNodes[grandParent].child2 = sibling;
+
+         mNodes[sibling].parent = grandParent;
+         FreeNode(parent);
+
+         RefitAncestors(grandParent);
+      }
+      else
+      {
+         mRoot = sibling;
+         mNodes[sibling].parent = NULL_NODE;
+         FreeNode(parent);
+      }
+   }
+
+   void DynamicBvh::RefitAncestors(int32_t nodeId)
+   {
+      int32_t index = nodeId;
+      while (index != NULL_NODE)
+      {
+         index = Balance(index);
+
+         Node& node = mNodes[index];
+         const Node& child1 = mNodes[node.child1];
+         const Node& child2 = mNodes[node.child2];
+
+         node.height = 1 + glm::max(child1.height, child2.height);
+         node.min = glm::min(child1.min, child2.min);
+         node.max = glm::max(child1.max, child2.max);
+
+         index = node.parent;
+      }
+   }
+
+   int32_t DynamicBvh::Balance(int32_t iA)
+   {
+      // Performs a left or right rotation if node A is imbalanced, returns the new root of the subtree
+      Node& A = mNodes[iA];
+      if (A.IsLeaf() || A.height < 2)
+         return iA;
+
+      int32_t iB = A.child1;
+      int32_t iC = A.child2;
+      Node& B = mNodes[iB];
+      Node& C = mNodes[iC];
+
+      int32_t balance = C.height - B.height;
+
+      // Rotate C up
+      if (balance > 1)
+      {
+         int32_t iF = C.child1;
+         int32_t iG = C.child2;
+         Node& F = mNodes[iF];
+         Node& G = mNodes[iG];
+
+         C.child1 = iA;
+         C.parent = A.parent;
+         A.parent = iC;
+
+         if (C.parent != NULL_NODE)
+         {
+            if (mNodes[C.parent].child1 == iA)
+               mNodes[C.parent].child1 = iC;
+            else
+               mNodes[C.parent].child2 = iC;
+         }
+         else
+         {
+            mRoot = iC;
+         }
+
+         if (F.height > G.height)
+         {
+            C.child2 = iF;
+            A.child2 = iG;
+            G.parent = iA;
+            A.min = glm::min(B.min, G.min);
+            A.max = glm::max(B.max, G.max);
+            C.min = glm::min(A.min, F.min);
+            C.max = glm::max(A.max, F.max);
+            A.height = 1 + glm::max(B.height, G.height);
+            C.height = 1 + glm::max(A.height, F.height);
+         }
+         else
+         {
+            C.child2 = iG;
+            A.child2 = iF;
+            F.parent = iA;
+            A.min = glm::min(B.min, F.min);
+            A.max = glm::max(B.max, F.max);
+            C.min = glm::min(A.min, G.min);
+            C.max = glm::max(A.max, G.max);
+            A.height = 1 + glm::max(B.height, F.height);
+            C.height = 1 + glm::max(A.height, G.height);
+         }
+
+         return iC;
+      }
+
+      // Rotate B up
+      if (balance < -1)
+      {
+         int32_t iD = B.child1;
+         int32_t iE = B.child2;
+         Node& D = mNodes[iD];
+         Node& E = mNodes[iE];
+
+         B.child1 = iA;
+         B.parent = A.parent;
+         A.parent = iB;
+
+         if (B.parent != NULL_NODE)
+         {
+            if (mNodes[B.parent].child1 == iA)
+               mNodes[B.parent].child1 = iB;
+            else
+               mNodes[B.parent].child2 = iB;
+         }
+         else
+         {
+            mRoot = iB;
+         }
+
+         if (D.height > E.height)
+         {
+            B.child2 = iD;
+            A.child1 = iE;
+            E.parent = iA;
+            A.min = glm::min(C.min, E.min);
+            A.max = glm::max(C.max, E.max);
+            B.min = glm::min(A.min, D.min);
+            B.max = glm::max(A.max, D.max);
+            A.height = 1 + glm::max(C.height, E.height);
+            B.height = 1 + glm::max(A.height, D.height);
+         }
+         else
+         {
+            B.child2 = iE;
+            A.child1 = iD;
+            D.parent = iA;
+            A.min = glm::min(C.min, D.min);
+            A.max = glm::max(C.max, D.max);
+            B.min = glm::min(A.min, E.min);
+            B.max = glm::max(A.max, E.max);
+            A.height = 1 + glm::max(C.height, D.height);
+            B.height = 1 + glm::max(A.height, E.height);
+         }
+
+         return iB;
+      }
+
+      return iA;
+   }
+
+   float DynamicBvh::SurfaceArea(const glm::vec3& min, const glm::vec3& max)
+   {
+      glm::vec3 d = max - min;
+      return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+   }
+
+   bool DynamicBvh::RayIntersectsBox(const glm::vec3& origin, const glm::vec3& invDirection, const glm::vec3& min,
+                                     const glm::vec3& max, float maxDistance)
+   {
+      glm::vec3 t0 = (min - origin) * invDirection;
+      glm::vec3 t1 = (max - origin) * invDirection;
+      glm::vec3 tNear = glm::min(t0, t1);
+      glm::vec3 tFar = glm::max(t0, t1);
+
+      float tEnter = glm::max(glm::max(tNear.x, tNear.y), tNear.z);
+      float tExit = glm::min(glm::min(tFar.x, tFar.y), tFar.z);
+
+      return tEnter <= tExit && tExit >= 0.0f && tEnter <= maxDistance;
+   }
+}
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <cassert>
+#include <glm/glm.hpp>
+#include "utility/math/Frustum.h"
+#include "utility/math/Ray.h"
+
+namespace Utopian
+{
+   /**
+    * Dynamic bounding volume hierarchy of axis aligned boxes.
+    * Leaves are stored with an enlarged (fat) box so that small movements don't require
+    * the tree to be modified, and the tree is kept balanced with AVL style rotations.
+    * Based on the dynamic tree from Box2D.
+    */
+   class DynamicBvh
+   {
+   public:
+      static const int32_t NULL_NODE = -1;
+
+      DynamicBvh(float margin = 1.0f);
+      ~DynamicBvh();
+
+      /** Creates a leaf and returns its proxy id. */
+      int32_t CreateProxy(const glm::vec3& min, const glm::vec3& max, void* userData);
+
+      /** Removes the leaf with the proxy id. */
+      void DestroyProxy(int32_t proxyId);
+
+      /**
+       * Updates the bounds of a proxy.
+       * @return True if the leaf had to be reinserted, false if it still fits in its fat box.
+       */
+      bool MoveProxy(int32_t proxyId, const glm::vec3& min, const glm::vec3& max);
+
+      /** Removes all proxies. */
+      void Clear();
+
+      void* GetUserData(int32_t proxyId) const;
+      void GetFatBounds(int32_t proxyId, glm::vec3& min, glm::vec3& max) const;
+      uint32_t GetNumProxies() const;
+      int32_t GetHeight() const;
+
+      /** Calls callback(userData) for every leaf overlapping the frustum. */
+      template <typename T>
+      void QueryFrustum(const Frustum& frustum, bool checkDepth, T callback) const;
+
+      /** Calls callback(userData) for every leaf overlapping the sphere. */
+      template <typename T>
+      void QuerySphere(const glm::vec3& center, float radius, T callback) const;
+
+      /**
+       * Calls callback(userData, maxDistance) for every leaf the ray hits closer than maxDistance.
+       * The callback returns the new max distance, which prunes the remaining traversal.
+       */
+      template <typename T>
+      void QueryRay(const Ray& ray, float maxDistance, T callback) const;
+
+   private:
+      struct Node
+      {
+         bool IsLeaf() const { return child1 == NULL_NODE; }
+
+         glm::vec3 min;
+         glm::vec3 max;
+         void* userData;
+
+         // Parent when in the tree, next free node when in the free list
+         int32_t parent;
+         int32_t child1;
+         int32_t child2;
+
+         // Leaf = 0, free node = -1
+         int32_t height;
+      };
+
+      int32_t AllocateNode();
+      void FreeNode(int32_t nodeId);
+      void InsertLeaf(int32_t leaf);
+      void RemoveLeaf(int32_t leaf);
+      int32_t Balance(int32_t nodeId);
+      void RefitAncestors(int32_t nodeId);
+
+      static float SurfaceArea(const glm::vec3& min, const glm::vec3& max);
+      static bool RayIntersectsBox(const glm::vec3& origin, const glm::vec3& invDirection, const glm::vec3& min,
+                                   const glm::vec3& max, float maxDistance);
+
+   private:
+      // Traversal stack size, the balanced tree stays far below this
+      static const uint32_t STACK_SIZE = 256;
+
+      std::vector<Node> mNodes;
+      int32_t mRoot;
+      int32_t mFreeList;
+      uint32_t mNumProxies;
+      float mMargin;
+   };
+
+   template <typename T>
+   void DynamicBvh::QueryFrustum(const Frustum& frustum, bool checkDepth, T callback) const
+   {
+      std::array<int32_t, STACK_SIZE> stack;
+      uint32_t stackSize = 0;
+      stack[stackSize++] = mRoot;
+
+      while (stackSize > 0)
+      {
+         int32_t nodeId = stack[--stackSize];
+         if (nodeId == NULL_NODE)
+            continue;
+
+         const Node& node = mNodes[nodeId];
+         if (!frustum.CheckBox(node.min, node.max, checkDepth))
+            continue;
+
+         if (node.IsLeaf())
+         {
+            callback(node.userData);
+         }
+         else
+         {
+            assert(stackSize + 2 <= STACK_SIZE);
+            stack[stackSize++] = node.child1;
+            stack[stackSize++] = node.child2;
+         }
+      }
+   }
+
+   template <typename T>
+   void DynamicBvh::QuerySphere(const glm::vec3& center, float radius, T callback) const
+   {
+      std::array<int32_t, STACK_SIZE> stack;
+      uint32_t stackSize = 0;
+      stack[stackSize++] = mRoot;
+
+      const float radiusSquared = radius * radius;
+
+      while (stackSize > 0)
+      {
+         int32_t nodeId = stack[--stackSize];
+         if (nodeId == NULL_NODE)
+            continue;
+
+         const Node& node = mNodes[nodeId];
+         glm::vec3 closest = glm::clamp(center, node.min, node.max);
+         glm::vec3 delta = closest - center;
+         if (glm::dot(delta, delta) > radiusSquared)
+            continue;
+
+         if (node.IsLeaf())
+         {
+            callback(node.userData);
+         }
+         else
+         {
+            assert(stackSize + 2 <= STACK_SIZE);
+            stack[stackSize++] = node.child1;
+            stack[stackSize++] = node.child2;
+         }
+      }
+   }
+
+   template <typename T>
+   void DynamicBvh::QueryRay(const Ray& ray, float maxDistance, T callback) const
+   {
+      std::array<int32_t, STACK_SIZE> stack;
+      uint32_t stackSize = 0;
+      stack[stackSize++] = mRoot;
+
+      const glm::vec3 invDirection = 1.0f / ray.direction;
+
+      while (stackSize > 0)
+      {
+         int32_t nodeId = stack[--stackSize];
+         if (nodeId == NULL_NODE)
+            continue;
+
+         const Node& node = mNodes[nodeId];
+         if (!RayIntersectsBox(ray.origin, invDirection, node.min, node.max, maxDistance))
+            continue;
+
+         if (node.IsLeaf())
+         {
+            maxDistance = callback(node.userData, maxDistance);
+         }
+         else
+         {
+            assert(stackSize + 2 <= STACK_SIZE);
+            stack[stackSize++] = node.child1;
+            stack[stackSize++] = node.child2;
+         }
+      }
+   }
+}
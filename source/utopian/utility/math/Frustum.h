@@ -1,3 +1,5 @@
+#pragma once
+
 #include <array>
 #include <math.h>
 #include <glm/glm.hpp>
@@ -49,7 +51,7 @@ namespace Utopian
          }
       }
 
-      bool CheckSphere(glm::vec3 pos, float radius)
+      bool CheckSphere(glm::vec3 pos, float radius) const
       {
          for (auto i = 0; i < planes.size(); i++)
          {
@@ -60,5 +62,27 @@ namespace Utopian
          }
          return true;
       }
+
+      /**
+       * Returns false if the axis aligned box is fully outside any of the planes.
+       * @note The near and far planes can be skipped, e.g. when culling shadow casters.
+       */
+      bool CheckBox(const glm::vec3& min, const glm::vec3& max, bool checkDepth = true) const
+      {
+         const auto numPlanes = checkDepth ? planes.size() : BACK;
+         for (auto i = 0; i < numPlanes; i++)
+         {
+            // The corner furthest along the plane normal
+            glm::vec3 positive = glm::vec3(planes[i].x >= 0.0f ? max.x : min.x,
+                                           planes[i].y >= 0.0f ? max.y : min.y,
+                                           planes[i].z >= 0.0f ? max.z : min.z);
+
+            if ((planes[i].x * positive.x) + (planes[i].y * positive.y) + (planes[i].z * positive.z) + planes[i].w < 0.0f)
+            {
+               return false;
+            }
+         }
+         return true;
+      }
    };
 }
@@ -0,0 +1,466 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include "utility/math/Heightmap.h"
+
+// SSE2 is part of the x64 baseline, other targets use the scalar path
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HEIGHTMAP_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace Utopian
+{
+   Heightmap::Heightmap()
+   {
+      mResolution = 0;
+      mSize = 1.0f;
+      mAmplitude = 1.0f;
+   }
+
+   Heightmap::~Heightmap()
+   {
+   }
+
+   void Heightmap::SetSamples(const float* samples, uint32_t resolution)
+   {
+      if (resolution != mResolution || mSamples.empty())
+      {
+         mResolution = resolution;
+         mSamples.assign(samples, samples + (size_t)resolution * resolution);
+         BuildPyramid();
+         return;
+      }
+
+      // Terrain brushes only modify a small part of the map, find the rectangle that changed
+      uint32_t minX = UINT32_MAX, minY = UINT32_MAX, maxX = 0, maxY = 0;
+      for (uint32_t y = 0; y < resolution; y++)
+      {
+         const float* source = samples + (size_t)y * resolution;
+         float* destination = &mSamples[(size_t)y * resolution];
+
+         if (memcmp(source, destination, resolution * sizeof(float)) == 0)
+            continue;
+
+         for (uint32_t x = 0; x < resolution; x++)
+         {
+            if (source[x] != destination[x])
+            {
+               minX = std::min(minX, x);
+               maxX = std::max(maxX, x);
+               minY = std::min(minY, y);
+               maxY = y;
+            }
+         }
+
+         memcpy(destination, source, resolution * sizeof(float));
+      }
+
+      if (minY != UINT32_MAX)
+         RefitPyramid(minX, minY, maxX, maxY);
+   }
+
+   void Heightmap::SetSize(float size)
+   {
+      mSize = size;
+   }
+
+   void Heightmap::SetAmplitude(float amplitude)
+   {
+      mAmplitude = amplitude;
+   }
+
+   bool Heightmap::GetTexelCoordinates(float x, float z, float& tx, float& ty) const
+   {
+      // Same transform as Terrain::TransformToUv(), the map is flipped in both directions
+      const float invSize = 1.0f / mSize;
+      float u = 1.0f - (x + 0.5f * mSize) * invSize;
+      float v = 1.0f - (z + 0.5f * mSize) * invSize;
+
+      if (u < 0.0f || u >= 1.0f || v < 0.0f || v >= 1.0f)
+         return false;
+
+      // The texel centers are at half texel offsets, the border texels are extended to the edges
+      const float maxTexel = (float)(mResolution - 1);
+      tx = std::min(std::max(u * mResolution - 0.5f, 0.0f), maxTexel);
+      ty = std::min(std::max(v * mResolution - 0.5f, 0.0f), maxTexel);
+
+      return true;
+   }
+
+   float Heightmap::GetHeightScale() const
+   {
+      return -mAmplitude; // Todo: Fix amplitude and -1
+   }
+
+   float Heightmap::GetHeight(float x, float z) const
+   {
+      if (IsEmpty())
+         return 0.0f;
+
+      float tx, ty;
+      if (!GetTexelCoordinates(x, z, tx, ty))
+         return -1.0f;
+
+      const uint32_t x0 = (uint32_t)tx;
+      const uint32_t y0 = (uint32_t)ty;
+      const uint32_t x1 = std::min(x0 + 1, mResolution - 1);
+      const uint32_t y1 = std::min(y0 + 1, mResolution - 1);
+      const float fx = tx - x0;
+      const float fy = ty - y0;
+
+      const float* row0 = &mSamples[(size_t)y0 * mResolution];
+      const float* row1 = &mSamples[(size_t)y1 * mResolution];
+      float h0 = row0[x0] + (row0[x1] - row0[x0]) * fx;
+      float h1 = row1[x0] + (row1[x1] - row1[x0]) * fx;
+
+      return (h0 + (h1 - h0) * fy) * GetHeightScale();
+   }
+
+   void Heightmap::GetHeights(const glm::vec2* positions, float* heights, uint32_t count) const
+   {
+      if (IsEmpty())
+      {
+         std::fill(heights, heights + count, 0.0f);
+         return;
+      }
+
+      uint32_t i = 0;
+
+#ifdef HEIGHTMAP_SSE2
+      const __m128 zero = _mm_setzero_ps();
+      const __m128 one = _mm_set1_ps(1.0f);
+      const __m128 halfSize = _mm_set1_ps(0.5f * mSize);
+      const __m128 invSize = _mm_set1_ps(1.0f / mSize);
+      const __m128 resolution = _mm_set1_ps((float)mResolution);
+      const __m128 halfTexel = _mm_set1_ps(0.5f);
+      const __m128 maxTexel = _mm_set1_ps((float)(mResolution - 1));
+      const __m128 heightScale = _mm_set1_ps(GetHeightScale());
+      const __m128 outside = _mm_set1_ps(-1.0f);
+      const float* samples = mSamples.data();
+
+      alignas(16) int32_t i00[4], i01[4], i10[4], i11[4];
+
+      for (; i + 4 <= count; i += 4)
+      {
+         // Deinterleave the x and z of four positions
+         __m128 a = _mm_loadu_ps(&positions[i].x);
+         __m128 b = _mm_loadu_ps(&positions[i + 2].x);
+         __m128 x = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+         __m128 z = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+
+         __m128 u = _mm_sub_ps(one, _mm_mul_ps(_mm_add_ps(x, halfSize), invSize));
+         __m128 v = _mm_sub_ps(one, _mm_mul_ps(_mm_add_ps(z, halfSize), invSize));
+         __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmplt_ps(u, one)),
+                                    _mm_and_ps(_mm_cmpge_ps(v, zero), _mm_cmplt_ps(v, one)));
+
+         __m128 tx = _mm_min_ps(_mm_max_ps(_mm_sub_ps(_mm_mul_ps(u, resolution), halfTexel), zero), maxTexel);
+         __m128 ty = _mm_min_ps(_mm_max_ps(_mm_sub_ps(_mm_mul_ps(v, resolution), halfTexel), zero), maxTexel);
+
+         // The coordinates are not negative so truncation is floor, the indices are exact in float
+         __m128 x0 = _mm_cvtepi32_ps(_mm_cvttps_epi32(tx));
+         __m128 y0 = _mm_cvtepi32_ps(_mm_cvttps_epi32(ty));
+         __m128 x1 = _mm_min_ps(_mm_add_ps(x0, one), maxTexel);
+         __m128 y1 = _mm_min_ps(_mm_add_ps(y0, one), maxTexel);
+         __m128 fx = _mm_sub_ps(tx, x0);
+         __m128 fy = _mm_sub_ps(ty, y0);
+
+         __m128 row0 = _mm_mul_ps(y0, resolution);
+         __m128 row1 = _mm_mul_ps(y1, resolution);
+         _mm_store_si128((__m128i*)i00, _mm_cvttps_epi32(_mm_add_ps(row0, x0)));
+         _mm_store_si128((__m128i*)i01, _mm_cvttps_epi32(_mm_add_ps(row0, x1)));
+         _mm_store_si128((__m128i*)i10, _mm_cvttps_epi32(_mm_add_ps(row1, x0)));
+         _mm_store_si128((__m128i*)i11, _mm_cvttps_epi32(_mm_add_ps(row1, x1)));
+
+         // SSE2 has no gather, the filtering is vectorized but the samples are loaded one at a time
+         __m128 h00 = _mm_setr_ps(samples[i00[0]], samples[i00[1]], samples[i00[2]], samples[i00[3]]);
+         __m128 h01 = _mm_setr_ps(samples[i01[0]], samples[i01[1]], samples[i01[2]], samples[i01[3]]);
+         __m128 h10 = _mm_setr_ps(samples[i10[0]], samples[i10[1]], samples[i10[2]], samples[i10[3]]);
+         __m128 h11 = _mm_setr_ps(samples[i11[0]], samples[i11[1]], samples[i11[2]], samples[i11[3]]);
+
+         __m128 h0 = _mm_add_ps(h00, _mm_mul_ps(_mm_sub_ps(h01, h00), fx));
+         __m128 h1 = _mm_add_ps(h10, _mm_mul_ps(_mm_sub_ps(h11, h10), fx));
+         __m128 height = _mm_mul_ps(_mm_add_ps(h0, _mm_mul_ps(_mm_sub_ps(h1, h0), fy)), heightScale);
+
+         height = _mm_or_ps(_mm_and_ps(inside, height), _mm_andnot_ps(inside, outside));
+         _mm_storeu_ps(&heights[i], height);
+      }
+#endif
+
+      for (; i < count; i++)
+         heights[i] = GetHeight(positions[i].x, positions[i].y);
+   }
+
+   glm::vec3 Heightmap::GetNormal(float x, float z) const
+   {
+      float tx, ty;
+      if (IsEmpty() || !GetTexelCoordinates(x, z, tx, ty))
+         return glm::vec3(0.0f, 1.0f, 0.0f);
+
+      const uint32_t x0 = (uint32_t)tx;
+      const uint32_t y0 = (uint32_t)ty;
+      const uint32_t x1 = std::min(x0 + 1, mResolution - 1);
+      const uint32_t y1 = std::min(y0 + 1, mResolution - 1);
+      const float fx = tx - x0;
+      const float fy = ty - y0;
+
+      const float* row0 = &mSamples[(size_t)y0 * mResolution];
+      const float* row1 = &mSamples[(size_t)y1 * mResolution];
+
+      // Partial derivatives of the bilinear patch in texels
+      float dtx = (row0[x1] - row0[x0]) * (1.0f - fy) + (row1[x1] - row1[x0]) * fy;
+      float dty = (row1[x0] - row0[x0]) * (1.0f - fx) + (row1[x1] - row0[x1]) * fx;
+
+      // A texel is size / resolution wide and the texel coordinates decrease with x and z
+      const float texelsPerUnit = -(float)mResolution / mSize;
+      float dhdx = dtx * texelsPerUnit * GetHeightScale();
+      float dhdz = dty * texelsPerUnit * GetHeightScale();
+
+      return glm::normalize(glm::vec3(-dhdx, 1.0f, -dhdz));
+   }
+
+   void Heightmap::BuildPyramid()
+   {
+      mPyramid.clear();
+
+      if (mResolution < 2)
+         return;
+
+      uint32_t size = mResolution - 1;
+      while (true)
+      {
+         PyramidLevel level;
+         level.size = size;
+         level.minMax.resize((size_t)size * size);
+         mPyramid.push_back(level);
+
+         if (size == 1)
+            break;
+
+         size = (size + 1) / 2;
+      }
+
+      RefitPyramid(0, 0, mResolution - 1, mResolution - 1);
+   }
+
+   void Heightmap::RefitPyramid(uint32_t minX, uint32_t minY, uint32_t maxX, uint32_t maxY)
+   {
+      if (mPyramid.empty())
+         return;
+
+      // A sample is a corner of the cells to its left and right
+      const uint32_t numCells = mResolution - 1;
+      uint32_t x0 = minX > 0 ? minX - 1 : 0;
+      uint32_t y0 = minY > 0 ? minY - 1 : 0;
+      uint32_t x1 = std::min(maxX, numCells - 1);
+      uint32_t y1 = std::min(maxY, numCells - 1);
+
+      PyramidLevel& cells = mPyramid[0];
+      for (uint32_t y = y0; y <= y1; y++)
+      {
+         const float* row0 = &mSamples[(size_t)y * mResolution];
+         const float* row1 = row0 + mResolution;
+         for (uint32_t x = x0; x <= x1; x++)
+         {
+            float minSample = std::min(std::min(row0[x], row0[x + 1]), std::min(row1[x], row1[x + 1]));
+            float maxSample = std::max(std::max(row0[x], row0[x + 1]), std::max(row1[x], row1[x + 1]));
+            cells.minMax[(size_t)y * cells.size + x] = glm::vec2(minSample, maxSample);
+         }
+      }
+
+      for (uint32_t i = 1; i < mPyramid.size(); i++)
+      {
+         const PyramidLevel& children = mPyramid[i - 1];
+         PyramidLevel& level = mPyramid[i];
+
+         x0 /= 2;
+         y0 /= 2;
+         x1 /= 2;
+         y1 /= 2;
+
+         for (uint32_t y = y0; y <= y1; y++)
+         {
+            for (uint32_t x = x0; x <= x1; x++)
+            {
+               // The last row and column of a level can have a single child when the level below has an odd size
+               glm::vec2 minMax = glm::vec2(FLT_MAX, -FLT_MAX);
+               for (uint32_t childY = 2 * y; childY < std::min(2 * y + 2, children.size); childY++)
+               {
+                  for (uint32_t childX = 2 * x; childX < std::min(2 * x + 2, children.size); childX++)
+                  {
+                     const glm::vec2& child = children.minMax[(size_t)childY * children.size + childX];
+                     minMax.x = std::min(minMax.x, child.x);
+                     minMax.y = std::max(minMax.y, child.y);
+                  }
+               }
+
+               level.minMax[(size_t)y * level.size + x] = minMax;
+            }
+         }
+      }
+   }
+
+   bool Heightmap::IntersectCell(Ray& ray, uint32_t cellX, uint32_t cellY, float& distance) const
+   {
+      const float scale = GetHeightScale();
+      const float* row0 = &mSamples[(size_t)cellY * mResolution];
+      const float* row1 = row0 + mResolution;
+
+      const float x0 = (float)cellX;
+      const float x1 = x0 + 1.0f;
+      const float z0 = (float)cellY;
+      const float z1 = z0 + 1.0f;
+      const glm::vec3 p00 = glm::vec3(x0, row0[cellX] * scale, z0);
+      const glm::vec3 p10 = glm::vec3(x1, row0[cellX + 1] * scale, z0);
+      const glm::vec3 p01 = glm::vec3(x0, row1[cellX] * scale, z1);
+      const glm::vec3 p11 = glm::vec3(x1, row1[cellX + 1] * scale, z1);
+
+      glm::vec3 intersectPoint;
+      float triangleDistance;
+      bool hit = false;
+      distance = FLT_MAX;
+
+      if (ray.TriangleIntersect(p00, p10, p11, intersectPoint, triangleDistance))
+      {
+         distance = triangleDistance;
+         hit = true;
+      }
+
+      if (ray.TriangleIntersect(p00, p11, p01, intersectPoint, triangleDistance) && triangleDistance < distance)
+      {
+         distance = triangleDistance;
+         hit = true;
+      }
+
+      return hit;
+   }
+
+   bool Heightmap::RayIntersect(const Ray& ray, glm::vec3& intersectPoint) const
+   {
+      if (mPyramid.empty())
+         return false;
+
+      // Trace in texel space where the cell corners are at integer x and z and y is the height.
+      // The transform is affine so the ray parameter of a hit is the same as in world space.
+      const float texelsPerUnit = -(float)mResolution / mSize;
+      const float texelOffset = 0.5f * mResolution - 0.5f;
+      const float scale = GetHeightScale();
+      const float numCells = (float)(mResolution - 1);
+
+      Ray texelRay;
+      texelRay.origin = glm::vec3(texelOffset + ray.origin.x * texelsPerUnit, ray.origin.y, texelOffset + ray.origin.z * texelsPerUnit);
+      texelRay.direction = glm::vec3(ray.direction.x * texelsPerUnit, ray.direction.y, ray.direction.z * texelsPerUnit);
+      const glm::vec3 origin = texelRay.origin;
+      const glm::vec3 direction = texelRay.direction;
+
+      // Clip the ray to the bounds of the whole map
+      const glm::vec2 rootMinMax = mPyramid.back().minMax[0];
+      const float boundsMin[3] = { 0.0f, std::min(rootMinMax.x * scale, rootMinMax.y * scale), 0.0f };
+      const float boundsMax[3] = { numCells, std::max(rootMinMax.x * scale, rootMinMax.y * scale), numCells };
+      const float rayOrigin[3] = { origin.x, origin.y, origin.z };
+      const float rayDirection[3] = { direction.x, direction.y, direction.z };
+
+      float tMin = 0.0f;
+      float tMax = FLT_MAX;
+      for (uint32_t axis = 0; axis < 3; axis++)
+      {
+         if (rayDirection[axis] == 0.0f)
+         {
+            if (rayOrigin[axis] < boundsMin[axis] || rayOrigin[axis] > boundsMax[axis])
+               return false;
+
+            continue;
+         }
+
+         float t0 = (boundsMin[axis] - rayOrigin[axis]) / rayDirection[axis];
+         float t1 = (boundsMax[axis] - rayOrigin[axis]) / rayDirection[axis];
+         tMin = std::max(tMin, std::min(t0, t1));
+         tMax = std::min(tMax, std::max(t0, t1));
+      }
+
+      if (tMin > tMax)
+         return false;
+
+      // Small step past node boundaries so that the position falls in the next node
+      const float horizontalLength = sqrtf(direction.x * direction.x + direction.z * direction.z);
+      const float nudge = horizontalLength > 0.0f ? 0.001f / horizontalLength : 0.0f;
+
+      const uint32_t topLevel = (uint32_t)mPyramid.size() - 1;
+      uint32_t level = topLevel;
+      float t = tMin;
+
+      while (t < tMax)
+      {
+         const PyramidLevel& pyramidLevel = mPyramid[level];
+         const float nodeSize = (float)(1u << level);
+         const float maxNode = (float)(pyramidLevel.size - 1);
+
+         glm::vec3 position = origin + direction * (t + nudge);
+         uint32_t nodeX = (uint32_t)std::min(std::max(position.x / nodeSize, 0.0f), maxNode);
+         uint32_t nodeY = (uint32_t)std::min(std::max(position.z / nodeSize, 0.0f), maxNode);
+
+         float tExit = tMax;
+         if (direction.x > 0.0f)
+            tExit = std::min(tExit, ((nodeX + 1) * nodeSize - origin.x) / direction.x);
+         else if (direction.x < 0.0f)
+            tExit = std::min(tExit, (nodeX * nodeSize - origin.x) / direction.x);
+
+         if (direction.z > 0.0f)
+            tExit = std::min(tExit, ((nodeY + 1) * nodeSize - origin.z) / direction.z);
+         else if (direction.z < 0.0f)
+            tExit = std::min(tExit, (nodeY * nodeSize - origin.z) / direction.z);
+
+         const glm::vec2 minMax = pyramidLevel.minMax[(size_t)nodeY * pyramidLevel.size + nodeX];
+         const float nodeMaxHeight = std::max(minMax.x * scale, minMax.y * scale);
+         const float rayMinHeight = std::min(origin.y + direction.y * t, origin.y + direction.y * tExit);
+
+         if (level > 0 && rayMinHeight <= nodeMaxHeight)
+         {
+            level--;
+            continue;
+         }
+
+         if (level == 0 && rayMinHeight <= nodeMaxHeight)
+         {
+            float distance;
+            if (IntersectCell(texelRay, nodeX, nodeY, distance))
+            {
+               intersectPoint = ray.origin + ray.direction * distance;
+               return true;
+            }
+         }
+
+         // Passed above the node, continue at a coarser level
+         t = std::max(tExit, t + nudge);
+         level = std::min(level + 1, topLevel);
+      }
+
+      return false;
+   }
+
+   const float* Heightmap::GetSamples() const
+   {
+      return mSamples.data();
+   }
+
+   uint32_t Heightmap::GetResolution() const
+   {
+      return mResolution;
+   }
+
+   float Heightmap::GetSize() const
+   {
+      return mSize;
+   }
+
+   float Heightmap::GetAmplitude() const
+   {
+      return mAmplitude;
+   }
+
+   bool Heightmap::IsEmpty() const
+   {
+      return mSamples.empty();
+   }
+}
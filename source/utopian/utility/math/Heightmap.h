@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "utility/math/Ray.h"
+
+namespace Utopian
+{
+   /**
+    * CPU copy of the terrain heightmap answering height, normal and ray queries.
+    * The samples are filtered bilinearly between the texel centers like the sampler used when rendering
+    * the terrain. Positions are in the same space as Terrain::GetHeight() and the map is centered at the origin.
+    * A min/max pyramid over the cells between the texel centers accelerates ray intersections.
+    */
+   class Heightmap
+   {
+   public:
+      Heightmap();
+      ~Heightmap();
+
+      /**
+       * Copies resolution * resolution samples, stored in rows of increasing v.
+       * When the resolution is unchanged only the pyramid nodes above the samples that differ are refit.
+       */
+      void SetSamples(const float* samples, uint32_t resolution);
+
+      /** Sets the width and depth of the area that the heightmap covers. */
+      void SetSize(float size);
+
+      /** The samples are scaled by the amplitude, see Terrain::GetAmplitudeScaling(). */
+      void SetAmplitude(float amplitude);
+
+      /** Returns the bilinearly filtered height, 0 if no samples are set and -1 outside of the map. */
+      float GetHeight(float x, float z) const;
+
+      /**
+       * Returns the height at every position, the same as calling GetHeight() for each of them.
+       * Four positions at a time are filtered with SSE2.
+       */
+      void GetHeights(const glm::vec2* positions, float* heights, uint32_t count) const;
+
+      /** Returns the normal of the bilinearly filtered surface, from the derivatives of the filtered texel. */
+      glm::vec3 GetNormal(float x, float z) const;
+
+      /**
+       * Returns true and the first point where the ray hits the surface.
+       * The ray steps through the min/max pyramid, skipping nodes that it passes above at the coarsest level
+       * possible, and is intersected exactly with the two triangles of each cell that it reaches.
+       * The half texel border outside of the outermost texel centers is not part of the traced surface.
+       */
+      bool RayIntersect(const Ray& ray, glm::vec3& intersectPoint) const;
+
+      const float* GetSamples() const;
+      uint32_t GetResolution() const;
+      float GetSize() const;
+      float GetAmplitude() const;
+      bool IsEmpty() const;
+
+   private:
+      /** Returns false if the position is outside of the map, otherwise the continuous texel coordinates. */
+      bool GetTexelCoordinates(float x, float z, float& tx, float& ty) const;
+
+      /** Scale from texel coordinates to height, the samples are negated to get the height. */
+      float GetHeightScale() const;
+
+      /** Allocates the pyramid levels and fits all of them. */
+      void BuildPyramid();
+
+      /** Refits the nodes that depend on the samples within the inclusive rectangle. */
+      void RefitPyramid(uint32_t minX, uint32_t minY, uint32_t maxX, uint32_t maxY);
+
+      /** Intersects the two triangles of a level 0 cell, the ray is in texel space. */
+      bool IntersectCell(Ray& ray, uint32_t cellX, uint32_t cellY, float& distance) const;
+
+      /**
+       * Every level stores the minimum and maximum sample of its nodes, level 0 has one node per cell
+       * between four texel centers and the last level is a single node covering the whole map.
+       */
+      struct PyramidLevel
+      {
+         uint32_t size;
+         std::vector<glm::vec2> minMax;
+      };
+
+   private:
+      std::vector<PyramidLevel> mPyramid;
+      std::vector<float> mSamples;
+      uint32_t mResolution;
+      float mSize;
+      float mAmplitude;
+   };
+}
@@ -25,6 +25,25 @@ namespace Utopian::Math
       return world;
    }
 
+   void TransformAabb(const glm::mat4& world, const glm::vec3& min, const glm::vec3& max, glm::vec3& outMin, glm::vec3& outMax)
+   {
+      // Arvo's method, avoids transforming all eight corners
+      glm::vec3 translation = glm::vec3(world[3]);
+      outMin = translation;
+      outMax = translation;
+
+      for (uint32_t col = 0; col < 3; col++)
+      {
+         for (uint32_t row = 0; row < 3; row++)
+         {
+            float a = world[col][row] * min[col];
+            float b = world[col][row] * max[col];
+            outMin[row] += glm::min(a, b);
+            outMax[row] += glm::max(a, b);
+         }
+      }
+   }
+
    // Retrieves the quaternion from a transformation matrix
    glm::quat GetQuaternion(const glm::mat4& transform)
    {
@@ -15,6 +15,9 @@ namespace Utopian::Math
    // Sets the translation in a transformation matrix
    glm::mat4 SetTranslation(glm::mat4 world, glm::vec3 translation);
 
+   // Transforms an axis aligned box and returns the axis aligned box enclosing the result
+   void TransformAabb(const glm::mat4& world, const glm::vec3& min, const glm::vec3& max, glm::vec3& outMin, glm::vec3& outMax);
+
    // Returns a random float
    float GetRandom(float min, float max);
 
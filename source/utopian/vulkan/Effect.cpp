@@ -69,8 +69,11 @@ namespace Utopian::Vk
       {
          mShader = shader;
 
-         for (auto& descriptorSet : mDescriptorSets)
-            descriptorSet.SetShader(mShader.get());
+         for (auto& frameDescriptorSets : mDescriptorSets)
+         {
+            for (auto& descriptorSet : frameDescriptorSets)
+               descriptorSet.SetShader(mShader.get());
+         }
 
          // Destroy pipeline if already created
          if (mPipeline->IsCreated())
@@ -88,34 +91,37 @@ namespace Utopian::Vk
    {
       mPipelineInterface = std::make_shared<PipelineInterface>(mDevice);
 
+      // Every frame in flight has its own set of descriptor sets
+      const uint32_t numFrames = device->GetNumFramesInFlight();
+
       for (int i = 0; i < shader->compiledShaders.size(); i++)
       {
          // Uniform blocks
          for (auto& iter : shader->compiledShaders[i]->reflection.uniformBlocks)
          {
             mPipelineInterface->AddUniformBuffer(iter.second.set, iter.second.binding, VK_SHADER_STAGE_ALL);
-            mDescriptorPool->AddDescriptor(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1);
+            mDescriptorPool->AddDescriptor(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, numFrames);
          }
 
          // Storage buffers
          for (auto& iter : shader->compiledShaders[i]->reflection.storageBuffers)
          {
             mPipelineInterface->AddStorageBuffer(iter.second.set, iter.second.binding, VK_SHADER_STAGE_ALL);
-            mDescriptorPool->AddDescriptor(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1);
+            mDescriptorPool->AddDescriptor(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, numFrames);
          }
 
          // Combined image samplers
          for (auto& iter : shader->compiledShaders[i]->reflection.combinedSamplers)
          {
             mPipelineInterface->AddCombinedImageSampler(iter.second.set, iter.second.binding, VK_SHADER_STAGE_ALL, iter.second.arraySize);
-            mDescriptorPool->AddDescriptor(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, iter.second.arraySize);
+            mDescriptorPool->AddDescriptor(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, iter.second.arraySize * numFrames);
          }
 
          // Images
          for (auto& iter : shader->compiledShaders[i]->reflection.images)
          {
             mPipelineInterface->AddStorageImage(iter.second.set, iter.second.binding, VK_SHADER_STAGE_ALL, iter.second.arraySize);
-            mDescriptorPool->AddDescriptor(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, iter.second.arraySize);
+            mDescriptorPool->AddDescriptor(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, iter.second.arraySize * numFrames);
          }
 
          // Push constants
@@ -128,76 +134,118 @@ namespace Utopian::Vk
       mPipelineInterface->Create();
       mDescriptorPool->Create();
 
-      for (uint32_t set = 0; set < mPipelineInterface->GetNumDescriptorSets(); set++)
+      mDescriptorSets.resize(numFrames);
+      mVkDescriptorSets.resize(numFrames);
+
+      for (uint32_t frame = 0; frame < numFrames; frame++)
       {
-         mDescriptorSets.push_back(DescriptorSet(device, this, set, mDescriptorPool.get()));
-         mVkDescriptorSets.push_back(mDescriptorSets[set].GetVkHandle());  // Todo
+         for (uint32_t set = 0; set < mPipelineInterface->GetNumDescriptorSets(); set++)
+         {
+            mDescriptorSets[frame].push_back(DescriptorSet(device, this, set, mDescriptorPool.get()));
+            mVkDescriptorSets[frame].push_back(mDescriptorSets[frame][set].GetVkHandle());  // Todo
+         }
       }
    }
 
    void Effect::BindUniformBuffer(std::string name, const VkDescriptorBufferInfo* bufferInfo)
    {
-      DescriptorSet& descriptorSet = mDescriptorSets[mShader->NameToSet(name)];
-      descriptorSet.BindUniformBuffer(name, bufferInfo);
-      descriptorSet.UpdateDescriptorSets();
+      for (auto& frameDescriptorSets : mDescriptorSets)
+      {
+         DescriptorSet& descriptorSet = frameDescriptorSets[mShader->NameToSet(name)];
+         descriptorSet.BindUniformBuffer(name, bufferInfo);
+         descriptorSet.UpdateDescriptorSets();
+      }
    }
 
    void Effect::BindStorageBuffer(std::string name, const VkDescriptorBufferInfo* bufferInfo)
    {
-      DescriptorSet& descriptorSet = mDescriptorSets[mShader->NameToSet(name)];
-      descriptorSet.BindStorageBuffer(name, bufferInfo);
-      descriptorSet.UpdateDescriptorSets();
+      for (auto& frameDescriptorSets : mDescriptorSets)
+      {
+         DescriptorSet& descriptorSet = frameDescriptorSets[mShader->NameToSet(name)];
+         descriptorSet.BindStorageBuffer(name, bufferInfo);
+         descriptorSet.UpdateDescriptorSets();
+      }
    }
 
    void Effect::BindUniformBuffer(std::string name, const ShaderBuffer& shaderBlock)
    {
-      BindUniformBuffer(name, shaderBlock.GetDescriptor());
+      // Each frame points to its own copy of the uniform buffer
+      for (uint32_t frame = 0; frame < mDescriptorSets.size(); frame++)
+      {
+         DescriptorSet& descriptorSet = mDescriptorSets[frame][mShader->NameToSet(name)];
+         descriptorSet.BindUniformBuffer(name, shaderBlock.GetDescriptor(frame));
+         descriptorSet.UpdateDescriptorSets();
+      }
    }
 
    void Effect::BindStorageBuffer(std::string name, const ShaderBuffer& shaderBlock)
    {
-      BindStorageBuffer(name, shaderBlock.GetDescriptor());
+      for (uint32_t frame = 0; frame < mDescriptorSets.size(); frame++)
+      {
+         DescriptorSet& descriptorSet = mDescriptorSets[frame][mShader->NameToSet(name)];
+         descriptorSet.BindStorageBuffer(name, shaderBlock.GetDescriptor(frame));
+         descriptorSet.UpdateDescriptorSets();
+      }
    }
 
    void Effect::BindCombinedImage(std::string name, const Texture& texture)
    {
-      DescriptorSet& descriptorSet = mDescriptorSets[mShader->NameToSet(name)];
-      descriptorSet.BindCombinedImage(name, texture.GetDescriptor(), 1u);
-      descriptorSet.UpdateDescriptorSets();
+      for (auto& frameDescriptorSets : mDescriptorSets)
+      {
+         DescriptorSet& descriptorSet = frameDescriptorSets[mShader->NameToSet(name)];
+         descriptorSet.BindCombinedImage(name, texture.GetDescriptor(), 1u);
+         descriptorSet.UpdateDescriptorSets();
+      }
    }
 
    void Effect::BindCombinedImage(std::string name, const Image& image, const Sampler& sampler)
    {
-      DescriptorSet& descriptorSet = mDescriptorSets[mShader->NameToSet(name)];
-      descriptorSet.BindCombinedImage(name, image, sampler);
-      descriptorSet.UpdateDescriptorSets();
+      for (auto& frameDescriptorSets : mDescriptorSets)
+      {
+         DescriptorSet& descriptorSet = frameDescriptorSets[mShader->NameToSet(name)];
+         descriptorSet.BindCombinedImage(name, image, sampler);
+         descriptorSet.UpdateDescriptorSets();
+      }
    }
 
    void Effect::BindCombinedImage(std::string name, const TextureArray& textureArray)
    {
-      DescriptorSet& descriptorSet = mDescriptorSets[mShader->NameToSet(name)];
-      descriptorSet.BindCombinedImage(name, textureArray.GetDescriptor(), textureArray.GetNumImages());
-      descriptorSet.UpdateDescriptorSets();
+      for (auto& frameDescriptorSets : mDescriptorSets)
+      {
+         DescriptorSet& descriptorSet = frameDescriptorSets[mShader->NameToSet(name)];
+         descriptorSet.BindCombinedImage(name, textureArray.GetDescriptor(), textureArray.GetNumImages());
+         descriptorSet.UpdateDescriptorSets();
+      }
    }
 
    void Effect::BindImage(std::string name, const Image& image)
    {
-      DescriptorSet& descriptorSet = mDescriptorSets[mShader->NameToSet(name)];
-      descriptorSet.BindImage(name, image);
-      descriptorSet.UpdateDescriptorSets();
+      for (auto& frameDescriptorSets : mDescriptorSets)
+      {
+         DescriptorSet& descriptorSet = frameDescriptorSets[mShader->NameToSet(name)];
+         descriptorSet.BindImage(name, image);
+         descriptorSet.UpdateDescriptorSets();
+      }
    }
 
    const DescriptorSet& Effect::GetDescriptorSet(uint32_t set) const
    {
-      if (set < 0 || set >= mDescriptorSets.size())
+      const std::vector<DescriptorSet>& frameDescriptorSets = mDescriptorSets[mDevice->GetFrameIndex()];
+
+      if (set < 0 || set >= frameDescriptorSets.size())
          assert(0);
 
-      return mDescriptorSets[set];
+      return frameDescriptorSets[set];
    }
 
    DescriptorSet& Effect::GetDescriptorSetFromName(std::string name)
    {
-      DescriptorSet& descriptorSet = mDescriptorSets[mShader->NameToSet(name)];
+      return GetDescriptorSetFromName(name, mDevice->GetFrameIndex());
+   }
+
+   DescriptorSet& Effect::GetDescriptorSetFromName(std::string name, uint32_t frameIndex)
+   {
+      DescriptorSet& descriptorSet = mDescriptorSets[frameIndex][mShader->NameToSet(name)];
       return descriptorSet;
    }
 
@@ -223,12 +271,12 @@ namespace Utopian::Vk
 
    const VkDescriptorSet* Effect::GetDescriptorSets() const
    {
-      return mVkDescriptorSets.data();
+      return mVkDescriptorSets[mDevice->GetFrameIndex()].data();
    }
 
    uint32_t Effect::GetNumDescriptorSets() const
    {
-      return (uint32_t)mVkDescriptorSets.size();
+      return (uint32_t)mVkDescriptorSets[mDevice->GetFrameIndex()].size();
    }
 
    ShaderCreateInfo Effect::GetShaderCreateInfo() const
@@ -50,13 +50,16 @@ namespace Utopian::Vk
       void BindImage(std::string name, const Image& image);
 
       /**
-       * Returns a descriptor set by index.
+       * Returns a descriptor set of the current frame by index.
        * Needs to be used if you want to bind additional descriptor sets that not are part of the Effect itself,
        * for example Meshes contains their own descriptor set for their texture.
        * @note This should only be used in rare cases.
+       * @note Every frame in flight has its own descriptor sets so that they can point to per frame
+       * copies of the uniform buffers, the Bind*() functions update the sets of all frames.
        */
       const DescriptorSet& GetDescriptorSet(uint32_t set) const;
       DescriptorSet& GetDescriptorSetFromName(std::string name);
+      DescriptorSet& GetDescriptorSetFromName(std::string name, uint32_t frameIndex);
 
       /** Returns a pointer to the Pipeline object. It is expected to be modified. */
       Pipeline* GetPipeline();
@@ -79,8 +82,8 @@ namespace Utopian::Vk
       Device* mDevice = nullptr;
       SharedPtr<Shader> mShader;
       SharedPtr<PipelineInterface> mPipelineInterface;
-      std::vector<DescriptorSet> mDescriptorSets;
-      std::vector<VkDescriptorSet> mVkDescriptorSets;
+      std::vector<std::vector<DescriptorSet>> mDescriptorSets;
+      std::vector<std::vector<VkDescriptorSet>> mVkDescriptorSets;
       ShaderCreateInfo mShaderCreateInfo;
       SharedPtr<DescriptorPool> mDescriptorPool;
    };
@@ -2,6 +2,7 @@
 #include "vulkan/EffectManager.h"
 #include "vulkan/Effect.h"
 #include "core/Log.h"
+#include "utility/Timer.h"
 #include "imgui/imgui.h"
 
 namespace Utopian::Vk
@@ -44,6 +45,8 @@ namespace Utopian::Vk
    
    void EffectManager::RecompileAllShaders()
    {
+      Timestamp startTime = gTimer().GetTimestamp();
+
       for (auto& trackedEffect : mEffects)
       {
          ShaderCreateInfo shaderCreateInfo = trackedEffect.effect->GetShaderCreateInfo();
@@ -53,7 +56,7 @@ namespace Utopian::Vk
          trackedEffect.lastModification = updatedModificationTime;
       }
 
-      UTO_LOG("Recompiled all shaders");
+      UTO_LOG("Recompiled all shaders in " + std::to_string(gTimer().GetElapsedTime(startTime)) + " ms");
    }
 
    void EffectManager::NotifyCallbacks(std::string name)
@@ -0,0 +1,52 @@
+#include "vulkan/FrameCommandPool.h"
+#include "vulkan/handles/Device.h"
+#include "vulkan/handles/CommandPool.h"
+#include "vulkan/handles/CommandBuffer.h"
+
+namespace Utopian::Vk
+{
+   static thread_local FrameCommandPool* tCurrentCommandPool = nullptr;
+
+   FrameCommandPool::FrameCommandPool(Device* device)
+   {
+      mDevice = device;
+      mCommandPool = std::make_shared<CommandPool>(device, device->GetQueueFamilyIndex(VK_QUEUE_GRAPHICS_BIT));
+      mNumUsedPrimary = 0u;
+      mNumUsedSecondary = 0u;
+   }
+
+   FrameCommandPool::~FrameCommandPool()
+   {
+      // The command buffers must be freed before the pool they are allocated from
+      mPrimaryCommandBuffers.clear();
+      mSecondaryCommandBuffers.clear();
+   }
+
+   CommandBuffer* FrameCommandPool::Acquire(VkCommandBufferLevel level)
+   {
+      std::vector<SharedPtr<CommandBuffer>>& commandBuffers = (level == VK_COMMAND_BUFFER_LEVEL_PRIMARY) ? mPrimaryCommandBuffers : mSecondaryCommandBuffers;
+      uint32_t& numUsed = (level == VK_COMMAND_BUFFER_LEVEL_PRIMARY) ? mNumUsedPrimary : mNumUsedSecondary;
+
+      if (numUsed == commandBuffers.size())
+         commandBuffers.push_back(std::make_shared<CommandBuffer>(mDevice, mCommandPool.get(), level, false));
+
+      return commandBuffers[numUsed++].get();
+   }
+
+   void FrameCommandPool::Reset()
+   {
+      mCommandPool->Reset();
+      mNumUsedPrimary = 0u;
+      mNumUsedSecondary = 0u;
+   }
+
+   void FrameCommandPool::SetCurrent(FrameCommandPool* commandPool)
+   {
+      tCurrentCommandPool = commandPool;
+   }
+
+   FrameCommandPool* FrameCommandPool::GetCurrent()
+   {
+      return tCurrentCommandPool;
+   }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+#include "vulkan/VulkanPrerequisites.h"
+#include "utility/Common.h"
+
+namespace Utopian::Vk
+{
+   /**
+    * Command pool that hands out command buffers for a single frame.
+    * All command buffers are recycled at once by Reset() instead of being freed individually.
+    *
+    * @note A Vulkan command pool must be externally synchronized so a FrameCommandPool
+    * must only be recorded from by one thread at a time.
+    */
+   class FrameCommandPool
+   {
+   public:
+      FrameCommandPool(Device* device);
+      ~FrameCommandPool();
+
+      /** Returns a command buffer that stays valid until the next call to Reset(). */
+      CommandBuffer* Acquire(VkCommandBufferLevel level);
+
+      /** Makes all command buffers available again, the GPU must be done executing them. */
+      void Reset();
+
+      /**
+       * Sets the pool that render targets on the calling thread record into.
+       * When nullptr render targets record into their own command buffer.
+       */
+      static void SetCurrent(FrameCommandPool* commandPool);
+      static FrameCommandPool* GetCurrent();
+
+   private:
+      Device* mDevice;
+      SharedPtr<CommandPool> mCommandPool;
+      std::vector<SharedPtr<CommandBuffer>> mPrimaryCommandBuffers;
+      std::vector<SharedPtr<CommandBuffer>> mSecondaryCommandBuffers;
+      uint32_t mNumUsedPrimary;
+      uint32_t mNumUsedSecondary;
+   };
+}
@@ -0,0 +1,229 @@
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <string>
+#include "vulkan/GeometryPool.h"
+#include "vulkan/handles/Device.h"
+#include "vulkan/handles/Buffer.h"
+
+namespace Utopian::Vk
+{
+   GeometryAllocation::GeometryAllocation(GeometryPool* pool, uint32_t heap, uint32_t page, uint32_t offset, uint32_t count, const SharedPtr<Buffer>& buffer, uint32_t elementSize)
+   {
+      mPool = pool;
+      mHeap = heap;
+      mPage = page;
+      mOffset = offset;
+      mCount = count;
+      mBuffer = buffer;
+      mElementSize = elementSize;
+   }
+
+   GeometryAllocation::~GeometryAllocation()
+   {
+      mPool->Free(mHeap, mPage, mOffset, mCount);
+   }
+
+   const SharedPtr<Buffer>& GeometryAllocation::GetBuffer() const
+   {
+      return mBuffer;
+   }
+
+   uint32_t GeometryAllocation::GetOffset() const
+   {
+      return mOffset;
+   }
+
+   VkDeviceSize GeometryAllocation::GetByteOffset() const
+   {
+      return (VkDeviceSize)mOffset * mElementSize;
+   }
+
+   uint32_t GeometryAllocation::GetCount() const
+   {
+      return mCount;
+   }
+
+   GeometryPool::GeometryPool(Device* device)
+   {
+      mDevice = device;
+      mFreedRanges.resize(MAX_FRAMES_IN_FLIGHT);
+   }
+
+   GeometryPool::~GeometryPool()
+   {
+   }
+
+   SharedPtr<GeometryAllocation> GeometryPool::AllocateVertices(uint32_t numVertices, uint32_t vertexSize)
+   {
+      return Allocate(numVertices, vertexSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+   }
+
+   SharedPtr<GeometryAllocation> GeometryPool::AllocateIndices(uint32_t numIndices)
+   {
+      return Allocate(numIndices, sizeof(uint32_t), VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+   }
+
+   SharedPtr<GeometryAllocation> GeometryPool::Allocate(uint32_t count, uint32_t elementSize, VkBufferUsageFlags usage)
+   {
+      if (count == 0)
+         return nullptr;
+
+      std::lock_guard<std::mutex> lock(mMutex);
+
+      uint32_t heapIndex = 0;
+      while (heapIndex < mHeaps.size() && (mHeaps[heapIndex].elementSize != elementSize || mHeaps[heapIndex].usage != usage))
+         heapIndex++;
+
+      if (heapIndex == mHeaps.size())
+      {
+         Heap heap;
+         heap.usage = usage;
+         heap.elementSize = elementSize;
+         mHeaps.push_back(heap);
+      }
+
+      Heap& heap = mHeaps[heapIndex];
+
+      // Best fit, the smallest free range that is large enough
+      uint32_t bestPage = ~0u;
+      uint32_t bestOffset = 0;
+      uint32_t bestCount = ~0u;
+
+      for (uint32_t i = 0; i < heap.pages.size(); i++)
+      {
+         for (const auto& range : heap.pages[i].freeRanges)
+         {
+            if (range.second >= count && range.second < bestCount)
+            {
+               bestPage = i;
+               bestOffset = range.first;
+               bestCount = range.second;
+            }
+         }
+      }
+
+      if (bestPage == ~0u)
+      {
+         uint32_t pageCapacity = (uint32_t)(PAGE_SIZE / elementSize);
+         bestPage = AddPage(heap, std::max(pageCapacity, count));
+         bestOffset = 0;
+         bestCount = heap.pages[bestPage].capacity;
+      }
+
+      Page& page = heap.pages[bestPage];
+      page.freeRanges.erase(bestOffset);
+
+      if (bestCount > count)
+         page.freeRanges[bestOffset + count] = bestCount - count;
+
+      page.numAllocations++;
+
+      return std::make_shared<GeometryAllocation>(this, heapIndex, bestPage, bestOffset, count, page.buffer, elementSize);
+   }
+
+   uint32_t GeometryPool::AddPage(Heap& heap, uint32_t capacity)
+   {
+      BUFFER_CREATE_INFO createInfo;
+      createInfo.usageFlags = heap.usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+      createInfo.memoryPropertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+      createInfo.data = nullptr;
+      createInfo.size = (VkDeviceSize)capacity * heap.elementSize;
+      createInfo.name = std::string(heap.usage == VK_BUFFER_USAGE_INDEX_BUFFER_BIT ? "Geometry pool index page " : "Geometry pool vertex page ") +
+                        std::to_string(heap.pages.size());
+
+      Page page;
+      page.buffer = std::make_shared<Buffer>(createInfo, mDevice);
+      page.freeRanges[0] = capacity;
+      page.capacity = capacity;
+      page.numAllocations = 0;
+      heap.pages.push_back(page);
+
+      return (uint32_t)heap.pages.size() - 1;
+   }
+
+   void GeometryPool::Free(uint32_t heap, uint32_t page, uint32_t offset, uint32_t count)
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+
+      mFreedRanges[mDevice->GetFrameIndex()].push_back({heap, page, offset, count});
+   }
+
+   void GeometryPool::GarbageCollect(uint32_t frameIndex)
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+
+      for (const auto& range : mFreedRanges[frameIndex])
+         Release(range);
+
+      mFreedRanges[frameIndex].clear();
+   }
+
+   void GeometryPool::Release(const FreedRange& range)
+   {
+      Page& page = mHeaps[range.heap].pages[range.page];
+      uint32_t offset = range.offset;
+      uint32_t count = range.count;
+
+      // Merge with the free ranges on both sides
+      auto next = page.freeRanges.lower_bound(offset);
+      if (next != page.freeRanges.begin())
+      {
+         auto previous = std::prev(next);
+         if (previous->first + previous->second == offset)
+         {
+            offset = previous->first;
+            count += previous->second;
+            page.freeRanges.erase(previous);
+         }
+      }
+
+      if (next != page.freeRanges.end() && offset + count == next->first)
+      {
+         count += next->second;
+         page.freeRanges.erase(next);
+      }
+
+      page.freeRanges[offset] = count;
+      page.numAllocations--;
+   }
+
+   std::vector<GeometryPool::HeapStatistics> GeometryPool::GetStatistics() const
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+
+      std::vector<HeapStatistics> statistics;
+
+      for (const auto& heap : mHeaps)
+      {
+         HeapStatistics heapStatistics = {};
+         heapStatistics.usage = heap.usage;
+         heapStatistics.elementSize = heap.elementSize;
+         heapStatistics.numPages = (uint32_t)heap.pages.size();
+
+         VkDeviceSize freeSize = 0;
+         for (const auto& page : heap.pages)
+         {
+            heapStatistics.numAllocations += page.numAllocations;
+            heapStatistics.numFreeRanges += (uint32_t)page.freeRanges.size();
+            heapStatistics.capacity += (VkDeviceSize)page.capacity * heap.elementSize;
+
+            for (const auto& range : page.freeRanges)
+            {
+               VkDeviceSize rangeSize = (VkDeviceSize)range.second * heap.elementSize;
+               freeSize += rangeSize;
+               heapStatistics.largestFreeRange = std::max(heapStatistics.largestFreeRange, rangeSize);
+            }
+         }
+
+         heapStatistics.usedSize = heapStatistics.capacity - freeSize;
+
+         if (freeSize > 0)
+            heapStatistics.fragmentation = 1.0f - (float)heapStatistics.largestFreeRange / (float)freeSize;
+
+         statistics.push_back(heapStatistics);
+      }
+
+      return statistics;
+   }
+}
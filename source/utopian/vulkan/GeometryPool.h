@@ -0,0 +1,126 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <vector>
+#include "vulkan/VulkanPrerequisites.h"
+#include "utility/Common.h"
+
+namespace Utopian::Vk
+{
+   class GeometryPool;
+
+   /**
+    * Range of vertices or indices sub-allocated from one of the large buffers of the GeometryPool.
+    * The range is returned to the pool when the allocation is destroyed.
+    */
+   class GeometryAllocation
+   {
+   public:
+      GeometryAllocation(GeometryPool* pool, uint32_t heap, uint32_t page, uint32_t offset, uint32_t count, const SharedPtr<Buffer>& buffer, uint32_t elementSize);
+      ~GeometryAllocation();
+
+      /** Returns the buffer shared with the other allocations of the same page. */
+      const SharedPtr<Buffer>& GetBuffer() const;
+
+      /** Offset in elements, the vertexOffset or firstIndex to draw with. */
+      uint32_t GetOffset() const;
+
+      /** Offset in bytes from the start of the buffer. */
+      VkDeviceSize GetByteOffset() const;
+
+      uint32_t GetCount() const;
+
+   private:
+      GeometryPool* mPool;
+      SharedPtr<Buffer> mBuffer;
+      uint32_t mHeap;
+      uint32_t mPage;
+      uint32_t mOffset;
+      uint32_t mCount;
+      uint32_t mElementSize;
+   };
+
+   /**
+    * Sub-allocates vertex and index data of many primitives from a few large device local buffers.
+    * Primitives sharing a buffer can be drawn without rebinding it, using vertexOffset and firstIndex.
+    * There is one heap of pages per vertex size and one for the indices, each page has a best fit
+    * free-list that merges neighbouring free ranges.
+    */
+   class GeometryPool
+   {
+   public:
+      struct HeapStatistics
+      {
+         VkBufferUsageFlags usage;
+         uint32_t elementSize;
+         uint32_t numPages;
+         uint32_t numAllocations;
+         uint32_t numFreeRanges;
+         VkDeviceSize capacity;
+         VkDeviceSize usedSize;
+         VkDeviceSize largestFreeRange;
+
+         /** 0 when all free memory is one range, approaches 1 as it is split into many small ones. */
+         float fragmentation;
+      };
+
+      /** Size of the pages, primitives larger than this get a page of their own. */
+      static const VkDeviceSize PAGE_SIZE = 32 * 1024 * 1024;
+
+      GeometryPool(Device* device);
+      ~GeometryPool();
+
+      /** Returns nullptr if numVertices is 0. */
+      SharedPtr<GeometryAllocation> AllocateVertices(uint32_t numVertices, uint32_t vertexSize);
+
+      /** Allocates 32-bit indices, returns nullptr if numIndices is 0. */
+      SharedPtr<GeometryAllocation> AllocateIndices(uint32_t numIndices);
+
+      /** Makes the ranges freed while recording the frame slot available again, the GPU must be done with it. */
+      void GarbageCollect(uint32_t frameIndex);
+
+      std::vector<HeapStatistics> GetStatistics() const;
+
+   private:
+      friend class GeometryAllocation;
+
+      struct Page
+      {
+         SharedPtr<Buffer> buffer;
+         std::map<uint32_t, uint32_t> freeRanges; // Offset to number of elements
+         uint32_t capacity;
+         uint32_t numAllocations;
+      };
+
+      struct Heap
+      {
+         VkBufferUsageFlags usage;
+         uint32_t elementSize;
+         std::vector<Page> pages;
+      };
+
+      struct FreedRange
+      {
+         uint32_t heap;
+         uint32_t page;
+         uint32_t offset;
+         uint32_t count;
+      };
+
+      SharedPtr<GeometryAllocation> Allocate(uint32_t count, uint32_t elementSize, VkBufferUsageFlags usage);
+      uint32_t AddPage(Heap& heap, uint32_t capacity);
+      void Free(uint32_t heap, uint32_t page, uint32_t offset, uint32_t count);
+      void Release(const FreedRange& range);
+
+   private:
+      Device* mDevice;
+      std::vector<Heap> mHeaps;
+
+      // Ranges can still be used by the frames in flight when they are freed
+      std::vector<std::vector<FreedRange>> mFreedRanges;
+
+      // Primitives can be created and destroyed by the asset loading threads
+      mutable std::mutex mMutex;
+   };
+}
@@ -9,6 +9,7 @@
 #include "vulkan/handles/DescriptorSet.h"
 #include "vulkan/handles/QueryPoolTimestamp.h"
 #include "vulkan/handles/QueryPoolStatistics.h"
+#include "vulkan/FrameCommandPool.h"
 #include "vulkan/Debug.h"
 #include "core/Profiler.h"
 
@@ -20,6 +21,7 @@ namespace Utopian::Vk
       mHeight = height;
 
       mCommandBuffer = std::make_shared<CommandBuffer>(device, VK_COMMAND_BUFFER_LEVEL_PRIMARY, false);
+      mActiveCommandBuffer = mCommandBuffer.get();
       mRenderPass = std::make_shared<RenderPass>(device);
       mFrameBuffer = std::make_shared<FrameBuffers>(device);
       mSampler = std::make_shared<Sampler>(device);
@@ -87,19 +89,25 @@ namespace Utopian::Vk
       mClearValues.push_back(clearValue);
    }
 
-   void RenderTarget::Begin(std::string debugName, glm::vec4 debugColor)
+   void RenderTarget::Begin(std::string debugName, glm::vec4 debugColor, VkSubpassContents subpassContents)
    {
       BeginCommandBuffer();
       BeginDebugLabelAndQueries(debugName, debugColor);
-      BeginRenderPass();
+      BeginRenderPass(subpassContents);
    }
 
    void RenderTarget::BeginCommandBuffer()
    {
-      mCommandBuffer->Begin();
+      FrameCommandPool* commandPool = FrameCommandPool::GetCurrent();
+      if (commandPool != nullptr)
+         mActiveCommandBuffer = commandPool->Acquire(VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+      else
+         mActiveCommandBuffer = mCommandBuffer.get();
+
+      mActiveCommandBuffer->Begin();
    }
    
-   void RenderTarget::BeginRenderPass()
+   void RenderTarget::BeginRenderPass(VkSubpassContents subpassContents)
    {
       VkRenderPassBeginInfo renderPassBeginInfo = {};
       renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -110,18 +118,24 @@ namespace Utopian::Vk
       renderPassBeginInfo.pClearValues = mClearValues.data();
       renderPassBeginInfo.framebuffer = mFrameBuffer->GetFrameBuffer(0); // TODO: NOTE: Should not be like this
 
-      mCommandBuffer->CmdBeginRenderPass(&renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
-      mCommandBuffer->CmdSetViewPort((float)GetWidth(), (float)GetHeight());
-      mCommandBuffer->CmdSetScissor(GetWidth(), GetHeight());
+      mActiveCommandBuffer->CmdBeginRenderPass(&renderPassBeginInfo, subpassContents);
+
+      // Secondary command buffers set their own dynamic state
+      if (subpassContents == VK_SUBPASS_CONTENTS_INLINE)
+      {
+         mActiveCommandBuffer->CmdSetViewPort((float)GetWidth(), (float)GetHeight());
+         mActiveCommandBuffer->CmdSetScissor(GetWidth(), GetHeight());
+      }
    }
 
    void RenderTarget::End(const SharedPtr<Semaphore>& waitSemaphore, const SharedPtr<Semaphore>& signalSemaphore)
    {
-      mCommandBuffer->CmdEndRenderPass();
+      mActiveCommandBuffer->CmdEndRenderPass();
 
       EndDebugLabelAndQueries();
 
-      mCommandBuffer->Submit(waitSemaphore, signalSemaphore);
+      mActiveCommandBuffer->Submit(waitSemaphore, signalSemaphore);
+      mActiveCommandBuffer = mCommandBuffer.get();
 
       if (gProfiler().IsEnabled())
       {   
@@ -134,11 +148,12 @@ namespace Utopian::Vk
 
    void RenderTarget::EndAndFlush()
    {
-      mCommandBuffer->CmdEndRenderPass();
+      mActiveCommandBuffer->CmdEndRenderPass();
       
       EndDebugLabelAndQueries();
 
-      mCommandBuffer->Flush();
+      mActiveCommandBuffer->Flush();
+      mActiveCommandBuffer = mCommandBuffer.get();
    }
 
    uint32_t RenderTarget::GetWidth()
@@ -156,27 +171,27 @@ namespace Utopian::Vk
       mDebugName = debugName;
       mDebugColor = debugColor;
 
-      Vk::DebugLabel::BeginRegion(mCommandBuffer->GetVkHandle(), mDebugName.c_str(), mDebugColor);
+      Vk::DebugLabel::BeginRegion(mActiveCommandBuffer->GetVkHandle(), mDebugName.c_str(), mDebugColor);
 
-      mTimestampQueryPool->Reset(mCommandBuffer.get());
-      mTimestampQueryPool->Begin(mCommandBuffer.get());
+      mTimestampQueryPool->Reset(mActiveCommandBuffer);
+      mTimestampQueryPool->Begin(mActiveCommandBuffer);
 
       if (mStatisticsQueryPool != nullptr)
       {
-         mStatisticsQueryPool->Reset(mCommandBuffer.get());
-         mStatisticsQueryPool->Begin(mCommandBuffer.get());
+         mStatisticsQueryPool->Reset(mActiveCommandBuffer);
+         mStatisticsQueryPool->Begin(mActiveCommandBuffer);
       }
    }
 
    void RenderTarget::EndDebugLabelAndQueries()
    {
-      Vk::DebugLabel::EndRegion(mCommandBuffer->GetVkHandle());
+      Vk::DebugLabel::EndRegion(mActiveCommandBuffer->GetVkHandle());
 
-      mTimestampQueryPool->End(mCommandBuffer.get());
+      mTimestampQueryPool->End(mActiveCommandBuffer);
 
       if (mStatisticsQueryPool != nullptr)
       {
-         mStatisticsQueryPool->End(mCommandBuffer.get());
+         mStatisticsQueryPool->End(mActiveCommandBuffer);
       }
    }
 
@@ -187,7 +202,7 @@ namespace Utopian::Vk
 
    Utopian::Vk::CommandBuffer* RenderTarget::GetCommandBuffer()
    {
-      return mCommandBuffer.get();
+      return mActiveCommandBuffer;
    }
 
    RenderPass* RenderTarget::GetRenderPass()
@@ -195,6 +210,11 @@ namespace Utopian::Vk
       return mRenderPass.get();
    }
 
+   VkFramebuffer RenderTarget::GetFrameBuffer()
+   {
+      return mFrameBuffer->GetFrameBuffer(0);
+   }
+
    void RenderTarget::SetClearColor(float r, float g, float b, float a)
    {
       mClearColor = glm::vec4(r, g, b, a);
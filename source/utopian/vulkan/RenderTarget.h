@@ -20,13 +20,20 @@ namespace Utopian::Vk
       RenderTarget(Device* device, uint32_t width, uint32_t height);
       ~RenderTarget();
 
-      /** Begins the command buffer and the render pass. */
-      void Begin(std::string debugName = "Unnamed pass", glm::vec4 debugColor = glm::vec4(1.0, 0.0, 0.0, 1.0));
+      /**
+       * Begins the command buffer and the render pass.
+       * If a FrameCommandPool is current on the calling thread the commands are recorded
+       * into a command buffer from it instead of the render target's own command buffer.
+       * With VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS the draw commands must be recorded
+       * into secondary command buffers that are executed with CommandBuffer::CmdExecuteCommands().
+       */
+      void Begin(std::string debugName = "Unnamed pass", glm::vec4 debugColor = glm::vec4(1.0, 0.0, 0.0, 1.0),
+                 VkSubpassContents subpassContents = VK_SUBPASS_CONTENTS_INLINE);
 
       void End(const SharedPtr<Semaphore>& waitSemaphore, const SharedPtr<Semaphore>& signalSemaphore);
       void EndAndFlush();
 
-      void BeginRenderPass();
+      void BeginRenderPass(VkSubpassContents subpassContents = VK_SUBPASS_CONTENTS_INLINE);
       void BeginDebugLabelAndQueries(std::string debugName, glm::vec4 debugColor);
       void EndDebugLabelAndQueries();
 
@@ -67,6 +74,7 @@ namespace Utopian::Vk
       Utopian::Vk::Sampler* GetSampler();
       Utopian::Vk::CommandBuffer* GetCommandBuffer();
       RenderPass* GetRenderPass();
+      VkFramebuffer GetFrameBuffer();
 
       uint32_t GetWidth();
       uint32_t GetHeight();
@@ -78,6 +86,7 @@ namespace Utopian::Vk
       SharedPtr<FrameBuffers> mFrameBuffer;
       SharedPtr<RenderPass> mRenderPass;
       SharedPtr<CommandBuffer> mCommandBuffer;
+      CommandBuffer* mActiveCommandBuffer;
       SharedPtr<Sampler> mSampler;
       uint32_t mWidth, mHeight;
       glm::vec4 mClearColor;
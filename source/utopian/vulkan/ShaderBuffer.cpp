@@ -1,44 +1,186 @@
 #include "ShaderBuffer.h"
 #include "vulkan/handles/Device.h"
 #include "vulkan/handles/Buffer.h"
+#include "vulkan/UniformAllocator.h"
 
 namespace Utopian::Vk
 {
+   std::set<ShaderBuffer*> ShaderBuffer::sStaleBuffers;
+   std::mutex ShaderBuffer::sStaleBuffersMutex;
+
    ShaderBuffer::ShaderBuffer()
    {
       mBuffer = nullptr;
+      mDevice = nullptr;
+      mStaleCopies = 0u;
    }
 
    ShaderBuffer::~ShaderBuffer()
    {
-      if (mBuffer != nullptr)
-         delete mBuffer;
+      Destroy();
    }
 
-   void ShaderBuffer::Create(Device* device, VkBufferUsageFlags usageFlags, VkMemoryPropertyFlags propertyFlags)
+   void ShaderBuffer::Create(Device* device, VkBufferUsageFlags usageFlags, VkMemoryPropertyFlags propertyFlags,
+                             ShaderBufferUpdateFrequency updateFrequency)
    {
+      mDevice = device;
+
+      uint32_t numCopies = 1u;
+      if ((usageFlags & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT) && (propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))
+      {
+         numCopies = device->GetNumFramesInFlight();
+
+         // Frequently updated blocks live in the persistently mapped pages of the allocator,
+         // blocks that don't fit in a page fall back to their own buffers
+         if (updateFrequency == UPDATE_FREQUENCY_PER_FRAME)
+            mAllocation = device->GetUniformAllocator()->Allocate(GetSize());
+      }
+
+      if (mAllocation.IsValid())
+      {
+         UniformAllocator* allocator = device->GetUniformAllocator();
+         for (uint32_t i = 0; i < numCopies; i++)
+         {
+            mMappedMemory.push_back(allocator->GetMappedMemory(mAllocation, i));
+
+            VkDescriptorBufferInfo descriptor = allocator->GetDescriptor(mAllocation, i);
+            descriptor.range = GetSize();
+            mDescriptors.push_back(descriptor);
+         }
+
+         return;
+      }
+
       BUFFER_CREATE_INFO createInfo;
       createInfo.usageFlags = usageFlags;
       createInfo.memoryPropertyFlags = propertyFlags;
       createInfo.data = nullptr;
       createInfo.size = GetSize();
       createInfo.name = "Shader buffer: " + GetDebugName();
-      mBuffer = new Buffer(createInfo, device);
 
-      // mBuffer will not be used by itself, it's the VkWriteDescriptorSet.pBufferInfo that points to our uniformBuffer.descriptor
-      // so here we need to point uniformBuffer.descriptor.buffer to uniformBuffer.buffer
-      mDescriptor.buffer = mBuffer->GetVkHandle();
-      mDescriptor.range = GetSize();
-      mDescriptor.offset = 0;
+      for (uint32_t i = 0; i < numCopies; i++)
+      {
+         Buffer* buffer = new Buffer(createInfo, device);
+         mFrameBuffers.push_back(buffer);
+
+         // The buffer will not be used by itself, it's the VkWriteDescriptorSet.pBufferInfo that points to the descriptor
+         // so here we need to point the descriptor to the buffer
+         VkDescriptorBufferInfo descriptor;
+         descriptor.buffer = buffer->GetVkHandle();
+         descriptor.range = GetSize();
+         descriptor.offset = 0;
+         mDescriptors.push_back(descriptor);
+      }
+
+      mBuffer = mFrameBuffers[GetCopyIndex(device->GetFrameIndex())];
+   }
+
+   void ShaderBuffer::Destroy()
+   {
+      {
+         std::lock_guard<std::mutex> lock(sStaleBuffersMutex);
+         sStaleBuffers.erase(this);
+         mStaleCopies = 0u;
+      }
+
+      if (mAllocation.IsValid())
+         mDevice->GetUniformAllocator()->Free(mAllocation);
+
+      for (Buffer* buffer : mFrameBuffers)
+         delete buffer;
+
+      mFrameBuffers.clear();
+      mMappedMemory.clear();
+      mDescriptors.clear();
+      mBuffer = nullptr;
    }
 
    void ShaderBuffer::MapMemory(VkDeviceSize offset, VkDeviceSize size, VkMemoryMapFlags flags, void** data)
    {
-      mBuffer->MapMemory(data);
+      if (mAllocation.IsValid())
+         *data = mMappedMemory[GetCopyIndex(mDevice->GetFrameIndex())];
+      else
+         mBuffer->MapMemory(data);
    }
 
    void ShaderBuffer::UnmapMemory()
    {
-      mBuffer->UnmapMemory();
+      // The pages of the allocator stay mapped
+      if (!mAllocation.IsValid())
+         mBuffer->UnmapMemory();
+   }
+
+   void ShaderBuffer::UpdateMemory()
+   {
+      assert(mDevice != nullptr);
+
+      uint32_t copyIndex = GetCopyIndex(mDevice->GetFrameIndex());
+      WriteCopy(copyIndex);
+
+      if (mDescriptors.size() > 1)
+      {
+         std::lock_guard<std::mutex> lock(sStaleBuffersMutex);
+         mStaleCopies = ((1u << mDescriptors.size()) - 1u) & ~(1u << copyIndex);
+         sStaleBuffers.insert(this);
+      }
+   }
+
+   void ShaderBuffer::WriteCopy(uint32_t copyIndex)
+   {
+      if (mAllocation.IsValid())
+      {
+         WriteMemory(mMappedMemory[copyIndex]);
+      }
+      else
+      {
+         mBuffer = mFrameBuffers[copyIndex];
+
+         uint8_t* mapped;
+         mBuffer->MapMemory((void**)&mapped);
+         WriteMemory(mapped);
+         mBuffer->UnmapMemory();
+      }
+   }
+
+   void ShaderBuffer::RefreshStaleCopies(uint32_t frameIndex)
+   {
+      std::lock_guard<std::mutex> lock(sStaleBuffersMutex);
+
+      for (auto iter = sStaleBuffers.begin(); iter != sStaleBuffers.end();)
+      {
+         ShaderBuffer* shaderBuffer = *iter;
+         uint32_t copyIndex = shaderBuffer->GetCopyIndex(frameIndex);
+
+         if (shaderBuffer->mStaleCopies & (1u << copyIndex))
+         {
+            shaderBuffer->WriteCopy(copyIndex);
+            shaderBuffer->mStaleCopies &= ~(1u << copyIndex);
+         }
+
+         if (shaderBuffer->mStaleCopies == 0u)
+            iter = sStaleBuffers.erase(iter);
+         else
+            iter++;
+      }
+   }
+
+   const VkDescriptorBufferInfo* ShaderBuffer::GetDescriptor() const
+   {
+      return GetDescriptor(mDevice->GetFrameIndex());
+   }
+
+   const VkDescriptorBufferInfo* ShaderBuffer::GetDescriptor(uint32_t frameIndex) const
+   {
+      return &mDescriptors[GetCopyIndex(frameIndex)];
+   }
+
+   Buffer* ShaderBuffer::GetBuffer()
+   {
+      return mBuffer;
+   }
+
+   uint32_t ShaderBuffer::GetCopyIndex(uint32_t frameIndex) const
+   {
+      return frameIndex % (uint32_t)mDescriptors.size();
    }
-}
\ No newline at end of file
+}
@@ -1,7 +1,11 @@
 #pragma once
 
+#include <vector>
+#include <set>
+#include <mutex>
 #include "vulkan/VulkanPrerequisites.h"
 #include "vulkan/handles/Buffer.h"
+#include "vulkan/UniformAllocator.h"
 
 /**
  * Macros that can be used to ease the creation of the C++ representation
@@ -13,14 +17,12 @@
 #define UNIFORM_BLOCK_BEGIN(Name)                        \
       class Name : public Utopian::Vk::ShaderBuffer      \
       {                                                  \
-      public:                                            \
-         virtual void UpdateMemory() {                   \
-            uint8_t *mapped;                             \
-            mBuffer->MapMemory((void**)&mapped);         \
+      protected:                                         \
+         virtual void WriteMemory(uint8_t* mapped) {     \
             memcpy(mapped, &data, sizeof(data));         \
-            mBuffer->UnmapMemory();                      \
          }                                               \
                                                          \
+      public:                                            \
          virtual int GetSize() {                         \
             return sizeof(data);                         \
          }                                               \
@@ -40,7 +42,20 @@
 
 namespace Utopian::Vk
 {
-   /** Base class for uniform and storage buffer. */
+   /** How often a uniform buffer is expected to be updated, see ShaderBuffer::Create(). */
+   enum ShaderBufferUpdateFrequency
+   {
+      UPDATE_FREQUENCY_PER_FRAME, // Sub-allocated from the persistently mapped UniformAllocator
+      UPDATE_FREQUENCY_RARELY     // Owns its buffers and maps them on every update
+   };
+
+   /**
+    * Base class for uniform and storage buffer.
+    *
+    * Uniform buffers get one copy per frame in flight so that the CPU can update the data of
+    * the next frame while the GPU still reads the previous one. Storage buffers are written and
+    * read back by the GPU and CPU across frames so they only have a single copy.
+    */
    class ShaderBuffer
    {
    public:
@@ -48,24 +63,63 @@ namespace Utopian::Vk
       virtual ~ShaderBuffer();
 
       // [NOTE] This has to be called after elements have been added to vectors, since GetSize() needs to return the correct size
-      // Creates a VkBuffer and maps it to a VkMemory (VulkanBase::CreateBuffer())
-      void Create(Device* device, VkBufferUsageFlags usageFlags, VkMemoryPropertyFlags propertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+      // Host visible uniform buffers updated every frame are sub-allocated from the UniformAllocator of the device,
+      // all other buffers create their own VkBuffer and map it to a VkMemory (VulkanBase::CreateBuffer())
+      void Create(Device* device, VkBufferUsageFlags usageFlags, VkMemoryPropertyFlags propertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+                  ShaderBufferUpdateFrequency updateFrequency = UPDATE_FREQUENCY_PER_FRAME);
+
+      /** Releases the memory, also done by the destructor. */
+      void Destroy();
 
       void MapMemory(VkDeviceSize offset, VkDeviceSize size, VkMemoryMapFlags flags, void** data);
       void UnmapMemory();
 
-      // This is where the data gets transfered to device memory w/ vkMapMemory,vkUnmapMemory and memcpy
-      virtual void UpdateMemory() = 0;
+      /**
+       * This is where the data gets transfered to device memory.
+       * Only the copy of the current frame is written, the other copies are refreshed by
+       * RefreshStaleCopies() once their frames are no longer used by the GPU.
+       */
+      void UpdateMemory();
 
       virtual int GetSize() = 0;
 
       virtual std::string GetDebugName() = 0;
 
-      const VkDescriptorBufferInfo* GetDescriptor() const { return &mDescriptor; }
-      Buffer* GetBuffer() { return mBuffer; }
+      /** Returns the descriptor of the copy used by the current frame. */
+      const VkDescriptorBufferInfo* GetDescriptor() const;
+
+      /** Returns the descriptor of the copy used by the frame slot. */
+      const VkDescriptorBufferInfo* GetDescriptor(uint32_t frameIndex) const;
+
+      /** Returns the buffer of the copy used by the current frame, nullptr if sub-allocated. */
+      Buffer* GetBuffer();
+
+      /**
+       * Writes the latest data to the copies of the frame slot that are out of date.
+       * Called at the start of every frame once the GPU is done with the slot.
+       */
+      static void RefreshStaleCopies(uint32_t frameIndex);
 
    protected:
+      /** Writes the data to the mapped memory of the copy being updated. */
+      virtual void WriteMemory(uint8_t* mapped) = 0;
+
+      // Buffer of the copy last written, nullptr if sub-allocated
       Buffer* mBuffer;
-      VkDescriptorBufferInfo mDescriptor;
+
+   private:
+      uint32_t GetCopyIndex(uint32_t frameIndex) const;
+      void WriteCopy(uint32_t copyIndex);
+
+      Device* mDevice;
+      std::vector<Buffer*> mFrameBuffers;
+      std::vector<uint8_t*> mMappedMemory;
+      std::vector<VkDescriptorBufferInfo> mDescriptors;
+      UniformAllocator::Allocation mAllocation;
+      uint32_t mStaleCopies;
+
+      // Buffers with copies that still have to be refreshed
+      static std::set<ShaderBuffer*> sStaleBuffers;
+      static std::mutex sStaleBuffersMutex;
    };
 }
@@ -0,0 +1,363 @@
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include "vulkan/ShaderCache.h"
+#include "vulkan/ShaderFactory.h"
+#include "core/Log.h"
+
+namespace Utopian::Vk
+{
+   static const uint32_t SHADER_CACHE_MAGIC = 0x43505355; // "USPC"
+
+   class CacheWriter
+   {
+   public:
+      template<typename T>
+      void Write(const T& value)
+      {
+         mStream.write((const char*)&value, sizeof(T));
+      }
+
+      void Write(const std::string& str)
+      {
+         Write((uint32_t)str.size());
+         mStream.write(str.data(), str.size());
+      }
+
+      std::string GetData() const
+      {
+         return mStream.str();
+      }
+
+   private:
+      std::ostringstream mStream;
+   };
+
+   class CacheReader
+   {
+   public:
+      CacheReader(const std::string& data)
+         : mData(data), mOffset(0), mValid(true)
+      {
+      }
+
+      template<typename T>
+      T Read()
+      {
+         T value = T();
+         if (mOffset + sizeof(T) > mData.size())
+         {
+            mValid = false;
+            return value;
+         }
+
+         memcpy(&value, &mData[mOffset], sizeof(T));
+         mOffset += sizeof(T);
+         return value;
+      }
+
+      std::string ReadString()
+      {
+         uint32_t size = Read<uint32_t>();
+         if (!mValid || mOffset + size > mData.size())
+         {
+            mValid = false;
+            return "";
+         }
+
+         std::string str = mData.substr(mOffset, size);
+         mOffset += size;
+         return str;
+      }
+
+      bool IsValid() const
+      {
+         return mValid;
+      }
+
+   private:
+      const std::string& mData;
+      size_t mOffset;
+      bool mValid;
+   };
+
+   static void WriteBlocks(CacheWriter& writer, const std::map<std::string, UniformBlockDesc>& blocks)
+   {
+      writer.Write((uint32_t)blocks.size());
+      for (auto& iter : blocks)
+      {
+         writer.Write(iter.second.name);
+         writer.Write(iter.second.set);
+         writer.Write(iter.second.binding);
+         writer.Write(iter.second.size);
+      }
+   }
+
+   static void ReadBlocks(CacheReader& reader, std::map<std::string, UniformBlockDesc>& blocks)
+   {
+      uint32_t count = reader.Read<uint32_t>();
+      for (uint32_t i = 0; i < count && reader.IsValid(); i++)
+      {
+         UniformBlockDesc desc;
+         desc.name = reader.ReadString();
+         desc.set = reader.Read<uint32_t>();
+         desc.binding = reader.Read<uint32_t>();
+         desc.size = reader.Read<uint32_t>();
+         blocks[desc.name] = desc;
+      }
+   }
+
+   static void WriteVariables(CacheWriter& writer, const std::map<std::string, UniformVariableDesc>& variables)
+   {
+      writer.Write((uint32_t)variables.size());
+      for (auto& iter : variables)
+      {
+         writer.Write((uint32_t)iter.second.type);
+         writer.Write(iter.second.name);
+         writer.Write(iter.second.set);
+         writer.Write(iter.second.binding);
+         writer.Write(iter.second.arraySize);
+      }
+   }
+
+   static void ReadVariables(CacheReader& reader, std::map<std::string, UniformVariableDesc>& variables)
+   {
+      uint32_t count = reader.Read<uint32_t>();
+      for (uint32_t i = 0; i < count && reader.IsValid(); i++)
+      {
+         UniformVariableDesc desc;
+         desc.type = (UniformVariableType)reader.Read<uint32_t>();
+         desc.name = reader.ReadString();
+         desc.set = reader.Read<uint32_t>();
+         desc.binding = reader.Read<uint32_t>();
+         desc.arraySize = reader.Read<uint32_t>();
+         variables[desc.name] = desc;
+      }
+   }
+
+   static void WriteVertexDescription(CacheWriter& writer, const VertexDescription* vertexDescription)
+   {
+      writer.Write((uint8_t)(vertexDescription != nullptr));
+      if (vertexDescription == nullptr)
+         return;
+
+      // The reflected vertex input only contains float vectors in binding 0 so the formats are enough to recreate it
+      const VkPipelineVertexInputStateCreateInfo* inputState = vertexDescription->GetInputState();
+      writer.Write(inputState->vertexAttributeDescriptionCount);
+      for (uint32_t i = 0; i < inputState->vertexAttributeDescriptionCount; i++)
+         writer.Write((uint32_t)inputState->pVertexAttributeDescriptions[i].format);
+   }
+
+   static SharedPtr<VertexDescription> ReadVertexDescription(CacheReader& reader)
+   {
+      if (reader.Read<uint8_t>() == 0)
+         return nullptr;
+
+      SharedPtr<VertexDescription> vertexDescription = std::make_shared<VertexDescription>();
+      uint32_t totalSize = 0;
+      uint32_t numAttributes = reader.Read<uint32_t>();
+      for (uint32_t i = 0; i < numAttributes && reader.IsValid(); i++)
+      {
+         VkFormat format = (VkFormat)reader.Read<uint32_t>();
+         switch (format)
+         {
+         case VK_FORMAT_R32G32_SFLOAT:
+            vertexDescription->AddAttribute(BINDING_0, Vec2Attribute());
+            totalSize += sizeof(glm::vec2);
+            break;
+         case VK_FORMAT_R32G32B32_SFLOAT:
+            vertexDescription->AddAttribute(BINDING_0, Vec3Attribute());
+            totalSize += sizeof(glm::vec3);
+            break;
+         case VK_FORMAT_R32G32B32A32_SFLOAT:
+            vertexDescription->AddAttribute(BINDING_0, Vec4Attribute());
+            totalSize += sizeof(glm::vec4);
+            break;
+         default:
+            assert(0);
+            break;
+         }
+      }
+
+      if (totalSize != 0)
+         vertexDescription->AddBinding(BINDING_0, totalSize, VK_VERTEX_INPUT_RATE_VERTEX);
+
+      return vertexDescription;
+   }
+
+   ShaderCache::ShaderCache(std::string directory)
+   {
+      mDirectory = directory;
+
+      std::error_code error;
+      std::filesystem::create_directories(mDirectory, error);
+   }
+
+   ShaderCache::~ShaderCache()
+   {
+   }
+
+   SharedPtr<CompiledShader> ShaderCache::Load(const std::string& filename, uint64_t optionsHash)
+   {
+      std::ifstream fin(GetEntryPath(filename, optionsHash), std::ios::binary);
+      if (!fin.is_open())
+         return nullptr;
+
+      std::string data((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+      CacheReader reader(data);
+
+      if (reader.Read<uint32_t>() != SHADER_CACHE_MAGIC || reader.Read<uint32_t>() != SHADER_CACHE_VERSION)
+         return nullptr;
+
+      // Compare the content of the shader and its includes with when the entry was stored
+      uint32_t numDependencies = reader.Read<uint32_t>();
+      for (uint32_t i = 0; i < numDependencies; i++)
+      {
+         std::string dependency = reader.ReadString();
+         uint64_t storedHash = reader.Read<uint64_t>();
+
+         uint64_t currentHash;
+         if (!reader.IsValid() || !HashFile(dependency, currentHash) || currentHash != storedHash)
+            return nullptr;
+      }
+
+      SharedPtr<CompiledShader> compiledShader = std::make_shared<CompiledShader>();
+      compiledShader->shaderStage = (VkShaderStageFlagBits)reader.Read<uint32_t>();
+      compiledShader->shaderModule = VK_NULL_HANDLE;
+
+      uint32_t numWords = reader.Read<uint32_t>();
+      compiledShader->spirvBytecode.resize(numWords);
+      for (uint32_t i = 0; i < numWords && reader.IsValid(); i++)
+         compiledShader->spirvBytecode[i] = reader.Read<uint32_t>();
+
+      ShaderReflection& reflection = compiledShader->reflection;
+      ReadBlocks(reader, reflection.uniformBlocks);
+      ReadBlocks(reader, reflection.storageBuffers);
+      ReadVariables(reader, reflection.combinedSamplers);
+      ReadVariables(reader, reflection.images);
+
+      uint32_t numPushConstants = reader.Read<uint32_t>();
+      for (uint32_t i = 0; i < numPushConstants && reader.IsValid(); i++)
+      {
+         PushConstantDesc desc;
+         desc.name = reader.ReadString();
+         desc.size = reader.Read<uint32_t>();
+         reflection.pushConstants[desc.name] = desc;
+      }
+
+      uint32_t numNameMappings = reader.Read<uint32_t>();
+      for (uint32_t i = 0; i < numNameMappings && reader.IsValid(); i++)
+      {
+         std::string name = reader.ReadString();
+         uint32_t set = reader.Read<uint32_t>();
+         uint32_t binding = reader.Read<uint32_t>();
+         reflection.nameMappings[name] = NameMapping(set, binding);
+      }
+
+      reflection.vertexDescription = ReadVertexDescription(reader);
+
+      if (!reader.IsValid())
+      {
+         UTO_LOG("Corrupt shader cache entry for: " + filename);
+         return nullptr;
+      }
+
+      return compiledShader;
+   }
+
+   void ShaderCache::Store(const std::string& filename, uint64_t optionsHash, const std::vector<std::string>& dependencies,
+                           const CompiledShader& compiledShader)
+   {
+      CacheWriter writer;
+      writer.Write(SHADER_CACHE_MAGIC);
+      writer.Write(SHADER_CACHE_VERSION);
+
+      writer.Write((uint32_t)dependencies.size());
+      for (auto& dependency : dependencies)
+      {
+         uint64_t hash;
+         if (!HashFile(dependency, hash))
+            return;
+
+         writer.Write(dependency);
+         writer.Write(hash);
+      }
+
+      writer.Write((uint32_t)compiledShader.shaderStage);
+      writer.Write((uint32_t)compiledShader.spirvBytecode.size());
+      for (unsigned int word : compiledShader.spirvBytecode)
+         writer.Write((uint32_t)word);
+
+      const ShaderReflection& reflection = compiledShader.reflection;
+      WriteBlocks(writer, reflection.uniformBlocks);
+      WriteBlocks(writer, reflection.storageBuffers);
+      WriteVariables(writer, reflection.combinedSamplers);
+      WriteVariables(writer, reflection.images);
+
+      writer.Write((uint32_t)reflection.pushConstants.size());
+      for (auto& iter : reflection.pushConstants)
+      {
+         writer.Write(iter.second.name);
+         writer.Write(iter.second.size);
+      }
+
+      writer.Write((uint32_t)reflection.nameMappings.size());
+      for (auto& iter : reflection.nameMappings)
+      {
+         writer.Write(iter.first);
+         writer.Write(iter.second.set);
+         writer.Write(iter.second.binding);
+      }
+
+      WriteVertexDescription(writer, reflection.vertexDescription.get());
+
+      std::ofstream fout(GetEntryPath(filename, optionsHash), std::ios::binary);
+      if (!fout.is_open())
+      {
+         UTO_LOG("Failed to write shader cache entry for: " + filename);
+         return;
+      }
+
+      std::string data = writer.GetData();
+      fout.write(data.data(), data.size());
+   }
+
+   uint64_t ShaderCache::Hash(const void* data, size_t size, uint64_t seed)
+   {
+      const uint8_t* bytes = (const uint8_t*)data;
+      uint64_t hash = seed;
+      for (size_t i = 0; i < size; i++)
+      {
+         hash ^= bytes[i];
+         hash *= 0x100000001b3ull;
+      }
+
+      return hash;
+   }
+
+   uint64_t ShaderCache::Hash(const std::string& str, uint64_t seed)
+   {
+      return Hash(str.data(), str.size(), seed);
+   }
+
+   std::string ShaderCache::GetEntryPath(const std::string& filename, uint64_t optionsHash) const
+   {
+      char name[32];
+      snprintf(name, sizeof(name), "%016llx", (unsigned long long)Hash(filename, optionsHash));
+      return mDirectory + "/" + name + ".spvcache";
+   }
+
+   bool ShaderCache::HashFile(const std::string& filename, uint64_t& hash)
+   {
+      std::ifstream fin(filename, std::ios::binary);
+      if (!fin.is_open())
+         return false;
+
+      std::string content((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+      hash = Hash(content);
+      return true;
+   }
+}
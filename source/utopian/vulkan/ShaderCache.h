@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "vulkan/VulkanPrerequisites.h"
+#include "utility/Common.h"
+
+namespace Utopian::Vk
+{
+   // Must be increased whenever the layout of the entries or the reflection changes, it is part of
+   // the options hash so that entries from an older version are not even opened
+   static const uint32_t SHADER_CACHE_VERSION = 2;
+
+   struct CompiledShader;
+
+   /**
+    * On-disk cache of compiled SPIR-V and its reflection data.
+    *
+    * An entry is stored per shader file and compiler options, together with the content hash of
+    * the shader and every file it includes. The entry is only used if none of them has changed,
+    * so a warm start skips glslang entirely while edited shaders and includes are still recompiled.
+    */
+   class ShaderCache
+   {
+   public:
+      ShaderCache(std::string directory);
+      ~ShaderCache();
+
+      /**
+       * Returns the cached shader or nullptr if there is no entry or if any of the
+       * files it was compiled from has changed.
+       * @note The shader module is not created.
+       */
+      SharedPtr<CompiledShader> Load(const std::string& filename, uint64_t optionsHash);
+
+      /**
+       * Stores the compiled shader.
+       * @param dependencies The shader file followed by all the files it includes.
+       */
+      void Store(const std::string& filename, uint64_t optionsHash, const std::vector<std::string>& dependencies,
+                 const CompiledShader& compiledShader);
+
+      /** 64-bit FNV-1a hash, can be chained by passing the previous hash as seed. */
+      static uint64_t Hash(const void* data, size_t size, uint64_t seed = 0xcbf29ce484222325ull);
+      static uint64_t Hash(const std::string& str, uint64_t seed = 0xcbf29ce484222325ull);
+
+   private:
+      std::string GetEntryPath(const std::string& filename, uint64_t optionsHash) const;
+      static bool HashFile(const std::string& filename, uint64_t& hash);
+
+      std::string mDirectory;
+   };
+}
@@ -10,8 +10,17 @@
 #include <ResourceLimits.h>
 #include "core/renderer/Renderer.h"
 
+#define SHADER_CACHE_DIRECTORY "data/shader_cache"
+
 namespace Utopian::Vk
 {
+   // The glslang options below are part of the shader cache key
+   static const int ClientInputSemanticsVersion = 100; // maps to, say, #define VULKAN 100
+   static const glslang::EShTargetClientVersion VulkanClientVersion = glslang::EShTargetVulkan_1_0;
+   static const glslang::EShTargetLanguageVersion TargetVersion = glslang::EShTargetSpv_1_0;
+   static const EShMessages Messages = (EShMessages)(EShMsgSpvRules | EShMsgVulkanRules);
+   static const int DefaultVersion = 100;
+
    const TBuiltInResource DefaultTBuiltInResource = {
       /* .MaxLights = */ 32,
       /* .MaxClipPlanes = */ 6,
@@ -119,6 +128,22 @@ namespace Utopian::Vk
          /* .generalConstantMatrixVectorIndexing = */ 1,
     }};
 
+   /** Records the path of every file included during preprocessing, they are dependencies in the shader cache. */
+   class RecordingFileIncluder : public DirStackFileIncluder
+   {
+   public:
+      virtual IncludeResult* includeLocal(const char* headerName, const char* includerName, size_t inclusionDepth) override
+      {
+         IncludeResult* result = DirStackFileIncluder::includeLocal(headerName, includerName, inclusionDepth);
+         if (result != nullptr)
+            includedFiles.push_back(result->headerName);
+
+         return result;
+      }
+
+      std::vector<std::string> includedFiles;
+   };
+
    ShaderFactory& gShaderFactory()
    {
       return ShaderFactory::Instance();
@@ -205,7 +230,7 @@ namespace Utopian::Vk
    }
    
    ShaderFactory::ShaderFactory(Device* device)
-      : mDevice(device)
+      : mDevice(device), mShaderCache(SHADER_CACHE_DIRECTORY)
    {
       glslang::InitializeProcess();
    }
@@ -286,30 +311,30 @@ namespace Utopian::Vk
       SharedPtr<CompiledShader> compiledShader = nullptr;
       bool error = false;
 
+      EShLanguage shaderType = GetGlslangStage(GetSuffix(filename));
+      uint64_t optionsHash = GetCompilerOptionsHash(shaderType);
+
+      compiledShader = mShaderCache.Load(filename, optionsHash);
+      if (compiledShader != nullptr)
+         return compiledShader;
+
       std::ifstream file(filename);
 
       std::string glslString((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
       const char* glslSource = glslString.c_str();
 
-      EShLanguage shaderType = GetGlslangStage(GetSuffix(filename));
-
       glslang::TShader shader(shaderType);
       shader.setStrings(&glslSource, 1);
 
-      int ClientInputSemanticsVersion = 100; // maps to, say, #define VULKAN 100
-      glslang::EShTargetClientVersion VulkanClientVersion = glslang::EShTargetVulkan_1_0;
-      glslang::EShTargetLanguageVersion TargetVersion = glslang::EShTargetSpv_1_0;
-
       shader.setEnvInput(glslang::EShSourceGlsl, shaderType, glslang::EShClientVulkan, ClientInputSemanticsVersion);
       shader.setEnvClient(glslang::EShClientVulkan, VulkanClientVersion);
       shader.setEnvTarget(glslang::EShTargetSpv, TargetVersion);
 
-      EShMessages messages = (EShMessages)(EShMsgSpvRules | EShMsgVulkanRules);
+      EShMessages messages = Messages;
       TBuiltInResource resources = DefaultTBuiltInResource;
-      const int DefaultVersion = 100;
 
       /* Preprocess */
-      DirStackFileIncluder includer;
+      RecordingFileIncluder includer;
       includer.pushExternalLocalDirectory(GetFilePath(filename));
 
       for (auto& directory : mIncludeDirectories)
@@ -364,11 +389,34 @@ namespace Utopian::Vk
          compiledShader->spirvBytecode = spirV;
          compiledShader->reflection = reflection;
          compiledShader->shaderStage = GetVulkanShaderStage(GetSuffix(filename));
+
+         std::vector<std::string> dependencies = { filename };
+         dependencies.insert(dependencies.end(), includer.includedFiles.begin(), includer.includedFiles.end());
+         mShaderCache.Store(filename, optionsHash, dependencies, *compiledShader);
       }
 
       return compiledShader;
    }
 
+   uint64_t ShaderFactory::GetCompilerOptionsHash(EShLanguage shaderType) const
+   {
+      int options[] = { (int)shaderType, ClientInputSemanticsVersion, (int)VulkanClientVersion, (int)TargetVersion, (int)Messages, DefaultVersion };
+      uint64_t hash = ShaderCache::Hash(options, sizeof(options));
+      hash = ShaderCache::Hash(&DefaultTBuiltInResource, sizeof(DefaultTBuiltInResource), hash);
+
+      // A different glslang can generate different SPIR-V and reflection for the same source
+      const glslang::Version glslangVersion = glslang::GetVersion();
+      int versions[] = { (int)SHADER_CACHE_VERSION, glslangVersion.major, glslangVersion.minor, glslangVersion.patch };
+      hash = ShaderCache::Hash(versions, sizeof(versions), hash);
+      hash = ShaderCache::Hash(std::string(glslangVersion.flavor != nullptr ? glslangVersion.flavor : ""), hash);
+
+      // The include directories decide which files are found by #include
+      for (auto& directory : mIncludeDirectories)
+         hash = ShaderCache::Hash(directory, hash);
+
+      return hash;
+   }
+
    void ShaderFactory::AddIncludeDirectory(std::string directory)
    {
       mIncludeDirectories.push_back(directory);
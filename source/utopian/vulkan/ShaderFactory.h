@@ -5,6 +5,7 @@
 #include <map>
 #include "vulkan/VulkanPrerequisites.h"
 #include "vulkan/VertexDescription.h"
+#include "vulkan/ShaderCache.h"
 #include "utility/Module.h"
 #include "utility/Common.h"
 #include <glslang/Public/ShaderLang.h>
@@ -135,11 +136,13 @@ namespace Utopian::Vk
 
    private:
       SharedPtr<CompiledShader> CompileShader(std::string filename);
+      uint64_t GetCompilerOptionsHash(EShLanguage shaderType) const;
       ShaderReflection ExtractShaderLayout(glslang::TProgram& program, EShLanguage shaderType);
       void ReflectVertexInput(glslang::TProgram& program, ShaderReflection* reflection);
    private:
       std::vector<Shader*> mLoadedShaders;
       std::vector<std::string> mIncludeDirectories;
+      ShaderCache mShaderCache;
       Device* mDevice;
    };
 
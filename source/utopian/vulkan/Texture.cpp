@@ -2,12 +2,23 @@
 #include "vulkan/handles/Sampler.h"
 #include "vulkan/handles/DescriptorSet.h"
 #include "vulkan/handles/Image.h"
+#include "vulkan/handles/Device.h"
 
 namespace Utopian::Vk
 {
    Texture::Texture(Device* device)
    {
       mDevice = device;
+      mWidth = 0;
+      mHeight = 0;
+      mNumMipLevels = 1;
+      mLoaded = true;
+      mLastUsedFrame = 0;
+      mFormat = VK_FORMAT_UNDEFINED;
+      mResidentSize = 0;
+      mResidentMipLevel = 0;
+      mStreamable = false;
+      mStreaming = false;
    }
 
    Texture::~Texture()
@@ -56,6 +67,71 @@ namespace Utopian::Vk
       return mNumMipLevels;
    }
 
+   bool Texture::IsLoaded() const
+   {
+      return mLoaded;
+   }
+
+   void Texture::AddDependentDescriptorSet(const SharedPtr<DescriptorSet>& descriptorSet, uint32_t frameIndex)
+   {
+      std::lock_guard<std::mutex> lock(mDependentDescriptorSetsMutex);
+
+      // Only asynchronously loaded textures ever replace their image
+      if (!mStreamable)
+         return;
+
+      for (auto& dependentDescriptorSet : mDependentDescriptorSets)
+      {
+         if (dependentDescriptorSet.descriptorSet.lock() == descriptorSet)
+            return;
+      }
+
+      DependentDescriptorSet dependentDescriptorSet;
+      dependentDescriptorSet.descriptorSet = descriptorSet;
+      dependentDescriptorSet.frameIndex = frameIndex;
+      mDependentDescriptorSets.push_back(dependentDescriptorSet);
+   }
+
+   void Texture::SetLastUsedFrame(uint64_t frameNumber)
+   {
+      mLastUsedFrame = frameNumber;
+   }
+
+   uint64_t Texture::GetLastUsedFrame() const
+   {
+      return mLastUsedFrame;
+   }
+
+   void Texture::SetImage(const SharedPtr<Vk::Image>& image, const SharedPtr<Vk::Sampler>& sampler, uint32_t width, uint32_t height,
+                          uint32_t numMipLevels, bool loaded)
+   {
+      std::lock_guard<std::mutex> lock(mDependentDescriptorSetsMutex);
+
+      // The shared placeholder is kept alive by TextureLoader
+      mDevice->QueueDestroy(mImage);
+      mDevice->QueueDestroy(mSampler);
+
+      mImage = image;
+      mSampler = sampler;
+      mWidth = width;
+      mHeight = height;
+      mNumMipLevels = numMipLevels;
+      mLoaded = loaded;
+      UpdateDescriptor();
+
+      // The sets are kept since the image is replaced again if the texture is evicted
+      for (auto iter = mDependentDescriptorSets.begin(); iter != mDependentDescriptorSets.end();)
+      {
+         if (SharedPtr<DescriptorSet> descriptorSet = iter->descriptorSet.lock())
+         {
+            mDevice->QueueDescriptorUpdate(descriptorSet, iter->frameIndex);
+            iter++;
+         }
+         else
+            iter = mDependentDescriptorSets.erase(iter);
+      }
+   }
+
    void Texture::UpdateDescriptor()
    {
       mDescriptor.sampler = mSampler->GetVkHandle();
@@ -2,6 +2,8 @@
 
 #include <vector>
 #include <string>
+#include <mutex>
+#include <atomic>
 #include "vulkan/VulkanPrerequisites.h"
 #include "utility/Common.h"
 
@@ -31,6 +33,32 @@ namespace Utopian::Vk
 
       void SetPath(std::string path);
 
+      /** Returns false while an asynchronously loaded texture still uses the placeholder image. */
+      bool IsLoaded() const;
+
+      /**
+       * The descriptor set is queued for an update whenever the image of an asynchronously
+       * loaded texture is replaced, it must have been bound with GetDescriptor().
+       * This happens when the file has been loaded and when TextureLoader evicts or streams
+       * back the texture. The set must only be bound by the given frame slot, see Device::QueueDescriptorUpdate().
+       */
+      void AddDependentDescriptorSet(const SharedPtr<DescriptorSet>& descriptorSet, uint32_t frameIndex);
+
+      /**
+       * Marks the texture as used by the frame, see TextureLoader::GetFrameNumber().
+       * TextureLoader evicts the least recently used textures when over the memory budget.
+       */
+      void SetLastUsedFrame(uint64_t frameNumber);
+      uint64_t GetLastUsedFrame() const;
+
+   private:
+      /**
+       * Replaces the image of an asynchronously loaded texture and updates the dependent descriptor sets.
+       * The previous image is queued for destruction since earlier frames can still sample it.
+       */
+      void SetImage(const SharedPtr<Vk::Image>& image, const SharedPtr<Vk::Sampler>& sampler, uint32_t width, uint32_t height,
+                    uint32_t numMipLevels, bool loaded);
+
    private:
       SharedPtr<Vk::Image> mImage;
       SharedPtr<Vk::Sampler> mSampler;
@@ -40,6 +68,23 @@ namespace Utopian::Vk
       uint32_t mHeight;
       uint32_t mNumMipLevels;
       Device* mDevice;
+      std::atomic<bool> mLoaded;
+      struct DependentDescriptorSet
+      {
+         std::weak_ptr<DescriptorSet> descriptorSet;
+         uint32_t frameIndex;
+      };
+
+      std::vector<DependentDescriptorSet> mDependentDescriptorSets;
+      std::mutex mDependentDescriptorSetsMutex;
+
+      // Residency state of asynchronously loaded textures, only used by TextureLoader
+      uint64_t mLastUsedFrame;
+      VkFormat mFormat;
+      VkDeviceSize mResidentSize;
+      uint32_t mResidentMipLevel;
+      bool mStreamable;
+      bool mStreaming;
 
       friend class TextureLoader;
    };
@@ -2,18 +2,34 @@
 #include "vulkan/handles/DescriptorSet.h"
 #include "vulkan/Texture.h"
 #include "vulkan/handles/Queue.h"
-#include "vulkan/handles/CommandBuffer.h"
+#include "vulkan/UploadManager.h"
 #include "vulkan/handles/Sampler.h"
 #include "TextureLoader.h"
 #include "Debug.h"
 #include "vulkan/handles/Device.h"
 #include "vulkan/handles/Image.h"
 #include "utility/Utility.h"
+#include "core/Log.h"
 #include <vulkan/vulkan_core.h>
 #define STB_IMAGE_IMPLEMENTATION
 #include "../external/stb_image.h"
 #include <gli/gli.hpp>
 #include <gli/type.hpp>
+#include <algorithm>
+
+#define DEFAULT_UPLOAD_BUDGET (32 * 1024 * 1024)
+
+// Textures that have not been used for this many frames can be evicted
+#define EVICTION_DELAY_FRAMES 300
+
+// Number of frames between the evictions, gives the freed memory time to show up in the VMA budget
+#define EVICTION_INTERVAL_FRAMES 30
+
+// Number of high mip levels that are dropped before a texture is evicted completely
+#define DROPPED_MIP_LEVELS 2
+
+// The usage is reduced to this fraction of the budget when it is exceeded
+#define RESIDENCY_TARGET 0.9
 
 namespace Utopian::Vk
 {
@@ -21,10 +37,23 @@ namespace Utopian::Vk
    {
       mDevice = device;
       mQueue = mDevice->GetQueue()->GetVkHandle();
+      mNumPendingTextures = 0u;
+      mUploadBudget = DEFAULT_UPLOAD_BUDGET;
+      mFrameNumber = 0u;
+      mMemoryBudget = 0u;
+      mNumReducingTextures = 0u;
+      mResidencyStatistics = {};
+
+      uint32_t grey = 0xff808080;
+      mPlaceholderTexture = CreateTexture(&grey, VK_FORMAT_R8G8B8A8_UNORM, 1, 1, 1, sizeof(uint32_t),
+                                          VK_IMAGE_ASPECT_COLOR_BIT, "Texture loader placeholder");
    }
 
    TextureLoader::~TextureLoader()
    {
+      // The decode tasks reference the loader
+      gTaskScheduler().Wait(&mDecodeCounter);
+      CompleteUploads(true);
    }
 
    TextureLoader& gTextureLoader()
@@ -60,6 +89,372 @@ namespace Utopian::Vk
       return texture;
    }
    
+   SharedPtr<Texture> TextureLoader::LoadTextureAsync(std::string path, VkFormat format)
+   {
+      if (mTextureMap.find(path) != mTextureMap.end())
+         return mTextureMap[path];
+
+      SharedPtr<Texture> texture = std::make_shared<Texture>(mDevice);
+      texture->mImage = mPlaceholderTexture->mImage;
+      texture->mSampler = mPlaceholderTexture->mSampler;
+      texture->mWidth = mPlaceholderTexture->mWidth;
+      texture->mHeight = mPlaceholderTexture->mHeight;
+      texture->mLoaded = false;
+      texture->mFormat = format;
+      texture->mStreamable = true;
+      texture->SetPath(path);
+      texture->UpdateDescriptor();
+      mTextureMap[path] = texture;
+
+      StreamTexture(texture, 0u);
+
+      return texture;
+   }
+
+   void TextureLoader::StreamTexture(const SharedPtr<Texture>& texture, uint32_t firstMipLevel)
+   {
+      texture->mStreaming = true;
+
+      if (!texture->IsLoaded())
+         mNumPendingTextures++;
+      else if (firstMipLevel > 0)
+         mNumReducingTextures++;
+
+      std::string path = texture->GetPath();
+      VkFormat format = texture->mFormat;
+      gTaskScheduler().Submit([this, texture, path, format, firstMipLevel]()
+      {
+         DecodeTexture(texture, path, format, firstMipLevel);
+      }, &mDecodeCounter, nullptr, TASK_PRIORITY_BACKGROUND);
+   }
+
+   void TextureLoader::EvictTexture(const SharedPtr<Texture>& texture)
+   {
+      texture->SetImage(mPlaceholderTexture->mImage, mPlaceholderTexture->mSampler, mPlaceholderTexture->mWidth,
+                        mPlaceholderTexture->mHeight, 1, false);
+      texture->mResidentSize = 0;
+      texture->mResidentMipLevel = 0;
+   }
+
+   void TextureLoader::DecodeTexture(SharedPtr<Texture> texture, std::string path, VkFormat format, uint32_t firstMipLevel)
+   {
+      DecodedTexture decodedTexture;
+      decodedTexture.texture = texture;
+      decodedTexture.firstMipLevel = firstMipLevel;
+      decodedTexture.size = 0;
+
+      std::string extension = GetFileExtension(path);
+      if (extension == ".ktx" || extension == ".dds")
+      {
+         gli::texture2d tex2D(gli::load(path.c_str()));
+
+         if (tex2D.empty())
+         {
+            UTO_LOG("Failed to load texture: " + path);
+            std::lock_guard<std::mutex> lock(mDecodedTexturesMutex);
+            mDecodedTextures.push_back(std::move(decodedTexture));
+            return;
+         }
+
+         // The levels of a single layer and face are stored after each other, the high ones are skipped
+         uint32_t firstLevel = std::min(firstMipLevel, static_cast<uint32_t>(tex2D.levels()) - 1);
+         const uint8_t* firstLevelData = (const uint8_t*)tex2D[firstLevel].data();
+
+         decodedTexture.format = format;
+         decodedTexture.width = static_cast<uint32_t>(tex2D[firstLevel].extent().x);
+         decodedTexture.height = static_cast<uint32_t>(tex2D[firstLevel].extent().y);
+         decodedTexture.numMipLevels = static_cast<uint32_t>(tex2D.levels()) - firstLevel;
+         decodedTexture.firstMipLevel = firstLevel;
+         decodedTexture.data.assign(firstLevelData, (const uint8_t*)tex2D.data() + tex2D.size());
+
+         VkDeviceSize offset = 0;
+         for (uint32_t i = 0; i < decodedTexture.numMipLevels; i++)
+         {
+            VkBufferImageCopy bufferCopyRegion = {};
+            bufferCopyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            bufferCopyRegion.imageSubresource.mipLevel = i;
+            bufferCopyRegion.imageSubresource.baseArrayLayer = 0;
+            bufferCopyRegion.imageSubresource.layerCount = 1;
+            bufferCopyRegion.imageExtent.width = static_cast<uint32_t>(tex2D[firstLevel + i].extent().x);
+            bufferCopyRegion.imageExtent.height = static_cast<uint32_t>(tex2D[firstLevel + i].extent().y);
+            bufferCopyRegion.imageExtent.depth = 1;
+            bufferCopyRegion.bufferOffset = offset;
+
+            decodedTexture.copyRegions.push_back(bufferCopyRegion);
+            offset += tex2D[firstLevel + i].size();
+         }
+      }
+      else
+      {
+         // Like LoadTextureSTB() the data is always expanded to RGBA
+         int width, height, texChannels;
+         stbi_uc* pixels = stbi_load(path.c_str(), &width, &height, &texChannels, STBI_rgb_alpha);
+
+         if (!pixels)
+         {
+            UTO_LOG("Failed to load texture: " + path);
+            std::lock_guard<std::mutex> lock(mDecodedTexturesMutex);
+            mDecodedTextures.push_back(std::move(decodedTexture));
+            return;
+         }
+
+         decodedTexture.format = VK_FORMAT_R8G8B8A8_UNORM;
+         decodedTexture.width = width;
+         decodedTexture.height = height;
+         decodedTexture.numMipLevels = 1;
+         decodedTexture.firstMipLevel = 0;
+         decodedTexture.data.assign(pixels, pixels + width * height * sizeof(uint32_t));
+         stbi_image_free(pixels);
+
+         VkBufferImageCopy bufferCopyRegion = {};
+         bufferCopyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+         bufferCopyRegion.imageSubresource.layerCount = 1;
+         bufferCopyRegion.imageExtent.width = width;
+         bufferCopyRegion.imageExtent.height = height;
+         bufferCopyRegion.imageExtent.depth = 1;
+         decodedTexture.copyRegions.push_back(bufferCopyRegion);
+      }
+
+      decodedTexture.size = decodedTexture.data.size();
+
+      std::lock_guard<std::mutex> lock(mDecodedTexturesMutex);
+      mDecodedTextures.push_back(std::move(decodedTexture));
+   }
+
+   void TextureLoader::Update()
+   {
+      mFrameNumber++;
+
+      CompleteUploads(false);
+      UpdateResidency();
+      SubmitUploads();
+   }
+
+   void TextureLoader::UpdateResidency()
+   {
+      VmaBudget heapBudget = mDevice->GetMemoryBudget(VK_MEMORY_HEAP_DEVICE_LOCAL_BIT);
+
+      ResidencyStatistics statistics = {};
+      statistics.memoryUsage = heapBudget.usage;
+      statistics.memoryBudget = (mMemoryBudget != 0) ? mMemoryBudget : heapBudget.budget;
+
+      std::vector<SharedPtr<Texture>> evictionCandidates;
+
+      for (auto& iter : mTextureMap)
+      {
+         const SharedPtr<Texture>& texture = iter.second;
+
+         if (!texture->mStreamable)
+            continue;
+
+         statistics.numStreamable++;
+
+         if (texture->mStreaming)
+         {
+            statistics.numStreaming++;
+            continue;
+         }
+
+         // Marked during the previous or the current frame depending on when the scene was culled
+         bool recentlyUsed = (texture->GetLastUsedFrame() + 1 >= mFrameNumber);
+         bool reduced = (texture->mResidentMipLevel > 0);
+
+         if (!texture->IsLoaded() || reduced)
+         {
+            if (recentlyUsed)
+            {
+               StreamTexture(texture, 0u);
+               statistics.numStreaming++;
+               continue;
+            }
+
+            if (!texture->IsLoaded())
+            {
+               statistics.numEvicted++;
+               continue;
+            }
+         }
+
+         if (reduced)
+            statistics.numReduced++;
+         else
+            statistics.numResident++;
+
+         statistics.residentSize += texture->mResidentSize;
+
+         if (texture->GetLastUsedFrame() + EVICTION_DELAY_FRAMES < mFrameNumber)
+            evictionCandidates.push_back(texture);
+      }
+
+      mResidencyStatistics = statistics;
+
+      // Reduced textures are not freed until their new image has been uploaded
+      if (statistics.memoryUsage <= statistics.memoryBudget || mNumReducingTextures > 0 ||
+          (mFrameNumber % EVICTION_INTERVAL_FRAMES) != 0)
+         return;
+
+      std::sort(evictionCandidates.begin(), evictionCandidates.end(), [](const SharedPtr<Texture>& a, const SharedPtr<Texture>& b) {
+         return a->GetLastUsedFrame() < b->GetLastUsedFrame();
+      });
+
+      VkDeviceSize targetUsage = (VkDeviceSize)(statistics.memoryBudget * RESIDENCY_TARGET);
+      VkDeviceSize excessSize = statistics.memoryUsage - targetUsage;
+      VkDeviceSize freedSize = 0;
+
+      for (auto& texture : evictionCandidates)
+      {
+         if (freedSize >= excessSize)
+            break;
+
+         // Every dropped level reduces the size to about a quarter
+         uint32_t numFileMipLevels = texture->GetNumMipLevels() + texture->mResidentMipLevel;
+         if (texture->mResidentMipLevel == 0 && numFileMipLevels > DROPPED_MIP_LEVELS)
+         {
+            freedSize += texture->mResidentSize - (texture->mResidentSize >> (2 * DROPPED_MIP_LEVELS));
+            StreamTexture(texture, DROPPED_MIP_LEVELS);
+         }
+         else
+         {
+            freedSize += texture->mResidentSize;
+            EvictTexture(texture);
+         }
+      }
+   }
+
+   void TextureLoader::SubmitUploads()
+   {
+      UploadBatch batch;
+      VkDeviceSize uploadedBytes = 0;
+
+      {
+         std::lock_guard<std::mutex> lock(mDecodedTexturesMutex);
+
+         while (!mDecodedTextures.empty())
+         {
+            // Textures that failed to decode keep their current image and are no longer streamed
+            if (mDecodedTextures.front().data.empty())
+            {
+               Texture* texture = mDecodedTextures.front().texture.get();
+               if (!texture->IsLoaded())
+                  mNumPendingTextures--;
+               else if (mDecodedTextures.front().firstMipLevel > 0)
+                  mNumReducingTextures--;
+
+               texture->mStreaming = false;
+               texture->mStreamable = false;
+               mDecodedTextures.pop_front();
+               continue;
+            }
+
+            VkDeviceSize size = mDecodedTextures.front().data.size();
+            if (!batch.textures.empty() && uploadedBytes + size > mUploadBudget)
+               break;
+
+            uploadedBytes += size;
+            batch.textures.push_back(std::move(mDecodedTextures.front()));
+            mDecodedTextures.pop_front();
+         }
+      }
+
+      if (batch.textures.empty())
+         return;
+
+      UploadManager* uploadManager = mDevice->GetUploadManager();
+
+      for (auto& decodedTexture : batch.textures)
+      {
+         IMAGE_CREATE_INFO imageDesc;
+         imageDesc.width = decodedTexture.width;
+         imageDesc.height = decodedTexture.height;
+         imageDesc.format = decodedTexture.format;
+         imageDesc.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+         imageDesc.mipLevels = decodedTexture.numMipLevels;
+         imageDesc.name = "Texture: " + decodedTexture.texture->GetPath();
+         SharedPtr<Image> image = std::make_shared<Vk::Image>(imageDesc, mDevice);
+
+         uploadManager->UploadImage(image, decodedTexture.data.data(), decodedTexture.data.size(), decodedTexture.copyRegions);
+
+         // The CPU copy is no longer needed once it is in the staging memory
+         decodedTexture.data = std::vector<uint8_t>();
+
+         batch.images.push_back(image);
+      }
+
+      batch.ticket = uploadManager->Submit();
+      mUploadBatches.push_back(std::move(batch));
+   }
+
+   void TextureLoader::CompleteUploads(bool wait)
+   {
+      UploadManager* uploadManager = mDevice->GetUploadManager();
+
+      for (auto iter = mUploadBatches.begin(); iter != mUploadBatches.end();)
+      {
+         UploadBatch& batch = *iter;
+
+         if (wait)
+            uploadManager->Wait(batch.ticket);
+         else if (!uploadManager->IsComplete(batch.ticket))
+         {
+            iter++;
+            continue;
+         }
+
+         for (uint32_t i = 0; i < batch.textures.size(); i++)
+         {
+            const DecodedTexture& decodedTexture = batch.textures[i];
+
+            SharedPtr<Sampler> sampler = std::make_shared<Vk::Sampler>(mDevice, false);
+            sampler->createInfo.minLod = 0.0f;
+            sampler->createInfo.maxLod = (float)decodedTexture.numMipLevels;
+            sampler->createInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
+            sampler->Create();
+
+            Texture* texture = decodedTexture.texture.get();
+            if (!texture->IsLoaded())
+               mNumPendingTextures--;
+            else if (decodedTexture.firstMipLevel > 0)
+               mNumReducingTextures--;
+
+            texture->SetImage(batch.images[i], sampler, decodedTexture.width, decodedTexture.height,
+                              decodedTexture.numMipLevels, true);
+            texture->mResidentSize = decodedTexture.size;
+            texture->mResidentMipLevel = decodedTexture.firstMipLevel;
+            texture->mStreaming = false;
+
+            // Gives textures that are not visible yet some time before they can be evicted
+            texture->SetLastUsedFrame(std::max(texture->GetLastUsedFrame(), mFrameNumber));
+         }
+
+         iter = mUploadBatches.erase(iter);
+      }
+   }
+
+   void TextureLoader::SetUploadBudget(VkDeviceSize bytesPerFrame)
+   {
+      mUploadBudget = bytesPerFrame;
+   }
+
+   uint32_t TextureLoader::GetNumPendingTextures() const
+   {
+      return mNumPendingTextures;
+   }
+
+   uint64_t TextureLoader::GetFrameNumber() const
+   {
+      return mFrameNumber;
+   }
+
+   void TextureLoader::SetMemoryBudget(VkDeviceSize budget)
+   {
+      mMemoryBudget = budget;
+   }
+
+   TextureLoader::ResidencyStatistics TextureLoader::GetResidencyStatistics() const
+   {
+      return mResidencyStatistics;
+   }
+
    SharedPtr<Texture> TextureLoader::LoadTextureGLI(std::string path, VkFormat format)
    {
       // These might be needed as parameters
@@ -74,14 +469,6 @@ namespace Utopian::Vk
       uint32_t height = static_cast<uint32_t>(tex2D[0].extent().y);
       uint32_t numMipLevels = static_cast<uint32_t>(tex2D.levels());
 
-      BUFFER_CREATE_INFO bufferDesc;
-      bufferDesc.usageFlags = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-      bufferDesc.memoryPropertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-      bufferDesc.data = tex2D.data();
-      bufferDesc.size = tex2D.size();
-      bufferDesc.name = "Texture loader GLI staging buffer";
-      Buffer stagingBuffer = Buffer(bufferDesc, mDevice);
-
       IMAGE_CREATE_INFO imageDesc;
       imageDesc.width = width;
       imageDesc.height = height;
@@ -111,17 +498,7 @@ namespace Utopian::Vk
          offset += static_cast<uint32_t>(tex2D[i].size());
       }
 
-      CommandBuffer cmdBuffer = CommandBuffer(mDevice, VK_COMMAND_BUFFER_LEVEL_PRIMARY, true);
-
-      // Transfer image to a valid layout
-      image->LayoutTransition(cmdBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-
-      stagingBuffer.Copy(&cmdBuffer, image.get(), bufferCopyRegions);
-
-      // Transfer back to final layouts
-      image->LayoutTransition(cmdBuffer, imageLayout);
-
-      cmdBuffer.Flush();
+      mDevice->GetUploadManager()->UploadImage(image, tex2D.data(), tex2D.size(), bufferCopyRegions, imageLayout);
 
       // Create the sampler
       SharedPtr<Sampler> sampler = std::make_shared<Vk::Sampler>(mDevice, false);
@@ -144,85 +521,47 @@ namespace Utopian::Vk
       int width, height, texChannels;
       uint32_t pixelSize = sizeof(uint32_t);
       stbi_uc* pixels = stbi_load(path.c_str(), &width, &height, &texChannels, STBI_rgb_alpha);
-      VkDeviceSize imageSize = width * height * pixelSize;
 
       if (!pixels) {
          return nullptr;
       }
 
-      // Temporary image used to retrieve the subresource layout needed for correct copying of image data
-      IMAGE_CREATE_INFO imageDesc;
-      imageDesc.width = width;
-      imageDesc.height = height;
-      imageDesc.tiling = VK_IMAGE_TILING_LINEAR;
-      imageDesc.properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-      imageDesc.name = "Texture loader temporary image";
-      Image temporaryImage = Image(imageDesc, mDevice);
-
-      VkSubresourceLayout imageLayout = temporaryImage.GetSubresourceLayout(mDevice);
-
-      uint32_t* data = new uint32_t[imageSize];
-
-      if (imageLayout.rowPitch == width * pixelSize) {
-         memcpy(data, pixels, (size_t)imageSize);
-      }
-      else {
-         uint8_t* dataBytes = reinterpret_cast<uint8_t*>(data);
-
-         for (int y = 0; y < height; y++) {
-            memcpy(&dataBytes[y * imageLayout.rowPitch], &pixels[y * width * pixelSize], height * pixelSize);
-         }
-      }
-
-      SharedPtr<Texture> texture = CreateTexture(data, VK_FORMAT_R8G8B8A8_UNORM,
+      // The pixels are copied to the staging memory so they can be freed right away
+      SharedPtr<Texture> texture = CreateTexture(pixels, VK_FORMAT_R8G8B8A8_UNORM,
                                        width, height, 1, pixelSize,
                                        VK_IMAGE_ASPECT_COLOR_BIT, "Texture: " + path);
 
       stbi_image_free(pixels);
-      delete[] data;
 
       return texture;
    }
 
    SharedPtr<Texture> TextureLoader::CreateTexture(void* data, VkFormat format, uint32_t width, uint32_t height, uint32_t depth, uint32_t pixelSize, VkImageAspectFlagBits aspectMask, std::string name)
    {
-      VkDevice device = mDevice->GetVkDevice();
       VkDeviceSize imageSize = width * height * depth * pixelSize; // NOTE: Assumes each pixel is stored as U8
 
-      // Create staging image and fill it with data
       IMAGE_CREATE_INFO imageDesc;
       imageDesc.width = width;
       imageDesc.height = height;
       imageDesc.depth = depth;
       imageDesc.format = format;
-      imageDesc.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
-      imageDesc.tiling = VK_IMAGE_TILING_LINEAR;
-      imageDesc.properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-      imageDesc.name = "Texture loader staging texture";
-      Image stagingImage = Image(imageDesc, mDevice);
-
-      if (data != nullptr)
-         stagingImage.UpdateMemory(data, imageSize);
-
-      // Create the final image
-      imageDesc.tiling = VK_IMAGE_TILING_OPTIMAL;
       imageDesc.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
       imageDesc.properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
       imageDesc.name = name;
       SharedPtr<Image> image = std::make_shared<Vk::Image>(imageDesc, mDevice);
 
-      CommandBuffer cmdBuffer(mDevice, VK_COMMAND_BUFFER_LEVEL_PRIMARY, true);
-
-      // Prepare images for copying
-      stagingImage.LayoutTransition(cmdBuffer, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
-      image->LayoutTransition(cmdBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-
-      stagingImage.Copy(cmdBuffer, image.get());
-
-      // Transition to final layout
-      image->LayoutTransition(cmdBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+      // The data is tightly packed so it is copied from the staging memory with a single region
+      VkBufferImageCopy bufferCopyRegion = {};
+      bufferCopyRegion.imageSubresource.aspectMask = aspectMask;
+      bufferCopyRegion.imageSubresource.mipLevel = 0;
+      bufferCopyRegion.imageSubresource.baseArrayLayer = 0;
+      bufferCopyRegion.imageSubresource.layerCount = 1;
+      bufferCopyRegion.imageExtent.width = width;
+      bufferCopyRegion.imageExtent.height = height;
+      bufferCopyRegion.imageExtent.depth = depth;
+      bufferCopyRegion.bufferOffset = 0;
 
-      cmdBuffer.Flush();
+      mDevice->GetUploadManager()->UploadImage(image, data, imageSize, {bufferCopyRegion});
 
       // Create the sampler
       SharedPtr<Sampler> sampler = std::make_shared<Vk::Sampler>(mDevice, false);
@@ -265,13 +604,6 @@ namespace Utopian::Vk
       uint32_t height = static_cast<uint32_t>(texCube.extent().y);
       uint32_t numMipLevels = static_cast<uint32_t>(texCube.levels());
 
-      BUFFER_CREATE_INFO bufferDesc;
-      bufferDesc.usageFlags = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-      bufferDesc.memoryPropertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-      bufferDesc.data = texCube.data();
-      bufferDesc.size = texCube.size();
-      Buffer stagingBuffer = Buffer(bufferDesc, mDevice);
-
       IMAGE_CREATE_INFO imageDesc;
       imageDesc.width = width;
       imageDesc.height = height;
@@ -307,17 +639,7 @@ namespace Utopian::Vk
          }
       }
 
-      CommandBuffer cmdBuffer = CommandBuffer(mDevice, VK_COMMAND_BUFFER_LEVEL_PRIMARY, true);
-
-      // Transfer image to a valid layout
-      image->LayoutTransition(cmdBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-
-      stagingBuffer.Copy(&cmdBuffer, image.get(), bufferCopyRegions);
-
-      // Transfer back to final layouts
-      image->LayoutTransition(cmdBuffer, imageLayout);
-
-      cmdBuffer.Flush();
+      mDevice->GetUploadManager()->UploadImage(image, texCube.data(), texCube.size(), bufferCopyRegions, imageLayout);
 
       // Create the sampler
       SharedPtr<Sampler> sampler = std::make_shared<Vk::Sampler>(mDevice, false);
@@ -2,15 +2,41 @@
 
 #include <map>
 #include <string>
+#include <deque>
+#include <mutex>
+#include <vector>
 #include "vulkan/VulkanPrerequisites.h"
 #include "utility/Module.h"
 #include "utility/Common.h"
+#include "core/TaskScheduler.h"
+#include "vulkan/UploadManager.h"
 
 namespace Utopian::Vk
 {
+   /**
+    * Loads and caches textures. Asynchronously loaded textures are also streamed, when the device local
+    * memory usage exceeds the budget the least recently used ones first drop their high mip levels and
+    * are then evicted completely. They are streamed back in when they are used again, see Texture::SetLastUsedFrame().
+    */
    class TextureLoader : public Module<TextureLoader>
    {
    public:
+      struct ResidencyStatistics
+      {
+         uint32_t numStreamable;
+         uint32_t numResident;
+         uint32_t numReduced;
+         uint32_t numEvicted;
+         uint32_t numStreaming;
+
+         /** Size of the streamable textures that are resident, in bytes. */
+         VkDeviceSize residentSize;
+
+         /** Device local memory usage and the budget it is kept within. */
+         VkDeviceSize memoryUsage;
+         VkDeviceSize memoryBudget;
+      };
+
       TextureLoader(Device* device);
       ~TextureLoader();
 
@@ -23,6 +49,37 @@ namespace Utopian::Vk
        */
       SharedPtr<Texture> LoadTexture(std::string path, VkFormat format = VK_FORMAT_R8G8B8A8_UNORM, bool useCache = true);
 
+      /** \brief Loads a texture from a file without blocking
+       *
+       * Returns immediately with a texture that uses a placeholder image. The file is decoded
+       * by the TaskScheduler and uploaded by Update(), descriptor sets registered with
+       * Texture::AddDependentDescriptorSet() are then updated to use the real image.
+       * Shares the cache with LoadTexture().
+       */
+      SharedPtr<Texture> LoadTextureAsync(std::string path, VkFormat format = VK_FORMAT_R8G8B8A8_UNORM);
+
+      /**
+       * Uploads decoded textures in a single submission and swaps in the textures whose
+       * upload has completed on the GPU. Evicts and streams back textures depending on the
+       * memory budget and when they were last used. Should be called once per frame.
+       */
+      void Update();
+
+      /** Incremented by Update(), textures that are drawn should be marked with it. */
+      uint64_t GetFrameNumber() const;
+
+      /** Sets the device local memory budget in bytes, 0 uses the budget reported by VMA. */
+      void SetMemoryBudget(VkDeviceSize budget);
+
+      /** Returns the residency of the streamable textures as of the last Update(). */
+      ResidencyStatistics GetResidencyStatistics() const;
+
+      /** Sets the maximum number of bytes uploaded per frame, at least one texture is always uploaded. */
+      void SetUploadBudget(VkDeviceSize bytesPerFrame);
+
+      /** Returns the number of asynchronously loaded textures that are not yet usable. */
+      uint32_t GetNumPendingTextures() const;
+
       /** \brief Loads a cubemap texture from a file
        *
        * Stores the texture inside a std::map. Multiple loadings from the same
@@ -44,12 +101,61 @@ namespace Utopian::Vk
        */
       SharedPtr<Texture> CreateCubemapTexture(VkFormat format, uint32_t width, uint32_t height, uint32_t numMipLevels);
    private:
+      /** Pixel data decoded on a worker thread, waiting to be uploaded. */
+      struct DecodedTexture
+      {
+         SharedPtr<Texture> texture;
+         std::vector<uint8_t> data;
+         std::vector<VkBufferImageCopy> copyRegions;
+         VkFormat format;
+         uint32_t width;
+         uint32_t height;
+         uint32_t numMipLevels;
+         uint32_t firstMipLevel;
+         VkDeviceSize size;
+      };
+
+      /** Textures uploaded by one UploadManager batch, swapped in when the batch has completed. */
+      struct UploadBatch
+      {
+         UploadManager::Ticket ticket;
+         std::vector<DecodedTexture> textures;
+         std::vector<SharedPtr<Image>> images;
+      };
+
       SharedPtr<Texture> LoadTextureGLI(std::string path, VkFormat format = VK_FORMAT_R8G8B8A8_UNORM);
       SharedPtr<Texture> LoadTextureSTB(std::string path);
+      /** Decodes the mip levels starting at firstMipLevel, the level is clamped to the mip chain of the file. */
+      void DecodeTexture(SharedPtr<Texture> texture, std::string path, VkFormat format, uint32_t firstMipLevel);
+      void SubmitUploads();
+      void CompleteUploads(bool wait);
+
+      /** Streams back recently used textures and drops the least recently used ones when over budget. */
+      void UpdateResidency();
+
+      /** Decodes and uploads the texture again with the mip levels starting at firstMipLevel. */
+      void StreamTexture(const SharedPtr<Texture>& texture, uint32_t firstMipLevel);
+
+      /** Replaces the image of the texture with the placeholder. */
+      void EvictTexture(const SharedPtr<Texture>& texture);
+
    private:
       std::map<std::string, SharedPtr<Texture>> mTextureMap;
       Device*  mDevice;
       VkQueue mQueue;
+
+      // Used by asynchronously loaded textures until their upload has completed
+      SharedPtr<Texture> mPlaceholderTexture;
+      std::deque<DecodedTexture> mDecodedTextures;
+      std::mutex mDecodedTexturesMutex;
+      std::vector<UploadBatch> mUploadBatches;
+      TaskCounter mDecodeCounter;
+      uint32_t mNumPendingTextures;
+      VkDeviceSize mUploadBudget;
+      uint64_t mFrameNumber;
+      VkDeviceSize mMemoryBudget;
+      uint32_t mNumReducingTextures;
+      ResidencyStatistics mResidencyStatistics;
    };
 
    TextureLoader& gTextureLoader();
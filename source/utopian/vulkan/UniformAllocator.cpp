@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <cassert>
+#include <string>
+#include "vulkan/UniformAllocator.h"
+#include "vulkan/handles/Device.h"
+#include "vulkan/handles/Buffer.h"
+
+namespace Utopian::Vk
+{
+   UniformAllocator::UniformAllocator(Device* device, uint32_t numFrames)
+   {
+      mDevice = device;
+      mNumFrames = numFrames;
+      mNumAllocations = 0u;
+      mAlignment = std::max(device->GetProperties().limits.minUniformBufferOffsetAlignment, (VkDeviceSize)16);
+   }
+
+   UniformAllocator::~UniformAllocator()
+   {
+      assert(mNumAllocations == 0u);
+
+      for (auto& page : mPages)
+      {
+         for (auto& buffer : page.frameBuffers)
+            buffer->UnmapMemory();
+      }
+   }
+
+   UniformAllocator::Allocation UniformAllocator::Allocate(VkDeviceSize size)
+   {
+      Allocation allocation;
+
+      VkDeviceSize alignedSize = (size + mAlignment - 1) & ~(mAlignment - 1);
+      if (alignedSize > PAGE_SIZE)
+         return allocation;
+
+      std::lock_guard<std::mutex> lock(mMutex);
+
+      std::vector<Allocation>& freeAllocations = mFreeAllocations[alignedSize];
+      if (!freeAllocations.empty())
+      {
+         allocation = freeAllocations.back();
+         freeAllocations.pop_back();
+      }
+      else
+      {
+         if (mPages.empty() || mPages.back().usedSize + alignedSize > PAGE_SIZE)
+            AddPage();
+
+         allocation.page = (uint32_t)mPages.size() - 1;
+         allocation.offset = mPages.back().usedSize;
+         allocation.size = alignedSize;
+         mPages.back().usedSize += alignedSize;
+      }
+
+      mNumAllocations++;
+
+      return allocation;
+   }
+
+   void UniformAllocator::Free(Allocation& allocation)
+   {
+      if (!allocation.IsValid())
+         return;
+
+      std::lock_guard<std::mutex> lock(mMutex);
+
+      mFreeAllocations[allocation.size].push_back(allocation);
+      mNumAllocations--;
+
+      allocation = Allocation();
+   }
+
+   uint8_t* UniformAllocator::GetMappedMemory(const Allocation& allocation, uint32_t frameIndex) const
+   {
+      assert(allocation.IsValid() && frameIndex < mNumFrames);
+
+      std::lock_guard<std::mutex> lock(mMutex);
+
+      return mPages[allocation.page].mappedMemory[frameIndex] + allocation.offset;
+   }
+
+   VkDescriptorBufferInfo UniformAllocator::GetDescriptor(const Allocation& allocation, uint32_t frameIndex) const
+   {
+      assert(allocation.IsValid() && frameIndex < mNumFrames);
+
+      std::lock_guard<std::mutex> lock(mMutex);
+
+      VkDescriptorBufferInfo descriptor;
+      descriptor.buffer = mPages[allocation.page].frameBuffers[frameIndex]->GetVkHandle();
+      descriptor.offset = allocation.offset;
+      descriptor.range = allocation.size;
+
+      return descriptor;
+   }
+
+   uint32_t UniformAllocator::GetNumFrames() const
+   {
+      return mNumFrames;
+   }
+
+   void UniformAllocator::AddPage()
+   {
+      BUFFER_CREATE_INFO createInfo;
+      createInfo.usageFlags = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+      createInfo.memoryPropertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+      createInfo.data = nullptr;
+      createInfo.size = PAGE_SIZE;
+      createInfo.name = "Uniform allocator page " + std::to_string(mPages.size());
+
+      Page page;
+      page.usedSize = 0;
+
+      for (uint32_t i = 0; i < mNumFrames; i++)
+      {
+         SharedPtr<Buffer> buffer = std::make_shared<Buffer>(createInfo, mDevice);
+
+         uint8_t* mapped;
+         buffer->MapMemory((void**)&mapped);
+
+         page.frameBuffers.push_back(buffer);
+         page.mappedMemory.push_back(mapped);
+      }
+
+      mPages.push_back(page);
+   }
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <vector>
+#include "vulkan/VulkanPrerequisites.h"
+#include "utility/Common.h"
+
+namespace Utopian::Vk
+{
+   /**
+    * Sub-allocates uniform blocks from large persistently mapped buffers.
+    * Every page has one buffer per frame in flight and an allocation uses the same
+    * offset in all of them, so updating the block of a frame is a single memcpy
+    * and there is no VkBuffer or device memory allocation per block.
+    */
+   class UniformAllocator
+   {
+   public:
+      struct Allocation
+      {
+         bool IsValid() const { return page != INVALID_PAGE; }
+
+         uint32_t page = INVALID_PAGE;
+         VkDeviceSize offset = 0;
+         VkDeviceSize size = 0;
+      };
+
+      /** Size of the pages, also the largest block that can be allocated. */
+      static const VkDeviceSize PAGE_SIZE = 64 * 1024;
+      static const uint32_t INVALID_PAGE = ~0u;
+
+      UniformAllocator(Device* device, uint32_t numFrames);
+      ~UniformAllocator();
+
+      /** Returns an invalid allocation if size is larger than PAGE_SIZE. */
+      Allocation Allocate(VkDeviceSize size);
+      void Free(Allocation& allocation);
+
+      /**
+       * Returns the persistently mapped memory of the allocation in the frame slot.
+       * @note Locks the allocator, the result is meant to be cached by the owner of the allocation.
+       */
+      uint8_t* GetMappedMemory(const Allocation& allocation, uint32_t frameIndex) const;
+
+      VkDescriptorBufferInfo GetDescriptor(const Allocation& allocation, uint32_t frameIndex) const;
+
+      uint32_t GetNumFrames() const;
+
+   private:
+      struct Page
+      {
+         std::vector<SharedPtr<Buffer>> frameBuffers;
+         std::vector<uint8_t*> mappedMemory;
+         VkDeviceSize usedSize;
+      };
+
+      void AddPage();
+
+   private:
+      Device* mDevice;
+      std::vector<Page> mPages;
+
+      // Freed allocations are reused by blocks with the same aligned size
+      std::map<VkDeviceSize, std::vector<Allocation>> mFreeAllocations;
+      VkDeviceSize mAlignment;
+      uint32_t mNumFrames;
+      uint32_t mNumAllocations;
+
+      // Shader buffers can be created by the asset loading threads
+      mutable std::mutex mMutex;
+   };
+}
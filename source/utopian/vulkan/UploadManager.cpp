@@ -0,0 +1,275 @@
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include "vulkan/UploadManager.h"
+#include "vulkan/Debug.h"
+#include "vulkan/handles/Device.h"
+#include "vulkan/handles/Buffer.h"
+#include "vulkan/handles/Image.h"
+#include "vulkan/handles/Queue.h"
+#include "vulkan/handles/Fence.h"
+#include "vulkan/handles/CommandBuffer.h"
+
+namespace Utopian::Vk
+{
+   UploadManager::UploadManager(Device* device)
+   {
+      mDevice = device;
+      mRingHead = 0;
+      mRingUsedSize = 0;
+      mAlignment = std::max(device->GetProperties().limits.optimalBufferCopyOffsetAlignment, (VkDeviceSize)16);
+      mNextTicket = 1;
+      mRecordingBatch.ticket = mNextTicket++;
+
+      BUFFER_CREATE_INFO createInfo;
+      createInfo.usageFlags = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+      createInfo.memoryPropertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+      createInfo.data = nullptr;
+      createInfo.size = RING_SIZE;
+      createInfo.name = "Upload manager staging ring";
+      mRingBuffer = std::make_shared<Buffer>(createInfo, mDevice);
+      mRingBuffer->MapMemory((void**)&mRingMemory);
+   }
+
+   UploadManager::~UploadManager()
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+
+      SubmitBatch();
+      RetireBatches(mRecordingBatch.ticket, true);
+
+      mRingBuffer->UnmapMemory();
+   }
+
+   void UploadManager::UploadBuffer(const SharedPtr<Buffer>& destination, const void* data, VkDeviceSize size, VkDeviceSize dstOffset)
+   {
+      if (size == 0)
+         return;
+
+      assert(destination != nullptr && data != nullptr);
+      assert(dstOffset + size <= destination->GetSize());
+
+      std::lock_guard<std::mutex> lock(mMutex);
+
+      VkDeviceSize stagingOffset;
+      Buffer* stagingBuffer = AllocateStaging(data, size, stagingOffset);
+      BeginBatch();
+
+      VkBufferCopy region = {};
+      region.srcOffset = stagingOffset;
+      region.dstOffset = dstOffset;
+      region.size = size;
+      vkCmdCopyBuffer(mRecordingBatch.commandBuffer->GetVkHandle(), stagingBuffer->GetVkHandle(),
+                      destination->GetVkHandle(), 1, &region);
+
+      mRecordingBatch.buffers.push_back(destination);
+   }
+
+   void UploadManager::UploadImage(const SharedPtr<Image>& image, const void* data, VkDeviceSize size,
+                                   const std::vector<VkBufferImageCopy>& regions, VkImageLayout finalLayout)
+   {
+      assert(image != nullptr);
+
+      std::lock_guard<std::mutex> lock(mMutex);
+
+      Buffer* stagingBuffer = nullptr;
+      VkDeviceSize stagingOffset = 0;
+
+      if (data != nullptr && size > 0)
+         stagingBuffer = AllocateStaging(data, size, stagingOffset);
+
+      BeginBatch();
+      CommandBuffer& commandBuffer = *mRecordingBatch.commandBuffer;
+
+      image->LayoutTransition(commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+      if (stagingBuffer != nullptr)
+      {
+         std::vector<VkBufferImageCopy> stagingRegions = regions;
+         for (auto& region : stagingRegions)
+            region.bufferOffset += stagingOffset;
+
+         stagingBuffer->Copy(&commandBuffer, image.get(), stagingRegions);
+      }
+
+      image->LayoutTransition(commandBuffer, finalLayout);
+
+      mRecordingBatch.images.push_back(image);
+   }
+
+   UploadManager::Ticket UploadManager::Submit()
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+
+      Ticket ticket = mRecordingBatch.ticket;
+
+      // Nothing recorded, the previous batch is the last one that contains uploads
+      if (mRecordingBatch.commandBuffer == nullptr)
+         return ticket - 1;
+
+      SubmitBatch();
+
+      return ticket;
+   }
+
+   UploadManager::Ticket UploadManager::GetCurrentTicket() const
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+
+      return mRecordingBatch.ticket;
+   }
+
+   bool UploadManager::IsComplete(Ticket ticket)
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+
+      assert(ticket <= mRecordingBatch.ticket);
+
+      if (ticket == mRecordingBatch.ticket)
+         return mRecordingBatch.commandBuffer == nullptr;
+
+      RetireBatches(ticket, false);
+
+      return mInFlightBatches.empty() || mInFlightBatches.front().ticket > ticket;
+   }
+
+   void UploadManager::Wait(Ticket ticket)
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+
+      assert(ticket <= mRecordingBatch.ticket);
+
+      if (ticket == mRecordingBatch.ticket)
+         SubmitBatch();
+
+      RetireBatches(ticket, true);
+   }
+
+   void UploadManager::Update()
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+
+      RetireBatches(mRecordingBatch.ticket, false);
+   }
+
+   VkDeviceSize UploadManager::GetUsedStagingSize() const
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+
+      return mRingUsedSize;
+   }
+
+   Buffer* UploadManager::AllocateStaging(const void* data, VkDeviceSize size, VkDeviceSize& offset)
+   {
+      VkDeviceSize alignedSize = (size + mAlignment - 1) & ~(mAlignment - 1);
+
+      if (alignedSize > RING_SIZE)
+      {
+         BUFFER_CREATE_INFO createInfo;
+         createInfo.usageFlags = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+         createInfo.memoryPropertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+         createInfo.data = (void*)data;
+         createInfo.size = size;
+         createInfo.name = "Upload manager dedicated staging buffer";
+         SharedPtr<Buffer> stagingBuffer = std::make_shared<Buffer>(createInfo, mDevice);
+
+         mRecordingBatch.dedicatedStagingBuffers.push_back(stagingBuffer);
+         offset = 0;
+
+         return stagingBuffer.get();
+      }
+
+      while (!AllocateRing(alignedSize, offset))
+      {
+         // The ring is full, the oldest batch has to complete before its memory can be reused
+         if (mInFlightBatches.empty())
+            SubmitBatch();
+
+         RetireBatches(mInFlightBatches.front().ticket, true);
+      }
+
+      memcpy(mRingMemory + offset, data, (size_t)size);
+
+      return mRingBuffer.get();
+   }
+
+   bool UploadManager::AllocateRing(VkDeviceSize size, VkDeviceSize& offset)
+   {
+      if (mRingUsedSize == 0)
+         mRingHead = 0;
+
+      // Allocations never wrap, the end of the ring is skipped instead
+      VkDeviceSize start = mRingHead;
+      VkDeviceSize skippedSize = 0;
+      if (start + size > RING_SIZE)
+      {
+         skippedSize = RING_SIZE - start;
+         start = 0;
+      }
+
+      if (mRingUsedSize + skippedSize + size > RING_SIZE)
+         return false;
+
+      offset = start;
+      mRingHead = start + size;
+      mRingUsedSize += skippedSize + size;
+      mRecordingBatch.ringSize += skippedSize + size;
+
+      return true;
+   }
+
+   void UploadManager::BeginBatch()
+   {
+      if (mRecordingBatch.commandBuffer == nullptr)
+         mRecordingBatch.commandBuffer = std::make_shared<CommandBuffer>(mDevice, VK_COMMAND_BUFFER_LEVEL_PRIMARY, true);
+   }
+
+   void UploadManager::SubmitBatch()
+   {
+      if (mRecordingBatch.commandBuffer == nullptr)
+         return;
+
+      CommandBuffer* commandBuffer = mRecordingBatch.commandBuffer.get();
+
+      // Makes the copied data visible to everything submitted after the batch
+      VkMemoryBarrier barrier = {};
+      barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+      barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+      barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+      vkCmdPipelineBarrier(commandBuffer->GetVkHandle(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                           0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+      commandBuffer->End();
+
+      mRecordingBatch.fence = std::make_shared<Fence>(mDevice, 0);
+
+      // Submitted directly since Queue::Submit() submits the recorded batch first
+      VkSubmitInfo submitInfo = {};
+      submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+      submitInfo.commandBufferCount = 1;
+      submitInfo.pCommandBuffers = commandBuffer->GetVkHandlePtr();
+      Debug::ErrorCheck(vkQueueSubmit(mDevice->GetQueue()->GetVkHandle(), 1, &submitInfo, mRecordingBatch.fence->GetVkHandle()));
+
+      mInFlightBatches.push_back(std::move(mRecordingBatch));
+
+      mRecordingBatch = Batch();
+      mRecordingBatch.ticket = mNextTicket++;
+   }
+
+   void UploadManager::RetireBatches(Ticket ticket, bool wait)
+   {
+      // Batches complete in submission order, which also is the order their ring memory was allocated in
+      while (!mInFlightBatches.empty() && mInFlightBatches.front().ticket <= ticket)
+      {
+         Batch& batch = mInFlightBatches.front();
+
+         if (wait)
+            batch.fence->Wait();
+         else if (!batch.fence->IsSignaled())
+            break;
+
+         mRingUsedSize -= batch.ringSize;
+         mInFlightBatches.pop_front();
+      }
+   }
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <vector>
+#include "vulkan/VulkanPrerequisites.h"
+#include "utility/Common.h"
+
+namespace Utopian::Vk
+{
+   /**
+    * Uploads buffer and image data to device local memory in batches.
+    * The data is copied to a persistently mapped staging ring buffer and the copies are recorded
+    * into one command buffer, which is submitted with a fence before the next submission to the
+    * queue or when Submit() is called. This replaces one staging buffer, submission and queue
+    * stall per upload with a single submission for everything uploaded in between.
+    *
+    * @note The source data can be released as soon as an Upload call returns. The destination is
+    *       kept alive by the batch until the GPU has executed the copy.
+    */
+   class UploadManager
+   {
+   public:
+      /** Identifies a batch of uploads, see IsComplete() and Wait(). */
+      typedef uint64_t Ticket;
+
+      /** Size of the staging ring, uploads larger than this get a dedicated staging buffer. */
+      static const VkDeviceSize RING_SIZE = 64 * 1024 * 1024;
+
+      UploadManager(Device* device);
+      ~UploadManager();
+
+      /** Records a copy of size bytes from data to destination at dstOffset. */
+      void UploadBuffer(const SharedPtr<Buffer>& destination, const void* data, VkDeviceSize size, VkDeviceSize dstOffset = 0);
+
+      /**
+       * Records a copy of data to the regions of image. The bufferOffset of the regions are relative to data.
+       * The image is transitioned to VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL before the copy and to finalLayout after.
+       * If data is nullptr only the layout transitions are recorded.
+       */
+      void UploadImage(const SharedPtr<Image>& image, const void* data, VkDeviceSize size,
+                       const std::vector<VkBufferImageCopy>& regions,
+                       VkImageLayout finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+      /**
+       * Submits the uploads recorded since the last submission and returns the ticket of the batch.
+       * Called by Queue::Submit() so that recorded uploads always execute before the command buffers
+       * that use them.
+       */
+      Ticket Submit();
+
+      /** Returns the ticket of the batch that uploads are currently recorded to. */
+      Ticket GetCurrentTicket() const;
+
+      /** Returns true if the GPU has executed all uploads in the batch, does not block. */
+      bool IsComplete(Ticket ticket);
+
+      /** Blocks until the GPU has executed all uploads in the batch, submitting it first if needed. */
+      void Wait(Ticket ticket);
+
+      /** Releases the staging memory and destinations of completed batches. Should be called once per frame. */
+      void Update();
+
+      /** Returns the number of bytes of the staging ring used by batches that have not completed. */
+      VkDeviceSize GetUsedStagingSize() const;
+
+   private:
+      struct Batch
+      {
+         Ticket ticket = 0;
+         SharedPtr<CommandBuffer> commandBuffer;
+         SharedPtr<Fence> fence;
+         std::vector<SharedPtr<Buffer>> buffers;
+         std::vector<SharedPtr<Image>> images;
+         std::vector<SharedPtr<Buffer>> dedicatedStagingBuffers;
+         VkDeviceSize ringSize = 0;
+      };
+
+      /**
+       * Copies data to the staging ring and returns the buffer and offset to copy from.
+       * Waits for in-flight batches if the ring is full, the mutex must be locked.
+       */
+      Buffer* AllocateStaging(const void* data, VkDeviceSize size, VkDeviceSize& offset);
+      bool AllocateRing(VkDeviceSize size, VkDeviceSize& offset);
+      void BeginBatch();
+      void SubmitBatch();
+      void RetireBatches(Ticket ticket, bool wait);
+
+   private:
+      Device* mDevice;
+      SharedPtr<Buffer> mRingBuffer;
+      uint8_t* mRingMemory;
+      VkDeviceSize mRingHead;
+      VkDeviceSize mRingUsedSize;
+      VkDeviceSize mAlignment;
+
+      Batch mRecordingBatch;
+      std::deque<Batch> mInFlightBatches;
+      Ticket mNextTicket;
+
+      // Meshes and textures can be created from several threads
+      mutable std::mutex mMutex;
+   };
+}
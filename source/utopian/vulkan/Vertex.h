@@ -56,6 +56,79 @@ namespace Utopian::Vk
       glm::vec4 jointWeights;
    };
 
+   /** The vertex layouts that a Primitive can store its vertices with on the GPU. */
+   enum VertexLayout
+   {
+      /** Vertex, used by all shaders including vertex.glsl. */
+      VERTEX_LAYOUT_DEFAULT,
+
+      /** CompactVertex, only for static meshes drawn with shaders including vertex_compact.glsl. */
+      VERTEX_LAYOUT_COMPACT
+   };
+
+   /**
+    * Quantized vertex layout for static meshes, 24 bytes compared to the 92 bytes of Vertex.
+    * Position and texture coordinates are stored as half floats, the normal and tangent are
+    * octahedral encoded to two snorm16 components and the color is stored as unorm8.
+    * The tangent handedness is stored in the w component of the position.
+    * There are no joint indices or weights so skinned meshes must use Vertex.
+    *
+    * Matches attribute layout in data\shaders\include\vertex_compact.glsl.
+    */
+   struct CompactVertex
+   {
+      CompactVertex() = default;
+
+      CompactVertex(const Vertex& vertex)
+      {
+         position[0] = glm::packHalf2x16(glm::vec2(vertex.pos.x, vertex.pos.y));
+         position[1] = glm::packHalf2x16(glm::vec2(vertex.pos.z, vertex.tangent.w < 0.0f ? -1.0f : 1.0f));
+         normal = glm::packSnorm2x16(EncodeOctahedral(vertex.normal));
+         uv = glm::packHalf2x16(vertex.uv);
+         color = glm::packUnorm4x8(glm::vec4(vertex.color, 1.0f));
+         tangent = glm::packSnorm2x16(EncodeOctahedral(glm::vec3(vertex.tangent)));
+      }
+
+      static VertexDescription GetDescription()
+      {
+         VertexDescription description;
+         description.AddBinding(BINDING_0, sizeof(CompactVertex), VK_VERTEX_INPUT_RATE_VERTEX);
+         description.AddAttribute(BINDING_0, Half4Attribute());   // Location 0 : InPosPacked
+         description.AddAttribute(BINDING_0, Snorm2Attribute());  // Location 1 : InNormalPacked
+         description.AddAttribute(BINDING_0, Half2Attribute());   // Location 2 : InTex
+         description.AddAttribute(BINDING_0, U32Attribute());     // Location 3 : InColorPacked
+         description.AddAttribute(BINDING_0, Snorm2Attribute());  // Location 4 : InTangentPacked
+         return description;
+      }
+
+      /** Maps the unit vector to the [-1, 1] square by projecting it onto an octahedron. */
+      static glm::vec2 EncodeOctahedral(glm::vec3 v)
+      {
+         float length = glm::abs(v.x) + glm::abs(v.y) + glm::abs(v.z);
+
+         // Meshes without tangents have zero vectors
+         if (length == 0.0f)
+            return glm::vec2(0.0f);
+
+         v /= length;
+
+         // The lower hemisphere is folded over the diagonals
+         if (v.z < 0.0f)
+         {
+            return glm::vec2((1.0f - glm::abs(v.y)) * (v.x >= 0.0f ? 1.0f : -1.0f),
+                             (1.0f - glm::abs(v.x)) * (v.y >= 0.0f ? 1.0f : -1.0f));
+         }
+
+         return glm::vec2(v.x, v.y);
+      }
+
+      uint32_t position[2];
+      uint32_t normal;
+      uint32_t uv;
+      uint32_t color;
+      uint32_t tangent;
+   };
+
    struct ScreenQuadVertex
    {
       static VertexDescription GetDescription()
@@ -18,6 +18,13 @@ namespace Utopian::Vk
       virtual uint32_t GetSize() const = 0;
    };
 
+   class FloatAttribute : public VertexAttribute
+   {
+   public:
+      virtual VkFormat GetFormat() const { return VK_FORMAT_R32_SFLOAT; }
+      virtual uint32_t GetSize() const { return sizeof(float); }
+   };
+
    class Vec2Attribute : public VertexAttribute
    {
    public:
@@ -39,6 +46,27 @@ namespace Utopian::Vk
       virtual uint32_t GetSize() const { return sizeof(glm::vec4); }
    };
 
+   class Half2Attribute : public VertexAttribute
+   {
+   public:
+      virtual VkFormat GetFormat() const { return VK_FORMAT_R16G16_SFLOAT; }
+      virtual uint32_t GetSize() const { return 2 * sizeof(uint16_t); }
+   };
+
+   class Half4Attribute : public VertexAttribute
+   {
+   public:
+      virtual VkFormat GetFormat() const { return VK_FORMAT_R16G16B16A16_SFLOAT; }
+      virtual uint32_t GetSize() const { return 4 * sizeof(uint16_t); }
+   };
+
+   class Snorm2Attribute : public VertexAttribute
+   {
+   public:
+      virtual VkFormat GetFormat() const { return VK_FORMAT_R16G16_SNORM; }
+      virtual uint32_t GetSize() const { return 2 * sizeof(int16_t); }
+   };
+
    class U32Attribute : public VertexAttribute
    {
    public:
@@ -20,6 +20,7 @@
 #include "handles/Queue.h"
 #include "handles/DescriptorSetLayout.h"
 #include "utility/Utility.h"
+#include "FrameCommandPool.h"
 #include "core/renderer/ScreenQuadRenderer.h"
 
 #define VK_FLAGS_NONE 0
@@ -28,23 +29,22 @@
 
 namespace Utopian::Vk
 {
-   VulkanApp::VulkanApp(Window* window)
-      : VulkanBase(window, VULKAN_ENABLE_VALIDATION)
+   VulkanApp::VulkanApp(Window* window, uint32_t numFramesInFlight)
+      : VulkanBase(window, VULKAN_ENABLE_VALIDATION, numFramesInFlight)
    {
-      mSecondaryCommandBuffers.resize(0);
+      mPrimaryCommandBuffer = nullptr;
       SetClearColor(ColorRGB(47, 141, 255));
    }
 
    VulkanApp::~VulkanApp()
    {
-      delete mPrimaryCommandBuffer;
    }
 
    void VulkanApp::Prepare()
    {
       VulkanBase::Prepare();
 
-      mPrimaryCommandBuffer = new CommandBuffer(mDevice, VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+      mSecondaryCommandBuffers.resize(mNumFramesInFlight);
    }
 
    void VulkanApp::SetClearColor(glm::vec4 color)
@@ -57,9 +57,9 @@ namespace Utopian::Vk
       return mClearColor;
    }
 
-   void VulkanApp::AddSecondaryCommandBuffer(CommandBuffer* commandBuffer)
+   void VulkanApp::AddSecondaryCommandBuffer(CommandBuffer* commandBuffer, uint32_t frameIndex)
    {
-      mSecondaryCommandBuffers.push_back(commandBuffer);
+      mSecondaryCommandBuffers[frameIndex].push_back(commandBuffer);
    }
 
    void VulkanApp::RecordRenderingCommandBuffer(VkFramebuffer frameBuffer)
@@ -77,12 +77,15 @@ namespace Utopian::Vk
       renderPassBeginInfo.pClearValues = clearValues;
       renderPassBeginInfo.framebuffer = frameBuffer;
 
+      // The primary command buffer is reused once the GPU is done with the frame slot
+      mPrimaryCommandBuffer = GetFrameCommandPool()->Acquire(VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+
       // Begin command buffer recording & the render pass
       mPrimaryCommandBuffer->Begin();
       mPrimaryCommandBuffer->CmdBeginRenderPass(&renderPassBeginInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);   // VK_SUBPASS_CONTENTS_INLINE
 
       std::vector<VkCommandBuffer> commandBuffers;
-      for (CommandBuffer* commandBuffer : mSecondaryCommandBuffers)
+      for (CommandBuffer* commandBuffer : mSecondaryCommandBuffers[mFrameIndex])
       {
          if (commandBuffer->IsActive()) 
          {
@@ -109,7 +112,7 @@ namespace Utopian::Vk
       // VkImageMemoryBarrier have oldLayout and newLayout fields that are used 
       RecordRenderingCommandBuffer(mFrameBuffers->GetCurrent());
 
-      mDevice->GetQueue()->Submit(mPrimaryCommandBuffer, mWaitFence.get(), GetWaitSubmitSemaphore(), GetRenderCompleteSemaphore());
+      mDevice->GetQueue()->Submit(mPrimaryCommandBuffer, GetFrameFence(), GetWaitSubmitSemaphore(), GetRenderCompleteSemaphore());
    }
 
    void VulkanApp::HandleMessages(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
@@ -57,19 +57,19 @@ namespace Utopian::Vk
    class VulkanApp : public VulkanBase
    {
    public:
-      VulkanApp(Window* window);
+      VulkanApp(Window* window, uint32_t numFramesInFlight = DEFAULT_FRAMES_IN_FLIGHT);
       ~VulkanApp();
 
       void Prepare();
 
       /**
        * Adds a secondary command buffer that will be executed by
-       * VulkanApp::Render().
+       * VulkanApp::Render() in the frames that use the frame slot.
        * 
-       * @note For example one secondary command buffer is used by the
+       * @note For example one secondary command buffer per frame in flight is used by the
        * ScreenQuadUi and ImGui.
        */
-      void AddSecondaryCommandBuffer(CommandBuffer* commandBuffer);
+      void AddSecondaryCommandBuffer(CommandBuffer* commandBuffer, uint32_t frameIndex);
 
       /** Submits the primary command buffer to the graphics queue. */
       virtual void Render();
@@ -89,7 +89,7 @@ namespace Utopian::Vk
 
    private:
       CommandBuffer*                mPrimaryCommandBuffer;
-      std::vector<CommandBuffer*>   mSecondaryCommandBuffers;
+      std::vector<std::vector<CommandBuffer*>> mSecondaryCommandBuffers;
       glm::vec4                     mClearColor;
    };
 }  // VulkanLib namespace
@@ -1,5 +1,6 @@
 #include <vector>
 #include <array>
+#include <algorithm>
 #include <cassert>
 #include <sstream>
 #include "utility/Platform.h"
@@ -16,16 +17,23 @@
 #include "handles/Instance.h"
 #include "handles/FrameBuffers.h"
 #include "handles/Queue.h"
+#include "handles/CommandBuffer.h"
+#include "ShaderBuffer.h"
+#include "UploadManager.h"
+#include "FrameCommandPool.h"
 
 namespace Utopian::Vk
 {
-   VulkanBase::VulkanBase(Utopian::Window* window, bool enableValidation)
+   VulkanBase::VulkanBase(Utopian::Window* window, bool enableValidation, uint32_t numFramesInFlight)
       : mWindow(window)
    {
       mInstance = new Instance("Utopian Engine (v0.4)", enableValidation);
       Debug::InitDebug(mInstance);
 
+      mNumFramesInFlight = std::min(std::max(numFramesInFlight, 1u), MAX_FRAMES_IN_FLIGHT);
+
       mDevice = new Device(mInstance);
+      mDevice->SetNumFramesInFlight(mNumFramesInFlight);
       DebugLabel::Setup(mDevice);
    }
 
@@ -34,9 +42,11 @@ namespace Utopian::Vk
       mSwapChain.cleanup();
 
          // Needs to be freed before deleting the device
-         mWaitFence = nullptr;
-         mImageAvailable = nullptr;
-         mRenderComplete = nullptr;
+         FrameCommandPool::SetCurrent(nullptr);
+         mFrameCommandPools.clear();
+         mFrameFences.clear();
+         mImageAvailable.clear();
+         mRenderComplete.clear();
          mWaitSubmitSemaphore = nullptr;
 
       delete mDepthStencil;
@@ -71,11 +81,14 @@ namespace Utopian::Vk
       mRenderPass = new RenderPass(mDevice, mColorFormat, mDepthFormat, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
       mFrameBuffers = new FrameBuffers(mDevice, mRenderPass, mDepthStencil, &mSwapChain, GetWindowWidth(), GetWindowHeight());
 
-      mImageAvailable = std::make_shared<Semaphore>(mDevice);
-      mRenderComplete = std::make_shared<Semaphore>(mDevice);
-      SetWaitSubmitSemaphore(mImageAvailable);
-
-      mWaitFence = std::make_shared<Fence>(mDevice, 0*VK_FENCE_CREATE_SIGNALED_BIT);
+      // The fences start signaled since no frame has been submitted yet
+      for (uint32_t i = 0; i < mNumFramesInFlight; i++)
+      {
+         mImageAvailable.push_back(std::make_shared<Semaphore>(mDevice));
+         mRenderComplete.push_back(std::make_shared<Semaphore>(mDevice));
+         mFrameFences.push_back(std::make_shared<Fence>(mDevice, VK_FENCE_CREATE_SIGNALED_BIT));
+         mFrameCommandPools.push_back(std::make_shared<FrameCommandPool>(mDevice));
+      }
    }
 
    void VulkanBase::SetupSwapchain()
@@ -89,9 +102,34 @@ namespace Utopian::Vk
       mSwapChain.create(&width, &height);
    }
 
-   void VulkanBase::PrepareFrame()
+   void VulkanBase::BeginFrame()
    {
+      if (!mFirstFrame)
+         mFrameIndex = (mFrameIndex + 1) % mNumFramesInFlight;
+
+      mFirstFrame = false;
+
+      // The previous frame has been recorded, make its bind statistics available
+      CommandBuffer::EndStatisticsFrame();
+
+      // Everything the GPU used for this slot NumFramesInFlight frames ago can now be reused
+      Fence* frameFence = GetFrameFence();
+      frameFence->Wait();
+      frameFence->Reset();
+
+      mDevice->SetFrameIndex(mFrameIndex);
       mDevice->GarbageCollect();
+      mDevice->GetUploadManager()->Update();
+      ShaderBuffer::RefreshStaleCopies(mFrameIndex);
+
+      // Render targets recorded on the main thread use the command buffers of this frame
+      FrameCommandPool* frameCommandPool = GetFrameCommandPool();
+      frameCommandPool->Reset();
+      FrameCommandPool::SetCurrent(frameCommandPool);
+   }
+
+   void VulkanBase::PrepareFrame()
+   {
       mDevice->UpdateDescriptorSets();
 
       Queue* queue = mDevice->GetQueue();
@@ -107,23 +145,29 @@ namespace Utopian::Vk
                                                 GetRenderCompleteSemaphore()->GetVkHandle()));
    }
 
-   bool VulkanBase::PreviousFrameComplete()
+   void VulkanBase::WaitForFramesInFlight()
    {
-      static bool firstFrame = true;
-      if (firstFrame)
-      {
-         firstFrame = false;
-         return true;
-      }
+      mDevice->GetQueue()->WaitIdle();
+   }
 
-      VkResult fenceStatus = vkGetFenceStatus(mDevice->GetVkDevice(), mWaitFence->GetVkHandle());
-      if (fenceStatus == VK_SUCCESS)
-      {
-         mWaitFence->Reset();
-         return true;
-      }
+   Fence* VulkanBase::GetFrameFence() const
+   {
+      return mFrameFences[mFrameIndex].get();
+   }
+
+   FrameCommandPool* VulkanBase::GetFrameCommandPool() const
+   {
+      return mFrameCommandPools[mFrameIndex].get();
+   }
 
-      return false;
+   uint32_t VulkanBase::GetFrameIndex() const
+   {
+      return mFrameIndex;
+   }
+
+   uint32_t VulkanBase::GetNumFramesInFlight() const
+   {
+      return mNumFramesInFlight;
    }
 
    Device* VulkanBase::GetDevice()
@@ -173,16 +217,20 @@ namespace Utopian::Vk
 
    const SharedPtr<Semaphore>& VulkanBase::GetImageAvailableSemaphore() const
    {
-      return mImageAvailable;
+      return mImageAvailable[mFrameIndex];
    }
 
    const SharedPtr<Semaphore>& VulkanBase::GetRenderCompleteSemaphore() const
    {
-      return mRenderComplete;
+      return mRenderComplete[mFrameIndex];
    }
 
    const SharedPtr<Semaphore>& VulkanBase::GetWaitSubmitSemaphore() const
    {
+      // Without another primary command buffer the submission waits on the swapchain image directly
+      if (mWaitSubmitSemaphore == nullptr)
+         return GetImageAvailableSemaphore();
+
       return mWaitSubmitSemaphore;
    }
 
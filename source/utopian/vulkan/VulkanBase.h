@@ -4,8 +4,10 @@
 #pragma comment(linker, "/subsystem:windows")
 #endif
 
+#include <vector>
 #include "vulkan/vulkanswapchain.hpp"
 #include "vulkan/VulkanPrerequisites.h"
+#include "vulkan/handles/Device.h"
 //#include "vulkan/handles/Semaphore.h"
 #include "core/Window.h"
 #include "utility/Timer.h"
@@ -35,13 +37,19 @@ namespace Utopian::Vk
    class VulkanBase
    {
    public:
-      VulkanBase(Utopian::Window* window, bool enableValidation);
+      VulkanBase(Utopian::Window* window, bool enableValidation, uint32_t numFramesInFlight = DEFAULT_FRAMES_IN_FLIGHT);
       virtual ~VulkanBase();
 
       virtual void Prepare();
       virtual void Render() = 0;
 
-      /** To be called at the start of a frame. */
+      /**
+       * To be called before anything of a new frame is updated. Waits until the GPU is done with the
+       * frame that last used the same frame slot so that its per-frame resources can be reused.
+       */
+      void BeginFrame();
+
+      /** To be called at the start of frame rendering. */
       void PrepareFrame();
 
       /** To be called at the end of a frame. */
@@ -56,21 +64,32 @@ namespace Utopian::Vk
       uint32_t GetWindowWidth();
       uint32_t GetWindowHeight();
 
-      /** Returns the semaphore that is signaled when a new swapchain image is ready for use. */
+      /** Returns the frame slot in [0, GetNumFramesInFlight()) that is currently being recorded. */
+      uint32_t GetFrameIndex() const;
+      uint32_t GetNumFramesInFlight() const;
+
+      /** Blocks until the GPU has finished all frames in flight. */
+      void WaitForFramesInFlight();
+
+      /** Returns the semaphore of the current frame that is signaled when a new swapchain image is ready for use. */
       const SharedPtr<Semaphore>& GetImageAvailableSemaphore() const;
 
-      /** Returns the semaphore that is signaled when the submitted primary command buffer is executed, i.e 
-       * the image can be presented. */
+      /** Returns the semaphore of the current frame that is signaled when the submitted primary command buffer
+       * is executed, i.e the image can be presented. */
       const SharedPtr<Semaphore>& GetRenderCompleteSemaphore() const;
 
       /** Returns the semaphore which the primary command buffer submission is waiting on. */
       const SharedPtr<Semaphore>& GetWaitSubmitSemaphore() const;
 
-      /** Sets the semaphore which the primary command buffer submission will wait on. This can
-       * be GetImageAvailableSemaphore() directly or a semaphore signaled by another primary command buffer. */
+      /** Sets the semaphore which the primary command buffer submission will wait on. This is a semaphore
+       * signaled by another primary command buffer, when nullptr GetImageAvailableSemaphore() is used. */
       void SetWaitSubmitSemaphore(const SharedPtr<Semaphore>& waitSemaphore);
 
-      bool PreviousFrameComplete();
+      /** Returns the fence that is signaled when the GPU has executed the current frame. */
+      Fence* GetFrameFence() const;
+
+      /** Returns the command pool of the current frame that is current on the main thread. */
+      FrameCommandPool* GetFrameCommandPool() const;
 
       Window* GetWindow();
 
@@ -86,10 +105,18 @@ namespace Utopian::Vk
       Device*                    mDevice = nullptr;
       Window*                    mWindow = nullptr;
       Image*                     mDepthStencil = nullptr;
-      SharedPtr<Semaphore>       mImageAvailable = nullptr;
-      SharedPtr<Semaphore>       mRenderComplete = nullptr;
       SharedPtr<Semaphore>       mWaitSubmitSemaphore = nullptr;
-      SharedPtr<Fence>           mWaitFence = nullptr;
+
+      // Per frame in flight synchronization
+      std::vector<SharedPtr<Semaphore>> mImageAvailable;
+      std::vector<SharedPtr<Semaphore>> mRenderComplete;
+      std::vector<SharedPtr<Fence>> mFrameFences;
+
+      // Command buffers recorded on the main thread during a frame are allocated from these
+      std::vector<SharedPtr<FrameCommandPool>> mFrameCommandPools;
+      uint32_t                   mNumFramesInFlight;
+      uint32_t                   mFrameIndex = 0;
+      bool                       mFirstFrame = true;
 
       // Note: Todo: Used by legacy effects
       RenderPass*                mRenderPass = nullptr;
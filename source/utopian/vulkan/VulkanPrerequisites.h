@@ -46,9 +46,15 @@ namespace Utopian::Vk
    class PipelineInterface;
    class VulkanApp;
    class RenderTarget;
+   class FrameCommandPool;
    class ScreenQuadRenderer;
    class ShaderBuffer;
    class ShaderFactory;
+   class UniformAllocator;
+   class PipelineCache;
+   class UploadManager;
+   class GeometryPool;
+   class GeometryAllocation;
    class TextureLoader;
    struct Vertex;
    class VertexAttribute;
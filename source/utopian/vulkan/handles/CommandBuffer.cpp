@@ -12,14 +12,42 @@
 
 namespace Utopian::Vk
 {
+   CommandBuffer::AtomicBindStatistics CommandBuffer::sCurrentStatistics;
+   BindStatistics CommandBuffer::sFrameStatistics;
+
+   static uint32_t GetBindPointIndex(VkPipelineBindPoint bindPoint)
+   {
+      return (bindPoint == VK_PIPELINE_BIND_POINT_COMPUTE) ? 1u : 0u;
+   }
+
    CommandBuffer::CommandBuffer(Device* device, VkCommandBufferLevel level, bool begin)
       : Handle(device, nullptr)
+   {
+      mCommandPool = device->GetCommandPool();
+      Allocate(level, begin);
+   }
+
+   CommandBuffer::CommandBuffer(Device* device, CommandPool* commandPool, VkCommandBufferLevel level, bool begin)
+      : Handle(device, nullptr)
+   {
+      mCommandPool = commandPool;
+      Allocate(level, begin);
+   }
+
+   CommandBuffer::~CommandBuffer()
+   {
+      // [NOTE] Maybe not needed, if the command pool frees all it's command buffers
+      vkFreeCommandBuffers(GetVkDevice(), mCommandPool->GetVkHandle(), 1, &mHandle);
+   }
+
+   void CommandBuffer::Allocate(VkCommandBufferLevel level, bool begin)
    {
       mActive = true;
+      InvalidateState();
 
       VkCommandBufferAllocateInfo allocateInfo = {};
       allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-      allocateInfo.commandPool = GetDevice()->GetCommandPool()->GetVkHandle();
+      allocateInfo.commandPool = mCommandPool->GetVkHandle();
       allocateInfo.commandBufferCount = 1;
       allocateInfo.level = level;
 
@@ -32,14 +60,10 @@ namespace Utopian::Vk
       }
    }
 
-   CommandBuffer::~CommandBuffer()
-   {
-      // [NOTE] Maybe not needed, if the command pool frees all it's command buffers
-      vkFreeCommandBuffers(GetVkDevice(), GetDevice()->GetCommandPool()->GetVkHandle(), 1, &mHandle);
-   }
-
     void CommandBuffer::Begin()
     {
+      InvalidateState();
+
       VkCommandBufferBeginInfo beginInfo = {};
       beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
       beginInfo.flags = 0;
@@ -50,6 +74,8 @@ namespace Utopian::Vk
 
    void CommandBuffer::Begin(RenderPass* renderPass, VkFramebuffer frameBuffer)
    {
+      InvalidateState();
+
       VkCommandBufferInheritanceInfo inheritanceInfo = {};
       inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
       inheritanceInfo.renderPass = renderPass->GetVkHandle();
@@ -65,13 +91,16 @@ namespace Utopian::Vk
 
    void CommandBuffer::End()
    {
+      FlushStatistics();
       Debug::ErrorCheck(vkEndCommandBuffer(mHandle));
    }
 
    void CommandBuffer::Flush(bool free)
    {
       assert(mHandle);
+      assert(!Queue::IsDeferringSubmits());
 
+      FlushStatistics();
       Debug::ErrorCheck(vkEndCommandBuffer(mHandle));
 
       VkSubmitInfo submitInfo = {};
@@ -93,6 +122,7 @@ namespace Utopian::Vk
    {
       assert(mHandle);
 
+      FlushStatistics();
       Debug::ErrorCheck(vkEndCommandBuffer(mHandle));
 
       Queue* queue = GetDevice()->GetQueue();
@@ -101,7 +131,7 @@ namespace Utopian::Vk
 
    void CommandBuffer::Cleanup()
    {
-      vkFreeCommandBuffers(GetVkDevice(), GetDevice()->GetCommandPool()->GetVkHandle(), 1, &mHandle);
+      vkFreeCommandBuffers(GetVkDevice(), mCommandPool->GetVkHandle(), 1, &mHandle);
    }
 
    void CommandBuffer::CmdBeginRenderPass(VkRenderPassBeginInfo* renderPassBeginInfo, VkSubpassContents subpassContents)
@@ -143,7 +173,16 @@ namespace Utopian::Vk
 
    void CommandBuffer::CmdBindPipeline(VkPipeline pipeline)
    {
+      BindPointState& state = mBindPointStates[GetBindPointIndex(VK_PIPELINE_BIND_POINT_GRAPHICS)];
+      if (state.pipeline == pipeline)
+      {
+         mStatistics.skippedBinds++;
+         return;
+      }
+
       vkCmdBindPipeline(mHandle, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+      state.pipeline = pipeline;
+      mStatistics.pipelineBinds++;
    }
 
    void CommandBuffer::CmdBindPipeline(const Pipeline* pipeline)
@@ -151,39 +190,75 @@ namespace Utopian::Vk
       if (!pipeline->IsCreated())
          assert(0);
 
-      if (pipeline->IsComputePipeline())
-         vkCmdBindPipeline(mHandle, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline->GetVkHandle());
-      else
-         vkCmdBindPipeline(mHandle, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->GetVkHandle());
+      VkPipelineBindPoint bindPoint = pipeline->IsComputePipeline() ? VK_PIPELINE_BIND_POINT_COMPUTE : VK_PIPELINE_BIND_POINT_GRAPHICS;
+      BindPointState& state = mBindPointStates[GetBindPointIndex(bindPoint)];
+      if (state.pipeline == pipeline->GetVkHandle())
+      {
+         mStatistics.skippedBinds++;
+         return;
+      }
+
+      vkCmdBindPipeline(mHandle, bindPoint, pipeline->GetVkHandle());
+      state.pipeline = pipeline->GetVkHandle();
+      mStatistics.pipelineBinds++;
+   }
+
+   bool CommandBuffer::BindDescriptorSets(VkPipelineLayout pipelineLayout, uint32_t descriptorSetCount, const VkDescriptorSet* descriptorSets,
+                                          VkPipelineBindPoint bindPoint, uint32_t firstSet)
+   {
+      BindPointState& state = mBindPointStates[GetBindPointIndex(bindPoint)];
+
+      // Sets bound with another pipeline layout are not tracked since they can be disturbed
+      bool redundant = (state.pipelineLayout == pipelineLayout) && (firstSet + descriptorSetCount <= MAX_TRACKED_DESCRIPTOR_SETS);
+      for (uint32_t i = 0; redundant && i < descriptorSetCount; i++)
+         redundant = (state.descriptorSets[firstSet + i] == descriptorSets[i]);
+
+      if (redundant)
+      {
+         mStatistics.skippedBinds++;
+         return false;
+      }
+
+      vkCmdBindDescriptorSets(mHandle, bindPoint, pipelineLayout, firstSet, descriptorSetCount, descriptorSets, 0, NULL);
+      mStatistics.descriptorSetBinds++;
+
+      if (state.pipelineLayout != pipelineLayout)
+      {
+         state.pipelineLayout = pipelineLayout;
+         state.descriptorSets.fill(VK_NULL_HANDLE);
+      }
+
+      for (uint32_t i = 0; i < descriptorSetCount && firstSet + i < MAX_TRACKED_DESCRIPTOR_SETS; i++)
+         state.descriptorSets[firstSet + i] = descriptorSets[i];
+
+      return true;
    }
 
    void CommandBuffer::CmdBindDescriptorSet(const PipelineLayout* pipelineLayout, DescriptorSet* descriptorSet)
    {
       VkDescriptorSet descriptorSetVk = descriptorSet->GetVkHandle();
-      vkCmdBindDescriptorSets(mHandle, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout->GetVkHandle(), 0, 1, &descriptorSetVk, 0, NULL);
+      BindDescriptorSets(pipelineLayout->GetVkHandle(), 1, &descriptorSetVk, VK_PIPELINE_BIND_POINT_GRAPHICS, 0);
    }
 
    void CommandBuffer::CmdBindDescriptorSet(VkPipelineLayout pipelineLayout, uint32_t descriptorSetCount, VkDescriptorSet * descriptorSets, VkPipelineBindPoint bindPoint, uint32_t firstSet)
    {
-      vkCmdBindDescriptorSets(mHandle, bindPoint, pipelineLayout, firstSet, descriptorSetCount, descriptorSets, 0, NULL);
+      BindDescriptorSets(pipelineLayout, descriptorSetCount, descriptorSets, bindPoint, firstSet);
    }
    
    void CommandBuffer::CmdBindDescriptorSets(const SharedPtr<Effect>& effect, uint32_t firstSet, VkPipelineBindPoint bindPoint)
    {
       assert(effect->GetNumDescriptorSets() > 0);
 
-      vkCmdBindDescriptorSets(mHandle,
-                              bindPoint,
-                              effect->GetPipelineInterface()->GetPipelineLayout(),
-                              firstSet,
-                              effect->GetNumDescriptorSets(),
-                              effect->GetDescriptorSets(),
-                              0, nullptr);
+      BindDescriptorSets(effect->GetPipelineInterface()->GetPipelineLayout(),
+                         effect->GetNumDescriptorSets(),
+                         effect->GetDescriptorSets(),
+                         bindPoint,
+                         firstSet);
    }
 
-   void CommandBuffer::CmdBindDescriptorSet(const PipelineInterface* pipelineInterface, uint32_t descriptorSetCount, VkDescriptorSet* descriptorSets, VkPipelineBindPoint bindPoint, uint32_t firstSet)
+   void CommandBuffer::CmdBindDescriptorSet(const PipelineInterface* pipelineInterface, uint32_t descriptorSetCount, const VkDescriptorSet* descriptorSets, VkPipelineBindPoint bindPoint, uint32_t firstSet)
    {
-      vkCmdBindDescriptorSets(mHandle, bindPoint, pipelineInterface->GetPipelineLayout(), firstSet, descriptorSetCount, descriptorSets, 0, NULL);
+      BindDescriptorSets(pipelineInterface->GetPipelineLayout(), descriptorSetCount, descriptorSets, bindPoint, firstSet);
    }
 
    void CommandBuffer::CmdPushConstants(const PipelineLayout* pipelineLayout, VkShaderStageFlags shaderStageFlags, uint32_t size, const void* data)
@@ -198,35 +273,60 @@ namespace Utopian::Vk
 
    void CommandBuffer::CmdBindVertexBuffer(uint32_t firstBinding, uint32_t bindingCount, const VkBuffer* buffers)
    {
+      bool redundant = (firstBinding + bindingCount <= MAX_TRACKED_VERTEX_BINDINGS);
+      for (uint32_t i = 0; redundant && i < bindingCount; i++)
+         redundant = (mVertexBuffers[firstBinding + i] == buffers[i]);
+
+      if (redundant)
+      {
+         mStatistics.skippedBinds++;
+         return;
+      }
+
       VkDeviceSize offsets[1] = { 0 };
       vkCmdBindVertexBuffers(mHandle, firstBinding, bindingCount, buffers, offsets);      
+      mStatistics.vertexBufferBinds++;
+
+      for (uint32_t i = 0; i < bindingCount && firstBinding + i < MAX_TRACKED_VERTEX_BINDINGS; i++)
+         mVertexBuffers[firstBinding + i] = buffers[i];
    }
 
    void CommandBuffer::CmdBindVertexBuffer(uint32_t firstBinding, uint32_t bindingCount, Buffer* buffer)
    {
-      VkDeviceSize offsets[1] = { 0 };
       VkBuffer vkBuffer = buffer->GetVkHandle();
-      vkCmdBindVertexBuffers(mHandle, firstBinding, bindingCount, &vkBuffer, offsets);    
+      CmdBindVertexBuffer(firstBinding, bindingCount, &vkBuffer);
    }
 
    void CommandBuffer::CmdBindIndexBuffer(VkBuffer buffer, VkDeviceSize offset, VkIndexType indexType)
    {
+      if (mIndexBuffer == buffer && mIndexBufferOffset == offset && mIndexType == indexType)
+      {
+         mStatistics.skippedBinds++;
+         return;
+      }
+
       vkCmdBindIndexBuffer(mHandle, buffer, offset, indexType);
+      mIndexBuffer = buffer;
+      mIndexBufferOffset = offset;
+      mIndexType = indexType;
+      mStatistics.indexBufferBinds++;
    }
 
    void CommandBuffer::CmdBindIndexBuffer(Buffer* buffer, VkDeviceSize offset, VkIndexType indexType)
    {
-      vkCmdBindIndexBuffer(mHandle, buffer->GetVkHandle(), offset, indexType);
+      CmdBindIndexBuffer(buffer->GetVkHandle(), offset, indexType);
    }
 
    void CommandBuffer::CmdDrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance)
    {
       vkCmdDrawIndexed(mHandle, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+      mStatistics.draws++;
    }
 
    void CommandBuffer::CmdDraw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance)
    {
       vkCmdDraw(mHandle, vertexCount, instanceCount, firstVertex, firstInstance);
+      mStatistics.draws++;
    }
 
    void CommandBuffer::CmdDispatch(uint32_t x, uint32_t y, uint32_t z)
@@ -234,6 +334,14 @@ namespace Utopian::Vk
       vkCmdDispatch(mHandle, x, y, z);
    }
 
+   void CommandBuffer::CmdExecuteCommands(uint32_t commandBufferCount, const VkCommandBuffer* commandBuffers)
+   {
+      vkCmdExecuteCommands(mHandle, commandBufferCount, commandBuffers);
+
+      // The state bound by the primary command buffer is undefined after executing secondary ones
+      InvalidateState();
+   }
+
    bool CommandBuffer::IsActive()
    {
       return mActive;
@@ -248,4 +356,45 @@ namespace Utopian::Vk
    {
       mActive = active;
    }
+
+   void CommandBuffer::InvalidateState()
+   {
+      for (auto& state : mBindPointStates)
+      {
+         state.pipeline = VK_NULL_HANDLE;
+         state.pipelineLayout = VK_NULL_HANDLE;
+         state.descriptorSets.fill(VK_NULL_HANDLE);
+      }
+
+      mVertexBuffers.fill(VK_NULL_HANDLE);
+      mIndexBuffer = VK_NULL_HANDLE;
+      mIndexBufferOffset = 0;
+      mIndexType = VK_INDEX_TYPE_MAX_ENUM;
+   }
+
+   void CommandBuffer::FlushStatistics()
+   {
+      sCurrentStatistics.pipelineBinds += mStatistics.pipelineBinds;
+      sCurrentStatistics.descriptorSetBinds += mStatistics.descriptorSetBinds;
+      sCurrentStatistics.vertexBufferBinds += mStatistics.vertexBufferBinds;
+      sCurrentStatistics.indexBufferBinds += mStatistics.indexBufferBinds;
+      sCurrentStatistics.skippedBinds += mStatistics.skippedBinds;
+      sCurrentStatistics.draws += mStatistics.draws;
+      mStatistics = BindStatistics();
+   }
+
+   void CommandBuffer::EndStatisticsFrame()
+   {
+      sFrameStatistics.pipelineBinds = sCurrentStatistics.pipelineBinds.exchange(0);
+      sFrameStatistics.descriptorSetBinds = sCurrentStatistics.descriptorSetBinds.exchange(0);
+      sFrameStatistics.vertexBufferBinds = sCurrentStatistics.vertexBufferBinds.exchange(0);
+      sFrameStatistics.indexBufferBinds = sCurrentStatistics.indexBufferBinds.exchange(0);
+      sFrameStatistics.skippedBinds = sCurrentStatistics.skippedBinds.exchange(0);
+      sFrameStatistics.draws = sCurrentStatistics.draws.exchange(0);
+   }
+
+   BindStatistics CommandBuffer::GetFrameStatistics()
+   {
+      return sFrameStatistics;
+   }
 }
@@ -1,16 +1,36 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include "vulkan/VulkanPrerequisites.h"
 #include "utility/Common.h"
 #include "Handle.h"
 
 namespace Utopian::Vk
 {
-   /** Wrapper for VkCommandBuffer. */
+   /** Number of state binds recorded into command buffers, see CommandBuffer::GetFrameStatistics(). */
+   struct BindStatistics
+   {
+      uint32_t pipelineBinds = 0;
+      uint32_t descriptorSetBinds = 0;
+      uint32_t vertexBufferBinds = 0;
+      uint32_t indexBufferBinds = 0;
+      uint32_t skippedBinds = 0; // Redundant binds that were never recorded
+      uint32_t draws = 0;
+   };
+
+   /**
+    * Wrapper for VkCommandBuffer.
+    * Keeps track of the bound pipeline, descriptor sets, vertex and index buffers
+    * so that binding the same state again is not recorded.
+    */
    class CommandBuffer : public Handle<VkCommandBuffer>
    {
    public:
       CommandBuffer(Device* device, VkCommandBufferLevel level, bool begin = false);
+
+      /** Allocates the command buffer from commandPool instead of the pool owned by the Device. */
+      CommandBuffer(Device* device, CommandPool* commandPool, VkCommandBufferLevel level, bool begin = false);
       ~CommandBuffer();
 
       /** Should be used for secondary command buffers. */
@@ -33,7 +53,7 @@ namespace Utopian::Vk
       void CmdBindPipeline(const Pipeline* pipeline);
       void CmdBindDescriptorSet(const PipelineLayout* pipelineLayout, DescriptorSet* descriptorSet);
       void CmdBindDescriptorSet(VkPipelineLayout pipelineLayout, uint32_t descriptorSetCount, VkDescriptorSet* descriptorSets, VkPipelineBindPoint bindPoint, uint32_t firstSet = 0);
-      void CmdBindDescriptorSet(const PipelineInterface* pipelineInterface, uint32_t descriptorSetCount, VkDescriptorSet* descriptorSets, VkPipelineBindPoint bindPoint, uint32_t firstSet = 0);
+      void CmdBindDescriptorSet(const PipelineInterface* pipelineInterface, uint32_t descriptorSetCount, const VkDescriptorSet* descriptorSets, VkPipelineBindPoint bindPoint, uint32_t firstSet = 0);
       void CmdBindDescriptorSets(const SharedPtr<Effect>& effect, uint32_t firstSet = 0, VkPipelineBindPoint bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS);
       void CmdPushConstants(const PipelineLayout* pipelineLayout, VkShaderStageFlags shaderStageFlags, uint32_t size, const void* data);
       void CmdPushConstants(const PipelineInterface* pipelineInterface, VkShaderStageFlags shaderStageFlags, uint32_t size, const void* data);
@@ -44,12 +64,64 @@ namespace Utopian::Vk
       void CmdDrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance);
       void CmdDraw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance);
       void CmdDispatch(uint32_t x, uint32_t y, uint32_t z);
+      void CmdExecuteCommands(uint32_t commandBufferCount, const VkCommandBuffer* commandBuffers);
 
       bool IsActive();
       void ToggleActive();
       void SetActive(bool active);
+
+      /** Forgets the tracked state, needed if commands are recorded to the VkCommandBuffer directly. */
+      void InvalidateState();
+
+      /** Moves the statistics gathered since the last call to the ones returned by GetFrameStatistics(). */
+      static void EndStatisticsFrame();
+
+      /** Returns the bind statistics of all command buffers ended during the previous frame. */
+      static BindStatistics GetFrameStatistics();
    
    private:
+      void Allocate(VkCommandBufferLevel level, bool begin);
+
+      /** Adds the statistics of this command buffer to the frame totals. */
+      void FlushStatistics();
+
+      bool BindDescriptorSets(VkPipelineLayout pipelineLayout, uint32_t descriptorSetCount, const VkDescriptorSet* descriptorSets,
+                              VkPipelineBindPoint bindPoint, uint32_t firstSet);
+
+   private:
+      static const uint32_t MAX_TRACKED_DESCRIPTOR_SETS = 8;
+      static const uint32_t MAX_TRACKED_VERTEX_BINDINGS = 4;
+
+      /** State tracked per bind point, index 0 is graphics and 1 is compute. */
+      struct BindPointState
+      {
+         VkPipeline pipeline;
+         VkPipelineLayout pipelineLayout;
+         std::array<VkDescriptorSet, MAX_TRACKED_DESCRIPTOR_SETS> descriptorSets;
+      };
+
+      CommandPool* mCommandPool;
       bool mActive;
+
+      std::array<BindPointState, 2> mBindPointStates;
+      std::array<VkBuffer, MAX_TRACKED_VERTEX_BINDINGS> mVertexBuffers;
+      VkBuffer mIndexBuffer;
+      VkDeviceSize mIndexBufferOffset;
+      VkIndexType mIndexType;
+      BindStatistics mStatistics;
+
+      struct AtomicBindStatistics
+      {
+         std::atomic<uint32_t> pipelineBinds{0};
+         std::atomic<uint32_t> descriptorSetBinds{0};
+         std::atomic<uint32_t> vertexBufferBinds{0};
+         std::atomic<uint32_t> indexBufferBinds{0};
+         std::atomic<uint32_t> skippedBinds{0};
+         std::atomic<uint32_t> draws{0};
+      };
+
+      // Command buffers are recorded from several threads
+      static AtomicBindStatistics sCurrentStatistics;
+      static BindStatistics sFrameStatistics;
    };
 }
@@ -13,4 +13,9 @@ namespace Utopian::Vk
       createInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
       Debug::ErrorCheck(vkCreateCommandPool(device->GetVkDevice(), &createInfo, nullptr, &mHandle));
    }
+
+   void CommandPool::Reset()
+   {
+      Debug::ErrorCheck(vkResetCommandPool(GetVkDevice(), mHandle, 0));
+   }
 }
@@ -10,6 +10,9 @@ namespace Utopian::Vk
    {
    public:
       CommandPool(Device* device, uint32_t queueFamilyIndex = 0);
+
+      /** Resets all command buffers allocated from the pool, they must not be in use by the GPU. */
+      void Reset();
    private:
    };
 }
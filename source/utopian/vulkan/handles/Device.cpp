@@ -7,10 +7,16 @@
 #include "vulkan/handles/Buffer.h"
 #include "vulkan/handles/Image.h"
 #include "vulkan/handles/DescriptorSet.h"
+#include "vulkan/handles/PipelineCache.h"
+#include "vulkan/UniformAllocator.h"
+#include "vulkan/UploadManager.h"
+#include "vulkan/GeometryPool.h"
 #include "vulkan/Debug.h"
 #include "core/Log.h"
 #include <fstream>
 
+#define PIPELINE_CACHE_PATH "data/pipeline_cache.bin"
+
 #define VMA_IMPLEMENTATION
 #include "../external/vk_mem_alloc.h"
 
@@ -48,14 +54,30 @@ namespace Utopian::Vk
       uint32_t queueFamilyIndex = GetQueueFamilyIndex(VK_QUEUE_GRAPHICS_BIT);
       mCommandPool = new CommandPool(this, queueFamilyIndex);
       mQueue = new Queue(this);
+
+      mFrameGarbage.resize(mNumFramesInFlight);
+      mDescriptorSetUpdateQueues.resize(mNumFramesInFlight);
+      mUniformAllocator = new UniformAllocator(this, mNumFramesInFlight);
+      mPipelineCache = new PipelineCache(this, PIPELINE_CACHE_PATH);
+      mUploadManager = new UploadManager(this);
+      mGeometryPool = new GeometryPool(this);
    }
 
    Device::~Device()
    {
+      // Waits for the uploads in flight, the batches use the command pool
+      delete mUploadManager;
+
       delete mCommandPool;
       delete mQueue;
 
-      GarbageCollect();
+      GarbageCollectAll();
+
+      delete mGeometryPool;
+      delete mUniformAllocator;
+
+      mPipelineCache->Save();
+      delete mPipelineCache;
 
       vmaDestroyAllocator(mAllocator);
       vkDestroyDevice(mDevice, nullptr);
@@ -225,62 +247,107 @@ namespace Utopian::Vk
       return mQueue;
    }
 
+   void Device::SetNumFramesInFlight(uint32_t numFramesInFlight)
+   {
+      assert(numFramesInFlight > 0 && numFramesInFlight <= MAX_FRAMES_IN_FLIGHT);
+
+      GarbageCollectAll();
+
+      mNumFramesInFlight = numFramesInFlight;
+      mFrameIndex = 0;
+      mFrameGarbage.resize(mNumFramesInFlight);
+      mDescriptorSetUpdateQueues.resize(mNumFramesInFlight);
+
+      // No uniform blocks can have been allocated yet
+      delete mUniformAllocator;
+      mUniformAllocator = new UniformAllocator(this, mNumFramesInFlight);
+   }
+
+   uint32_t Device::GetNumFramesInFlight() const
+   {
+      return mNumFramesInFlight;
+   }
+
+   void Device::SetFrameIndex(uint32_t frameIndex)
+   {
+      assert(frameIndex < mNumFramesInFlight);
+      mFrameIndex = frameIndex;
+   }
+
+   uint32_t Device::GetFrameIndex() const
+   {
+      return mFrameIndex;
+   }
+
    void Device::QueueDestroy(SharedPtr<Vk::Buffer>& buffer)
    {
-      mBuffersToFree.push_back(buffer);
+      mFrameGarbage[mFrameIndex].buffersToFree.push_back(buffer);
       buffer = nullptr;
    }
 
    void Device::QueueDestroy(VkPipeline pipeline)
    {
-      mPipelinesToFree.push_back(pipeline);
+      mFrameGarbage[mFrameIndex].pipelinesToFree.push_back(pipeline);
    }
 
    void Device::QueueDestroy(SharedPtr<Vk::Image> image)
    {
-      mImagesToFree.push_back(image);
+      mFrameGarbage[mFrameIndex].imagesToFree.push_back(image);
    }
 
    void Device::QueueDestroy(SharedPtr<Vk::Sampler> sampler)
    {
-      mSamplersToFree.push_back(sampler);
+      mFrameGarbage[mFrameIndex].samplersToFree.push_back(sampler);
    }
 
    void Device::GarbageCollect()
    {
-      if (mBuffersToFree.size() > 0)
-      {
-         mBuffersToFree.clear();
-      }
+      FrameGarbage& garbage = mFrameGarbage[mFrameIndex];
 
-      if (mImagesToFree.size() > 0)
-      {
-         mImagesToFree.clear();
-      }
+      garbage.buffersToFree.clear();
+      garbage.imagesToFree.clear();
+      garbage.samplersToFree.clear();
 
-      if (mSamplersToFree.size() > 0)
+      for (auto& pipeline : garbage.pipelinesToFree)
+         vkDestroyPipeline(GetVkDevice(), pipeline, nullptr);
+
+      garbage.pipelinesToFree.clear();
+
+      mGeometryPool->GarbageCollect(mFrameIndex);
+   }
+
+   void Device::GarbageCollectAll()
+   {
+      uint32_t frameIndex = mFrameIndex;
+
+      for (uint32_t i = 0; i < mFrameGarbage.size(); i++)
       {
-         mSamplersToFree.clear();
+         mFrameIndex = i;
+         GarbageCollect();
       }
 
-      for (auto& pipeline : mPipelinesToFree)
-         vkDestroyPipeline(GetVkDevice(), pipeline, nullptr);
-
-      if (mPipelinesToFree.size() > 0)
-         mPipelinesToFree.clear();
+      mFrameIndex = frameIndex;
    }
 
-   void Device::QueueDescriptorUpdate(Vk::DescriptorSet* descriptorSet)
+   void Device::QueueDescriptorUpdate(const SharedPtr<Vk::DescriptorSet>& descriptorSet, uint32_t frameIndex)
    {
-      mDescriptorSetUpdateQueue.push_back(descriptorSet);
+      assert(frameIndex < mNumFramesInFlight);
+
+      std::lock_guard<std::mutex> lock(mDescriptorSetUpdateMutex);
+      mDescriptorSetUpdateQueues[frameIndex].push_back(descriptorSet);
    }
 
    void Device::UpdateDescriptorSets()
    {
-      for (auto& descriptorSet : mDescriptorSetUpdateQueue)
+      std::lock_guard<std::mutex> lock(mDescriptorSetUpdateMutex);
+
+      // The frame fence of this slot has been waited on so none of the sets are in use
+      std::vector<SharedPtr<Vk::DescriptorSet>>& updateQueue = mDescriptorSetUpdateQueues[mFrameIndex];
+
+      for (auto& descriptorSet : updateQueue)
          descriptorSet->UpdateDescriptorSets();
 
-      mDescriptorSetUpdateQueue.clear();
+      updateQueue.clear();
    }
 
    VmaAllocation Device::AllocateMemory(Image* image, VkMemoryPropertyFlags flags)
@@ -381,6 +448,26 @@ namespace Utopian::Vk
       vmaFreeStatsString(mAllocator, statsPtr);
    }
 
+   UniformAllocator* Device::GetUniformAllocator() const
+   {
+      return mUniformAllocator;
+   }
+
+   PipelineCache* Device::GetPipelineCache() const
+   {
+      return mPipelineCache;
+   }
+
+   UploadManager* Device::GetUploadManager() const
+   {
+      return mUploadManager;
+   }
+
+   GeometryPool* Device::GetGeometryPool() const
+   {
+      return mGeometryPool;
+   }
+
    CommandPool* Device::GetCommandPool() const
    {
       return mCommandPool;
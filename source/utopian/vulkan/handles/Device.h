@@ -3,12 +3,17 @@
 #include <vulkan/vulkan.h>
 #include <vector>
 #include <string>
+#include <mutex>
 #include "vulkan/VulkanPrerequisites.h"
 #include "utopian/utility/Common.h"
 #include "../external/vk_mem_alloc.h"
 
 namespace Utopian::Vk
 {
+   /** Upper limit of how many frames the CPU can record ahead of the GPU. */
+   const uint32_t MAX_FRAMES_IN_FLIGHT = 3;
+   const uint32_t DEFAULT_FRAMES_IN_FLIGHT = 2;
+
    struct VulkanVersion
    {
       VulkanVersion();
@@ -34,19 +39,44 @@ namespace Utopian::Vk
        */
       Queue* GetQueue() const;
 
-      /** Adds the buffers the a garbage collect list that will be destroyed once no command buffer is active. */
+      /**
+       * Sets how many frames can be recorded while the GPU is still executing earlier ones.
+       * @note Must be called before any per-frame resources are created.
+       */
+      void SetNumFramesInFlight(uint32_t numFramesInFlight);
+      uint32_t GetNumFramesInFlight() const;
+
+      /** Sets the frame slot in [0, GetNumFramesInFlight()) that the CPU is currently recording. */
+      void SetFrameIndex(uint32_t frameIndex);
+      uint32_t GetFrameIndex() const;
+
+      /**
+       * Adds the resources to the garbage collect list of the current frame slot. They are destroyed
+       * when the slot is reused, at that point the GPU is done with the frame that last used them.
+       */
       void QueueDestroy(SharedPtr<Vk::Buffer>& buffer);
       void QueueDestroy(VkPipeline pipeline);
       void QueueDestroy(SharedPtr<Vk::Image> image);
       void QueueDestroy(SharedPtr<Vk::Sampler> sampler);
 
-      /** Destroys all Vulkan resources that have been added to the garbage collect list. */
+      /**
+       * Destroys the Vulkan resources in the garbage collect list of the current frame slot and
+       * releases the GeometryPool ranges freed by it.
+       */
       void GarbageCollect();
 
-      /** Queues an update of a descriptor set that is performed once no command buffer is active. */
-      void QueueDescriptorUpdate(Vk::DescriptorSet* descriptorSet);
+      /** Destroys the garbage collect lists of all frame slots, the GPU must be idle. */
+      void GarbageCollectAll();
+
+      /**
+       * Queues an update of a descriptor set that is only bound by the given frame slot.
+       * The update is performed when the slot is recorded next, at that point the GPU is done with
+       * the previous frame that used the set. Sets that are rewritten at runtime therefore need one copy
+       * per frame in flight, see Material::descriptorSets.
+       */
+      void QueueDescriptorUpdate(const SharedPtr<Vk::DescriptorSet>& descriptorSet, uint32_t frameIndex);
 
-      /** Perform descriptor set update on queued objects. */
+      /** Performs the descriptor set updates queued for the current frame slot. */
       void UpdateDescriptorSets();
 
       /* Memory management. */
@@ -72,6 +102,18 @@ namespace Utopian::Vk
       /* Returns physical device properties. */
       const VkPhysicalDeviceProperties& GetProperties() const;
 
+      /** Returns the allocator that the per-frame uniform blocks are sub-allocated from. */
+      UniformAllocator* GetUniformAllocator() const;
+
+      /** Returns the pipeline cache shared by all pipelines, saved to disk when the device is destroyed. */
+      PipelineCache* GetPipelineCache() const;
+
+      /** Returns the manager that batches the staging uploads to device local buffers and images. */
+      UploadManager* GetUploadManager() const;
+
+      /** Returns the pool that the vertex and index buffers of primitives are sub-allocated from. */
+      GeometryPool* GetGeometryPool() const;
+
       /** Returns the command pool from the device which new command buffers can be allocated from. */
       CommandPool* GetCommandPool() const;
 
@@ -103,15 +145,27 @@ namespace Utopian::Vk
 
       CommandPool* mCommandPool = nullptr;
       Queue* mQueue = nullptr;
+      UniformAllocator* mUniformAllocator = nullptr;
+      PipelineCache* mPipelineCache = nullptr;
+      UploadManager* mUploadManager = nullptr;
+      GeometryPool* mGeometryPool = nullptr;
       bool mDebugMarkersEnabled = false;
 
       // Garbage collection
-      std::vector<SharedPtr<Vk::Buffer>> mBuffersToFree;
-      std::vector<VkPipeline> mPipelinesToFree;
-      std::vector<SharedPtr<Vk::Image>> mImagesToFree;
-      std::vector<SharedPtr<Vk::Sampler>> mSamplersToFree;
+      struct FrameGarbage
+      {
+         std::vector<SharedPtr<Vk::Buffer>> buffersToFree;
+         std::vector<VkPipeline> pipelinesToFree;
+         std::vector<SharedPtr<Vk::Image>> imagesToFree;
+         std::vector<SharedPtr<Vk::Sampler>> samplersToFree;
+      };
+
+      std::vector<FrameGarbage> mFrameGarbage;
+      uint32_t mNumFramesInFlight = 1;
+      uint32_t mFrameIndex = 0;
 
       // Descriptor update
-      std::vector<Vk::DescriptorSet*> mDescriptorSetUpdateQueue;
+      std::vector<std::vector<SharedPtr<Vk::DescriptorSet>>> mDescriptorSetUpdateQueues;
+      std::mutex mDescriptorSetUpdateMutex;
    };
 }
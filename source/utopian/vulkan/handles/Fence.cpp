@@ -37,6 +37,11 @@ namespace Utopian::Vk
       Reset();
    }
 
+   bool Fence::IsSignaled() const
+   {
+      return vkGetFenceStatus(GetVkDevice(), mHandle) == VK_SUCCESS;
+   }
+
    void Fence::Reset()
    {
       vkResetFences(GetVkDevice(), 1, &mHandle);
@@ -14,6 +14,9 @@ namespace Utopian::Vk
       void Create(VkFenceCreateFlags flags);
       void Wait();
       void Reset();
+
+      /** Returns true if the fence is signaled, does not block. */
+      bool IsSignaled() const;
    private:
    };
 }
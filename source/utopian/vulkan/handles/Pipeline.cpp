@@ -1,9 +1,11 @@
 #include "vulkan/handles/Pipeline.h"
 #include "vulkan/handles/RenderPass.h"
+#include "vulkan/handles/PipelineCache.h"
 #include "vulkan/Debug.h"
 #include "vulkan/PipelineInterface.h"
 #include "vulkan/ShaderFactory.h"
 #include "core/renderer/RendererUtility.h"
+#include "utility/Timer.h"
 #include <vulkan/VulkanPrerequisites.h>
 
 namespace Utopian::Vk
@@ -80,7 +82,10 @@ namespace Utopian::Vk
       createInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
       createInfo.layout = pipelineInterface->GetPipelineLayout();
       createInfo.stage = shader->shaderStages[0];
-      vkCreateComputePipelines(GetVkDevice(), VK_NULL_HANDLE, 1, &createInfo, nullptr, &mHandle);
+      // Only the driver call is timed so that compute and graphics pipelines are measured the same way
+      Timestamp startTime = gTimer().GetTimestamp();
+      Debug::ErrorCheck(vkCreateComputePipelines(GetVkDevice(), GetDevice()->GetPipelineCache()->GetVkHandle(), 1, &createInfo, nullptr, &mHandle));
+      GetDevice()->GetPipelineCache()->AddCreationTime(gTimer().GetElapsedTime(startTime));
    }
 
    void Pipeline::CreateGraphicsPipeline(Shader* shader, PipelineInterface* pipelineInterface)
@@ -148,7 +153,9 @@ namespace Utopian::Vk
       pipelineCreateInfo.pStages = shader->shaderStages.data();
 
       // Create the pipeline
-      Debug::ErrorCheck(vkCreateGraphicsPipelines(GetVkDevice(), VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &mHandle));
+      Timestamp startTime = gTimer().GetTimestamp();
+      Debug::ErrorCheck(vkCreateGraphicsPipelines(GetVkDevice(), GetDevice()->GetPipelineCache()->GetVkHandle(), 1, &pipelineCreateInfo, nullptr, &mHandle));
+      GetDevice()->GetPipelineCache()->AddCreationTime(gTimer().GetElapsedTime(startTime));
    }
 
    bool Pipeline::IsComputePipeline() const
@@ -0,0 +1,113 @@
+#include <fstream>
+#include <cstring>
+#include "vulkan/handles/PipelineCache.h"
+#include "vulkan/handles/Device.h"
+#include "vulkan/Debug.h"
+#include "core/Log.h"
+
+namespace Utopian::Vk
+{
+   PipelineCache::PipelineCache(Device* device, std::string filename)
+      : Handle(device, vkDestroyPipelineCache)
+   {
+      mFilename = filename;
+      mWarm = false;
+      mNumCreatedPipelines = 0u;
+      mTotalCreationTimeUs = 0u;
+
+      std::vector<uint8_t> data;
+      std::ifstream fin(filename, std::ios::binary | std::ios::ate);
+      if (fin.is_open())
+      {
+         data.resize((size_t)fin.tellg());
+         fin.seekg(0);
+         fin.read((char*)data.data(), data.size());
+
+         if (!IsCompatible(data, device->GetProperties()))
+         {
+            UTO_LOG("Discarding incompatible pipeline cache " + filename);
+            data.clear();
+         }
+      }
+
+      VkPipelineCacheCreateInfo createInfo = {};
+      createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+      createInfo.initialDataSize = data.size();
+      createInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+      Debug::ErrorCheck(vkCreatePipelineCache(GetVkDevice(), &createInfo, nullptr, &mHandle));
+
+      mWarm = !data.empty();
+      if (mWarm)
+         UTO_LOG("Loaded pipeline cache " + filename + " (" + std::to_string(data.size()) + " bytes)");
+   }
+
+   void PipelineCache::Save()
+   {
+      size_t size = 0;
+      Debug::ErrorCheck(vkGetPipelineCacheData(GetVkDevice(), mHandle, &size, nullptr));
+
+      std::vector<uint8_t> data(size);
+      Debug::ErrorCheck(vkGetPipelineCacheData(GetVkDevice(), mHandle, &size, data.data()));
+
+      std::ofstream fout(mFilename, std::ios::binary);
+      if (!fout.is_open())
+      {
+         UTO_LOG("Failed to write pipeline cache " + mFilename);
+         return;
+      }
+
+      fout.write((const char*)data.data(), size);
+
+      UTO_LOG("Saved pipeline cache " + mFilename + " (" + std::to_string(size) + " bytes), " +
+              std::to_string(GetNumCreatedPipelines()) + " pipelines created in " +
+              std::to_string(GetTotalCreationTime()) + " ms with a " + (mWarm ? "warm" : "cold") + " cache");
+   }
+
+   void PipelineCache::AddCreationTime(double milliseconds)
+   {
+      mNumCreatedPipelines++;
+      mTotalCreationTimeUs += (uint64_t)(milliseconds * 1000.0);
+   }
+
+   bool PipelineCache::IsWarm() const
+   {
+      return mWarm;
+   }
+
+   uint32_t PipelineCache::GetNumCreatedPipelines() const
+   {
+      return mNumCreatedPipelines;
+   }
+
+   double PipelineCache::GetTotalCreationTime() const
+   {
+      return mTotalCreationTimeUs / 1000.0;
+   }
+
+   bool PipelineCache::IsCompatible(const std::vector<uint8_t>& data, const VkPhysicalDeviceProperties& properties)
+   {
+      // The driver is allowed to reject the data but not all of them do, so the
+      // header written by vkGetPipelineCacheData() is validated here as well.
+      // The UUID changes with the driver version.
+      struct
+      {
+         uint32_t headerSize;
+         uint32_t headerVersion;
+         uint32_t vendorID;
+         uint32_t deviceID;
+         uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+      } header;
+
+      if (data.size() < sizeof(header))
+         return false;
+
+      memcpy(&header, data.data(), sizeof(header));
+
+      return header.headerSize >= sizeof(header) &&
+             header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+             header.vendorID == properties.vendorID &&
+             header.deviceID == properties.deviceID &&
+             memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+   }
+}
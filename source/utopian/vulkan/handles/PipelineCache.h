@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include "Handle.h"
+#include "vulkan/VulkanPrerequisites.h"
+
+namespace Utopian::Vk
+{
+   /**
+    * Wrapper for VkPipelineCache.
+    * The cache is shared by all pipelines created on the device and is serialized to disk
+    * so that the driver compilation cost is only paid the first time a pipeline is created.
+    */
+   class PipelineCache : public Handle<VkPipelineCache>
+   {
+   public:
+      /**
+       * Creates the cache with the initial data read from filename.
+       * The data is discarded if it was written by another vendor, device or driver version.
+       */
+      PipelineCache(Device* device, std::string filename);
+
+      /** Writes the current content of the cache to the file it was loaded from. */
+      void Save();
+
+      /** Accumulates the time spent creating pipelines, used to measure the effect of the cache. */
+      void AddCreationTime(double milliseconds);
+
+      /** Returns true if valid data was loaded from disk. */
+      bool IsWarm() const;
+
+      uint32_t GetNumCreatedPipelines() const;
+      double GetTotalCreationTime() const;
+
+   private:
+      static bool IsCompatible(const std::vector<uint8_t>& data, const VkPhysicalDeviceProperties& properties);
+
+      std::string mFilename;
+      bool mWarm;
+      std::atomic<uint32_t> mNumCreatedPipelines;
+      std::atomic<uint64_t> mTotalCreationTimeUs;
+   };
+}
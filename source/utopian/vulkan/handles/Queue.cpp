@@ -1,5 +1,6 @@
 #include "vulkan/Debug.h"
 #include "vulkan/handles/Device.h"
+#include "vulkan/UploadManager.h"
 #include "Queue.h"
 #include "Fence.h"
 #include "CommandBuffer.h"
@@ -7,6 +8,8 @@
 
 namespace Utopian::Vk
 {
+   static thread_local std::vector<Queue::Submission>* tDeferredSubmits = nullptr;
+
    Queue::Queue(Device* device)
       : Handle(device, nullptr)
    {
@@ -22,6 +25,14 @@ namespace Utopian::Vk
 
    void Queue::Submit(CommandBuffer* commandBuffer, Fence* renderFence, const SharedPtr<Semaphore>& waitSemaphore, const SharedPtr<Semaphore>& signalSemaphore)
    {
+      if (tDeferredSubmits != nullptr)
+      {
+         tDeferredSubmits->push_back({commandBuffer, renderFence, waitSemaphore, signalSemaphore});
+         return;
+      }
+
+      SubmitUploads();
+
       VkSubmitInfo submitInfo = {};
 
       //VkPipelineStageFlags stageFlags = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
@@ -55,6 +66,75 @@ namespace Utopian::Vk
          Debug::ErrorCheck(vkQueueSubmit(GetVkHandle(), 1, &submitInfo, renderFence->GetVkHandle()));
    }
 
+   void Queue::Submit(const std::vector<Submission>& submissions)
+   {
+      if (submissions.empty())
+         return;
+
+      SubmitUploads();
+
+      VkPipelineStageFlags stageFlags = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+      std::vector<VkSubmitInfo> submitInfos(submissions.size());
+      Fence* renderFence = nullptr;
+
+      for (uint32_t i = 0; i < submissions.size(); i++)
+      {
+         const Submission& submission = submissions[i];
+         VkSubmitInfo& submitInfo = submitInfos[i];
+         submitInfo = {};
+         submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+
+         if (submission.waitSemaphore != nullptr)
+         {
+            submitInfo.waitSemaphoreCount = 1;
+            submitInfo.pWaitSemaphores = submission.waitSemaphore->GetVkHandlePtr();
+         }
+
+         if (submission.signalSemaphore != nullptr)
+         {
+            submitInfo.signalSemaphoreCount = 1;
+            submitInfo.pSignalSemaphores = submission.signalSemaphore->GetVkHandlePtr();
+         }
+
+         submitInfo.pWaitDstStageMask = &stageFlags;
+         submitInfo.commandBufferCount = 1;
+         submitInfo.pCommandBuffers = submission.commandBuffer->GetVkHandlePtr();
+
+         // A fence signals when all batches in the call complete so only one of them can have one
+         if (submission.renderFence != nullptr)
+         {
+            assert(renderFence == nullptr);
+            renderFence = submission.renderFence;
+         }
+      }
+
+      VkFence fence = (renderFence != nullptr) ? renderFence->GetVkHandle() : VK_NULL_HANDLE;
+      Debug::ErrorCheck(vkQueueSubmit(GetVkHandle(), (uint32_t)submitInfos.size(), submitInfos.data(), fence));
+   }
+
+   void Queue::SubmitUploads()
+   {
+      // The command buffers can use data that has been recorded for upload but not yet submitted
+      UploadManager* uploadManager = GetDevice()->GetUploadManager();
+      if (uploadManager != nullptr)
+         uploadManager->Submit();
+   }
+
+   void Queue::SetDeferredSubmits(std::vector<Submission>* submissions)
+   {
+      tDeferredSubmits = submissions;
+   }
+
+   std::vector<Queue::Submission>* Queue::GetDeferredSubmits()
+   {
+      return tDeferredSubmits;
+   }
+
+   bool Queue::IsDeferringSubmits()
+   {
+      return tDeferredSubmits != nullptr;
+   }
+
    void Queue::WaitIdle()
    {
       Debug::ErrorCheck(vkQueueWaitIdle(GetVkHandle()));
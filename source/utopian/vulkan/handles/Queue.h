@@ -1,5 +1,6 @@
 #pragma once
 
+#include <vector>
 #include "Handle.h"
 #include "vulkan/VulkanPrerequisites.h"
 #include "vulkan/handles/Semaphore.h"
@@ -11,15 +12,39 @@ namespace Utopian::Vk
    class Queue : public Handle<VkQueue>
    {
    public:
+      /** A submit call that has been deferred, see SetDeferredSubmits(). */
+      struct Submission
+      {
+         CommandBuffer* commandBuffer;
+         Fence* renderFence;
+         SharedPtr<Semaphore> waitSemaphore;
+         SharedPtr<Semaphore> signalSemaphore;
+      };
+
       Queue(Device* device);
       ~Queue();
 
       /**
        * Submits a recorded command buffer to the graphics queue.
+       * Uploads recorded by the UploadManager are submitted first.
        */
       void Submit(CommandBuffer* commandBuffer, Fence* renderFence, const SharedPtr<Semaphore>& waitSemaphore, const SharedPtr<Semaphore>& signalSemaphore);
+
+      /** Submits deferred submissions in the order they appear in the list with a single vkQueueSubmit. */
+      void Submit(const std::vector<Submission>& submissions);
       void WaitIdle();
 
+      /**
+       * While set, Submit() calls made from the calling thread are appended to submissions instead
+       * of being sent to the queue. Lets command buffers be recorded on worker threads and submitted
+       * later in a fixed order. Pass nullptr to submit directly again.
+       */
+      static void SetDeferredSubmits(std::vector<Submission>* submissions);
+      static std::vector<Submission>* GetDeferredSubmits();
+      static bool IsDeferringSubmits();
+
    protected:
+      /** Submits the pending batch of the UploadManager so that it executes before the next submission. */
+      void SubmitUploads();
    };
 }